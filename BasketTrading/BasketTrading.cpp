@@ -26,6 +26,8 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <OUCommon/BinaryLog.h>
+
 #include <TFTrading/InstrumentManager.h>
 #include <TFTrading/AccountManager.h>
 #include <TFTrading/OrderManager.h>
@@ -52,6 +54,14 @@ bool AppBasketTrading::OnInit() {
   m_sDbName = "BasketTrading.db";
   m_sStateFileName = "BasketTrading.state";
 
+  try {
+    ou::BinaryLog::Open( "BasketTrading.log", ou::BinaryLog::Text );
+    ou::BinaryLog::SetLevel( ou::BinaryLog::Debug ); // the combo and leg net values, logged at Debug under "Combo"
+  }
+  catch ( const std::runtime_error& e ) {
+    std::cout << e.what() << std::endl;
+  }
+
   m_dtLatestEod = ptime( date( 2019, 6, 28 ), time_duration( 23, 59, 59 ) );
 
   m_pFrameMain = new FrameMain( 0, wxID_ANY, "Basket Trading" );
@@ -474,6 +484,8 @@ void AppBasketTrading::OnClose( wxCloseEvent& event ) {
 
 int AppBasketTrading::OnExit() {
 
+  ou::BinaryLog::Close();
+
   return 0;
 }
 
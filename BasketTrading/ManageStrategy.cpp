@@ -151,10 +151,10 @@ ManageStrategy::ManageStrategy(
   m_fBar( fBar ),
   m_eTradeDirection( ETradeDirection::None ),
   m_bfQuotes01Sec( 1 ),
-  m_bfTrades01Sec( 1 ),
-  m_bfTrades06Sec( 6 ),
+  m_ixTrades01Sec( m_blTrades.Add( ou::tf::BarLadder::Resolution::Seconds( 1 ) ) ),
+  m_ixTrades06Sec( m_blTrades.Add( ou::tf::BarLadder::Resolution::Seconds( 6 ) ) ),
 //  m_bfTicks06sec( 6 ),
-//  m_bfTrades60Sec( 60 ),
+//  m_ixTrades60Sec( m_blTrades.Add( ou::tf::BarLadder::Resolution::Seconds( 60 ) ) ),
 //  m_cntUpReturn {}, m_cntDnReturn {},
   m_stateEma( EmaState::EmaUnstable ),
   m_stateBollinger( EBollingerState::Unknown ),
@@ -220,10 +220,11 @@ ManageStrategy::ManageStrategy(
   pcdvStrategyData->Add( EChartSlot::Price, &m_ceLongExits );
 
   m_bfQuotes01Sec.SetOnBarComplete( MakeDelegate( this, &ManageStrategy::HandleBarQuotes01Sec ) );
-  m_bfTrades01Sec.SetOnBarComplete( MakeDelegate( this, &ManageStrategy::HandleBarTrades01Sec ) );
-  m_bfTrades06Sec.SetOnBarComplete( MakeDelegate( this, &ManageStrategy::HandleBarTrades06Sec ) );
+  m_blTrades.SetOnBarComplete(
+    [this]( size_t ix, const ou::tf::Bar& bar ){
+      HandleBarTrades( ix, bar );
+    } );
   //m_bfTicks06sec.SetOnBarComplete( MakeDelegate( this, &ManageStrategy::HandleBarTicks06Sec ) );
-//  m_bfTrades60Sec.SetOnBarComplete( MakeDelegate( this, &ManageStrategy::HandleBarTrades60Sec ) );
 
   ReadDailyBars( m_sDailyBarPath );
 
@@ -468,9 +469,7 @@ void ManageStrategy::HandleTradeUnderlying( const ou::tf::Trade& trade ) {
 //  if ( trade.Price() < m_TradeLatest.Price() ) m_cntDnReturn--;
 //  m_trades.Append( trade );
   //m_bfTicks06sec.Add( trade.DateTime(), 0, 1 );
-  m_bfTrades01Sec.Add( trade );
-  m_bfTrades06Sec.Add( trade );
-//  m_bfTrades60Sec.Add( trade );
+  m_blTrades.Add( trade );
   TimeTick( trade );
   m_TradeUnderlyingLatest = trade; // allow previous one to be used till last moment
 }
@@ -1011,6 +1010,12 @@ void ManageStrategy::HandleBarQuotes01Sec( const ou::tf::Bar& bar ) {
   TimeTick( bar );
 }
 
+void ManageStrategy::HandleBarTrades( size_t ix, const ou::tf::Bar& bar ) {
+  if ( m_ixTrades01Sec == ix ) HandleBarTrades01Sec( bar );
+  else if ( m_ixTrades06Sec == ix ) HandleBarTrades06Sec( bar );
+//  else if ( m_ixTrades60Sec == ix ) HandleBarTrades60Sec( bar );
+}
+
 void ManageStrategy::HandleBarTrades01Sec( const ou::tf::Bar& bar ) {
 
   if ( 0 == m_vEMA.size() ) {  // issue here is that as vector is updated, memory is moved, using heap instead
@@ -1078,7 +1083,7 @@ void ManageStrategy::HandleBarTicks06Sec( const ou::tf::Bar& bar ) {
   m_ceTickCount.Append( bar.DateTime(), bar.Volume() );
 }
 
-// unused without m_bfTrades60Sec
+// unused without m_ixTrades60Sec
 void ManageStrategy::HandleBarTrades60Sec( const ou::tf::Bar& bar ) { // sentiment event trigger for MasterPortfolio
   //m_fBar( *this, bar );
 }
@@ -1112,6 +1117,42 @@ double ManageStrategy::EmitInfo() {
   return dblNet;
 }
 
+void ManageStrategy::ScenarioSnapshots( ptime dtUtcNow, mapScenarioSnapshot_t& map ) {
+  if ( !m_pPositionUnderlying ) return;
+  const double price( m_TradeUnderlyingLatest.Price() );
+  if ( 0.0 == price ) return;
+  for ( mapCombo_t::value_type& vt: m_mapCombo ) {
+    combo_t* pCombo = std::dynamic_pointer_cast<combo_t>( vt.second ).get();
+    ou::tf::option::ScenarioRisk::Snapshot snapshot;
+    pCombo->Snapshot( dtUtcNow, snapshot.vLeg );
+    if ( !snapshot.vLeg.empty() ) {
+      snapshot.sUnderlying = m_sUnderlying;
+      snapshot.dblUnderlying = price;
+      map[ pCombo->GetPortfolio()->Id() ] = std::move( snapshot );
+    }
+  }
+  const ou::tf::Position::TableRowDef& row( m_pPositionUnderlying->GetRow() );
+  if ( 0 != row.nPositionActive ) { // signed as Leg::Snapshot
+    ou::tf::option::ScenarioRisk::Leg leg;
+    switch ( row.eOrderSideActive ) {
+      case ou::tf::OrderSide::Buy:
+        leg.dblQuantity = row.nPositionActive;
+        break;
+      case ou::tf::OrderSide::Sell:
+        leg.dblQuantity = -(double)row.nPositionActive;
+        break;
+      default:
+        break;
+    }
+    if ( 0.0 != leg.dblQuantity ) {
+      ou::tf::option::ScenarioRisk::Snapshot& snapshot( map[ m_pPortfolioStrategy->Id() ] );
+      snapshot.sUnderlying = m_sUnderlying;
+      snapshot.dblUnderlying = price;
+      snapshot.vLeg.push_back( leg );
+    }
+  }
+}
+
 void ManageStrategy::CloseExpiryItm( boost::gregorian::date date ) {
   double price( m_TradeUnderlyingLatest.Price() );
   for ( mapCombo_t::value_type& vt: m_mapCombo ) {
@@ -21,6 +21,7 @@
 #ifndef MANAGESTRATEGY_H
 #define MANAGESTRATEGY_H
 
+#include <map>
 #include <string>
 #include <memory>
 #include <functional>
@@ -37,6 +38,7 @@
 
 #include <TFTimeSeries/TimeSeries.h>
 #include <TFTimeSeries/BarFactory.h>
+#include <TFTimeSeries/BarLadder.h>
 
 #include <TFIndicators/TSSWStats.h>
 
@@ -44,6 +46,7 @@
 
 #include <TFOptions/Chain.h>
 #include <TFOptions/Option.h>
+#include <TFOptions/ScenarioRisk.h>
 #include <TFOptionCombos/Combo.h>
 
 #include <TFTrading/Position.h>
@@ -148,6 +151,10 @@ public:
 
   double EmitInfo();
 
+  // active combos, and the underlying position, keyed by portfolio id, the caller fills in the rate
+  using mapScenarioSnapshot_t = std::map<idPortfolio_t,ou::tf::option::ScenarioRisk::Snapshot>;
+  void ScenarioSnapshots( ptime dtUtcNow, mapScenarioSnapshot_t& );
+
 protected:
 private:
 
@@ -264,9 +271,10 @@ private:
 
   ou::tf::BarFactory m_bfQuotes01Sec; // provides more frequent ticks for Order Monitoring
 
-  ou::tf::BarFactory m_bfTrades01Sec; // ema calcs
-  ou::tf::BarFactory m_bfTrades06Sec; // charting
-  //ou::tf::BarFactory m_bfTrades60Sec; // sentiment analysis
+  ou::tf::BarLadder m_blTrades; // one pass per trade for the trade based bars
+  size_t m_ixTrades01Sec; // ema calcs
+  size_t m_ixTrades06Sec; // charting
+  //size_t m_ixTrades60Sec; // sentiment analysis
 
   //ou::tf::BarFactory m_bfTicks06sec; // monitors liquidity, use to determine a minimum count for entry
 
@@ -382,6 +390,7 @@ private:
 
   void HandleBarQuotes01Sec( const ou::tf::Bar& bar );
 
+  void HandleBarTrades( size_t ix, const ou::tf::Bar& bar );
   void HandleBarTrades01Sec( const ou::tf::Bar& bar );
   void HandleBarTrades06Sec( const ou::tf::Bar& bar );
   void HandleBarTrades60Sec( const ou::tf::Bar& bar );
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 
 #include <set>
+#include <cmath>
 #include <algorithm>
 
 #include <OUCommon/TimeSource.h>
@@ -30,7 +31,33 @@
 #include "MasterPortfolio.h"
 
 namespace {
+
   const std::string sPortfolioPrefix( "strategy-" );
+
+  // a combo is revalued only when its snapshot has moved past these since it was last set
+  const double dblScenarioUnderlying( 0.0005 ); // fraction of price
+  const double dblScenarioVolatility( 0.0025 ); // a quarter vol point
+  const double dblScenarioYears( 1.0 / 365.0 ); // a day
+  const double dblScenarioRate( 0.0001 );
+
+  bool ScenarioChanged( const ou::tf::option::ScenarioRisk::Snapshot& prior, const ou::tf::option::ScenarioRisk::Snapshot& next ) {
+    if ( prior.sUnderlying != next.sUnderlying ) return true;
+    if ( prior.vLeg.size() != next.vLeg.size() ) return true;
+    if ( dblScenarioUnderlying * prior.dblUnderlying < std::abs( next.dblUnderlying - prior.dblUnderlying ) ) return true;
+    if ( dblScenarioRate < std::abs( next.dblRate - prior.dblRate ) ) return true;
+    if ( dblScenarioRate < std::abs( next.dblCarry - prior.dblCarry ) ) return true;
+    for ( size_t ix = 0; ix < next.vLeg.size(); ix++ ) {
+      const ou::tf::option::ScenarioRisk::Leg& legPrior( prior.vLeg[ ix ] );
+      const ou::tf::option::ScenarioRisk::Leg& legNext( next.vLeg[ ix ] );
+      if ( legPrior.side != legNext.side ) return true;
+      if ( legPrior.dblStrike != legNext.dblStrike ) return true;
+      if ( legPrior.dblQuantity != legNext.dblQuantity ) return true;
+      if ( dblScenarioVolatility < std::abs( legNext.dblVolatility - legPrior.dblVolatility ) ) return true;
+      if ( dblScenarioYears < std::abs( legNext.dblYears - legPrior.dblYears ) ) return true;
+    }
+    return false;
+  }
+
 }
 
 MasterPortfolio::MasterPortfolio(
@@ -118,6 +145,12 @@ MasterPortfolio::MasterPortfolio(
 
   m_libor.SetWatchOn( m_pIQ );
 
+  ou::tf::option::ScenarioRisk::Grid grid;
+  grid.vUnderlying = { -0.10, -0.05, -0.02, 0.0, 0.02, 0.05, 0.10 };
+  grid.vVolatility = { -0.05, 0.0, 0.05 };
+  grid.vDays = { 0.0, 1.0 };
+  m_scenario.SetGrid( grid );
+
 }
 
 MasterPortfolio::~MasterPortfolio(void) {
@@ -783,6 +816,81 @@ void MasterPortfolio::EmitInfo( void ) {
         dblNet += strategy.pManageStrategy->EmitInfo();
     } );
   std::cout << "Portfolio net: " << dblNet << std::endl;
+  EmitScenarioRisk();
+}
+
+void MasterPortfolio::EmitScenarioRisk( void ) {
+
+  using ScenarioRisk = ou::tf::option::ScenarioRisk;
+
+  const ptime dtUtcNow( ou::TimeSource::Instance().External() );
+
+  ManageStrategy::mapScenarioSnapshot_t mapSnapshot;
+  for ( mapStrategy_t::value_type& vt: m_mapStrategy ) {
+    Strategy& strategy( vt.second );
+    if ( strategy.pManageStrategy ) {
+      strategy.pManageStrategy->ScenarioSnapshots( dtUtcNow, mapSnapshot );
+    }
+  }
+
+  mapScenarioCombo_t::iterator iterCombo = m_mapScenarioCombo.begin();
+  while ( m_mapScenarioCombo.end() != iterCombo ) {
+    if ( mapSnapshot.end() == mapSnapshot.find( iterCombo->first ) ) {
+      m_scenario.Remove( iterCombo->second.idCombo ); // closed since the last pass
+      iterCombo = m_mapScenarioCombo.erase( iterCombo );
+    }
+    else ++iterCombo;
+  }
+
+  for ( ManageStrategy::mapScenarioSnapshot_t::value_type& vt: mapSnapshot ) {
+    ScenarioRisk::Snapshot& snapshot( vt.second );
+    double dblYears {};
+    for ( const ScenarioRisk::Leg& leg: snapshot.vLeg ) {
+      dblYears = std::max( dblYears, leg.dblYears );
+    }
+    snapshot.dblRate = m_libor.ValueAt( boost::posix_time::hours( (long)( dblYears * 365.0 * 24.0 ) ) ) / 100.0;
+    snapshot.dblCarry = snapshot.dblRate; // no dividend yield
+    mapScenarioCombo_t::iterator iter = m_mapScenarioCombo.find( vt.first );
+    if ( m_mapScenarioCombo.end() == iter ) {
+      m_mapScenarioCombo.emplace( vt.first, ScenarioCombo{ m_scenario.Add( snapshot ), snapshot } );
+    }
+    else {
+      if ( ScenarioChanged( iter->second.snapshot, snapshot ) ) {
+        m_scenario.Set( iter->second.idCombo, snapshot );
+        iter->second.snapshot = snapshot;
+      }
+    }
+  }
+
+  m_scenario.Calculate();
+
+  const ScenarioRisk::vPL_t& vPortfolio( m_scenario.Portfolio() );
+  if ( vPortfolio.empty() ) return;
+
+  auto EmitShock =
+    [this]( const std::string& sName, const ScenarioRisk::vPL_t& vPL ){
+      if ( vPL.empty() ) return;
+      ScenarioRisk::vPL_t::const_iterator iterWorst = std::min_element( vPL.begin(), vPL.end() );
+      ScenarioRisk::vPL_t::const_iterator iterBest = std::max_element( vPL.begin(), vPL.end() );
+      const ScenarioRisk::Shock& worst( m_scenario.Scenario( iterWorst - vPL.begin() ) );
+      const ScenarioRisk::Shock& best( m_scenario.Scenario( iterBest - vPL.begin() ) );
+      std::cout
+        << "Scenario " << sName
+        << " worst: " << *iterWorst
+        << " (" << worst.dblUnderlying << "," << worst.dblVolatility << "," << worst.dblDays << ")"
+        << " best: " << *iterBest
+        << " (" << best.dblUnderlying << "," << best.dblVolatility << "," << best.dblDays << ")"
+        << std::endl;
+    };
+
+  std::set<std::string> setUnderlying;
+  for ( const ManageStrategy::mapScenarioSnapshot_t::value_type& vt: mapSnapshot ) {
+    setUnderlying.insert( vt.second.sUnderlying );
+  }
+  for ( const std::string& sUnderlying: setUnderlying ) {
+    EmitShock( sUnderlying, m_scenario.Underlying( sUnderlying ) );
+  }
+  EmitShock( "portfolio", vPortfolio );
 }
 
 void MasterPortfolio::CloseExpiryItm( boost::gregorian::date date ) {
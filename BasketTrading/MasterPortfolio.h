@@ -30,6 +30,7 @@
 #include <TFOptions/Option.h>
 #include <TFOptions/Engine.h>
 #include <TFOptions/NoRiskInterestRateSeries.h>
+#include <TFOptions/ScenarioRisk.h>
 
 #include <TFTrading/ProviderManager.h>
 #include <TFTrading/PortfolioManager.h>
@@ -91,6 +92,7 @@ public:
   void CloseItmLeg();
   void AddCombo( bool bForced );
   void EmitInfo();
+  void EmitScenarioRisk(); // revalues the combos across the grid, emits the worst and best of the book
 
 protected:
 private:
@@ -130,6 +132,14 @@ private:
   ou::tf::FedRateFromIQFeed m_fedrate;
   std::unique_ptr<ou::tf::option::Engine> m_pOptionEngine;
 
+  ou::tf::option::ScenarioRisk m_scenario;
+  struct ScenarioCombo {
+    ou::tf::option::ScenarioRisk::idCombo_t idCombo;
+    ou::tf::option::ScenarioRisk::Snapshot snapshot; // as last set, to skip revaluing an unchanged combo
+  };
+  using mapScenarioCombo_t = std::map<idPortfolio_t,ScenarioCombo>;
+  mapScenarioCombo_t m_mapScenarioCombo; // live combos, a closed combo is removed, its id left with an empty snapshot
+
   //Sentiment m_sentiment;
 
   pChartDataView_t m_pChartDataView;
@@ -0,0 +1,91 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    BinaryLogDecode.cpp
+ * Author:  raymond@burkholder.net
+ * Project: BinaryLogDecode
+ * Created: May 23, 2020, 17:25
+ */
+
+// prints files written by ou::BinaryLog in binary form as text, one record per line:
+//   time (utc) level category message
+//   records are in the order written by the drain thread, --sort orders them by time
+//
+//   BinaryLogDecode session.blog | grep IB
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <boost/program_options.hpp>
+
+#include <OUCommon/BinaryLog.h>
+
+int main( int argc, char* argv[] ) {
+
+  namespace po = boost::program_options;
+
+  std::vector<std::string> vFile;
+
+  po::options_description config( "BinaryLogDecode options" );
+  config.add_options()
+    ( "help", "this message" )
+    ( "file", po::value<std::vector<std::string> >( &vFile ), "binary log, repeat for several" )
+    ( "sort", "order the records of each file by time" )
+    ;
+  po::positional_options_description positional;
+  positional.add( "file", -1 );
+
+  po::variables_map vm;
+  try {
+    po::store( po::command_line_parser( argc, argv ).options( config ).positional( positional ).run(), vm );
+    po::notify( vm );
+  }
+  catch ( const std::exception& e ) {
+    std::cout << e.what() << std::endl << config << std::endl;
+    return 1;
+  }
+
+  if ( vm.count( "help" ) || vFile.empty() ) {
+    std::cout << config << std::endl;
+    return vm.count( "help" ) ? 0 : 1;
+  }
+
+  const bool bSort( 0 != vm.count( "sort" ) );
+
+  for ( const std::string& sPath: vFile ) {
+    try {
+      ou::BinaryLogReader reader( sPath );
+      std::string sLine;
+      if ( bSort ) {
+        std::vector<std::string> vLine;
+        while ( reader.Next( sLine ) ) vLine.push_back( sLine );
+        std::stable_sort( vLine.begin(), vLine.end(), // the stamp leads, fixed width
+          []( const std::string& lhs, const std::string& rhs ){ return 0 > lhs.compare( 0, 26, rhs, 0, 26 ); } );
+        for ( const std::string& s: vLine ) std::cout << s << '\n';
+      }
+      else {
+        while ( reader.Next( sLine ) ) std::cout << sLine << '\n';
+      }
+    }
+    catch ( const std::exception& e ) {
+      std::cout << e.what() << std::endl;
+      return 1;
+    }
+  }
+  std::cout.flush();
+
+  return 0;
+}
@@ -0,0 +1,215 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FeedReplay.cpp
+ * Author:  raymond@burkholder.net
+ * Project: FeedReplay
+ * Created: May 22, 2020, 15:40
+ */
+
+// serves files written by ou::FeedCapture (Network::StartCapture, IBTWS::Capture) back on their ports,
+//   in place of the IQFeed or TWS daemons, for repeatable benchmarks of the ingest path
+//   one listener per file, on the port recorded in the file, or --port when there is one file
+//   --speed 1 keeps the recorded pace, 10 is ten times as fast, 0 sends as fast as the client reads
+//   what the client sends (watch requests, the TWS handshake) is read and discarded,
+//     the capture already holds the responses
+//   each connection is served the whole file; --once ends after one connection per file,
+//     otherwise clients may reconnect until interrupted
+//
+//   FeedReplay --file level1.cap --file level2.cap --speed 0 --once
+
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+
+#include <OUCommon/FeedCapture.h>
+
+namespace {
+
+  using tcp = boost::asio::ip::tcp;
+  using steady_clock_t = std::chrono::steady_clock;
+
+  const size_t nCoalesce( 1 << 16 ); // unpaced: blocks are gathered to this size per write
+
+  struct Session {
+    uint64_t cntBlocks;
+    uint64_t cntBytes;
+    double dblSeconds;
+    double dblLagMax; // seconds behind the recorded pace, at worst
+    Session(): cntBlocks( 0 ), cntBytes( 0 ), dblSeconds( 0.0 ), dblLagMax( 0.0 ) {}
+  };
+
+  Session Serve( tcp::socket& socket, const std::string& sPath, double dblSpeed ) {
+
+    Session session;
+    ou::FeedCaptureReader reader( sPath );
+    ou::FeedCaptureReader::Block block;
+
+    std::vector<char> vOut;
+    vOut.reserve( 2 * nCoalesce );
+
+    const steady_clock_t::time_point tpStart( steady_clock_t::now() );
+
+    while ( reader.Next( block ) ) {
+      if ( 0.0 < dblSpeed ) {
+        const steady_clock_t::time_point tpDue(
+          tpStart + std::chrono::nanoseconds( (int64_t)( block.nOffset / dblSpeed ) ) );
+        const steady_clock_t::time_point tpNow( steady_clock_t::now() );
+        if ( tpDue > tpNow ) {
+          std::this_thread::sleep_until( tpDue );
+        }
+        else {
+          session.dblLagMax = std::max( session.dblLagMax, std::chrono::duration<double>( tpNow - tpDue ).count() );
+        }
+        boost::asio::write( socket, boost::asio::buffer( block.vBytes ) );
+      }
+      else {
+        vOut.insert( vOut.end(), block.vBytes.begin(), block.vBytes.end() );
+        if ( nCoalesce <= vOut.size() ) {
+          boost::asio::write( socket, boost::asio::buffer( vOut ) );
+          vOut.clear();
+        }
+      }
+      session.cntBlocks++;
+      session.cntBytes += block.vBytes.size();
+    }
+    if ( !vOut.empty() ) {
+      boost::asio::write( socket, boost::asio::buffer( vOut ) );
+    }
+
+    session.dblSeconds = std::chrono::duration<double>( steady_clock_t::now() - tpStart ).count();
+    return session;
+  }
+
+  void Listen( const std::string& sPath, unsigned short nPort, double dblSpeed, bool bOnce ) {
+
+    boost::asio::io_service io;
+    tcp::acceptor acceptor( io, tcp::endpoint( boost::asio::ip::address_v4::loopback(), nPort ) );
+    std::cout << sPath << ": listening on " << nPort << std::endl;
+
+    do {
+      tcp::socket socket( io );
+      acceptor.accept( socket );
+      socket.set_option( tcp::no_delay( true ) );
+
+      // requests from the client are discarded, so its sends never block
+      std::thread threadDiscard(
+        [&socket](){
+          char rBuffer[ 4096 ];
+          boost::system::error_code ec;
+          while ( !ec ) {
+            socket.read_some( boost::asio::buffer( rBuffer ), ec );
+          }
+        } );
+
+      try {
+        const Session session( Serve( socket, sPath, dblSpeed ) );
+        std::cout
+          << sPath << ": "
+          << session.cntBlocks << " blocks, "
+          << session.cntBytes << " bytes in "
+          << session.dblSeconds << "s, "
+          << ( session.cntBytes / 1e6 ) / std::max( session.dblSeconds, 1e-9 ) << " MB/s"
+          ;
+        if ( 0.0 < dblSpeed ) {
+          std::cout << ", max lag " << session.dblLagMax * 1000.0 << "ms";
+        }
+        std::cout << std::endl;
+      }
+      catch ( const boost::system::system_error& e ) {
+        std::cout << sPath << ": client went away: " << e.what() << std::endl;
+      }
+
+      boost::system::error_code ec;
+      socket.shutdown( tcp::socket::shutdown_both, ec );
+      threadDiscard.join();
+      socket.close( ec );
+    } while ( !bOnce );
+  }
+
+} // namespace anonymous
+
+int main( int argc, char* argv[] ) {
+
+  namespace po = boost::program_options;
+
+  std::vector<std::string> vFile;
+  unsigned short nPort( 0 );
+  double dblSpeed( 1.0 );
+
+  po::options_description config( "FeedReplay options" );
+  config.add_options()
+    ( "help", "this message" )
+    ( "file", po::value<std::vector<std::string> >( &vFile ), "capture file, repeat for several ports" )
+    ( "port", po::value<unsigned short>( &nPort ), "port, when serving one file, instead of the recorded port" )
+    ( "speed", po::value<double>( &dblSpeed )->default_value( 1.0 ), "multiple of the recorded pace, 0 for as fast as possible" )
+    ( "once", "exit after one connection per file" )
+    ;
+
+  po::variables_map vm;
+  try {
+    po::store( po::parse_command_line( argc, argv, config ), vm );
+    po::notify( vm );
+  }
+  catch ( const std::exception& e ) {
+    std::cout << e.what() << std::endl << config << std::endl;
+    return 1;
+  }
+
+  if ( vm.count( "help" ) || vFile.empty() || ( 0.0 > dblSpeed ) ) {
+    std::cout << config << std::endl;
+    return vm.count( "help" ) ? 0 : 1;
+  }
+  if ( ( 0 != nPort ) && ( 1 != vFile.size() ) ) {
+    std::cout << "--port applies to a single --file" << std::endl;
+    return 1;
+  }
+
+  const bool bOnce( 0 != vm.count( "once" ) );
+
+  std::vector<std::thread> vThread;
+  for ( const std::string& sPath: vFile ) {
+    unsigned short nPortFile( nPort );
+    try {
+      if ( 0 == nPortFile ) {
+        nPortFile = ou::FeedCaptureReader( sPath ).Port();
+      }
+    }
+    catch ( const std::exception& e ) {
+      std::cout << e.what() << std::endl;
+      return 1;
+    }
+    vThread.emplace_back(
+      [sPath,nPortFile,dblSpeed,bOnce](){
+        try {
+          Listen( sPath, nPortFile, dblSpeed, bOnce );
+        }
+        catch ( const std::exception& e ) {
+          std::cout << sPath << ": " << e.what() << std::endl;
+        }
+      } );
+  }
+
+  for ( std::thread& thread: vThread ) {
+    thread.join();
+  }
+
+  return 0;
+}
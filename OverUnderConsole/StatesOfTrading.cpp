@@ -13,7 +13,7 @@
 
 #include "StatesOfTrading.h"
 
-sc::result StatePreMarket::Handle( const EvQuote& quote ) {  // requires quotes to come before trades.
+ou::hsm::result StatePreMarket::Handle( const EvQuote& quote ) {  // requires quotes to come before trades.
   InstrumentState& is( context<MachineMarketStates>().data );
   if ( is.bMarketHoursCrossMidnight && is.bDaySession ) { // transit
     is.dtPreTradingStop = quote.Quote().DateTime() + is.tdMarketOpenIdle;
@@ -35,7 +35,7 @@ sc::result StatePreMarket::Handle( const EvQuote& quote ) {  // requires quotes
   return discard_event();
 }
 
-sc::result StatePreMarket::Handle( const EvTrade& trade ) {
+ou::hsm::result StatePreMarket::Handle( const EvTrade& trade ) {
   InstrumentState& is( context<MachineMarketStates>().data ); 
   if ( is.bMarketHoursCrossMidnight && is.bDaySession ) { // transit
     //return transit<App::StateMarketOpen>();  // late but transit anyway
@@ -49,14 +49,14 @@ sc::result StatePreMarket::Handle( const EvTrade& trade ) {
   return discard_event();
 }
 
-sc::result StateMarketOpen::Handle( const EvTrade& trade ) {
+ou::hsm::result StateMarketOpen::Handle( const EvTrade& trade ) {
   InstrumentState& is( context<MachineMarketStates>().data );
   is.dblOpeningTrade = trade.Trade().Price();
   std::cout << trade.Trade().DateTime() << ": " << is.pPosition->GetInstrument()->GetInstrumentName() << " Open " << is.dblOpeningTrade << std::endl;
   return transit<StatePreTrading>();
 }
 
-sc::result StatePreTrading::Handle( const EvQuote& quote ) {  // not currently used
+ou::hsm::result StatePreTrading::Handle( const EvQuote& quote ) {  // not currently used
 
   InstrumentState& is( context<MachineMarketStates>().data );
 
@@ -67,13 +67,13 @@ sc::result StatePreTrading::Handle( const EvQuote& quote ) {  // not currently u
   return discard_event();
 }
 
-sc::result StateCancelOrders::Handle( const EvQuote& quote ) {
+ou::hsm::result StateCancelOrders::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
   is.pPosition->CancelOrders();
   return transit<StateCancelOrdersIdle>();
 }
 
-sc::result StateCancelOrdersIdle::Handle( const EvQuote& quote ) {
+ou::hsm::result StateCancelOrdersIdle::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
 
   if ( is.bDaySession ) { // transit
@@ -84,13 +84,13 @@ sc::result StateCancelOrdersIdle::Handle( const EvQuote& quote ) {
   return discard_event();
 }
 
-sc::result StateClosePositions::Handle( const EvQuote& quote ) {
+ou::hsm::result StateClosePositions::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
   is.pPosition->ClosePosition();
   return transit<StateClosePositionsIdle>();
 }
 
-sc::result StateClosePositionsIdle::Handle( const EvQuote& quote ) {
+ou::hsm::result StateClosePositionsIdle::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
 
   if ( is.bDaySession ) { // transit
@@ -101,7 +101,7 @@ sc::result StateClosePositionsIdle::Handle( const EvQuote& quote ) {
   return discard_event();
 }
 
-sc::result StateAfterMarket::Handle( const EvQuote& quote ) {
+ou::hsm::result StateAfterMarket::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
 
   if ( is.bDaySession ) { // transit
@@ -112,12 +112,12 @@ sc::result StateAfterMarket::Handle( const EvQuote& quote ) {
   return discard_event();
 }
 
-sc::result StateMarketClosed::Handle( const EvQuote& quote ) {
+ou::hsm::result StateMarketClosed::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
   return discard_event();
 }
 
-sc::result StateZeroPosition::Handle( const EvQuote& quote ) {
+ou::hsm::result StateZeroPosition::Handle( const EvQuote& quote ) {
 
   InstrumentState& is( context<MachineMarketStates>().data );
   if ( is.bDaySession ) { // transit
@@ -164,7 +164,7 @@ sc::result StateZeroPosition::Handle( const EvQuote& quote ) {
   return transit<StateAfterMarket>();
 }
 
-sc::result StateLong::Handle( const EvQuote& quote ) {
+ou::hsm::result StateLong::Handle( const EvQuote& quote ) {
   InstrumentState& is( context<MachineMarketStates>().data );
   if ( is.bDaySession ) { // transit
     if ( quote.Quote().DateTime().time_of_day() >= is.tdCancelOrders ) {
@@ -202,7 +202,7 @@ sc::result StateLong::Handle( const EvQuote& quote ) {
   return discard_event();
 }
 
-sc::result StateShort::Handle( const EvQuote& quote ) {
+ou::hsm::result StateShort::Handle( const EvQuote& quote ) {
 
   InstrumentState& is( context<MachineMarketStates>().data );
 
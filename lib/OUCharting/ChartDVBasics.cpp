@@ -135,6 +135,40 @@ ChartDVBasics::~ChartDVBasics(void) {
   m_bfSells.SetOnBarComplete( nullptr );
 }
 
+void ChartDVBasics::SetRetention(
+  ou::ChartEntryTime::size_type nCapacity,
+  boost::posix_time::time_duration tdWindow, boost::posix_time::time_duration tdRollUp
+) {
+  auto set = [nCapacity,tdWindow,tdRollUp]( ou::ChartEntryTime& ce ){ ce.SetRetention( nCapacity, tdWindow, tdRollUp ); };
+  set( m_ceBars );
+  for ( ceVolumes_t& volumes: m_rVolumes ) {
+    set( volumes.ceVolumeUp );
+    set( volumes.ceVolumeNeutral );
+    set( volumes.ceVolumeDn );
+  }
+  for ( infoBollinger& ib: m_vInfoBollinger ) {
+    set( ib.m_ceEma );
+    set( ib.m_ceUpperBollinger );
+    set( ib.m_ceLowerBollinger );
+    set( ib.m_ceSlope );
+    set( ib.m_ceSlopeBy2 );
+    set( ib.m_ceSlopeBy3 );
+  }
+  set( m_ceTrade );
+  set( m_ceQuoteUpper );
+  set( m_ceQuoteLower );
+  set( m_ceQuoteSpread );
+  set( m_ceTickDiffs );
+  set( m_ceTickDiffsRoc );
+  set( m_ceZigZag );
+  set( m_ceShortEntries );
+  set( m_ceLongEntries );
+  set( m_ceShortFills );
+  set( m_ceLongFills );
+  set( m_ceShortExits );
+  set( m_ceLongExits );
+}
+
 void ChartDVBasics::HandleBarCompletionTrades( const ou::tf::Bar& bar ) {
   m_ceBars.AppendBar( bar );
 }
@@ -54,6 +54,13 @@ public:
   void HandleQuote( const ou::tf::Quote& quote );
   void HandleTrade( const ou::tf::Trade& trade );
 
+  // bounds the chart entries, for sessions running for days, see ChartEntryTime::SetRetention
+  //   (the quote and trade series feeding the indicators are not bounded)
+  void SetRetention(
+    ou::ChartEntryTime::size_type nCapacity,
+    boost::posix_time::time_duration tdWindow = boost::posix_time::hours( 8 ),
+    boost::posix_time::time_duration tdRollUp = boost::posix_time::minutes( 1 ) );
+
 protected:
 
   enum enumTradeDirection { ETradeDirUnkn=0, ETradeDirUp, ETradeDirDn } m_TradeDirection;
@@ -13,6 +13,8 @@
 
 //#include "StdAfx.h"
 
+#include <algorithm>
+
 #include <boost/phoenix/core.hpp>
 #include <boost/phoenix/bind/bind_member_function.hpp>
 
@@ -73,6 +75,14 @@ void ChartEntryBars::Pop( const ou::tf::Bar& bar ) {
   m_vClose.push_back( bar.Close() );
 }
 
+void ChartEntryBars::RollUp( const vGroup_t& vGroup ) {
+  Regroup( m_vOpen,  vGroup, []( const double* begin, const double* ){ return *begin; } );
+  Regroup( m_vHigh,  vGroup, []( const double* begin, const double* end ){ return *std::max_element( begin, end ); } );
+  Regroup( m_vLow,   vGroup, []( const double* begin, const double* end ){ return *std::min_element( begin, end ); } );
+  Regroup( m_vClose, vGroup, []( const double*, const double* end ){ return *( end - 1 ); } );
+  ChartEntryTime::RollUp( vGroup );
+}
+
 bool ChartEntryBars::AddEntryToChart(XYChart *pXY, structChartAttributes *pAttributes) {
 
   bool bAdded( false );
@@ -62,10 +62,12 @@ private:
   std::vector<double> m_vLow;
   std::vector<double> m_vClose;
   
-  ou::tf::Queue<ou::tf::Bar> m_queueBars;
+  ou::tf::QueueSingleProducer<ou::tf::Bar> m_queueBars;
   
   void ClearQueue( void );
   void Pop( const ou::tf::Bar& bar );
+
+  virtual void RollUp( const vGroup_t& );
 };
 
 //template<typename Iterator>
@@ -11,6 +11,7 @@
  * See the file LICENSE.txt for redistribution information.             *
  ************************************************************************/
 
+#include <cassert>
 #include <algorithm>
 
 #include <boost/phoenix/core.hpp>
@@ -37,7 +38,9 @@ ChartEntryBase::~ChartEntryBase() {
 
 ChartEntryTime::ChartEntryTime() :
   ChartEntryBase(),
-    m_dtViewPortBegin( boost::posix_time::not_a_date_time ), m_dtViewPortEnd( boost::posix_time::not_a_date_time )
+    m_dtViewPortBegin( boost::posix_time::not_a_date_time ), m_dtViewPortEnd( boost::posix_time::not_a_date_time ),
+    m_nCapacity( 0 ),
+    m_tdWindow( boost::posix_time::not_a_date_time ), m_tdRollUp( boost::posix_time::minutes( 1 ) )
 {
 }
 
@@ -67,20 +70,38 @@ void ChartEntryTime::Reserve( size_type nSize ) {
   m_vChartTime.reserve( nSize );
 }
 
+void ChartEntryTime::SetRetention( size_type nCapacity, time_duration tdWindow, time_duration tdRollUp ) {
+  assert( ( 0 == nCapacity ) || ( 4 <= nCapacity ) );
+  m_nCapacity = nCapacity;
+  m_tdWindow = tdWindow;
+  m_tdRollUp = tdRollUp;
+  if ( 0 != m_nCapacity ) {
+    Reserve( m_nCapacity ); // each level reserves its own
+  }
+}
+
 void ChartEntryTime::Append(boost::posix_time::ptime dt) {
   m_queue.Append( dt );
 }
 
+double ChartEntryTime::ChartTime( boost::posix_time::ptime dt ) {
+  return Chart::chartTime(
+    dt.date().year(), dt.date().month(), dt.date().day(),
+    dt.time_of_day().hours(), dt.time_of_day().minutes(), dt.time_of_day().seconds() );
+}
+
 // runs in thread of main
 void ChartEntryTime::AppendFg(boost::posix_time::ptime dt) {
+
+  if ( ( 0 != m_nCapacity ) && ( m_nCapacity <= m_vDateTime.size() ) ) {
+    Compact(); // before this point is added, as the inheritors add theirs after this returns
+  }
+
   m_vDateTime.push_back( dt );
 
   // this is maybe done on the fly and not correct here.
   try {
-    m_vChartTime.push_back(
-      Chart::chartTime(
-        dt.date().year(), dt.date().month(), dt.date().day(),
-        dt.time_of_day().hours(), dt.time_of_day().minutes(), dt.time_of_day().seconds() ) );
+    m_vChartTime.push_back( ChartTime( dt ) );
 
     if ( ( boost::posix_time::not_a_date_time != m_dtViewPortEnd ) && ( dt > m_dtViewPortEnd ) ) {
       // don't append any more values to visible area
@@ -127,6 +148,58 @@ void ChartEntryTime::SetViewPort( boost::posix_time::ptime dtBegin, boost::posix
 }
 
 
+// the inheritors' vectors are the same length as m_vDateTime here, this runs before they add to them
+void ChartEntryTime::Compact( void ) {
+
+  const size_type n( m_vDateTime.size() );
+
+  vGroup_t vGroup;
+  vGroup.reserve( n );
+
+  size_type ix( 0 );
+
+  if ( !m_tdWindow.is_special() && !m_tdRollUp.is_special() && ( boost::posix_time::time_duration( 0, 0, 0 ) < m_tdRollUp ) ) {
+    const boost::posix_time::ptime dtAged( m_vDateTime.back() - m_tdWindow );
+    const int64_t nTicksRollUp( m_tdRollUp.ticks() );
+    while ( ( ix < n ) && ( m_vDateTime[ ix ] < dtAged ) ) {
+      const boost::posix_time::ptime dt( m_vDateTime[ ix ] );
+      const int64_t nTicks( dt.time_of_day().ticks() );
+      const boost::posix_time::ptime dtBucket(
+        dt.date(), boost::posix_time::time_duration( 0, 0, 0, nTicks - ( nTicks % nTicksRollUp ) ) );
+      const boost::posix_time::ptime dtNext( dtBucket + m_tdRollUp );
+      size_type ixEnd( ix + 1 );
+      while ( ( ixEnd < n ) && ( m_vDateTime[ ixEnd ] < dtNext ) && ( m_vDateTime[ ixEnd ] < dtAged ) ) {
+        ++ixEnd;
+      }
+      vGroup.push_back( Group{ ix, ixEnd } );
+      if ( 1 < ( ixEnd - ix ) ) { // a group is stamped with the start of its bucket, and moved there by RollUp
+        m_vDateTime[ ix ] = dtBucket;
+        m_vChartTime[ ix ] = ChartTime( dtBucket );
+      }
+      ix = ixEnd;
+    }
+  }
+
+  for ( ; ix < n; ++ix ) {
+    vGroup.push_back( Group{ ix, ix + 1 } );
+  }
+
+  // drop the oldest, leaving room to grow
+  const size_type nKeep( m_nCapacity - m_nCapacity / 4 );
+  if ( nKeep < vGroup.size() ) {
+    vGroup.erase( vGroup.begin(), vGroup.begin() + ( vGroup.size() - nKeep ) );
+  }
+
+  RollUp( vGroup );
+
+  SetViewPort( m_dtViewPortBegin, m_dtViewPortEnd );
+}
+
+void ChartEntryTime::RollUp( const vGroup_t& vGroup ) {
+  Regroup( m_vDateTime, vGroup, []( const boost::posix_time::ptime* begin, const boost::posix_time::ptime* ){ return *begin; } );
+  Regroup( m_vChartTime, vGroup, []( const double* begin, const double* ){ return *begin; } );
+}
+
 // there are out-of-order issues or loss-of-data issues if m_bUseThreadSafety is changed while something is in the Queue
 void ChartEntryTime::ClearQueue( void ) {
   namespace args = boost::phoenix::placeholders;
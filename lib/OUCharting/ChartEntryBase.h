@@ -99,11 +99,18 @@ private:
 
 // **********
 
+// retention, for charts running for days, off by default:
+//   SetRetention reserves nCapacity points in each vector, so they do not reallocate,
+//   on reaching nCapacity, points more than tdWindow older than the latest are rolled up into
+//     one point per tdRollUp, then if still needed, the oldest are dropped to leave nCapacity / 4 free,
+//   each entry type merges its own values in RollUp: last price, summed volume, combined bars
+
 class ChartEntryTime : public ChartEntryBase { // maintains chart information for a set of price@datetime points
 public:
 
   using vDateTime_t = std::vector<boost::posix_time::ptime>;
   using size_type   =  vDateTime_t::size_type;
+  using time_duration = boost::posix_time::time_duration;
 
   ChartEntryTime( void );
   //ChartEntryTime( size_type nSize );
@@ -118,8 +125,39 @@ public:
 
   void SetViewPort( boost::posix_time::ptime dtBegin, boost::posix_time::ptime dtEnd );
 
+  // tdWindow as not_a_date_time: no roll up, only the oldest are dropped
+  void SetRetention(
+    size_type nCapacity,
+    time_duration tdWindow = boost::posix_time::not_a_date_time,
+    time_duration tdRollUp = boost::posix_time::minutes( 1 ) );
+
 protected:
 
+  struct Group { // source points [ixBegin, ixEnd) become the one point at the group's position
+    size_type ixBegin;
+    size_type ixEnd;
+  };
+  using vGroup_t = std::vector<Group>;
+
+  // each level merges its own vectors, then calls its base
+  virtual void RollUp( const vGroup_t& );
+
+  template<typename T, typename Merge> // Merge: T( const T* begin, const T* end ), a group of two or more
+  static void Regroup( std::vector<T>& v, const vGroup_t& vGroup, Merge&& merge ) {
+    size_type ixDst( 0 );
+    for ( const Group& group: vGroup ) { // ixDst <= group.ixBegin, so in place front to back
+      if ( 1 == ( group.ixEnd - group.ixBegin ) ) {
+        v[ ixDst ] = v[ group.ixBegin ];
+      }
+      else {
+        T merged( merge( &v[ group.ixBegin ], &v[ group.ixBegin ] + ( group.ixEnd - group.ixBegin ) ) );
+        v[ ixDst ] = merged;
+      }
+      ++ixDst;
+    }
+    v.resize( ixDst );
+  }
+
   boost::posix_time::ptime m_dtViewPortBegin;
   boost::posix_time::ptime m_dtViewPortEnd;
 
@@ -144,7 +182,14 @@ private:
 
   using vChartTime_t = std::vector<double> ;
 
-  ou::tf::Queue<boost::posix_time::ptime> m_queue;
+  ou::tf::QueueSingleProducer<boost::posix_time::ptime> m_queue;
+
+  size_type m_nCapacity; // 0 for unbounded
+  time_duration m_tdWindow;
+  time_duration m_tdRollUp;
+
+  void Compact( void );
+  static double ChartTime( boost::posix_time::ptime );
 
 //  struct TimeDouble_t {
 //    boost::posix_time::ptime m_dt;
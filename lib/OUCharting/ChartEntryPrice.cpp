@@ -33,6 +33,7 @@ ChartEntryPrice::~ChartEntryPrice( void ) {
 
 void ChartEntryPrice::Reserve( size_type nSize ) {
   m_vDouble.reserve( nSize );
+  ChartEntryTime::Reserve( nSize );
 }
 
 void ChartEntryPrice::Clear( void ) {
@@ -58,6 +59,11 @@ void ChartEntryPrice::Pop( const ou::tf::Price& price ) {
   m_vDouble.push_back( price.Value() );
 }
 
+void ChartEntryPrice::RollUp( const vGroup_t& vGroup ) {
+  Regroup( m_vDouble, vGroup, [this]( const double* begin, const double* end ){ return Merge( begin, end ); } );
+  ChartEntryTime::RollUp( vGroup );
+}
+
 bool ChartEntryPrice::AddEntryToChart(XYChart *pXY, structChartAttributes *pAttributes)  {
   bool bAdded( false );
   ClearQueue();
@@ -50,6 +50,9 @@ public:
 protected:
   
   void Pop( const ou::tf::Price& );
+
+  virtual void RollUp( const vGroup_t& );
+  virtual double Merge( const double* begin, const double* end ) const { return *( end - 1 ); } // last price of the group
   
   DoubleArray GetPrices( void ) const {  // prices which are visible in viewport
     return DoubleArray( &m_vDouble[ m_ixStart ], m_nElements );
@@ -59,7 +62,7 @@ private:
   
   vDouble_t m_vDouble;
   
-  ou::tf::Queue<ou::tf::Price> m_queue;
+  ou::tf::QueueSingleProducer<ou::tf::Price> m_queue;
 
 };
 
@@ -106,8 +106,26 @@ void ChartEntryShape::Clear( void ) {
     for ( vpChar_t::iterator iter = m_vpChar.begin(); m_vpChar.end() != iter; ++iter ) {
       delete [] *iter;
     }
+    m_vpChar.clear();
   }
   ChartEntryPrice::Clear();
 }
 
+void ChartEntryShape::Reserve( size_type nSize ) {
+  m_vpChar.reserve( nSize );
+  ChartEntryPrice::Reserve( nSize );
+}
+
+// a group keeps the label of its first point, the labels rolled up or dropped are released
+void ChartEntryShape::RollUp( const vGroup_t& vGroup ) {
+  size_type ix( 0 );
+  for ( const Group& group: vGroup ) {
+    for ( ; ix < group.ixBegin; ++ix ) delete [] m_vpChar[ ix ];
+    ix = group.ixBegin + 1;
+  }
+  for ( ; ix < m_vpChar.size(); ++ix ) delete [] m_vpChar[ ix ];
+  Regroup( m_vpChar, vGroup, []( const char* const* begin, const char* const* ){ return *begin; } );
+  ChartEntryPrice::RollUp( vGroup );
+}
+
 } // namespace ou
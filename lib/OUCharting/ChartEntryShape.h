@@ -35,11 +35,12 @@ public:
   void AddLabel( const boost::posix_time::ptime &dt, double price, const std::string &sLabel );
   virtual bool AddEntryToChart( XYChart *pXY, structChartAttributes *pAttributes );
   virtual void Clear( void );
+  virtual void Reserve( size_type );
   void ClearQueue( void );
 protected:
   
   struct Entry {
-    const ou::tf::Price price;
+    ou::tf::Price price;
     const char* pLabel;
     Entry( void ): pLabel( 0 ) {}
     Entry( const ou::tf::Price& price_, const char* pLabel_ ): price( price_ ), pLabel( pLabel_ ) {}
@@ -56,10 +57,13 @@ protected:
     return StringArray( &m_vpChar[ m_ixStart ],  m_nElements );
   }
 private:
-  typedef ou::tf::Queue<Entry> queueLabel_t;
+  typedef ou::tf::QueueSingleProducer<Entry> queueLabel_t;
   queueLabel_t m_queueLabel;
   //boost::lockfree::spsc_queue<char*, boost::lockfree::capacity<lockfreesize> > m_lfShape;
   void Pop( const Entry& );
+
+  virtual void RollUp( const vGroup_t& );
+  virtual double Merge( const double* begin, const double* end ) const { return *begin; } // the shape with the kept label
 };
 
 } // namespace ou
@@ -46,6 +46,12 @@ void ChartEntryVolume::Append( const ou::tf::Bar& bar ) {
   Append( bar.DateTime(), bar.Volume() );
 }
 
+double ChartEntryVolume::Merge( const double* begin, const double* end ) const {
+  double sum {};
+  for ( ; begin != end; ++begin ) sum += *begin;
+  return sum;
+}
+
 bool ChartEntryVolume::AddEntryToChart( XYChart *pXY, structChartAttributes *pAttributes ) {
   bool bAdded( false );
   ChartEntryPrice::ClearQueue();
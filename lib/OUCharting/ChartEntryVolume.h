@@ -33,6 +33,7 @@ public:
   virtual bool AddEntryToChart( XYChart *pXY, structChartAttributes *pAttributes );
 
 protected:
+  virtual double Merge( const double* begin, const double* end ) const; // volume of the group
 private:
 };
 
@@ -0,0 +1,128 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    AhoCorasick.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 24, 2020, 09:30
+ */
+
+#include <map>
+#include <deque>
+#include <stdexcept>
+
+#include "AhoCorasick.h"
+
+namespace ou { // One Unified
+
+AhoCorasick::AhoCorasick() {
+  for ( unsigned int ix = 0; ix < 256; ++ix ) {
+    m_rFold[ ix ] = std::tolower( ix );
+    m_rRoot[ ix ] = 0;
+  }
+}
+
+AhoCorasick::~AhoCorasick() {}
+
+AhoCorasick::ixPattern_t AhoCorasick::AddPattern( const std::string& sPattern, bool bCaseSensitive, bool bWholeWord ) {
+  if ( sPattern.empty() ) {
+    throw std::invalid_argument( "AhoCorasick: zero length pattern" );
+  }
+  m_vPattern.push_back( structPattern{ sPattern, bCaseSensitive, bWholeWord } );
+  return m_vPattern.size() - 1;
+}
+
+void AhoCorasick::Build( void ) {
+
+  // trie, with maps while building
+  std::vector<std::map<uint8_t, uint32_t> > vGoto( 1 );
+  std::vector<std::vector<ixPattern_t> > vOut( 1 );
+
+  for ( ixPattern_t ixPattern = 0; ixPattern < m_vPattern.size(); ++ixPattern ) {
+    uint32_t state( 0 );
+    for ( const char ch: m_vPattern[ ixPattern ].sPattern ) {
+      const uint8_t chFold( m_rFold[ static_cast<uint8_t>( ch ) ] );
+      std::map<uint8_t, uint32_t>::iterator iter = vGoto[ state ].find( chFold );
+      if ( vGoto[ state ].end() == iter ) {
+        const uint32_t stateNew( vGoto.size() );
+        vGoto[ state ].emplace( chFold, stateNew );
+        vGoto.emplace_back();
+        vOut.emplace_back();
+        state = stateNew;
+      }
+      else {
+        state = iter->second;
+      }
+    }
+    vOut[ state ].push_back( ixPattern );
+  }
+
+  const size_t nStates( vGoto.size() );
+
+  // failure links, breadth first; outputs of the failure state are appended to each state's own
+  std::vector<uint32_t> vFail( nStates, 0 );
+  std::deque<uint32_t> queue;
+  for ( const std::map<uint8_t, uint32_t>::value_type& vt: vGoto[ 0 ] ) {
+    queue.push_back( vt.second );
+  }
+  while ( !queue.empty() ) {
+    const uint32_t state( queue.front() );
+    queue.pop_front();
+    for ( const std::map<uint8_t, uint32_t>::value_type& vt: vGoto[ state ] ) {
+      const uint8_t ch( vt.first );
+      const uint32_t stateChild( vt.second );
+      uint32_t stateFail( vFail[ state ] );
+      while ( true ) {
+        std::map<uint8_t, uint32_t>::const_iterator iter = vGoto[ stateFail ].find( ch );
+        if ( vGoto[ stateFail ].end() != iter ) {
+          vFail[ stateChild ] = iter->second;
+          break;
+        }
+        if ( 0 == stateFail ) break; // to the root
+        stateFail = vFail[ stateFail ];
+      }
+      const std::vector<ixPattern_t>& vOutFail( vOut[ vFail[ stateChild ] ] );
+      vOut[ stateChild ].insert( vOut[ stateChild ].end(), vOutFail.begin(), vOutFail.end() );
+      queue.push_back( stateChild );
+    }
+  }
+
+  // flatten
+  for ( unsigned int ix = 0; ix < 256; ++ix ) m_rRoot[ ix ] = 0;
+  for ( const std::map<uint8_t, uint32_t>::value_type& vt: vGoto[ 0 ] ) {
+    m_rRoot[ vt.first ] = vt.second;
+  }
+
+  m_vEdgeBegin.assign( nStates + 1, 0 );
+  m_vEdgeChar.clear();
+  m_vEdgeNext.clear();
+  m_vOutputBegin.assign( nStates + 1, 0 );
+  m_vOutput.clear();
+  for ( uint32_t state = 0; state < nStates; ++state ) {
+    m_vEdgeBegin[ state ] = m_vEdgeChar.size();
+    if ( 0 != state ) { // the root uses m_rRoot
+      for ( const std::map<uint8_t, uint32_t>::value_type& vt: vGoto[ state ] ) { // map keeps them sorted
+        m_vEdgeChar.push_back( vt.first );
+        m_vEdgeNext.push_back( vt.second );
+      }
+    }
+    m_vOutputBegin[ state ] = m_vOutput.size();
+    m_vOutput.insert( m_vOutput.end(), vOut[ state ].begin(), vOut[ state ].end() );
+  }
+  m_vEdgeBegin[ nStates ] = m_vEdgeChar.size();
+  m_vOutputBegin[ nStates ] = m_vOutput.size();
+  m_vFail.swap( vFail );
+}
+
+} // namespace ou
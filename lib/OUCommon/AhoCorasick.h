@@ -0,0 +1,130 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    AhoCorasick.h
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 24, 2020, 09:30
+ */
+
+// multi-pattern search, all patterns found in one pass over the text, Aho-Corasick with failure links
+//   KeyWordMatch finds a single whole key, WuManber reports matches to the console, this reports each
+//     ( pattern, end position ) to a callback
+//   the automaton runs on case folded text; a case sensitive pattern is confirmed against the text on a match
+//   a whole word pattern matches only without a letter or digit on either side
+//   built once: AddPattern for each, then Build; not to be changed while searched,
+//     build a new one and swap it in (as NewsScanner does)
+//   layout after Build: a full 256 entry table at the root, sorted edge arrays elsewhere,
+//     outputs flattened along the dictionary links so a match needs no chain walk
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+namespace ou { // One Unified
+
+class AhoCorasick {
+public:
+
+  using ixPattern_t = uint32_t;
+
+  AhoCorasick();
+  ~AhoCorasick();
+
+  ixPattern_t AddPattern( const std::string& sPattern, bool bCaseSensitive = false, bool bWholeWord = false ); // throws on empty
+  void Build( void );
+
+  size_t Patterns( void ) const { return m_vPattern.size(); }
+  size_t States( void ) const { return m_vEdgeBegin.empty() ? 0 : m_vEdgeBegin.size() - 1; }
+  const std::string& Pattern( ixPattern_t ix ) const { return m_vPattern[ ix ].sPattern; }
+
+  // fMatch( ixPattern_t, size_t ixEnd ), ixEnd one past the last character of the match
+  template<typename Match>
+  void Search( const char* pText, size_t nText, Match&& fMatch ) const {
+    if ( m_vOutputBegin.empty() ) return; // not built
+    uint32_t state( 0 );
+    for ( size_t ix = 0; ix < nText; ++ix ) {
+      const uint8_t ch( m_rFold[ static_cast<uint8_t>( pText[ ix ] ) ] );
+      state = Next( state, ch );
+      for ( uint32_t ixOut = m_vOutputBegin[ state ]; ixOut < m_vOutputBegin[ state + 1 ]; ++ixOut ) {
+        const ixPattern_t ixPattern( m_vOutput[ ixOut ] );
+        if ( Confirm( m_vPattern[ ixPattern ], pText, nText, ix + 1 ) ) {
+          fMatch( ixPattern, ix + 1 );
+        }
+      }
+    }
+  }
+
+  template<typename Match>
+  void Search( const std::string& sText, Match&& fMatch ) const {
+    Search( sText.data(), sText.size(), fMatch );
+  }
+
+protected:
+private:
+
+  struct structPattern {
+    std::string sPattern;
+    bool bCaseSensitive;
+    bool bWholeWord;
+  };
+
+  std::vector<structPattern> m_vPattern;
+
+  uint8_t m_rFold[ 256 ]; // lower case
+
+  // the automaton, valid after Build
+  uint32_t m_rRoot[ 256 ];            // goto from the root, every character defined
+  std::vector<uint32_t> m_vEdgeBegin; // per state, into the edge arrays, one extra at the end
+  std::vector<uint8_t> m_vEdgeChar;   // sorted within a state
+  std::vector<uint32_t> m_vEdgeNext;
+  std::vector<uint32_t> m_vFail;
+  std::vector<uint32_t> m_vOutputBegin; // per state, into m_vOutput, one extra at the end
+  std::vector<ixPattern_t> m_vOutput;
+
+  uint32_t Next( uint32_t state, uint8_t ch ) const {
+    while ( 0 != state ) {
+      const uint32_t ixBegin( m_vEdgeBegin[ state ] );
+      const uint32_t ixEnd( m_vEdgeBegin[ state + 1 ] );
+      for ( uint32_t ix = ixBegin; ix < ixEnd; ++ix ) {
+        const uint8_t chEdge( m_vEdgeChar[ ix ] );
+        if ( ch == chEdge ) return m_vEdgeNext[ ix ];
+        if ( ch < chEdge ) break;
+      }
+      state = m_vFail[ state ];
+    }
+    return m_rRoot[ ch ];
+  }
+
+  static bool IsWord( char ch ) { return 0 != std::isalnum( static_cast<unsigned char>( ch ) ); }
+
+  static bool Confirm( const structPattern& pattern, const char* pText, size_t nText, size_t ixEnd ) {
+    const size_t ixBegin( ixEnd - pattern.sPattern.size() );
+    if ( pattern.bWholeWord ) {
+      if ( ( 0 < ixBegin ) && IsWord( pText[ ixBegin - 1 ] ) ) return false;
+      if ( ( nText > ixEnd ) && IsWord( pText[ ixEnd ] ) ) return false;
+    }
+    if ( pattern.bCaseSensitive ) {
+      if ( 0 != std::memcmp( pText + ixBegin, pattern.sPattern.data(), pattern.sPattern.size() ) ) return false;
+    }
+    return true;
+  }
+
+};
+
+} // namespace ou
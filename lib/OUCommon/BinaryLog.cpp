@@ -0,0 +1,533 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    BinaryLog.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 23, 2020, 15:10
+ */
+
+// binary file:
+//   magic, then entries, each a type byte:
+//     'C' category: id u8, name
+//     'S' site: id u32, level u8, category u8, line u32, format, file
+//     'B' block: length u32, then records of one thread, as pushed:
+//           length u32 (whole record), site id u32, stamp u64, arguments
+//   strings are length u16 then bytes; definitions precede the first record using them
+
+#include <mutex>
+#include <ctime>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "BinaryLog.h"
+
+namespace ou { // One Unified
+
+namespace {
+
+  const char* rszLevel[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+
+  // registry, shared by the writers (on first use of a site, or a thread's first record) and the drain thread
+  struct Registry {
+
+    std::mutex mutex;
+    std::vector<BinaryLog::Site*> vSite; // by id - 1
+    std::vector<std::string> vCategory;
+
+    FILE* pFile;
+    BinaryLog::EFormat eFormat;
+    size_t nRingBytes;
+    size_t nSiteWritten;
+    size_t nCategoryWritten;
+
+    std::thread threadDrain;
+    std::atomic<bool> bRun;
+
+    Registry()
+    : pFile( nullptr ), eFormat( BinaryLog::Binary ), nRingBytes( 1 << 20 ),
+      nSiteWritten( 0 ), nCategoryWritten( 0 ), bRun( false )
+    {
+      vCategory.push_back( "general" );
+    }
+
+    // at exit, when Open had no Close: the drain thread empties the rings and ends, the file is closed
+    ~Registry() {
+      if ( threadDrain.joinable() ) {
+        bRun = false;
+        threadDrain.join();
+      }
+      if ( nullptr != pFile ) {
+        std::fclose( pFile ); // flushes
+        pFile = nullptr;
+      }
+    }
+  };
+
+  Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+  }
+
+  void WriteString( FILE* pFile, const char* sz, size_t n ) {
+    const uint16_t nBytes( std::min<size_t>( n, UINT16_MAX ) );
+    std::fwrite( &nBytes, 2, 1, pFile );
+    std::fwrite( sz, 1, nBytes, pFile );
+  }
+
+} // namespace anonymous
+
+// rings are kept after their thread ends, until emptied, as histograms are in Latency
+struct BinaryLog::Ring {
+
+  std::vector<char> vBuffer;
+  const uint64_t nMask;
+  alignas( 64 ) std::atomic<uint64_t> nHead; // written by the owning thread
+  alignas( 64 ) std::atomic<uint64_t> nTail; // written by the drain thread
+  std::atomic<uint64_t> cntDropped;
+
+  explicit Ring( size_t nBytes )
+  : vBuffer( nBytes ), nMask( nBytes - 1 ), nHead( 0 ), nTail( 0 ), cntDropped( 0 ) {}
+
+  void Copy( uint64_t nPosition, const char* pSource, size_t n ) {
+    const size_t ix( nPosition & nMask );
+    const size_t nFirst( std::min( n, vBuffer.size() - ix ) );
+    std::memcpy( &vBuffer[ ix ], pSource, nFirst );
+    std::memcpy( &vBuffer[ 0 ], pSource + nFirst, n - nFirst );
+  }
+
+  void Write( uint64_t nPosition, size_t n, FILE* pFile ) const {
+    const size_t ix( nPosition & nMask );
+    const size_t nFirst( std::min( n, vBuffer.size() - ix ) );
+    std::fwrite( &vBuffer[ ix ], 1, nFirst, pFile );
+    std::fwrite( &vBuffer[ 0 ], 1, n - nFirst, pFile );
+  }
+
+  void Read( uint64_t nPosition, char* pDest, size_t n ) const {
+    const size_t ix( nPosition & nMask );
+    const size_t nFirst( std::min( n, vBuffer.size() - ix ) );
+    std::memcpy( pDest, &vBuffer[ ix ], nFirst );
+    std::memcpy( pDest + nFirst, &vBuffer[ 0 ], n - nFirst );
+  }
+};
+
+const char BinaryLog::szMagic[ 9 ] = "OUBLOG01";
+
+thread_local BinaryLog::Ring* BinaryLog::m_pRing( nullptr );
+
+std::atomic<bool> BinaryLog::m_bOpen( false );
+std::atomic<uint8_t> BinaryLog::m_eLevel( BinaryLog::Info );
+std::atomic<uint64_t> BinaryLog::m_maskCategory( ~uint64_t( 0 ) );
+
+// not destroyed: the registry, constructed earlier, is destroyed later, and its last drain reads the rings
+BinaryLog::vRing_t& BinaryLog::Rings( void ) {
+  static vRing_t* pv( new vRing_t );
+  return *pv;
+}
+
+uint64_t BinaryLog::Now( void ) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+uint32_t BinaryLog::Register( Site& site ) {
+  Registry& registry( GetRegistry() );
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  uint32_t id( site.id.load( std::memory_order_relaxed ) );
+  if ( 0 == id ) { // first use on any thread
+    registry.vSite.push_back( &site );
+    id = registry.vSite.size();
+    site.id.store( id, std::memory_order_release );
+  }
+  return id;
+}
+
+BinaryLog::category_t BinaryLog::Category( const std::string& sName ) {
+  Registry& registry( GetRegistry() );
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  for ( size_t ix = 0; ix < registry.vCategory.size(); ++ix ) {
+    if ( sName == registry.vCategory[ ix ] ) return ix;
+  }
+  if ( nMaxCategory == registry.vCategory.size() ) return 0;
+  registry.vCategory.push_back( sName );
+  return registry.vCategory.size() - 1;
+}
+
+void BinaryLog::Enable( category_t category, bool bEnable ) {
+  if ( nMaxCategory <= category ) return;
+  const uint64_t mask( uint64_t( 1 ) << category );
+  if ( bEnable ) m_maskCategory.fetch_or( mask, std::memory_order_relaxed );
+  else m_maskCategory.fetch_and( ~mask, std::memory_order_relaxed );
+}
+
+void BinaryLog::Push( const char* pRecord, size_t nLength ) {
+  if ( nullptr == m_pRing ) {
+    Registry& registry( GetRegistry() );
+    std::lock_guard<std::mutex> lock( registry.mutex );
+    Rings().emplace_back( new Ring( registry.nRingBytes ) );
+    m_pRing = Rings().back().get();
+  }
+  Ring& ring( *m_pRing );
+  const uint64_t nHead( ring.nHead.load( std::memory_order_relaxed ) );
+  const uint64_t nTail( ring.nTail.load( std::memory_order_acquire ) );
+  if ( nLength > ( ring.vBuffer.size() - ( nHead - nTail ) ) ) {
+    ring.cntDropped.store( ring.cntDropped.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    return;
+  }
+  ring.Copy( nHead, pRecord, nLength );
+  ring.nHead.store( nHead + nLength, std::memory_order_release );
+}
+
+uint64_t BinaryLog::Dropped( void ) {
+  Registry& registry( GetRegistry() );
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  uint64_t cnt( 0 );
+  for ( const std::unique_ptr<Ring>& p: Rings() ) {
+    cnt += p->cntDropped.load( std::memory_order_relaxed );
+  }
+  return cnt;
+}
+
+const char* BinaryLog::Name( ELevel eLevel ) {
+  return ( _Count > eLevel ) ? rszLevel[ eLevel ] : "";
+}
+
+void BinaryLog::Stamp( std::string& sOut, uint64_t nStamp ) {
+  const time_t nSeconds( nStamp / 1000000000 );
+  std::tm tm;
+#ifdef _WIN32
+  gmtime_s( &tm, &nSeconds );
+#else
+  gmtime_r( &nSeconds, &tm );
+#endif
+  char sz[ 40 ];
+  const size_t n( std::strftime( sz, sizeof( sz ), "%Y-%m-%d %H:%M:%S", &tm ) );
+  std::snprintf( sz + n, sizeof( sz ) - n, ".%06u", (unsigned int)( ( nStamp % 1000000000 ) / 1000 ) );
+  sOut += sz;
+}
+
+void BinaryLog::Format( std::string& sOut, const std::string& sFormat, const char* pArgs, size_t nArgs ) {
+
+  const char* p( pArgs );
+  const char* const pEnd( pArgs + nArgs );
+  char sz[ 32 ];
+
+  std::string::size_type ix( 0 );
+  while ( true ) {
+    const std::string::size_type ixBrace( sFormat.find( "{}", ix ) );
+    if ( std::string::npos == ixBrace ) {
+      sOut.append( sFormat, ix, std::string::npos );
+      break;
+    }
+    sOut.append( sFormat, ix, ixBrace - ix );
+    ix = ixBrace + 2;
+    if ( p >= pEnd ) {
+      sOut += "{}"; // fewer arguments than placeholders
+      continue;
+    }
+    const EArg eArg( static_cast<EArg>( *p++ ) );
+    switch ( eArg ) {
+      case I64: {
+          int64_t n;
+          std::memcpy( &n, p, 8 ); p += 8;
+          std::snprintf( sz, sizeof( sz ), "%lld", (long long)n );
+          sOut += sz;
+        }
+        break;
+      case U64: {
+          uint64_t n;
+          std::memcpy( &n, p, 8 ); p += 8;
+          std::snprintf( sz, sizeof( sz ), "%llu", (unsigned long long)n );
+          sOut += sz;
+        }
+        break;
+      case F64: {
+          double dbl;
+          std::memcpy( &dbl, p, 8 ); p += 8;
+          std::snprintf( sz, sizeof( sz ), "%g", dbl );
+          sOut += sz;
+        }
+        break;
+      case Bool:
+        sOut += ( 0 != *p++ ) ? "true" : "false";
+        break;
+      case Char:
+        sOut += *p++;
+        break;
+      case Str: {
+          uint16_t nBytes;
+          std::memcpy( &nBytes, p, 2 ); p += 2;
+          sOut.append( p, nBytes );
+          p += nBytes;
+        }
+        break;
+      default:
+        sOut += "{?}";
+        p = pEnd; // unknown type, the rest can not be followed
+        break;
+    }
+  }
+}
+
+// empties each ring, writes definitions first, returns the bytes taken from the rings
+size_t BinaryLog::Drain( std::vector<char>& vRecord, std::string& sLine ) {
+
+  Registry& registry( GetRegistry() );
+  std::vector<Ring*> vRing;
+  std::vector<uint64_t> vHead;
+
+  {
+    std::lock_guard<std::mutex> lock( registry.mutex );
+    for ( std::unique_ptr<Ring>& p: Rings() ) {
+      vRing.push_back( p.get() );
+      vHead.push_back( p->nHead.load( std::memory_order_acquire ) ); // before sites: a record's site is already registered
+    }
+    if ( BinaryLog::Binary == registry.eFormat ) {
+      for ( ; registry.nCategoryWritten < registry.vCategory.size(); ++registry.nCategoryWritten ) {
+        const std::string& sName( registry.vCategory[ registry.nCategoryWritten ] );
+        const uint8_t id( registry.nCategoryWritten );
+        std::fputc( 'C', registry.pFile );
+        std::fwrite( &id, 1, 1, registry.pFile );
+        WriteString( registry.pFile, sName.data(), sName.size() );
+      }
+      for ( ; registry.nSiteWritten < registry.vSite.size(); ++registry.nSiteWritten ) {
+        const BinaryLog::Site& site( *registry.vSite[ registry.nSiteWritten ] );
+        const uint32_t id( registry.nSiteWritten + 1 );
+        const uint8_t level( site.eLevel );
+        std::fputc( 'S', registry.pFile );
+        std::fwrite( &id, 4, 1, registry.pFile );
+        std::fwrite( &level, 1, 1, registry.pFile );
+        std::fwrite( &site.category, 1, 1, registry.pFile );
+        std::fwrite( &site.nLine, 4, 1, registry.pFile );
+        WriteString( registry.pFile, site.szFormat, std::strlen( site.szFormat ) );
+        WriteString( registry.pFile, site.szFile, std::strlen( site.szFile ) );
+      }
+    }
+  }
+
+  size_t cntDrained( 0 );
+  for ( size_t ix = 0; ix < vRing.size(); ++ix ) {
+    Ring& ring( *vRing[ ix ] );
+    uint64_t nTail( ring.nTail.load( std::memory_order_relaxed ) );
+    if ( ( BinaryLog::Binary == registry.eFormat ) && ( nTail < vHead[ ix ] ) ) {
+      // records end where the head was stored, the span goes out as is
+      const uint32_t nBytes( vHead[ ix ] - nTail );
+      std::fputc( 'B', registry.pFile );
+      std::fwrite( &nBytes, 4, 1, registry.pFile );
+      ring.Write( nTail, nBytes, registry.pFile );
+      nTail = vHead[ ix ];
+      ring.nTail.store( nTail, std::memory_order_release );
+      cntDrained += nBytes;
+    }
+    while ( nTail < vHead[ ix ] ) { // text
+      uint32_t nLength;
+      ring.Read( nTail, reinterpret_cast<char*>( &nLength ), 4 );
+      vRecord.resize( nLength );
+      ring.Read( nTail, vRecord.data(), nLength );
+      nTail += nLength;
+      ring.nTail.store( nTail, std::memory_order_release );
+      cntDrained += nLength;
+
+      uint32_t id;
+      uint64_t nStamp;
+      std::memcpy( &id, vRecord.data() + 4, 4 );
+      std::memcpy( &nStamp, vRecord.data() + 8, 8 );
+      const BinaryLog::Site* pSite;
+      std::string sCategory;
+      {
+        std::lock_guard<std::mutex> lock( registry.mutex );
+        pSite = registry.vSite[ id - 1 ];
+        sCategory = registry.vCategory[ pSite->category ];
+      }
+      sLine.clear();
+      BinaryLog::Stamp( sLine, nStamp );
+      sLine += ' ';
+      sLine += BinaryLog::Name( pSite->eLevel );
+      sLine += ' ';
+      sLine += sCategory;
+      sLine += ' ';
+      BinaryLog::Format( sLine, pSite->szFormat, vRecord.data() + BinaryLog::nRecordHeader, nLength - BinaryLog::nRecordHeader );
+      sLine += '\n';
+      std::fwrite( sLine.data(), 1, sLine.size(), registry.pFile );
+    }
+  }
+  return cntDrained;
+}
+
+void BinaryLog::Open( const std::string& sPath, EFormat eFormat, size_t nRingBytes ) {
+
+  Close();
+
+  Registry& registry( GetRegistry() );
+  {
+    std::lock_guard<std::mutex> lock( registry.mutex );
+    registry.pFile = std::fopen( sPath.c_str(), ( Binary == eFormat ) ? "wb" : "w" );
+    if ( nullptr == registry.pFile ) {
+      throw std::runtime_error( "BinaryLog: can not open " + sPath );
+    }
+    if ( Binary == eFormat ) {
+      std::fwrite( szMagic, 1, 8, registry.pFile );
+    }
+    registry.eFormat = eFormat;
+    size_t nBytes( 4096 );
+    while ( nBytes < nRingBytes ) nBytes <<= 1; // a power of two, for masking; applies to rings created from now
+    registry.nRingBytes = nBytes;
+    registry.nSiteWritten = 0;
+    registry.nCategoryWritten = 0;
+  }
+
+  registry.bRun = true;
+  registry.threadDrain = std::thread(
+    [&registry](){
+      std::vector<char> vRecord;
+      std::string sLine;
+      std::chrono::steady_clock::time_point tpFlush( std::chrono::steady_clock::now() );
+      while ( registry.bRun.load( std::memory_order_acquire ) ) {
+        if ( 0 == Drain( vRecord, sLine ) ) {
+          std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        const std::chrono::steady_clock::time_point tpNow( std::chrono::steady_clock::now() );
+        if ( std::chrono::milliseconds( 200 ) < ( tpNow - tpFlush ) ) {
+          std::fflush( registry.pFile );
+          tpFlush = tpNow;
+        }
+      }
+      Drain( vRecord, sLine );
+    } );
+
+  m_bOpen = true;
+}
+
+void BinaryLog::Close( void ) {
+  Registry& registry( GetRegistry() );
+  m_bOpen = false;
+  if ( registry.threadDrain.joinable() ) {
+    registry.bRun = false;
+    registry.threadDrain.join();
+  }
+  std::lock_guard<std::mutex> lock( registry.mutex );
+  if ( nullptr != registry.pFile ) {
+    std::fclose( registry.pFile );
+    registry.pFile = nullptr;
+  }
+}
+
+// ==== BinaryLogReader
+
+BinaryLogReader::BinaryLogReader( const std::string& sPath )
+: m_pFile( nullptr ), m_ixBlock( 0 )
+{
+  m_pFile = std::fopen( sPath.c_str(), "rb" );
+  if ( nullptr == m_pFile ) {
+    throw std::runtime_error( "BinaryLogReader: can not open " + sPath );
+  }
+  char rMagic[ 8 ];
+  if ( ( 8 != std::fread( rMagic, 1, 8, m_pFile ) ) || ( 0 != std::memcmp( rMagic, BinaryLog::szMagic, 8 ) ) ) {
+    std::fclose( m_pFile );
+    m_pFile = nullptr;
+    throw std::runtime_error( "BinaryLogReader: " + sPath + " is not a binary log" );
+  }
+  m_vCategory.push_back( "general" );
+}
+
+BinaryLogReader::~BinaryLogReader() {
+  if ( nullptr != m_pFile ) {
+    std::fclose( m_pFile );
+    m_pFile = nullptr;
+  }
+}
+
+bool BinaryLogReader::ReadString( std::string& s ) {
+  uint16_t nBytes;
+  if ( 2 != std::fread( &nBytes, 1, 2, m_pFile ) ) return false;
+  s.resize( nBytes );
+  return nBytes == std::fread( &s[ 0 ], 1, nBytes, m_pFile );
+}
+
+bool BinaryLogReader::Record( std::string& sLine ) {
+
+  if ( ( m_ixBlock + BinaryLog::nRecordHeader ) > m_vBlock.size() ) return false;
+  const char* pRecord( m_vBlock.data() + m_ixBlock );
+  uint32_t nLength;
+  uint32_t id;
+  uint64_t nStamp;
+  std::memcpy( &nLength, pRecord, 4 );
+  std::memcpy( &id, pRecord + 4, 4 );
+  std::memcpy( &nStamp, pRecord + 8, 8 );
+  if ( ( BinaryLog::nRecordHeader > nLength ) || ( ( m_ixBlock + nLength ) > m_vBlock.size() ) ) {
+    m_ixBlock = m_vBlock.size(); // damaged, skip the rest of the block
+    return false;
+  }
+  m_ixBlock += nLength;
+
+  sLine.clear();
+  BinaryLog::Stamp( sLine, nStamp );
+  if ( ( 0 == id ) || ( m_vSite.size() < id ) ) {
+    sLine += " ? unknown site";
+    return true;
+  }
+  const SiteInfo& site( m_vSite[ id - 1 ] );
+  sLine += ' ';
+  sLine += BinaryLog::Name( site.eLevel );
+  sLine += ' ';
+  sLine += ( site.category < m_vCategory.size() ) ? m_vCategory[ site.category ] : "?";
+  sLine += ' ';
+  BinaryLog::Format( sLine, site.sFormat, pRecord + BinaryLog::nRecordHeader, nLength - BinaryLog::nRecordHeader );
+  return true;
+}
+
+bool BinaryLogReader::Next( std::string& sLine ) {
+  if ( Record( sLine ) ) return true; // the rest of the current block
+  while ( true ) {
+    const int type( std::fgetc( m_pFile ) );
+    switch ( type ) {
+      case 'C': {
+          uint8_t id;
+          std::string sName;
+          if ( ( 1 != std::fread( &id, 1, 1, m_pFile ) ) || !ReadString( sName ) ) return false;
+          if ( m_vCategory.size() <= id ) m_vCategory.resize( id + 1 );
+          m_vCategory[ id ] = sName;
+        }
+        break;
+      case 'S': {
+          uint32_t id;
+          uint8_t level;
+          SiteInfo site;
+          if ( ( 4 != std::fread( &id, 1, 4, m_pFile ) ) || ( 0 == id ) ) return false;
+          if ( 1 != std::fread( &level, 1, 1, m_pFile ) ) return false;
+          if ( 1 != std::fread( &site.category, 1, 1, m_pFile ) ) return false;
+          if ( 4 != std::fread( &site.nLine, 1, 4, m_pFile ) ) return false;
+          if ( !ReadString( site.sFormat ) || !ReadString( site.sFile ) ) return false;
+          site.eLevel = static_cast<BinaryLog::ELevel>( level );
+          if ( m_vSite.size() < id ) m_vSite.resize( id );
+          m_vSite[ id - 1 ] = std::move( site );
+        }
+        break;
+      case 'B': {
+          uint32_t nBytes;
+          if ( 4 != std::fread( &nBytes, 1, 4, m_pFile ) ) return false;
+          m_vBlock.resize( nBytes );
+          if ( nBytes != std::fread( m_vBlock.data(), 1, nBytes, m_pFile ) ) return false;
+          m_ixBlock = 0;
+          if ( Record( sLine ) ) return true;
+        }
+        break;
+      default:
+        return false; // EOF, or a file cut short
+    }
+  }
+}
+
+} // namespace ou
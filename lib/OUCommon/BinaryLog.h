@@ -0,0 +1,207 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    BinaryLog.h
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 23, 2020, 15:10
+ */
+
+// logging for feed and order threads, where std::cout stalls the thread on console i/o
+//   OU_LOG( level, category, "format {} with {}", arg1, arg2 ) stores the call site id, a time stamp,
+//     and the raw arguments, formatting happens later, on the drain thread or in BinaryLogDecode
+//   the call site (format, file, line, level, category) is a static, registered on first use
+//   each thread writes to its own ring, single producer, single consumer, no locks:
+//     when a ring is full the record is dropped and counted, the writer never waits
+//   a drain thread empties the rings into a file, binary (site table + records) or text
+//     records of different threads are in file order, not strictly in time order, each has its stamp
+//   level and categories switch at runtime, a disabled call costs a couple of relaxed loads
+//     categories: up to 64, by name, "general" is 0; the category of a call site is fixed at its first use
+//   arguments: integers, floating point, bool, char, const char*, std::string (strings truncated to fit a record)
+//   nothing is recorded until Open
+//
+//   BinaryLog::Open( "session.blog" );
+//   const ou::BinaryLog::category_t catIB( ou::BinaryLog::Category( "IB" ) );
+//   OU_LOG( ou::BinaryLog::Info, catIB, "order {} filled {}@{}", idOrder, nQuantity, dblPrice );
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+namespace ou { // One Unified
+
+class BinaryLog {
+public:
+
+  enum ELevel: uint8_t { Trace, Debug, Info, Warn, Error, _Count };
+  enum EFormat { Binary, Text };
+
+  using category_t = uint8_t;
+  static const category_t nMaxCategory = 64;
+
+  struct Site {
+    const char* szFormat;
+    const char* szFile;
+    uint32_t nLine;
+    ELevel eLevel;
+    category_t category;
+    std::atomic<uint32_t> id; // 0 until registered
+    constexpr Site( const char* szFormat_, const char* szFile_, uint32_t nLine_, ELevel eLevel_, category_t category_ )
+    : szFormat( szFormat_ ), szFile( szFile_ ), nLine( nLine_ ), eLevel( eLevel_ ), category( category_ ), id( 0 ) {}
+  };
+
+  static void Open( const std::string& sPath, EFormat = Binary, size_t nRingBytes = 1 << 20 ); // starts the drain thread
+  static void Close( void ); // drains the rings, ends the drain thread, closes the file
+
+  static category_t Category( const std::string& sName ); // registers or finds, 0 when out of categories
+  static void SetLevel( ELevel eLevel ) { m_eLevel.store( eLevel, std::memory_order_relaxed ); }
+  static void Enable( category_t, bool bEnable );
+
+  static bool Enabled( ELevel eLevel, category_t category ) {
+    return m_bOpen.load( std::memory_order_relaxed )
+      && ( eLevel >= m_eLevel.load( std::memory_order_relaxed ) )
+      && ( 0 != ( m_maskCategory.load( std::memory_order_relaxed ) & ( uint64_t( 1 ) << category ) ) );
+  }
+
+  template<typename... Args>
+  static void Write( Site& site, const Args&... args ) {
+    uint32_t id( site.id.load( std::memory_order_acquire ) );
+    if ( 0 == id ) id = Register( site );
+    char rRecord[ nMaxRecord ];
+    char* p( rRecord + nRecordHeader );
+    ( Encode( p, rRecord + nMaxRecord, args ), ... );
+    const uint32_t nLength( p - rRecord );
+    const uint64_t nStamp( Now() );
+    std::memcpy( rRecord, &nLength, 4 );
+    std::memcpy( rRecord + 4, &id, 4 );
+    std::memcpy( rRecord + 8, &nStamp, 8 );
+    Push( rRecord, nLength );
+  }
+
+  static uint64_t Dropped( void ); // records lost to full rings, all threads
+
+  static const char* Name( ELevel );
+
+  // shared with the decoder
+  enum EArg: uint8_t { I64 = 1, U64, F64, Bool, Char, Str };
+  static const size_t nRecordHeader = 4 + 4 + 8; // length, site id, nanoseconds since 1970
+  static const size_t nMaxRecord = 1024;
+  static const char szMagic[ 9 ];
+
+  // format with the {} replaced by the arguments, as the text file and the decoder show them
+  static void Format( std::string& sOut, const std::string& sFormat, const char* pArgs, size_t nArgs );
+  static void Stamp( std::string& sOut, uint64_t nStamp );
+
+protected:
+private:
+
+  struct Ring;
+  static thread_local Ring* m_pRing;
+  using vRing_t = std::vector<std::unique_ptr<Ring> >;
+  static vRing_t& Rings( void ); // under the registry lock
+
+  static size_t Drain( std::vector<char>& vRecord, std::string& sLine ); // the drain thread
+
+  static std::atomic<bool> m_bOpen;
+  static std::atomic<uint8_t> m_eLevel;
+  static std::atomic<uint64_t> m_maskCategory;
+
+  static uint32_t Register( Site& );
+  static void Push( const char* pRecord, size_t nLength );
+  static uint64_t Now( void );
+
+  template<typename T>
+  static void Put( char*& p, char* const pEnd, EArg eArg, const T& t ) {
+    if ( ( 1 + sizeof( T ) ) > size_t( pEnd - p ) ) return;
+    *p++ = eArg;
+    std::memcpy( p, &t, sizeof( T ) );
+    p += sizeof( T );
+  }
+
+  static void PutString( char*& p, char* const pEnd, const char* sz, size_t n ) {
+    if ( 3 > ( pEnd - p ) ) return;
+    const uint16_t nBytes( std::min<size_t>( n, pEnd - p - 3 ) );
+    *p++ = Str;
+    std::memcpy( p, &nBytes, 2 );
+    std::memcpy( p + 2, sz, nBytes );
+    p += 2 + nBytes;
+  }
+
+  static void Encode( char*& p, char* const pEnd, bool b ) { Put<uint8_t>( p, pEnd, Bool, b ); }
+  static void Encode( char*& p, char* const pEnd, char ch ) { Put<char>( p, pEnd, Char, ch ); }
+  static void Encode( char*& p, char* const pEnd, const char* sz ) { PutString( p, pEnd, sz, std::strlen( sz ) ); }
+  static void Encode( char*& p, char* const pEnd, const std::string& s ) { PutString( p, pEnd, s.data(), s.size() ); }
+
+  template<typename T>
+  static void Encode( char*& p, char* const pEnd, const T& t ) {
+    if constexpr ( std::is_floating_point<T>::value ) {
+      Put<double>( p, pEnd, F64, t );
+    }
+    else if constexpr ( std::is_enum<T>::value ) {
+      Put<int64_t>( p, pEnd, I64, static_cast<int64_t>( t ) );
+    }
+    else if constexpr ( std::is_signed<T>::value ) {
+      Put<int64_t>( p, pEnd, I64, t );
+    }
+    else {
+      static_assert( std::is_unsigned<T>::value, "BinaryLog: argument type not supported" );
+      Put<uint64_t>( p, pEnd, U64, t );
+    }
+  }
+
+  template<size_t N>
+  static void Encode( char*& p, char* const pEnd, const char (&sz)[ N ] ) { PutString( p, pEnd, sz, std::strlen( sz ) ); }
+};
+
+// reads a file written with BinaryLog::Binary, as text lines
+class BinaryLogReader {
+public:
+  BinaryLogReader( const std::string& sPath ); // throws std::runtime_error on a missing or foreign file
+  ~BinaryLogReader();
+  bool Next( std::string& sLine ); // false at the end of the file
+protected:
+private:
+  struct SiteInfo {
+    std::string sFormat;
+    std::string sFile;
+    uint32_t nLine;
+    BinaryLog::ELevel eLevel;
+    BinaryLog::category_t category;
+  };
+  FILE* m_pFile;
+  std::vector<SiteInfo> m_vSite; // by id - 1
+  std::vector<std::string> m_vCategory;
+  std::vector<char> m_vBlock;
+  size_t m_ixBlock;
+  bool ReadString( std::string& );
+  bool Record( std::string& sLine ); // the next record of the current block
+};
+
+} // namespace ou
+
+#define OU_LOG( level, category, format, ... ) \
+  do { \
+    if ( ou::BinaryLog::Enabled( level, category ) ) { \
+      static ou::BinaryLog::Site site_( format, __FILE__, __LINE__, level, category ); \
+      ou::BinaryLog::Write( site_, ##__VA_ARGS__ ); \
+    } \
+  } while ( false )
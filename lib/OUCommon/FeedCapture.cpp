@@ -0,0 +1,130 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FeedCapture.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 22, 2020, 14:20
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include "FeedCapture.h"
+
+namespace ou { // One Unified
+
+namespace {
+
+  const size_t nFileBuffer( 1 << 20 );
+  const size_t nHeader( 8 + 2 + 6 + 8 ); // magic, port, reserved, start
+  const size_t nBlockHeader( 8 + 4 ); // offset, length
+  const uint32_t nMaxBlock( 1 << 26 ); // a sanity limit when reading
+
+} // namespace anonymous
+
+const char FeedCapture::szMagic[ 9 ] = "OUFEEDC1";
+
+// ==== FeedCapture
+
+FeedCapture::FeedCapture( const std::string& sPath, uint16_t nPort )
+: m_pFile( nullptr ), m_vBuffer( nFileBuffer ),
+  m_tpStart( std::chrono::steady_clock::now() ),
+  m_cntBlocks( 0 ), m_cntBytes( 0 )
+{
+  m_pFile = std::fopen( sPath.c_str(), "wb" );
+  if ( nullptr == m_pFile ) {
+    throw std::runtime_error( "FeedCapture: can not open " + sPath );
+  }
+  std::setvbuf( m_pFile, m_vBuffer.data(), _IOFBF, m_vBuffer.size() );
+
+  const int64_t nStart(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch() ).count() );
+
+  char rHeader[ nHeader ];
+  std::memset( rHeader, 0, nHeader );
+  std::memcpy( rHeader, szMagic, 8 );
+  std::memcpy( rHeader + 8, &nPort, 2 );
+  std::memcpy( rHeader + 16, &nStart, 8 );
+  std::fwrite( rHeader, 1, nHeader, m_pFile );
+}
+
+FeedCapture::~FeedCapture() {
+  if ( nullptr != m_pFile ) {
+    std::fclose( m_pFile );
+    m_pFile = nullptr;
+  }
+}
+
+void FeedCapture::Write( const void* pBytes, size_t nBytes ) {
+  const uint64_t nOffset(
+    std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - m_tpStart ).count() );
+  const uint32_t nLength( nBytes );
+  char rBlockHeader[ nBlockHeader ];
+  std::memcpy( rBlockHeader, &nOffset, 8 );
+  std::memcpy( rBlockHeader + 8, &nLength, 4 );
+  std::fwrite( rBlockHeader, 1, nBlockHeader, m_pFile );
+  std::fwrite( pBytes, 1, nBytes, m_pFile );
+  m_cntBlocks++;
+  m_cntBytes += nBytes;
+}
+
+void FeedCapture::Flush() {
+  std::fflush( m_pFile );
+}
+
+// ==== FeedCaptureReader
+
+FeedCaptureReader::FeedCaptureReader( const std::string& sPath )
+: m_pFile( nullptr ), m_nPort( 0 ), m_nStart( 0 ), m_posFirst( 0 )
+{
+  m_pFile = std::fopen( sPath.c_str(), "rb" );
+  if ( nullptr == m_pFile ) {
+    throw std::runtime_error( "FeedCaptureReader: can not open " + sPath );
+  }
+  char rHeader[ nHeader ];
+  if ( ( nHeader != std::fread( rHeader, 1, nHeader, m_pFile ) ) || ( 0 != std::memcmp( rHeader, FeedCapture::szMagic, 8 ) ) ) {
+    std::fclose( m_pFile );
+    m_pFile = nullptr;
+    throw std::runtime_error( "FeedCaptureReader: " + sPath + " is not a feed capture" );
+  }
+  std::memcpy( &m_nPort, rHeader + 8, 2 );
+  std::memcpy( &m_nStart, rHeader + 16, 8 );
+  m_posFirst = std::ftell( m_pFile );
+}
+
+FeedCaptureReader::~FeedCaptureReader() {
+  if ( nullptr != m_pFile ) {
+    std::fclose( m_pFile );
+    m_pFile = nullptr;
+  }
+}
+
+bool FeedCaptureReader::Next( Block& block ) {
+  char rBlockHeader[ nBlockHeader ];
+  if ( nBlockHeader != std::fread( rBlockHeader, 1, nBlockHeader, m_pFile ) ) return false;
+  uint32_t nLength;
+  std::memcpy( &block.nOffset, rBlockHeader, 8 );
+  std::memcpy( &nLength, rBlockHeader + 8, 4 );
+  if ( nMaxBlock < nLength ) return false;
+  block.vBytes.resize( nLength );
+  return nLength == std::fread( block.vBytes.data(), 1, nLength, m_pFile );
+}
+
+void FeedCaptureReader::Rewind() {
+  std::fseek( m_pFile, m_posFirst, SEEK_SET );
+}
+
+} // namespace ou
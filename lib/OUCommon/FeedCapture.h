@@ -0,0 +1,89 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FeedCapture.h
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 22, 2020, 14:20
+ */
+
+// raw capture of the bytes received on a feed socket, for replay by FeedReplay
+//   file: header { "OUFEEDC1", port, start time }, then per receive { nanoseconds since start, length, bytes }
+//   integers little endian, as written on x86
+//   written from the one thread reading the socket (Network's asio thread, IBTWS's message thread),
+//     buffered, a block costs a memcpy unless the buffer fills
+//   FeedCaptureReader steps through a file, as used by the replay server and by benchmarks
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace ou { // One Unified
+
+class FeedCapture {
+public:
+
+  static const char szMagic[ 9 ];
+
+  FeedCapture( const std::string& sPath, uint16_t nPort ); // throws std::runtime_error when the file can not be opened
+  ~FeedCapture();
+
+  void Write( const void* pBytes, size_t nBytes ); // stamped on arrival
+  void Flush();
+
+  uint64_t Blocks() const { return m_cntBlocks; }
+  uint64_t Bytes() const { return m_cntBytes; }
+
+protected:
+private:
+
+  FILE* m_pFile;
+  std::vector<char> m_vBuffer; // setvbuf
+  std::chrono::steady_clock::time_point m_tpStart;
+
+  uint64_t m_cntBlocks;
+  uint64_t m_cntBytes;
+};
+
+class FeedCaptureReader {
+public:
+
+  struct Block {
+    uint64_t nOffset; // nanoseconds since the start of the capture
+    std::vector<char> vBytes;
+  };
+
+  FeedCaptureReader( const std::string& sPath ); // throws std::runtime_error on a missing or foreign file
+  ~FeedCaptureReader();
+
+  uint16_t Port() const { return m_nPort; }
+  int64_t Start() const { return m_nStart; } // wall clock at capture start, nanoseconds since 1970
+
+  bool Next( Block& ); // false at the end of the file, or on a truncated block
+  void Rewind();
+
+protected:
+private:
+
+  FILE* m_pFile;
+  uint16_t m_nPort;
+  int64_t m_nStart;
+  long m_posFirst;
+};
+
+} // namespace ou
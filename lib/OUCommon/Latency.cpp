@@ -0,0 +1,177 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    Latency.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 22, 2020, 09:05
+ */
+
+#include <cmath>
+#include <mutex>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+#include "Latency.h"
+
+namespace ou { // One Unified
+
+namespace {
+
+  // histograms of all threads, kept after a thread ends so its counts remain in the report
+  std::mutex& RegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  const char* rszStage[] = {
+    "Line", "Decode", "Watch", "Position", "Order", "WatchDone",
+    "User0", "User1", "User2", "User3"
+  };
+
+} // namespace anonymous
+
+thread_local Latency::stamp_t Latency::m_nOrigin( 0 );
+thread_local Latency::Histogram* Latency::m_pHistogram( nullptr );
+
+Latency::Histogram::Histogram() {
+  for ( unsigned int ixStage = 0; ixStage < _Count; ++ixStage ) {
+    for ( unsigned int ix = 0; ix < nBuckets; ++ix ) {
+      rCount[ ixStage ][ ix ].store( 0, std::memory_order_relaxed );
+    }
+    rMax[ ixStage ].store( 0, std::memory_order_relaxed );
+  }
+}
+
+Latency::vHistogram_t& Latency::Histograms() {
+  static vHistogram_t v;
+  return v;
+}
+
+Latency::Histogram& Latency::Local() {
+  if ( nullptr == m_pHistogram ) {
+    std::unique_ptr<Histogram> p( new Histogram );
+    m_pHistogram = p.get();
+    std::lock_guard<std::mutex> lock( RegistryMutex() );
+    Histograms().push_back( std::move( p ) );
+  }
+  return *m_pHistogram;
+}
+
+unsigned int Latency::Bucket( stamp_t n ) {
+  if ( ( stamp_t( 1 ) << nSubBits ) > n ) return n;
+  const unsigned int nMsb( 63 - __builtin_clzll( n ) );
+  if ( nMaxBits <= nMsb ) return nBuckets - 1;
+  const unsigned int nShift( nMsb - nSubBits );
+  return ( ( nMsb - nSubBits + 1 ) << nSubBits ) + ( ( n >> nShift ) & ( ( 1 << nSubBits ) - 1 ) );
+}
+
+Latency::stamp_t Latency::Upper( unsigned int ixBucket ) {
+  if ( ( 1u << nSubBits ) > ixBucket ) return ixBucket;
+  const unsigned int nShift( ( ixBucket >> nSubBits ) - 1 );
+  const stamp_t nSub( ixBucket & ( ( 1 << nSubBits ) - 1 ) );
+  return ( ( ( stamp_t( 1 ) << nSubBits ) + nSub + 1 ) << nShift ) - 1;
+}
+
+void Latency::Record( EStage eStage, stamp_t nElapsed ) {
+  Histogram& histogram( Local() );
+  // the owning thread is the only writer: a load and store rather than a locked increment
+  std::atomic<uint64_t>& count( histogram.rCount[ eStage ][ Bucket( nElapsed ) ] );
+  count.store( count.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+  std::atomic<stamp_t>& max( histogram.rMax[ eStage ] );
+  if ( nElapsed > max.load( std::memory_order_relaxed ) ) {
+    max.store( nElapsed, std::memory_order_relaxed );
+  }
+}
+
+Latency::Summary Latency::Summarize( EStage eStage ) {
+
+  std::vector<uint64_t> vCount( nBuckets, 0 );
+  Summary summary;
+
+  {
+    std::lock_guard<std::mutex> lock( RegistryMutex() );
+    for ( const std::unique_ptr<Histogram>& p: Histograms() ) {
+      for ( unsigned int ix = 0; ix < nBuckets; ++ix ) {
+        vCount[ ix ] += p->rCount[ eStage ][ ix ].load( std::memory_order_relaxed );
+      }
+      summary.nMax = std::max( summary.nMax, p->rMax[ eStage ].load( std::memory_order_relaxed ) );
+    }
+  }
+
+  for ( uint64_t n: vCount ) summary.nCount += n;
+  if ( 0 == summary.nCount ) return summary;
+
+  // smallest bucket holding at least the fraction of the counts
+  auto Percentile = [&vCount,&summary]( double dblFraction )->stamp_t {
+    const uint64_t nRank( std::max<uint64_t>( 1, (uint64_t)std::ceil( dblFraction * summary.nCount ) ) );
+    uint64_t nRunning( 0 );
+    for ( unsigned int ix = 0; ix < nBuckets; ++ix ) {
+      nRunning += vCount[ ix ];
+      if ( nRunning >= nRank ) return std::min( Upper( ix ), summary.nMax );
+    }
+    return summary.nMax;
+  };
+
+  summary.nP50 = Percentile( 0.50 );
+  summary.nP99 = Percentile( 0.99 );
+  summary.nP999 = Percentile( 0.999 );
+
+  return summary;
+}
+
+void Latency::Report( std::ostream& stream ) {
+  stream
+    << std::setw( 10 ) << std::left << "stage" << std::right
+    << std::setw( 12 ) << "count"
+    << std::setw( 10 ) << "p50"
+    << std::setw( 10 ) << "p99"
+    << std::setw( 10 ) << "p99.9"
+    << std::setw( 10 ) << "max"
+    << "  (microseconds since receive)"
+    << std::endl;
+  stream << std::fixed << std::setprecision( 1 );
+  for ( unsigned int ix = 0; ix < _Count; ++ix ) {
+    const Summary summary( Summarize( static_cast<EStage>( ix ) ) );
+    if ( 0 != summary.nCount ) {
+      stream
+        << std::setw( 10 ) << std::left << rszStage[ ix ] << std::right
+        << std::setw( 12 ) << summary.nCount
+        << std::setw( 10 ) << summary.nP50 / 1000.0
+        << std::setw( 10 ) << summary.nP99 / 1000.0
+        << std::setw( 10 ) << summary.nP999 / 1000.0
+        << std::setw( 10 ) << summary.nMax / 1000.0
+        << std::endl;
+    }
+  }
+}
+
+void Latency::Reset() {
+  std::lock_guard<std::mutex> lock( RegistryMutex() );
+  for ( std::unique_ptr<Histogram>& p: Histograms() ) {
+    for ( unsigned int ixStage = 0; ixStage < _Count; ++ixStage ) {
+      for ( unsigned int ix = 0; ix < nBuckets; ++ix ) {
+        p->rCount[ ixStage ][ ix ].store( 0, std::memory_order_relaxed );
+      }
+      p->rMax[ ixStage ].store( 0, std::memory_order_relaxed );
+    }
+  }
+}
+
+const char* Latency::Name( EStage eStage ) {
+  return ( _Count > eStage ) ? rszStage[ eStage ] : "";
+}
+
+} // namespace ou
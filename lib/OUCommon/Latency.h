@@ -0,0 +1,126 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    Latency.h
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 22, 2020, 09:05
+ */
+
+// latency from socket receive to each stage of tick processing
+//   Network::OnReadDone stamps an origin (steady clock, nanoseconds) for the lines of the buffer just read,
+//     the origin is thread local: decoding, Watch, Position and order calls run on the same thread
+//     as the read, so the stamp is carried with the line and the quote without changing either
+//   a stage records ( now - origin ) in a histogram of its thread, nothing is recorded without an origin
+//     (a call from a gui or timer thread, or with the tracing compiled out)
+//   histograms are per thread, written without locks or read-modify-write, merged when read
+//     log-linear buckets, 16 per power of two: a percentile is within 6.25%
+//   Report gives count, p50, p99, p99.9, max per stage; a Reset concurrent with recording may drop a few counts
+//   compile time switch: define OU_LATENCY (eg add_compile_definitions( OU_LATENCY )), otherwise
+//     the OU_LATENCY_ macros compile to nothing
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace ou { // One Unified
+
+class Latency {
+public:
+
+  using stamp_t = uint64_t; // nanoseconds
+
+  enum EStage {
+    Line,      // Network: line extracted, before dispatch
+    Decode,    // provider: message decoded into symbol state
+    Watch,     // Watch::HandleQuote / HandleTrade
+    Position,  // Position::HandleQuote
+    Order,     // OrderManager::PlaceOrder, before the provider
+    WatchDone, // Watch: all OnQuote / OnTrade handlers (indicators, strategies) have returned
+    User0, User1, User2, User3, // for indicators and strategies
+    _Count
+  };
+
+  struct Summary {
+    uint64_t nCount;
+    stamp_t nP50;
+    stamp_t nP99;
+    stamp_t nP999;
+    stamp_t nMax;
+    Summary(): nCount( 0 ), nP50( 0 ), nP99( 0 ), nP999( 0 ), nMax( 0 ) {}
+  };
+
+  static stamp_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch() ).count();
+  }
+
+  static void Origin( stamp_t nOrigin ) { m_nOrigin = nOrigin; } // 0 clears
+  static stamp_t Origin() { return m_nOrigin; }
+
+  static void Mark( EStage eStage ) {
+    if ( 0 != m_nOrigin ) {
+      Record( eStage, Now() - m_nOrigin );
+    }
+  }
+
+  static void Record( EStage, stamp_t nElapsed ); // into the histogram of the calling thread
+
+  static Summary Summarize( EStage ); // merged over threads
+  static void Report( std::ostream& ); // stages with counts, in microseconds
+  static void Reset();
+
+  static const char* Name( EStage );
+
+  static const unsigned int nSubBits = 4;
+  static const unsigned int nMaxBits = 36; // 68 seconds, longer goes in the last bucket
+  static const unsigned int nBuckets = ( 1 << nSubBits ) + ( nMaxBits - nSubBits ) * ( 1 << nSubBits );
+
+  static unsigned int Bucket( stamp_t );
+  static stamp_t Upper( unsigned int ixBucket ); // largest value in the bucket
+
+protected:
+private:
+
+  struct Histogram {
+    std::atomic<uint64_t> rCount[ _Count ][ nBuckets ];
+    std::atomic<stamp_t> rMax[ _Count ];
+    Histogram();
+  };
+
+  static thread_local stamp_t m_nOrigin;
+  static thread_local Histogram* m_pHistogram;
+
+  using vHistogram_t = std::vector<std::unique_ptr<Histogram> >;
+  static vHistogram_t& Histograms();
+
+  static Histogram& Local();
+};
+
+} // namespace ou
+
+#if defined( OU_LATENCY )
+  #define OU_LATENCY_ORIGIN() ou::Latency::Origin( ou::Latency::Now() )
+  #define OU_LATENCY_CLEAR() ou::Latency::Origin( 0 )
+  #define OU_LATENCY_MARK( stage ) ou::Latency::Mark( ou::Latency::stage )
+#else
+  #define OU_LATENCY_ORIGIN() ((void)0)
+  #define OU_LATENCY_CLEAR() ((void)0)
+  #define OU_LATENCY_MARK( stage ) ((void)0)
+#endif
@@ -20,6 +20,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <cassert>
 
 #include <typeinfo>
@@ -34,6 +35,8 @@
 #include <boost/interprocess/detail/atomic.hpp>
 
 #include <OUCommon/Debug.h>
+#include <OUCommon/Latency.h>
+#include <OUCommon/FeedCapture.h>
 
 #include "ReusableBuffers.h"
 
@@ -112,12 +115,17 @@ public:
 
   void SetPort( port_t port ) { m_Connection.nPort = port; };
   void SetAddress( const ipaddress_t& ipaddress ) { m_Connection.sAddress = ipaddress; };
+  const structConnection& GetConnection( void ) const { return m_Connection; };
   void Connect( void );
   void Connect( const structConnection& connection );
   void Disconnect( void );
   void Send( const std::string&, bool bNotifyOnDone = false ); // string being sent out to network
   void GiveBackBuffer( linebuffer_t* p ) { m_reposLineBuffers.CheckInL( p ); };  // parsed buffer being given back to accept more parsed network traffic
 
+  // raw received bytes to a file for FeedReplay, switched on the asio thread, throws when the file can not be opened
+  void StartCapture( const std::string& sPath );
+  void StopCapture( void );
+
 protected:
 
   // CRTP based dummy callbacks
@@ -165,6 +173,8 @@ private:
   size_t m_cntSends;
   size_t m_cntBytesTransferred_send;
 
+  std::shared_ptr<FeedCapture> m_pCapture; // accessed on the asio thread
+
   void OnConnectDone( const boost::system::error_code& error );
   void OnNetDisconnecting( void);
   void OnSendDoneCommon( const boost::system::error_code& error, std::size_t bytes_transferred, linebuffer_t* );
@@ -486,9 +496,15 @@ void Network<ownerT,charT>::OnReadDone( const boost::system::error_code& error,
   else {
     assert( ( NS_CONNECTED == m_stateNetwork ) || ( NS_DISCONNECTING == m_stateNetwork) );
 
+    OU_LATENCY_ORIGIN(); // lines of this buffer, and the ticks decoded from them, are timed from here
+
     ++m_cntAsyncReads;
     m_cntBytesTransferred_input += bytes_transferred;
 
+    if ( m_pCapture ) {
+      m_pCapture->Write( pbuffer->data(), bytes_transferred );
+    }
+
     AsyncRead();  // set up for another read while processing existing buffer
 
     // process the buffer:
@@ -503,6 +519,7 @@ void Network<ownerT,charT>::OnReadDone( const boost::system::error_code& error,
       }
       if ( 0x0a == ch ) {
         // send the buffer off
+        OU_LATENCY_MARK( Line );
         if ( &Network<ownerT, charT>::OnNetworkLineBuffer != &ownerT::OnNetworkLineBuffer ) {
           static_cast<ownerT*>( this )->OnNetworkLineBuffer( m_pline );
         }
@@ -522,6 +539,7 @@ void Network<ownerT,charT>::OnReadDone( const boost::system::error_code& error,
       --bytes_transferred;
     } // end while
 
+    OU_LATENCY_CLEAR();
   }
   m_reposInputBuffers.CheckInL( pbuffer );
 
@@ -529,6 +547,21 @@ void Network<ownerT,charT>::OnReadDone( const boost::system::error_code& error,
   boost::interprocess::ipcdetail::atomic_dec32( &m_lReadProgress );
 }
 
+//
+// Capture
+//
+
+template <typename ownerT, typename charT>
+void Network<ownerT,charT>::StartCapture( const std::string& sPath ) {
+  std::shared_ptr<FeedCapture> pCapture( new FeedCapture( sPath, m_Connection.nPort ) );
+  m_io.post( [this,pCapture](){ m_pCapture = pCapture; } );
+}
+
+template <typename ownerT, typename charT>
+void Network<ownerT,charT>::StopCapture( void ) {
+  m_io.post( [this](){ m_pCapture.reset(); } );
+}
+
 //
 // Send
 //
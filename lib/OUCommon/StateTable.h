@@ -0,0 +1,279 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    StateTable.h
+ * Author:  raymond@burkholder.net
+ * Project: OUCommon
+ * Created: May 25, 2020, 10:15
+ */
+
+// hierarchical state machine, resolved at compile time, for the tick path
+//   in place of boost::statechart: no rtti reaction lookup, no virtual calls, no allocation on transition
+//   the states are listed in the machine, the first is the initial state:
+//     struct Machine: ou::hsm::Machine<Machine, StateA, StateB, StateC> { Data data; };
+//     struct StateA: ou::hsm::State<Machine, StateA> { result Handle( const EvX& ); };
+//     struct StateC: ou::hsm::State<StateB, StateC> {}; // StateC is inside StateB
+//   each event type gets a table, one entry per state, of functions calling that state's Handle,
+//     process_event is an index into it with the current (innermost) state
+//   Handle returns discard_event(), forward_event() (to the outer state), or transit<S>();
+//     events without a Handle of their own are forwarded, discarded past the outermost state
+//   a transition exits up to the common outer state and enters down to the target,
+//     then to the target's inner initial states; Entry and Exit may be supplied by a state
+//   a state object lives for the one call only and holds no data, data lives in the machine,
+//     reached with context<Machine>()
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace ou { // One Unified
+namespace hsm { // hierarchical state machine
+
+struct result {
+  enum class EAction: uint8_t { Discard, Forward, Transit };
+  EAction eAction;
+  uint8_t ixTarget; // for Transit
+};
+
+struct MachineTag {};
+
+namespace detail {
+
+template<typename O, bool bMachine = std::is_base_of<MachineTag, O>::value>
+struct MachineOf {
+  using type = O;
+};
+
+template<typename O>
+struct MachineOf<O, false> {
+  using type = typename MachineOf<typename O::outer_t>::type;
+};
+
+} // namespace detail
+
+template<typename O, typename S, typename InnerInitial = void> // O = outer state or machine, S = CRTP state
+class State {
+  template<typename M, typename... States> friend class Machine;
+public:
+
+  using outer_t = O;
+  using inner_initial_t = InnerInitial;
+  using machine_t = typename detail::MachineOf<O>::type;
+
+  template<typename E>
+  result Handle( const E& ) { return forward_event(); }
+
+  void Entry( void ) {}
+  void Exit( void ) {}
+
+protected:
+
+  template<typename C>
+  C& context( void ) {
+    static_assert( std::is_same<C, machine_t>::value, "context is the machine" );
+    return *m_pMachine;
+  }
+
+  result discard_event( void ) const { return result{ result::EAction::Discard, 0 }; }
+  result forward_event( void ) const { return result{ result::EAction::Forward, 0 }; }
+
+  template<typename T>
+  result transit( void ) const {
+    constexpr uint8_t ix = machine_t::template Index<T>();
+    static_assert( ix < machine_t::nStates, "transit to a state not listed in the machine" );
+    return result{ result::EAction::Transit, ix };
+  }
+
+private:
+  machine_t* m_pMachine;
+};
+
+template<typename M, typename... States> // M = CRTP machine, the first of States is the initial state
+class Machine: public MachineTag {
+public:
+
+  static constexpr uint8_t nStates = sizeof...( States ); // also the index for 'no state'
+  static_assert( ( 0 < nStates ) && ( 255 > nStates ), "one to 254 states" );
+
+  Machine(): m_ixState( nStates ) {}
+  ~Machine() {} // no Exits from here, M is gone, terminate() beforehand for them
+
+  void initiate( void ) {
+    terminate();
+    Transit( 0 );
+  }
+
+  void terminate( void ) {
+    M& m( static_cast<M&>( *this ) );
+    for ( uint8_t ix = m_ixState; nStates != ix; ix = Outer( ix ) ) {
+      Exit( ix, m );
+    }
+    m_ixState = nStates;
+  }
+
+  bool terminated( void ) const { return nStates == m_ixState; }
+
+  template<typename S>
+  bool is_in( void ) const { // S is the current state or one of its outer states
+    constexpr uint8_t ixState = Index<S>();
+    for ( uint8_t ix = m_ixState; nStates != ix; ix = Outer( ix ) ) {
+      if ( ixState == ix ) return true;
+    }
+    return false;
+  }
+
+  template<typename E>
+  void process_event( const E& event ) {
+    using fDispatch_t = result (*)( M&, const E& );
+    static constexpr fDispatch_t rDispatch[] = { &Dispatch<States, E>... };
+    M& m( static_cast<M&>( *this ) );
+    uint8_t ix( m_ixState );
+    while ( nStates != ix ) {
+      const result r( rDispatch[ ix ]( m, event ) );
+      switch ( r.eAction ) {
+        case result::EAction::Discard:
+          return;
+        case result::EAction::Forward:
+          ix = Outer( ix );
+          break;
+        case result::EAction::Transit:
+          Transit( r.ixTarget );
+          return;
+      }
+    }
+  }
+
+  template<typename S>
+  static constexpr uint8_t Index( void ) {
+    constexpr bool rMatch[] = { std::is_same<S, States>::value... };
+    uint8_t ix( 0 );
+    while ( ( nStates > ix ) && !rMatch[ ix ] ) ++ix;
+    return ix;
+  }
+
+protected:
+private:
+
+  uint8_t m_ixState; // innermost active state
+
+  template<typename S>
+  static constexpr uint8_t OuterIndex( void ) {
+    using outer_t = typename S::outer_t;
+    if constexpr ( std::is_base_of<MachineTag, outer_t>::value ) {
+      return nStates;
+    }
+    else {
+      static_assert( Index<outer_t>() < nStates, "outer state not listed in the machine" );
+      return Index<outer_t>();
+    }
+  }
+
+  template<typename S>
+  static constexpr uint8_t InnerIndex( void ) {
+    using inner_t = typename S::inner_initial_t;
+    if constexpr ( std::is_void<inner_t>::value ) {
+      return nStates;
+    }
+    else {
+      static_assert( Index<inner_t>() < nStates, "inner initial state not listed in the machine" );
+      return Index<inner_t>();
+    }
+  }
+
+  static uint8_t Outer( uint8_t ix ) {
+    static constexpr uint8_t rOuter[] = { OuterIndex<States>()... };
+    return rOuter[ ix ];
+  }
+
+  static uint8_t Inner( uint8_t ix ) {
+    static constexpr uint8_t rInner[] = { InnerIndex<States>()... };
+    return rInner[ ix ];
+  }
+
+  template<typename S, typename E>
+  static result Dispatch( M& m, const E& event ) {
+    S state;
+    state.m_pMachine = &m;
+    return state.Handle( event );
+  }
+
+  template<typename S>
+  static void CallEntry( M& m ) {
+    S state;
+    state.m_pMachine = &m;
+    state.Entry();
+  }
+
+  template<typename S>
+  static void CallExit( M& m ) {
+    S state;
+    state.m_pMachine = &m;
+    state.Exit();
+  }
+
+  static void Entry( uint8_t ix, M& m ) {
+    using fCall_t = void (*)( M& );
+    static constexpr fCall_t rEntry[] = { &CallEntry<States>... };
+    rEntry[ ix ]( m );
+  }
+
+  static void Exit( uint8_t ix, M& m ) {
+    using fCall_t = void (*)( M& );
+    static constexpr fCall_t rExit[] = { &CallExit<States>... };
+    rExit[ ix ]( m );
+  }
+
+  static bool Encloses( uint8_t ixOuter, uint8_t ix ) { // strictly
+    for ( ix = Outer( ix ); nStates != ix; ix = Outer( ix ) ) {
+      if ( ixOuter == ix ) return true;
+    }
+    return false;
+  }
+
+  void Transit( uint8_t ixTarget ) {
+
+    M& m( static_cast<M&>( *this ) );
+
+    // exit to the common outer state, a transition to self or to an outer state exits and re-enters it
+    uint8_t ixCommon( m_ixState );
+    while ( ( nStates != ixCommon ) && !Encloses( ixCommon, ixTarget ) ) {
+      Exit( ixCommon, m );
+      ixCommon = Outer( ixCommon );
+    }
+
+    // enter from below the common state down to the target
+    uint8_t rPath[ nStates ];
+    uint8_t nPath( 0 );
+    for ( uint8_t ix = ixTarget; ixCommon != ix; ix = Outer( ix ) ) {
+      rPath[ nPath++ ] = ix;
+    }
+    while ( 0 != nPath ) {
+      Entry( rPath[ --nPath ], m );
+    }
+
+    // and on to the innermost initial state
+    uint8_t ix( ixTarget );
+    for ( uint8_t ixInner = Inner( ix ); nStates != ixInner; ixInner = Inner( ix ) ) {
+      ix = ixInner;
+      Entry( ix, m );
+    }
+
+    m_ixState = ix;
+  }
+
+};
+
+} // namespace hsm
+} // namespace ou
@@ -35,21 +35,6 @@ ReturnMatrix OLSError(Matrix& x,Matrix& y,ColumnVector& beta,int df) {
 }
 
 void adfTest(double* x,int obs,int k,double* dfs,double* pv) {
-  double xAxis[8]={
-    0.01,0.025,0.05,0.1,0.9,0.95,0.975,0.99
-  };
-  double yAxis[6]={
-    25.0,50.0,100.0,250.0,500.0,10000.0
-  };
-  double zSurface[6][8]={
-    -4.38,-3.95,-3.60,-3.24,-1.14,-0.80,-0.50,-0.15,
-    -4.15,-3.80,-3.50,-3.18,-1.19,-0.87,-0.58,-0.24,
-    -4.04,-3.73,-3.45,-3.15,-1.22,-0.90,-0.62,-0.28,
-    -3.99,-3.69,-3.43,-3.13,-1.23,-0.92,-0.64,-0.31,
-    -3.98,-3.68,-3.42,-3.13,-1.24,-0.93,-0.65,-0.32,
-    -3.96,-3.66,-3.41,-3.12,-1.25,-0.94,-0.66,-0.33,
-  };
-
   int lags=k+1;
   int cols=(lags-1)+3;
   int rows=obs-lags;
@@ -75,6 +60,29 @@ void adfTest(double* x,int obs,int k,double* dfs,double* pv) {
   ColumnVector beta=OLS(xMat,yMat);
   DiagonalMatrix stderror=OLSError(xMat,yMat,beta,df);
 
+  Real tStatistic=beta(2)/stderror(2);
+
+  *dfs=tStatistic;
+  *pv=adfPValue(tStatistic,rows);
+  delete[] delta;
+}
+
+double adfPValue(double tStatistic,int rows) {
+  double xAxis[8]={
+    0.01,0.025,0.05,0.1,0.9,0.95,0.975,0.99
+  };
+  double yAxis[6]={
+    25.0,50.0,100.0,250.0,500.0,10000.0
+  };
+  double zSurface[6][8]={
+    -4.38,-3.95,-3.60,-3.24,-1.14,-0.80,-0.50,-0.15,
+    -4.15,-3.80,-3.50,-3.18,-1.19,-0.87,-0.58,-0.24,
+    -4.04,-3.73,-3.45,-3.15,-1.22,-0.90,-0.62,-0.28,
+    -3.99,-3.69,-3.43,-3.13,-1.23,-0.92,-0.64,-0.31,
+    -3.98,-3.68,-3.42,-3.13,-1.24,-0.93,-0.65,-0.32,
+    -3.96,-3.66,-3.41,-3.12,-1.25,-0.94,-0.66,-0.33,
+  };
+
   int lx,ux;
   double* zSection=new double[8];
   Real yLookup=rows-1;
@@ -97,7 +105,6 @@ void adfTest(double* x,int obs,int k,double* dfs,double* pv) {
 
   int lz,uz;
   double pValue=0.0;
-  Real tStatistic=beta(2)/stderror(2);
   GetNeighbourIndices(8,zSection,tStatistic,&lz,&uz);
   if(lz==uz)
   {
@@ -112,10 +119,39 @@ void adfTest(double* x,int obs,int k,double* dfs,double* pv) {
     pValue=z1+(z2-z1)*((y-y1)/(y2-y1));
   }
 
-  *dfs=tStatistic;
-  *pv=pValue;
   delete[] zSection;
-  delete[] delta;
+  return pValue;
+}
+
+double egPValue(double tStatistic,int rows) {
+  // MacKinnon (1994) table 3, N=2, constant and trend: asymptotic p = Phi( polynomial in tau )
+  const double tauMin=-21.15;
+  const double tauMax=0.63;
+  const double tauStar=-3.19; // small p polynomial at or below, large p polynomial above
+  const double smallP[3]={ 3.6646, 1.5419, 3.6448e-2 };
+  const double largeP[4]={ 2.85, 0.5272, -0.36622, -0.051695 };
+  // MacKinnon (2010) table 2, N=2, constant and trend, 5%: c(T) = b0 + b1/T + b2/T^2
+  const double crit[3]={ -3.78057, -9.5106, -12.074 };
+
+  // finite sample critical values lie below the asymptotic, the statistic is moved up by the difference
+  double T=rows;
+  double tau=tStatistic;
+  if(0<T)
+  {
+    tau-=(crit[1]/T)+(crit[2]/(T*T));
+  }
+
+  if(tau>tauMax) return 1.0;
+  if(tau<tauMin) return 0.0;
+  double z;
+  if(tau<=tauStar)
+  {
+    z=smallP[0]+tau*(smallP[1]+tau*smallP[2]);
+  }else
+  {
+    z=largeP[0]+tau*(largeP[1]+tau*(largeP[2]+tau*largeP[3]));
+  }
+  return 0.5*erfc(-z/sqrt(2.0));
 }
 
 void GetNeighbourIndices(int n,double* inArr,double x,int* lx,int* ux) {
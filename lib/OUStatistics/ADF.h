@@ -2,3 +2,11 @@
 
 void adfTest(double* x, int obs, int k, double* dfs, double* pv);
 
+// p-value of the adf t statistic, interpolated from the critical value table, rows is the regression row count
+double adfPValue(double tStatistic, int rows);
+
+// p-value of the engle granger t statistic, adf on the residuals of a two series cointegrating regression,
+//   MacKinnon (1994) distribution for N=2 with constant and trend, moved to the sample size with the
+//   MacKinnon (2010) 5% response surface, rows is the regression row count
+double egPValue(double tStatistic, int rows);
+
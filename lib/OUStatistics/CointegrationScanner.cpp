@@ -0,0 +1,143 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    CointegrationScanner.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUStatistics
+ * Created: May 16, 2020, 15:40
+ */
+
+#include <mutex>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+
+#include <boost/asio/post.hpp>
+
+#include "CointegrationScanner.h"
+
+namespace ou { // One Unified
+namespace stats { // statistics
+
+CointegrationScanner::CointegrationScanner( size_t nSeries, size_t nObservations, size_t nLags, size_t nThreads )
+: m_nSeries( nSeries ), m_nObservations( nObservations ), m_nLags( nLags ), m_nThreads( nThreads ),
+  m_work( boost::asio::make_work_guard( m_context ) )
+{
+  if ( 0 == m_nThreads ) {
+    m_nThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+  }
+  for ( size_t ix = 1; ix < m_nThreads; ++ix ) {
+    m_vThread.emplace_back( [this](){ m_context.run(); } );
+  }
+}
+
+CointegrationScanner::~CointegrationScanner() {
+  m_work.reset();
+  for ( std::thread& thread: m_vThread ) {
+    thread.join();
+  }
+}
+
+void CointegrationScanner::AddPair( size_t ixY, size_t ixX ) {
+  assert( ixY < m_nSeries );
+  assert( ixX < m_nSeries );
+  assert( ixY != ixX );
+  m_vCandidate.emplace_back( Candidate( ixY, ixX ) );
+  m_vRolling.emplace_back( RollingCointegration( m_nObservations, m_nLags ) );
+}
+
+void CointegrationScanner::AddAllPairs() {
+  m_vCandidate.reserve( m_vCandidate.size() + m_nSeries * ( m_nSeries - 1 ) / 2 );
+  m_vRolling.reserve( m_vCandidate.capacity() );
+  for ( size_t ixY = 0; ixY < m_nSeries; ++ixY ) {
+    for ( size_t ixX = ixY + 1; ixX < m_nSeries; ++ixX ) {
+      AddPair( ixY, ixX );
+    }
+  }
+}
+
+template<typename F>
+void CointegrationScanner::ForEachBlock( F f ) {
+  const size_t nCandidates( m_vCandidate.size() );
+  const size_t nBlocks( std::min( m_nThreads, nCandidates / c_nMinBlock ) );
+  if ( 1 >= nBlocks ) {
+    f( 0, nCandidates );
+  }
+  else {
+    const size_t nBlock( ( nCandidates + nBlocks - 1 ) / nBlocks );
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t nPending( ( nCandidates - 1 ) / nBlock ); // blocks after the first
+    for ( size_t ixBegin = nBlock; ixBegin < nCandidates; ixBegin += nBlock ) {
+      const size_t ixEnd( std::min( ixBegin + nBlock, nCandidates ) );
+      boost::asio::post(
+        m_context,
+        [&f,&mutex,&cv,&nPending,ixBegin,ixEnd](){
+          f( ixBegin, ixEnd );
+          std::lock_guard<std::mutex> lock( mutex );
+          if ( 0 == --nPending ) cv.notify_one();
+        } );
+    }
+    f( 0, nBlock );
+    std::unique_lock<std::mutex> lock( mutex );
+    cv.wait( lock, [&nPending](){ return 0 == nPending; } );
+  }
+}
+
+void CointegrationScanner::Append( const vValue_t& vValue ) {
+  assert( m_nSeries == vValue.size() );
+  ForEachBlock(
+    [this,&vValue]( size_t ixBegin, size_t ixEnd ){
+      for ( size_t ix = ixBegin; ix < ixEnd; ++ix ) {
+        Candidate& candidate( m_vCandidate[ ix ] );
+        RollingCointegration& rolling( m_vRolling[ ix ] );
+        rolling.Append( vValue[ candidate.ixY ], vValue[ candidate.ixX ] );
+        candidate.bValid = rolling.Calculate( candidate.result );
+      }
+    } );
+}
+
+void CointegrationScanner::Append( const vvValue_t& vvValue ) {
+  if ( vvValue.empty() ) return;
+  ForEachBlock(
+    [this,&vvValue]( size_t ixBegin, size_t ixEnd ){
+      for ( size_t ix = ixBegin; ix < ixEnd; ++ix ) {
+        Candidate& candidate( m_vCandidate[ ix ] );
+        RollingCointegration& rolling( m_vRolling[ ix ] );
+        for ( const vValue_t& vValue: vvValue ) {
+          assert( m_nSeries == vValue.size() );
+          rolling.Append( vValue[ candidate.ixY ], vValue[ candidate.ixX ] );
+        }
+        candidate.bValid = rolling.Calculate( candidate.result );
+      }
+    } );
+}
+
+CointegrationScanner::vCandidate_t CointegrationScanner::Best( size_t n, double dblMaxPValue ) const {
+  vCandidate_t v;
+  for ( const Candidate& candidate: m_vCandidate ) {
+    if ( candidate.bValid && ( dblMaxPValue >= candidate.result.dblPValue ) ) {
+      v.push_back( candidate );
+    }
+  }
+  const size_t nKeep( std::min( n, v.size() ) );
+  std::partial_sort(
+    v.begin(), v.begin() + nKeep, v.end(),
+    []( const Candidate& lhs, const Candidate& rhs ){ return lhs.result.dblTStatistic < rhs.result.dblTStatistic; } );
+  v.erase( v.begin() + nKeep, v.end() );
+  return v;
+}
+
+} // namespace stats
+} // namespace ou
@@ -0,0 +1,96 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    CointegrationScanner.h
+ * Author:  raymond@burkholder.net
+ * Project: OUStatistics
+ * Created: May 16, 2020, 15:40
+ */
+
+// rolling engle granger statistics for a set of candidate pairs drawn from a universe of series (eg daily closes)
+//   the pairs are split into contiguous blocks, each pair is independent, the blocks run on workers kept
+//     for the life of the scanner, with the calling thread taking the first block
+//   a block is at least c_nMinBlock candidates, so a small set runs serially on the calling thread
+
+#ifndef COINTEGRATIONSCANNER_H
+#define COINTEGRATIONSCANNER_H
+
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+#include "RollingADF.h"
+
+namespace ou { // One Unified
+namespace stats { // statistics
+
+class CointegrationScanner {
+public:
+
+  struct Candidate {
+    size_t ixY; // dependent, index into the universe
+    size_t ixX; // hedge
+    bool bValid; // statistics available (window full, regression not singular)
+    RollingCointegration::Result result;
+    Candidate( size_t ixY_, size_t ixX_ ): ixY( ixY_ ), ixX( ixX_ ), bValid( false ) {}
+  };
+
+  using vCandidate_t = std::vector<Candidate>;
+  using vValue_t = std::vector<double>; // one value per series in the universe
+  using vvValue_t = std::vector<vValue_t>; // chronological
+
+  // nThreads of 0 uses the hardware concurrency
+  CointegrationScanner( size_t nSeries, size_t nObservations, size_t nLags, size_t nThreads = 0 );
+  ~CointegrationScanner();
+
+  void AddPair( size_t ixY, size_t ixX );
+  void AddAllPairs(); // ixY < ixX, add the reverse explicitly where the other ordering is of interest
+
+  void Append( const vValue_t& ); // one bar across the universe, statistics updated
+  void Append( const vvValue_t& ); // history, statistics updated as of the last bar
+
+  const vCandidate_t& Candidates() const { return m_vCandidate; }
+
+  // candidates with valid statistics, ordered by t statistic (most negative first), at most n
+  vCandidate_t Best( size_t n, double dblMaxPValue = 1.0 ) const;
+
+protected:
+private:
+
+  // about 0.7us per candidate per Append (250 observations, 1 lag), a block of this size
+  //   outweighs handing it to a worker, where starting a thread cost some 11us
+  static const size_t c_nMinBlock = 32;
+
+  const size_t m_nSeries;
+  const size_t m_nObservations;
+  const size_t m_nLags;
+  size_t m_nThreads;
+
+  vCandidate_t m_vCandidate;
+  std::vector<RollingCointegration> m_vRolling; // parallel to m_vCandidate
+
+  boost::asio::io_context m_context;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_work;
+  std::vector<std::thread> m_vThread; // m_nThreads - 1 workers
+
+  template<typename F>
+  void ForEachBlock( F f ); // f( ixBegin, ixEnd ) over the candidates, blocks in parallel, returns when all are done
+};
+
+} // namespace stats
+} // namespace ou
+
+#endif /* COINTEGRATIONSCANNER_H */
@@ -0,0 +1,311 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RollingADF.cpp
+ * Author:  raymond@burkholder.net
+ * Project: OUStatistics
+ * Created: May 16, 2020, 11:05
+ */
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "ADF.h"
+#include "RollingADF.h"
+
+namespace ou { // One Unified
+namespace stats { // statistics
+
+namespace {
+
+// in place cholesky of the leading p x p of a row major matrix with stride n, lower triangle, false if not positive definite
+bool Cholesky( double* L, size_t p, size_t n ) {
+  for ( size_t j = 0; j < p; ++j ) {
+    double d = L[ j * n + j ];
+    for ( size_t k = 0; k < j; ++k ) d -= L[ j * n + k ] * L[ j * n + k ];
+    if ( 0.0 >= d ) return false;
+    d = std::sqrt( d );
+    L[ j * n + j ] = d;
+    for ( size_t i = j + 1; i < p; ++i ) {
+      double s = L[ i * n + j ];
+      for ( size_t k = 0; k < j; ++k ) s -= L[ i * n + k ] * L[ j * n + k ];
+      L[ i * n + j ] = s / d;
+    }
+  }
+  return true;
+}
+
+// solve L L' x = b in place
+void Solve( const double* L, size_t p, size_t n, double* x ) {
+  for ( size_t i = 0; i < p; ++i ) {
+    double s = x[ i ];
+    for ( size_t k = 0; k < i; ++k ) s -= L[ i * n + k ] * x[ k ];
+    x[ i ] = s / L[ i * n + i ];
+  }
+  for ( size_t i = p; 0 < i--; ) {
+    double s = x[ i ];
+    for ( size_t k = i + 1; k < p; ++k ) s -= L[ k * n + i ] * x[ k ];
+    x[ i ] = s / L[ i * n + i ];
+  }
+}
+
+} // namespace anonymous
+
+//
+// LaggedCrossProducts
+//
+
+LaggedCrossProducts::LaggedCrossProducts( size_t nSeries, size_t nObservations, size_t nLags )
+: m_nSeries( nSeries ), m_nObservations( nObservations ), m_nLags( nLags ),
+  m_nRows( nObservations - nLags - 1 ),
+  m_nDim( 2 + nSeries * ( nLags + 2 ) ),
+  m_nRebuild( std::max<size_t>( 256, nObservations ) ),
+  m_cntValues( 0 ), m_cntRows( 0 ), m_cntSinceRebuild( 0 ), m_nTrendBase( 0 )
+{
+  assert( 0 < nSeries );
+  assert( nObservations > nLags + 1 );
+  m_vBuffer.resize( ( m_nObservations + 1 ) * m_nSeries );
+  m_vSum.resize( m_nDim * m_nDim );
+  m_vLevel.resize( ( m_nSeries + 1 ) * ( m_nSeries + 1 ) );
+  m_vRow.resize( m_nDim );
+}
+
+void LaggedCrossProducts::Row( uint64_t t, double* w ) const {
+  w[ IxConstant() ] = 1.0;
+  w[ IxTrend() ] = (double)( (int64_t)t - m_nTrendBase );
+  for ( size_t ixSeries = 0; ixSeries < m_nSeries; ++ixSeries ) {
+    const double prior = Value( ixSeries, t - 1 );
+    w[ IxLevel( ixSeries ) ] = prior;
+    w[ IxDiff( ixSeries ) ] = Value( ixSeries, t ) - prior;
+    for ( size_t lag = 1; lag <= m_nLags; ++lag ) {
+      w[ IxLagDiff( ixSeries, lag ) ] = Value( ixSeries, t - lag ) - Value( ixSeries, t - lag - 1 );
+    }
+  }
+}
+
+void LaggedCrossProducts::AccumulateRow( uint64_t t, double sign ) {
+  double* w = m_vRow.data();
+  Row( t, w );
+  for ( size_t i = 0; i < m_nDim; ++i ) {
+    const double wi = sign * w[ i ];
+    double* row = &m_vSum[ i * m_nDim ];
+    for ( size_t j = 0; j <= i; ++j ) {
+      row[ j ] += wi * w[ j ];
+    }
+  }
+  for ( size_t i = 0; i < m_nDim; ++i ) { // mirror the lower triangle
+    for ( size_t j = i + 1; j < m_nDim; ++j ) {
+      m_vSum[ i * m_nDim + j ] = m_vSum[ j * m_nDim + i ];
+    }
+  }
+}
+
+void LaggedCrossProducts::AccumulateLevel( uint64_t t, double sign ) {
+  const size_t n( m_nSeries + 1 );
+  double* v = m_vRow.data(); // large enough, dimension exceeds series + 1
+  v[ 0 ] = 1.0;
+  for ( size_t ixSeries = 0; ixSeries < m_nSeries; ++ixSeries ) {
+    v[ 1 + ixSeries ] = Value( ixSeries, t );
+  }
+  for ( size_t i = 0; i < n; ++i ) {
+    for ( size_t j = 0; j < n; ++j ) {
+      m_vLevel[ i * n + j ] += sign * v[ i ] * v[ j ];
+    }
+  }
+}
+
+void LaggedCrossProducts::Append( const double* rValue ) {
+
+  const uint64_t t( m_cntValues );
+  for ( size_t ixSeries = 0; ixSeries < m_nSeries; ++ixSeries ) {
+    m_vBuffer[ ( t % ( m_nObservations + 1 ) ) * m_nSeries + ixSeries ] = rValue[ ixSeries ];
+  }
+  ++m_cntValues;
+
+  ++m_cntSinceRebuild;
+  if ( m_nRebuild <= m_cntSinceRebuild ) {
+    Rebuild();
+    return;
+  }
+
+  AccumulateLevel( t, 1.0 );
+  if ( m_nObservations <= t ) {
+    AccumulateLevel( t - m_nObservations, -1.0 );
+  }
+
+  if ( m_nLags + 1 <= t ) {
+    AccumulateRow( t, 1.0 );
+    ++m_cntRows;
+    if ( m_nRows < m_cntRows ) {
+      AccumulateRow( t - m_nRows, -1.0 ); // values back to t - obs are still in the ring
+      --m_cntRows;
+    }
+  }
+}
+
+void LaggedCrossProducts::Rebuild() {
+
+  m_cntSinceRebuild = 0;
+  m_nTrendBase = (int64_t)m_cntValues - 1;
+  std::fill( m_vSum.begin(), m_vSum.end(), 0.0 );
+  std::fill( m_vLevel.begin(), m_vLevel.end(), 0.0 );
+
+  const uint64_t tBeginValue = ( m_nObservations < m_cntValues ) ? ( m_cntValues - m_nObservations ) : 0;
+  for ( uint64_t t = tBeginValue; t < m_cntValues; ++t ) {
+    AccumulateLevel( t, 1.0 );
+  }
+
+  m_cntRows = 0;
+  const uint64_t tBeginRow = std::max<uint64_t>( m_nLags + 1, ( m_nRows < m_cntValues ) ? ( m_cntValues - m_nRows ) : 0 );
+  for ( uint64_t t = tBeginRow; t < m_cntValues; ++t ) {
+    AccumulateRow( t, 1.0 );
+    ++m_cntRows;
+  }
+}
+
+//
+// AdfStatistic
+//
+
+bool AdfStatistic( const double* S, size_t p, size_t nRows, double& dblTStatistic ) {
+
+  if ( nRows <= p ) return false;
+
+  const size_t n( p + 1 );
+  std::vector<double> vL( S, S + n * n );
+  double* L = vL.data();
+  if ( !Cholesky( L, p, n ) ) return false;
+
+  std::vector<double> vBeta( p );
+  double* beta = vBeta.data();
+  for ( size_t i = 0; i < p; ++i ) beta[ i ] = S[ i * n + p ]; // X'y
+  Solve( L, p, n, beta );
+
+  double rss = S[ p * n + p ]; // y'y - beta'X'y
+  for ( size_t i = 0; i < p; ++i ) rss -= beta[ i ] * S[ i * n + p ];
+  if ( 0.0 >= rss ) return false;
+
+  std::vector<double> vU( p, 0.0 ); // column of the inverse for the level coefficient
+  double* u = vU.data();
+  u[ 1 ] = 1.0;
+  Solve( L, p, n, u );
+
+  const double sigma2 = rss / (double)( nRows - p );
+  dblTStatistic = beta[ 1 ] / std::sqrt( sigma2 * u[ 1 ] );
+  return true;
+}
+
+//
+// RollingADF
+//
+
+RollingADF::RollingADF( size_t nObservations, size_t nLags )
+: m_lcp( 1, nObservations, nLags )
+{
+}
+
+void RollingADF::Append( double x ) {
+  m_lcp.Append( &x );
+}
+
+bool RollingADF::Calculate( double& dblTStatistic, double& dblPValue ) const {
+  if ( !m_lcp.Full() ) return false;
+  if ( !AdfStatistic( m_lcp.Sums(), m_lcp.Dimension() - 1, m_lcp.Rows(), dblTStatistic ) ) return false;
+  dblPValue = adfPValue( dblTStatistic, m_lcp.Rows() );
+  return true;
+}
+
+//
+// RollingCointegration
+//
+
+RollingCointegration::RollingCointegration( size_t nObservations, size_t nLags )
+: m_lcp( 2, nObservations, nLags )
+{
+  const size_t n( nLags + 4 );
+  m_vA.resize( n * m_lcp.Dimension() );
+  m_vAS.resize( n * m_lcp.Dimension() );
+  m_vSe.resize( n * n );
+}
+
+void RollingCointegration::Append( double y, double x ) {
+  const double r[ 2 ] = { y, x };
+  m_lcp.Append( r );
+}
+
+bool RollingCointegration::Calculate( Result& result ) const {
+
+  if ( !m_lcp.Full() ) return false;
+
+  // first stage over the window of values: y = alpha + beta * x
+  const double* L = m_lcp.LevelSums(); // [ 1, y, x ]
+  const double n = L[ 0 ];
+  const double sy = L[ 1 ];
+  const double sx = L[ 2 ];
+  const double sxy = L[ 1 * 3 + 2 ];
+  const double sxx = L[ 2 * 3 + 2 ];
+  const double denominator = n * sxx - sx * sx;
+  if ( 0.0 >= denominator ) return false;
+  const double beta = ( n * sxy - sx * sy ) / denominator;
+  const double alpha = ( sy - beta * sx ) / n;
+
+  // residual rows: w_e = A * w_pair
+  const size_t k( m_lcp.Lags() );
+  const size_t d( m_lcp.Dimension() );
+  const size_t m( k + 4 );
+  double* A = m_vA.data();
+  std::fill( m_vA.begin(), m_vA.end(), 0.0 );
+  A[ 0 * d + m_lcp.IxConstant() ] = 1.0;
+  A[ 1 * d + m_lcp.IxLevel( 0 ) ] = 1.0;
+  A[ 1 * d + m_lcp.IxLevel( 1 ) ] = -beta;
+  A[ 1 * d + m_lcp.IxConstant() ] = -alpha;
+  A[ 2 * d + m_lcp.IxTrend() ] = 1.0;
+  for ( size_t lag = 1; lag <= k; ++lag ) {
+    A[ ( 2 + lag ) * d + m_lcp.IxLagDiff( 0, lag ) ] = 1.0;
+    A[ ( 2 + lag ) * d + m_lcp.IxLagDiff( 1, lag ) ] = -beta;
+  }
+  A[ ( k + 3 ) * d + m_lcp.IxDiff( 0 ) ] = 1.0;
+  A[ ( k + 3 ) * d + m_lcp.IxDiff( 1 ) ] = -beta;
+
+  const double* S = m_lcp.Sums();
+  double* AS = m_vAS.data();
+  for ( size_t i = 0; i < m; ++i ) {
+    for ( size_t j = 0; j < d; ++j ) {
+      double s( 0.0 );
+      for ( size_t l = 0; l < d; ++l ) s += A[ i * d + l ] * S[ l * d + j ];
+      AS[ i * d + j ] = s;
+    }
+  }
+  double* Se = m_vSe.data();
+  for ( size_t i = 0; i < m; ++i ) {
+    for ( size_t j = 0; j < m; ++j ) {
+      double s( 0.0 );
+      for ( size_t l = 0; l < d; ++l ) s += AS[ i * d + l ] * A[ j * d + l ];
+      Se[ i * m + j ] = s;
+    }
+  }
+
+  double dblTStatistic;
+  if ( !AdfStatistic( Se, m - 1, m_lcp.Rows(), dblTStatistic ) ) return false;
+
+  result.dblAlpha = alpha;
+  result.dblBeta = beta;
+  result.dblTStatistic = dblTStatistic;
+  result.dblPValue = egPValue( dblTStatistic, m_lcp.Rows() ); // residuals of an estimated beta, not the adf table
+  return true;
+}
+
+} // namespace stats
+} // namespace ou
@@ -0,0 +1,150 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RollingADF.h
+ * Author:  raymond@burkholder.net
+ * Project: OUStatistics
+ * Created: May 16, 2020, 11:05
+ */
+
+// rolling augmented dickey fuller and engle granger cointegration
+//   same regression as adfTest( x, obs, k, ... ): constant, level, trend, k lagged differences,
+//   evaluated on the last obs values as each new value arrives
+//   the normal equations are kept as running sums of row cross products: a row is added as a value arrives,
+//     the oldest row is subtracted, so an update is O(p^2) and an evaluation is a p x p cholesky solve,
+//     rather than rebuilding and inverting the regression matrix
+//   the sums are rebuilt from the retained values periodically to flush rounding drift
+
+#ifndef ROLLINGADF_H
+#define ROLLINGADF_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace ou { // One Unified
+namespace stats { // statistics
+
+// running sums of w * w' over a window of regression rows,
+//   w is built from the lagged values and differences of one or more series:
+//   [ 1, level(t-1) per series, trend, diff(t-1 .. t-k) per series, diff(t) per series ]
+//   with one series, w is the adf regressors followed by the dependent
+// also keeps sums of [ 1, value(t) per series ] cross products over the window of values
+class LaggedCrossProducts {
+public:
+
+  LaggedCrossProducts( size_t nSeries, size_t nObservations, size_t nLags );
+
+  void Append( const double* rValue ); // one value per series
+
+  bool Full( void ) const { return m_nRows == m_cntRows; }
+  size_t Rows( void ) const { return m_nRows; } // regression rows in a full window: obs - k - 1
+  size_t Observations( void ) const { return m_nObservations; }
+  size_t Lags( void ) const { return m_nLags; }
+  size_t Dimension( void ) const { return m_nDim; }
+
+  const double* Sums( void ) const { return m_vSum.data(); } // Dimension x Dimension, row major, symmetric
+  const double* LevelSums( void ) const { return m_vLevel.data(); } // ( Series + 1 ) squared, row major
+
+  size_t IxConstant( void ) const { return 0; }
+  size_t IxLevel( size_t ixSeries ) const { return 1 + ixSeries; }
+  size_t IxTrend( void ) const { return 1 + m_nSeries; }
+  size_t IxLagDiff( size_t ixSeries, size_t lag ) const { return 1 + m_nSeries + ixSeries * m_nLags + lag; } // lag 1 .. k
+  size_t IxDiff( size_t ixSeries ) const { return 2 + m_nSeries + m_nSeries * m_nLags + ixSeries; }
+
+protected:
+private:
+
+  const size_t m_nSeries;
+  const size_t m_nObservations;
+  const size_t m_nLags;
+  const size_t m_nRows;
+  const size_t m_nDim;
+  const size_t m_nRebuild;
+
+  std::vector<double> m_vBuffer; // ring of the last obs + 1 values per series, the extra value retires the oldest row
+  uint64_t m_cntValues; // values appended, the index of the next value
+  size_t m_cntRows; // rows in the sums
+  size_t m_cntSinceRebuild;
+  int64_t m_nTrendBase; // trend is relative to this, re-based on rebuild (the constant absorbs the shift)
+
+  std::vector<double> m_vSum;
+  std::vector<double> m_vLevel;
+  mutable std::vector<double> m_vRow;
+
+  double Value( size_t ixSeries, uint64_t ixValue ) const {
+    return m_vBuffer[ ( ixValue % ( m_nObservations + 1 ) ) * m_nSeries + ixSeries ];
+  }
+  void Row( uint64_t ixValue, double* w ) const; // regression row whose dependent is the difference ending at ixValue
+  void AccumulateRow( uint64_t ixValue, double sign );
+  void AccumulateLevel( uint64_t ixValue, double sign );
+  void Rebuild( void );
+};
+
+// t statistic of the level coefficient given the sums of the adf rows
+//   S is ( p + 1 ) x ( p + 1 ), regressors then the dependent, returns false when singular
+bool AdfStatistic( const double* S, size_t p, size_t nRows, double& dblTStatistic );
+
+class RollingADF {
+public:
+
+  RollingADF( size_t nObservations, size_t nLags ); // as obs, k in adfTest
+
+  void Append( double x );
+
+  bool Ready( void ) const { return m_lcp.Full(); }
+
+  // false until a window of observations is available
+  bool Calculate( double& dblTStatistic, double& dblPValue ) const;
+
+protected:
+private:
+  LaggedCrossProducts m_lcp;
+};
+
+// engle granger: y = alpha + beta * x over the window, then adfTest on the residuals of the window,
+//   the p-value from egPValue, beta is estimated so the plain adf table would be far too generous
+//   the residual rows are a linear combination of the rows of the two series, so their sums
+//   are A * S * A' from the sums of the pair, and remain incremental as alpha and beta move
+class RollingCointegration {
+public:
+
+  struct Result {
+    double dblAlpha;
+    double dblBeta;
+    double dblTStatistic;
+    double dblPValue;
+    Result( void ): dblAlpha( 0.0 ), dblBeta( 0.0 ), dblTStatistic( 0.0 ), dblPValue( 1.0 ) {}
+  };
+
+  RollingCointegration( size_t nObservations, size_t nLags );
+
+  void Append( double y, double x );
+
+  bool Ready( void ) const { return m_lcp.Full(); }
+
+  bool Calculate( Result& ) const;
+
+protected:
+private:
+  LaggedCrossProducts m_lcp;
+  mutable std::vector<double> m_vA; // ( p + 1 ) x dimension
+  mutable std::vector<double> m_vAS;
+  mutable std::vector<double> m_vSe;
+};
+
+} // namespace stats
+} // namespace ou
+
+#endif /* ROLLINGADF_H */
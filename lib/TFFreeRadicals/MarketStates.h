@@ -13,47 +13,41 @@
 
 #pragma once
 
-#include <boost/mpl/list.hpp>
+// events and state bases for the market session machine, see OverUnderConsole/StatesOfTrading.h
+//   table driven with ou::hsm (OUCommon/StateTable.h), was boost::statechart
+//   the machine lists its states, the first is the initial state
 
-#include <boost/statechart/event.hpp>
-#include <boost/statechart/state_machine.hpp>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/statechart/transition.hpp>
+#include <OUCommon/StateTable.h>
 
 #include <TFTimeSeries/DatedDatum.h>
 
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
-
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 // Events
-struct EvInitialize: sc::event<EvInitialize> {};
+struct EvInitialize {};
 
-struct EvQuote: sc::event<EvQuote> {
-  EvQuote( const ou::tf::Quote& quote ): sc::event<EvQuote>(), m_quote( quote ) {};
+struct EvQuote {
+  EvQuote( const ou::tf::Quote& quote ): m_quote( quote ) {};
   const ou::tf::Quote& Quote( void ) const { return m_quote; };
 private:
   const ou::tf::Quote& m_quote;
 };
 
-struct EvTrade: sc::event<EvTrade> {
-  EvTrade( const ou::tf::Trade& trade ): sc::event<EvTrade>(), m_trade( trade ) {};
+struct EvTrade {
+  EvTrade( const ou::tf::Trade& trade ): m_trade( trade ) {};
   const ou::tf::Trade& Trade( void ) const { return m_trade; };
 private:
   const ou::tf::Trade& m_trade;
 };
 
-struct EvScheduled: sc::event<EvScheduled> {};
+struct EvScheduled {};
 
 // Machine
 
-template<typename T, typename I>  // I = StateInitialization
-struct MachineMarketStates: 
-  sc::state_machine<MachineMarketStates<T,I>, I> 
+template<typename T, typename... States>  // States: StateInitialization first, then the rest
+struct MachineMarketStates:
+  ou::hsm::Machine<MachineMarketStates<T,States...>, States...>
 {
   T data;
 };
@@ -61,38 +55,21 @@ struct MachineMarketStates:
 // States
 
 template<typename S, typename O, typename P> // S = CRTP State, O = Outer State, P = StatePreMarket
-struct StateInitialization: sc::simple_state<StateInitialization<S,O,P>, O> {
-  typedef sc::custom_reaction<EvInitialize> reactions;
-  sc::result react( const EvInitialize& event ) { return static_cast<S*>( this )->Handle( event ); }
-protected:
-  sc::result Handle( const EvInitialize& event ) { 
-    //this->transit<P>();  // 2015/11/08 won't compile, need to fix
-    return this->discard_event();  // this is substitute until above statement can be fixed
-  } 
+struct StateInitialization: ou::hsm::State<O, S> {
+  using ou::hsm::State<O, S>::Handle;
+  ou::hsm::result Handle( const EvInitialize& event ) {
+    // as with statechart, where transit<P> never compiled: a transit here would bring the trading states to life
+    return this->discard_event();
+  }
 };
 
-template<typename O, typename S, typename InnerInitial=mpl::list<> > // O = Outer State, S = State
-struct StateBase: sc::simple_state<StateBase<O,S,InnerInitial>, O, InnerInitial > {
-
-  typedef mpl::list<
-    sc::custom_reaction<EvQuote>,
-    sc::custom_reaction<EvTrade>,
-    sc::custom_reaction<EvScheduled>
-  > reactions;
-
-
-//protected:
-  sc::result Handle( const EvQuote& ) { return this->discard_event(); }
-  sc::result Handle( const EvTrade& ) { return this->discard_event(); };
-  sc::result Handle( const EvScheduled& ) { return this->discard_event(); };
-
-  template<typename E>
-  sc::result react( const E& event ) { return static_cast<S*>( this )->Handle( event ); };
-  //sc::result react( const E& event ) { return Handle( event ); };
-
-private:
+template<typename O, typename S, typename InnerInitial=void> // O = Outer State, S = State
+struct StateBase: ou::hsm::State<O, S, InnerInitial> {
+  using ou::hsm::State<O, S, InnerInitial>::Handle;
+  ou::hsm::result Handle( const EvQuote& ) { return this->discard_event(); }
+  ou::hsm::result Handle( const EvTrade& ) { return this->discard_event(); };
+  ou::hsm::result Handle( const EvScheduled& ) { return this->discard_event(); };
 };
 
 } // namespace tf
 } // namespace ou
-
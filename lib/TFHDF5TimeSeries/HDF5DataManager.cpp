@@ -17,6 +17,7 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "HDF5TickFilter.h"
 #include "HDF5DataManager.h"
 
 namespace ou { // One Unified
@@ -32,6 +33,7 @@ const char HDF5DataManager::m_H5FileName[] = "TradeFrame.hdf5";
 //  needs a good rethink and re-architect for file handle handling
 
 HDF5DataManager::HDF5DataManager( enumFileOptionType fot ) {
+  HDF5TickFilter::Register(); // before any coded dataset is read or written
 //  ++m_RefCount;
 //  if ( 1 == m_RefCount ) {
     //std::cout << "Opening DataManager" << std::endl;
@@ -0,0 +1,188 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    HDF5TickFilter.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFHDF5TimeSeries
+ * Created: May 20, 2020, 13:10
+ */
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <TFTimeSeries/TickCodec.h>
+
+#include "HDF5TickFilter.h"
+
+// client data values:
+//   [0] price scale, supplied by the writer
+//   [1] layout version, [2] record size, [3] field count,
+//   then per field: kind | width << 8, offset
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+
+  const unsigned int nLayoutVersion( 1 );
+  const size_t nFixed( 4 );
+  const size_t nMaxFields( 32 );
+  const size_t nMaxValues( nFixed + 2 * nMaxFields );
+
+  bool BuildLayout( size_t cd_nelmts, const unsigned int cd_values[], TickCodec::Layout& layout ) {
+    if ( nFixed > cd_nelmts ) return false;
+    if ( nLayoutVersion != cd_values[ 1 ] ) return false;
+    const size_t nFields( cd_values[ 3 ] );
+    if ( ( nFixed + 2 * nFields ) > cd_nelmts ) return false;
+    layout.vField.clear();
+    layout.nRecordSize = cd_values[ 2 ];
+    for ( size_t ix = 0; ix < nFields; ++ix ) {
+      const unsigned int nKindWidth( cd_values[ nFixed + 2 * ix ] );
+      layout.vField.push_back(
+        TickCodec::Field{
+          static_cast<TickCodec::EKind>( nKindWidth & 0xff ), nKindWidth >> 8, cd_values[ nFixed + 2 * ix + 1 ] } );
+    }
+    return layout.Valid();
+  }
+
+  htri_t CanApply( hid_t dcpl_id, hid_t type_id, hid_t space_id ) {
+    return ( H5T_COMPOUND == H5Tget_class( type_id ) ) ? 1 : 0;
+  }
+
+  // record the layout of the compound type with the price scale supplied to Set
+  herr_t SetLocal( hid_t dcpl_id, hid_t type_id, hid_t space_id ) {
+
+    unsigned int flags;
+    size_t cd_nelmts( nMaxValues );
+    unsigned int cd_values[ nMaxValues ];
+    if ( 0 > H5Pget_filter_by_id2( dcpl_id, HDF5TickFilter::idFilter, &flags, &cd_nelmts, cd_values, 0, nullptr, nullptr ) ) {
+      return -1;
+    }
+    if ( 1 > cd_nelmts ) return -1;
+
+    const int nMembers( H5Tget_nmembers( type_id ) );
+    if ( ( 0 > nMembers ) || ( nMaxFields < static_cast<size_t>( nMembers ) ) ) return -1;
+
+    cd_values[ 1 ] = nLayoutVersion;
+    cd_values[ 2 ] = H5Tget_size( type_id );
+    cd_values[ 3 ] = nMembers;
+
+    for ( int ix = 0; ix < nMembers; ++ix ) {
+
+      const hid_t idMember( H5Tget_member_type( type_id, ix ) );
+      const H5T_class_t classMember( H5Tget_member_class( type_id, ix ) );
+      const size_t nWidth( H5Tget_size( idMember ) );
+      const bool bLittleEndian( H5T_ORDER_LE == H5Tget_order( idMember ) );
+      H5Tclose( idMember );
+
+      char* szName( H5Tget_member_name( type_id, ix ) );
+      const bool bDateTime( ( nullptr != szName ) && ( std::string( "DateTime" ) == szName ) );
+      if ( nullptr != szName ) H5free_memory( szName );
+
+      TickCodec::EKind eKind( TickCodec::EKind::Raw );
+      if ( bLittleEndian ) {
+        if ( ( H5T_INTEGER == classMember ) && ( 8 == nWidth ) && bDateTime ) eKind = TickCodec::EKind::Time;
+        else if ( ( H5T_FLOAT == classMember ) && ( 8 == nWidth ) ) eKind = TickCodec::EKind::Price;
+        else if ( ( H5T_INTEGER == classMember ) && ( ( 4 == nWidth ) || ( 8 == nWidth ) ) ) eKind = TickCodec::EKind::Integer;
+      }
+
+      cd_values[ nFixed + 2 * ix ] = static_cast<unsigned int>( eKind ) | ( nWidth << 8 );
+      cd_values[ nFixed + 2 * ix + 1 ] = H5Tget_member_offset( type_id, ix );
+    }
+
+    return H5Pmodify_filter( dcpl_id, HDF5TickFilter::idFilter, flags, nFixed + 2 * nMembers, cd_values );
+  }
+
+  // returns the size of the new buffer, 0 on failure
+  size_t Filter(
+    unsigned int flags, size_t cd_nelmts, const unsigned int cd_values[],
+    size_t nbytes, size_t* buf_size, void** buf
+  ) {
+
+    TickCodec::Layout layout;
+    if ( !BuildLayout( cd_nelmts, cd_values, layout ) ) return 0;
+    if ( 0 == cd_values[ 0 ] ) return 0;
+    const TickCodec codec( layout, cd_values[ 0 ] );
+
+    size_t nOut;
+    void* pOut;
+
+    if ( 0 != ( flags & H5Z_FLAG_REVERSE ) ) {
+      nOut = TickCodec::DecodedSize( *buf, nbytes );
+      if ( 0 == nOut ) return 0;
+      pOut = H5allocate_memory( nOut, false );
+      if ( nullptr == pOut ) return 0;
+      if ( nOut != codec.Decode( *buf, nbytes, static_cast<uint8_t*>( pOut ), nOut ) ) {
+        H5free_memory( pOut );
+        return 0;
+      }
+    }
+    else {
+      const size_t nMax( codec.MaxEncodedSize( nbytes ) );
+      pOut = H5allocate_memory( nMax, false );
+      if ( nullptr == pOut ) return 0;
+      nOut = codec.Encode( *buf, nbytes, static_cast<uint8_t*>( pOut ), nMax );
+      if ( 0 == nOut ) {
+        H5free_memory( pOut );
+        return 0;
+      }
+    }
+
+    H5free_memory( *buf );
+    *buf = pOut;
+    *buf_size = nOut;
+    return nOut;
+  }
+
+  const H5Z_class2_t classTickFilter = {
+    H5Z_CLASS_T_VERS,
+    HDF5TickFilter::idFilter,
+    1, 1,
+    "trade-frame tick codec",
+    &CanApply,
+    &SetLocal,
+    &Filter
+  };
+
+} // namespace anonymous
+
+void HDF5TickFilter::Register() {
+  static std::once_flag flag;
+  std::call_once(
+    flag,
+    [](){
+      if ( 0 > H5Zregister( &classTickFilter ) ) {
+        throw std::runtime_error( "HDF5TickFilter::Register failed" );
+      }
+    } );
+}
+
+void HDF5TickFilter::Set( H5::DSetCreatPropList& pl, uint32_t nPriceScale ) {
+  const unsigned int cd_values[ 1 ] = { nPriceScale };
+  pl.setFilter( idFilter, H5Z_FLAG_OPTIONAL, 1, cd_values );
+}
+
+uint32_t HDF5TickFilter::PriceScale( uint8_t nSignificantDigits ) {
+  uint32_t nScale( 1 );
+  for ( uint8_t ix = 0; ix < std::min<uint8_t>( std::max<uint8_t>( nSignificantDigits, 2 ), 9 ); ++ix ) {
+    nScale *= 10;
+  }
+  return nScale;
+}
+
+} // namespace tf
+} // namespace ou
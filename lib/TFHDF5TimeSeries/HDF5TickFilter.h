@@ -0,0 +1,53 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    HDF5TickFilter.h
+ * Author:  raymond@burkholder.net
+ * Project: TFHDF5TimeSeries
+ * Created: May 20, 2020, 13:10
+ */
+
+// TickCodec as an HDF5 chunk filter, in place of shuffle + deflate for Quote and Trade series
+//   the field layout is taken from the dataset's compound type when the dataset is created,
+//     only the price scale is supplied by the writer
+//   the filter is optional: a chunk it can not code is stored as is
+//   HDF5DataManager registers the filter, it must be registered before a coded dataset is read,
+//     h5dump and other tools will not read these datasets
+
+#pragma once
+
+#include <cstdint>
+
+#include <hdf5/H5Cpp.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class HDF5TickFilter {
+public:
+
+  static const H5Z_filter_t idFilter = 311; // unregistered, from the range set aside for testing and private use
+
+  static void Register(); // once per process, subsequent calls do nothing
+  static void Set( H5::DSetCreatPropList&, uint32_t nPriceScale ); // the property list needs chunking
+
+  // 10^digits, at least 2 digits (cents), prices off the scale are stored as is, just less compactly
+  static uint32_t PriceScale( uint8_t nSignificantDigits );
+
+protected:
+private:
+};
+
+} // namespace tf
+} // namespace ou
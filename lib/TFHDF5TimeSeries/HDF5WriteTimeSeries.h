@@ -17,6 +17,7 @@
 #include <string>
 #include <stdexcept>
 
+#include "HDF5TickFilter.h"
 #include "HDF5TimeSeriesContainer.h"
 
 namespace ou { // One Unified
@@ -31,6 +32,10 @@ public:
   HDF5WriteTimeSeries<TS>( HDF5DataManager& dm );  // dm needs to be read/write
   HDF5WriteTimeSeries<TS>( HDF5DataManager& dm, bool bDeflatable, bool bExpandable, int nDeflate = 5, hsize_t nChunkSize = 1024 );
   virtual ~HDF5WriteTimeSeries<TS>( void );
+
+  // new datasets use HDF5TickFilter in place of shuffle + deflate, needs bExpandable
+  void UseTickCodec( uint32_t nPriceScale ) { m_nPriceScale = nPriceScale; }
+
   void Write( const std::string &sPathName, TS* timeseries );
 
 protected:
@@ -40,15 +45,17 @@ private:
   int m_nDeflate;
   bool m_bExpandable;
   hsize_t m_nChunkSize;
+  uint32_t m_nPriceScale; // 0 when the tick codec is not used
 };
 
 template<class TS> HDF5WriteTimeSeries<TS>::HDF5WriteTimeSeries( HDF5DataManager& dm ) 
-: m_dm( dm ), m_bDeflatable( false ), m_bExpandable( false ), m_nDeflate( 0 ), m_nChunkSize( 0 )
+: m_dm( dm ), m_bDeflatable( false ), m_bExpandable( false ), m_nDeflate( 0 ), m_nChunkSize( 0 ), m_nPriceScale( 0 )
 {
 }
 
 template<class TS> HDF5WriteTimeSeries<TS>::HDF5WriteTimeSeries( HDF5DataManager& dm, bool bDeflatable, bool bExpandable, int nDeflate, hsize_t nChunkSize )
-: m_dm( dm ), m_bDeflatable( bDeflatable ), m_bExpandable( bExpandable ), m_nDeflate( nDeflate ), m_nChunkSize( nChunkSize )
+: m_dm( dm ), m_bDeflatable( bDeflatable ), m_bExpandable( bExpandable ), m_nDeflate( nDeflate ), m_nChunkSize( nChunkSize ),
+  m_nPriceScale( 0 )
 {
   if ( bDeflatable ) assert( 0 < nDeflate );
   if ( bExpandable ) assert( 0 < nChunkSize );
@@ -99,9 +106,14 @@ template<class TS> void HDF5WriteTimeSeries<TS>::Write(const std::string &sPathN
       if ( m_bExpandable ) {
         pl.setChunk( 1, &m_nChunkSize );
       }
-      if ( m_bDeflatable ) {
-        pl.setShuffle();
-        pl.setDeflate(m_nDeflate);
+      if ( m_bExpandable && ( 0 != m_nPriceScale ) ) {
+        HDF5TickFilter::Set( pl, m_nPriceScale );
+      }
+      else {
+        if ( m_bDeflatable ) {
+          pl.setShuffle();
+          pl.setDeflate(m_nDeflate);
+        }
       }
 
       dataset = new H5::DataSet( m_dm.GetH5File()->createDataSet( sPathName, *pdt, *pds, pl ) );
@@ -0,0 +1,227 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    IQFeedLevel2.h
+ * Author:  raymond@burkholder.net
+ * Project: TFIQFeed
+ * Created: May 19, 2020, 14:30
+ */
+
+// connection to the IQFeed level 2 port (market maker / exchange depth)
+//   each '2' (update) or 'Z' (summary) line is one market maker's bid and ask,
+//     it is delivered through CRTP as two MarketDepth, a zero volume when a side is not valid
+//   symbols requested before the connection completes are watched once it does, and again after a reconnect
+//   SetAddress/SetPort (from Network) point the connection at a stand-in feed for testing
+
+#pragma once
+
+#include <set>
+#include <mutex>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <iostream>
+
+#include <OUCommon/Network.h>
+#include <OUCommon/TimeSource.h>
+#include <OUCommon/ReusableBuffers.h>
+
+#include <TFTimeSeries/DatedDatum.h>
+
+#include "IQFeedMessages.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+template <typename T>
+class IQFeedLevel2: public ou::Network<IQFeedLevel2<T> > {
+  friend ou::Network<IQFeedLevel2<T> >;
+public:
+
+  typedef typename ou::Network<IQFeedLevel2<T> > inherited_t;
+  typedef typename inherited_t::linebuffer_t linebuffer_t;
+
+  IQFeedLevel2( void );
+  virtual ~IQFeedLevel2( void );
+
+  void StartDepth( const std::string& sSymbol );
+  void StopDepth( const std::string& sSymbol );
+
+  bool Level2Connected( void ) const { return m_bConnected; }
+
+  static MarketDepth::MMID_t MMID( const std::string& ); // first four characters, as packed by MarketDepth
+
+protected:
+
+  // called by Network via CRTP
+  void OnNetworkConnected( void );
+  void OnNetworkDisconnected( void );
+  void OnNetworkError( size_t e ) {
+    if ( &IQFeedLevel2<T>::OnIQFeedLevel2Error != &T::OnIQFeedLevel2Error ) {
+      static_cast<T*>( this )->OnIQFeedLevel2Error( e );
+    }
+  };
+  void OnNetworkLineBuffer( linebuffer_t* );
+
+  // CRTP based dummy callbacks
+  void OnIQFeedLevel2Connected( void ) {};
+  void OnIQFeedLevel2Disconnected( void ) {};
+  void OnIQFeedLevel2Error( size_t ) {};
+  void OnIQFeedLevel2Depth( const std::string& sSymbol, const MarketDepth& ) {};
+  void OnIQFeedLevel2SymbolNotFound( const std::string& sSymbol ) {};
+
+private:
+
+  bool m_bConnected;
+
+  std::mutex m_mutexSymbols;
+  std::set<std::string> m_setSymbols; // watched, or to be watched on connection
+
+  std::string m_sSymbol; // symbol of the message being decoded
+
+  typename ou::BufferRepository<IQFL2Message> m_reposL2Messages;
+
+  void Decode( IQFL2Message& );
+};
+
+template <typename T>
+IQFeedLevel2<T>::IQFeedLevel2( void )
+: ou::Network<IQFeedLevel2<T> >( "127.0.0.1", 9200 ),
+  m_bConnected( false )
+{
+}
+
+template <typename T>
+IQFeedLevel2<T>::~IQFeedLevel2( void ) {
+}
+
+template <typename T>
+MarketDepth::MMID_t IQFeedLevel2<T>::MMID( const std::string& sMMID ) {
+  MarketDepth::MMID_t mmid( 0 );
+  std::memcpy( &mmid, sMMID.c_str(), std::min<size_t>( 4, sMMID.size() ) );
+  return mmid;
+}
+
+template <typename T>
+void IQFeedLevel2<T>::StartDepth( const std::string& sSymbol ) {
+  std::lock_guard<std::mutex> lock( m_mutexSymbols );
+  if ( m_setSymbols.insert( sSymbol ).second ) {
+    if ( m_bConnected ) {
+      inherited_t::Send( "w" + sSymbol + "\n" );
+    }
+  }
+}
+
+template <typename T>
+void IQFeedLevel2<T>::StopDepth( const std::string& sSymbol ) {
+  std::lock_guard<std::mutex> lock( m_mutexSymbols );
+  if ( 0 != m_setSymbols.erase( sSymbol ) ) {
+    if ( m_bConnected ) {
+      inherited_t::Send( "r" + sSymbol + "\n" );
+    }
+  }
+}
+
+template <typename T>
+void IQFeedLevel2<T>::OnNetworkConnected( void ) {
+  {
+    std::lock_guard<std::mutex> lock( m_mutexSymbols );
+    m_bConnected = true;
+    for ( const std::string& sSymbol: m_setSymbols ) {
+      inherited_t::Send( "w" + sSymbol + "\n" );
+    }
+  }
+  if ( &IQFeedLevel2<T>::OnIQFeedLevel2Connected != &T::OnIQFeedLevel2Connected ) {
+    static_cast<T*>( this )->OnIQFeedLevel2Connected();
+  }
+}
+
+template <typename T>
+void IQFeedLevel2<T>::OnNetworkDisconnected( void ) {
+  {
+    std::lock_guard<std::mutex> lock( m_mutexSymbols );
+    m_bConnected = false;
+  }
+  if ( &IQFeedLevel2<T>::OnIQFeedLevel2Disconnected != &T::OnIQFeedLevel2Disconnected ) {
+    static_cast<T*>( this )->OnIQFeedLevel2Disconnected();
+  }
+}
+
+template <typename T>
+void IQFeedLevel2<T>::OnNetworkLineBuffer( linebuffer_t* pBuffer ) {
+
+  typename linebuffer_t::iterator iter = (*pBuffer).begin();
+  typename linebuffer_t::iterator end = (*pBuffer).end();
+
+  BOOST_ASSERT( iter != end );
+
+  switch ( *iter ) {
+    case '2':
+    case 'Z':
+      {
+        IQFL2Message* msg = m_reposL2Messages.CheckOutL();
+        msg->Assign( iter, end );
+        Decode( *msg );
+        m_reposL2Messages.CheckInL( msg );
+      }
+      break;
+    case 'n': // n,symbol
+      {
+        IQFL2Message* msg = m_reposL2Messages.CheckOutL();
+        msg->Assign( iter, end );
+        if ( &IQFeedLevel2<T>::OnIQFeedLevel2SymbolNotFound != &T::OnIQFeedLevel2SymbolNotFound ) {
+          static_cast<T*>( this )->OnIQFeedLevel2SymbolNotFound( msg->Field( IQFL2Message::L2Symbol ) );
+        }
+        else {
+          std::cout << "IQFeedLevel2: " << msg->Field( IQFL2Message::L2Symbol ) << " not found" << std::endl;
+        }
+        m_reposL2Messages.CheckInL( msg );
+      }
+      break;
+    case 'E':
+      std::cout << "IQFeedLevel2: " << std::string( iter, end ) << std::endl;
+      break;
+    case 'M': // market maker description
+    case 'O': // deprecated
+    case 'T': // timestamp
+    case 'S': // system
+    default:
+      break;
+  }
+
+  this->GiveBackBuffer( pBuffer );
+}
+
+template <typename T>
+void IQFeedLevel2<T>::Decode( IQFL2Message& msg ) {
+
+  if ( IQFL2Message::L2AskValid > msg.FieldCount() ) return; // truncated
+
+  m_sSymbol = msg.Field( IQFL2Message::L2Symbol );
+  const MarketDepth::MMID_t mmid( MMID( msg.Field( IQFL2Message::L2MMID ) ) );
+  const ptime dt( ou::TimeSource::Instance().External() ); // as with level 1 quotes
+
+  const MarketDepth bid(
+    dt, 'B', msg.BidValid() ? msg.Integer( IQFL2Message::L2BidSize ) : 0, msg.Double( IQFL2Message::L2Bid ), mmid );
+  const MarketDepth ask(
+    dt, 'S', msg.AskValid() ? msg.Integer( IQFL2Message::L2AskSize ) : 0, msg.Double( IQFL2Message::L2Ask ), mmid );
+
+  if ( &IQFeedLevel2<T>::OnIQFeedLevel2Depth != &T::OnIQFeedLevel2Depth ) {
+    static_cast<T*>( this )->OnIQFeedLevel2Depth( m_sSymbol, bid );
+    static_cast<T*>( this )->OnIQFeedLevel2Depth( m_sSymbol, ask );
+  }
+}
+
+} // namespace tf
+} // namespace ou
@@ -108,6 +108,52 @@ IQFSummaryMessage::IQFSummaryMessage( iterator_t& current, iterator_t& end )
 IQFSummaryMessage::~IQFSummaryMessage() {
 }
 
+//**** IQFL2Message
+
+IQFL2Message::IQFL2Message( void )
+: IQFBaseMessage<IQFL2Message>()
+{
+}
+
+IQFL2Message::IQFL2Message( iterator_t& current, iterator_t& end )
+: IQFBaseMessage<IQFL2Message>( current, end )
+{
+}
+
+IQFL2Message::~IQFL2Message() {
+}
+
+ptime IQFL2Message::DateTime( ixFields_t ixTime ) {
+
+  if ( ( L2Date > FieldCount() ) || ( ixTime > FieldCount() ) ) { // truncated message
+    return ptime( boost::date_time::special_values::not_a_date_time );
+  }
+
+  fielddelimiter_t date = m_vFieldDelimiters[ L2Date ];
+  fielddelimiter_t time = m_vFieldDelimiters[ ixTime ];
+
+  if ( ( ( date.second - date.first ) == 10 ) && ( ( time.second - time.first ) >= 8 ) ) {
+    std::string sDateTime;
+    sDateTime.reserve( 26 );
+    if ( '-' == *( date.first + 4 ) ) { // yyyy-mm-dd
+      sDateTime.assign( date.first, date.second );
+    }
+    else { // mm/dd/yyyy
+      sDateTime.assign( date.first + 6, date.first + 10 );
+      sDateTime += '-';
+      sDateTime.append( date.first + 0, date.first + 2 );
+      sDateTime += '-';
+      sDateTime.append( date.first + 3, date.first + 5 );
+    }
+    sDateTime += ' ';
+    sDateTime.append( time.first, time.second ); // hh:mm:ss[.ffffff]
+    return boost::posix_time::time_from_string( sDateTime );
+  }
+  else {
+    return ptime( boost::date_time::special_values::not_a_date_time );
+  }
+}
+
 //**** IQFTimeMessage
 
 IQFTimeMessage::IQFTimeMessage( void )
@@ -64,6 +64,8 @@ public:
   iterator_t FieldBegin( ixFields_t );
   iterator_t FieldEnd( ixFields_t );
 
+  ixFields_t FieldCount( void ) const { return m_vFieldDelimiters.size() - 1; }; // fields are 1 based
+
 protected:
 
   std::vector<fielddelimiter_t> m_vFieldDelimiters;
@@ -315,6 +317,43 @@ public:
 private:
 };
 
+//**** IQFL2Message
+// one market maker's (or one exchange's) bid and ask on the level 2 port
+class IQFL2Message: public IQFBaseMessage<IQFL2Message> { // 2 (update), Z (summary)
+public:
+
+  enum enumFieldIds {
+    L2Symbol = 2,
+    L2MMID = 3,
+    L2Bid = 4,
+    L2Ask = 5,
+    L2BidSize = 6,
+    L2AskSize = 7,
+    L2BidTime = 8,
+    L2Date = 9,
+    L2Condition = 10,
+    L2AskTime = 11,
+    L2BidValid = 12,
+    L2AskValid = 13,
+    L2EndOfGroup = 14,
+    _L2LastEntry
+  };
+
+  IQFL2Message( void );
+  IQFL2Message( iterator_t& current, iterator_t& end );
+  ~IQFL2Message(void);
+
+  bool BidValid( void ) { return "T" == Field( L2BidValid ); };
+  bool AskValid( void ) { return "T" == Field( L2AskValid ); };
+
+  ptime BidTime( void ) { return DateTime( L2BidTime ); };
+  ptime AskTime( void ) { return DateTime( L2AskTime ); };
+
+protected:
+private:
+  ptime DateTime( ixFields_t ); // L2Date with the supplied time field
+};
+
 
 template <class T, class charT>
 IQFBaseMessage<T, charT>::IQFBaseMessage( void )
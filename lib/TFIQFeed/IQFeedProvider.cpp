@@ -14,54 +14,215 @@
 
 //#include "StdAfx.h"
 
+#include <chrono>
+#include <functional>
+
 #include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <TFTrading/KeyTypes.h>
 
+#include "IQFeedLevel2.h"
+#include "NewsScanner.h"
 #include "IQFeedProvider.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+class IQFeedProviderLevel2: public IQFeedLevel2<IQFeedProviderLevel2> {
+  friend IQFeedLevel2<IQFeedProviderLevel2>;
+public:
+  explicit IQFeedProviderLevel2( IQFeedProvider& provider ): m_provider( provider ) {}
+protected:
+  void OnIQFeedLevel2Depth( const std::string& sSymbol, const MarketDepth& md ) {
+    m_provider.OnLevel2Depth( sSymbol, md );
+  }
+private:
+  IQFeedProvider& m_provider;
+};
+
+// additional level 1 connection, messages are handed to the provider on this connection's asio thread
+class IQFeedProviderShard: public IQFeed<IQFeedProviderShard> {
+  friend IQFeed<IQFeedProviderShard>;
+public:
+  IQFeedProviderShard( IQFeedProvider& provider, size_t ixShard ): m_provider( provider ), m_ixShard( ixShard ) {}
+protected:
+  void OnIQFeedConnected( void ) { m_provider.HandleShardConnected( m_ixShard ); }
+  void OnIQFeedDisConnected( void ) { m_provider.HandleShardDisConnected( m_ixShard ); }
+  void OnIQFeedError( size_t e ) { m_provider.OnIQFeedError( e ); }
+  void OnIQFeedUpdateMessage( linebuffer_t* pBuffer, IQFUpdateMessage* pMsg ) {
+    m_provider.HandleUpdate( m_ixShard, pMsg );
+    UpdateDone( pBuffer, pMsg );
+  }
+  void OnIQFeedSummaryMessage( linebuffer_t* pBuffer, IQFSummaryMessage* pMsg ) {
+    m_provider.HandleSummary( m_ixShard, pMsg );
+    SummaryDone( pBuffer, pMsg );
+  }
+  void OnIQFeedFundamentalMessage( linebuffer_t* pBuffer, IQFFundamentalMessage* pMsg ) {
+    m_provider.HandleFundamental( m_ixShard, pMsg );
+    FundamentalDone( pBuffer, pMsg );
+  }
+  void OnIQFeedTimeMessage( linebuffer_t* pBuffer, IQFTimeMessage* pMsg ) {
+    m_provider.HandleTime( m_ixShard, pMsg );
+    TimeDone( pBuffer, pMsg );
+  }
+private:
+  IQFeedProvider& m_provider;
+  size_t m_ixShard;
+};
+
+struct IQFeedProvider::ShardState {
+  std::unique_ptr<IQFeedProviderShard> pConnection; // empty for shard 0, the provider's own connection
+  std::atomic<bool> bConnected; // exchanged by the shard's connection callbacks, so it is counted once
+  size_t nSymbols; // maintained by the thread issuing watches
+  // written by the shard's thread only, read by GetShardStats
+  std::atomic<uint64_t> cntMessages;
+  std::atomic<int64_t> nLag; // microseconds
+  std::atomic<int64_t> nLagMax;
+  int64_t nOffsetMin; // microseconds, local clock less the feed's time stamp, the least seen
+  bool bOffset;
+  // GetShardStats only
+  uint64_t cntPrevious;
+  std::chrono::steady_clock::time_point tpPrevious;
+  ShardState()
+  : bConnected( false ), nSymbols( 0 ), cntMessages( 0 ), nLag( 0 ), nLagMax( 0 ),
+    nOffsetMin( 0 ), bOffset( false ),
+    cntPrevious( 0 ), tpPrevious( std::chrono::steady_clock::now() )
+  {}
+};
+
 IQFeedProvider::IQFeedProvider( void ) 
 : ProviderInterface<IQFeedProvider,IQFeedSymbol>(), 
-  IQFeed<IQFeedProvider>()
+  IQFeed<IQFeedProvider>(),
+  m_cntShardsConnected( 0 ), m_bShardsReported( false ), m_bDisconnecting( false ),
+  m_pNewsScanner( nullptr )
 {
   m_sName = "IQF";
   m_nID = keytypes::EProviderIQF;
   m_bProvidesQuotes = true;
   m_bProvidesTrades = true;
+  m_bProvidesDepth = true;
+  m_vShard.emplace_back( new ShardState );
 }
 
 IQFeedProvider::~IQFeedProvider(void) {
 }
 
+void IQFeedProvider::SetShards( size_t nShards ) {
+  assert( !m_bConnected );
+  if ( !m_bConnected ) {
+    if ( 0 == nShards ) nShards = 1;
+    m_vShard.clear();
+    for ( size_t ix = 0; ix < nShards; ++ix ) {
+      m_vShard.emplace_back( new ShardState );
+      if ( 0 != ix ) m_vShard.back()->pConnection.reset( new IQFeedProviderShard( *this, ix ) );
+    }
+  }
+}
+
+size_t IQFeedProvider::Shard( const std::string& sSymbol ) const {
+  if ( 1 == m_vShard.size() ) return 0;
+  std::string::size_type ixDigit( sSymbol.find_first_of( "0123456789" ) );
+  if ( 0 == ixDigit ) ixDigit = std::string::npos;
+  return std::hash<std::string>()( sSymbol.substr( 0, ixDigit ) ) % m_vShard.size();
+}
+
+IQFeedProvider::ShardStats IQFeedProvider::GetShardStats( size_t ixShard ) {
+  ShardStats stats;
+  if ( ixShard < m_vShard.size() ) {
+    ShardState& state( *m_vShard[ ixShard ] );
+    const std::chrono::steady_clock::time_point tpNow( std::chrono::steady_clock::now() );
+    stats.nSymbols = state.nSymbols;
+    stats.cntMessages = state.cntMessages.load( std::memory_order_relaxed );
+    const double dblSeconds( std::chrono::duration<double>( tpNow - state.tpPrevious ).count() );
+    if ( 0.0 < dblSeconds ) {
+      stats.dblRate = ( stats.cntMessages - state.cntPrevious ) / dblSeconds;
+    }
+    state.cntPrevious = stats.cntMessages;
+    state.tpPrevious = tpNow;
+    stats.dblLag = state.nLag.load( std::memory_order_relaxed ) / 1e6;
+    stats.dblLagMax = state.nLagMax.load( std::memory_order_relaxed ) / 1e6;
+  }
+  return stats;
+}
+
+void IQFeedProvider::SendToShard( size_t ixShard, const std::string& s ) {
+  if ( 0 == ixShard ) {
+    IQFeed<IQFeedProvider>::Send( s );
+  }
+  else {
+    m_vShard[ ixShard ]->pConnection->Send( s );
+  }
+}
+
 void IQFeedProvider::Connect() {
   if ( !m_bConnected ) {
     ProviderInterfaceBase::OnConnecting( 0 );
     inherited_t::Connect();
-    IQFeed_t::Connect();
+    m_bDisconnecting = false;
+    // after a shard dropped, the others are still up
+    if ( !m_vShard[ 0 ]->bConnected.load( std::memory_order_acquire ) ) IQFeed_t::Connect();
+    for ( pShardState_t& pShard: m_vShard ) {
+      if ( pShard->pConnection && !pShard->bConnected.load( std::memory_order_acquire ) ) {
+        pShard->pConnection->SetAddress( IQFeed_t::GetConnection().sAddress );
+        pShard->pConnection->SetPort( IQFeed_t::GetConnection().nPort );
+        pShard->pConnection->Connect();
+      }
+    }
+    if ( m_pLevel2 ) m_pLevel2->Connect(); // watches are re-issued on connection
   }
 }
 
 void IQFeedProvider::OnIQFeedConnected( void ) {
-  m_bConnected = true;
-  inherited_t::ConnectionComplete();
-  ProviderInterfaceBase::OnConnected( 0 );
+  HandleShardConnected( 0 );
+}
+
+// the last shard to connect completes the connection
+void IQFeedProvider::HandleShardConnected( size_t ixShard ) {
+  bool bConnected( false );
+  if ( !m_vShard[ ixShard ]->bConnected.compare_exchange_strong( bConnected, true ) ) return; // already counted
+  if ( m_vShard.size() == ++m_cntShardsConnected ) {
+    bool bReported( false );
+    if ( m_bShardsReported.compare_exchange_strong( bReported, true ) ) {
+      m_bConnected = true;
+      inherited_t::ConnectionComplete();
+      ProviderInterfaceBase::OnConnected( 0 );
+    }
+  }
 }
 
 void IQFeedProvider::Disconnect() {
-  if ( m_bConnected ) {
+  if ( m_bConnected || ( 0 != m_cntShardsConnected.load() ) ) { // or the shards left up after one dropped
+    m_bDisconnecting = true;
     inherited_t::Disconnecting();
     ProviderInterfaceBase::OnDisconnecting( 0 );
+    if ( m_pLevel2 ) m_pLevel2->Disconnect();
+    for ( pShardState_t& pShard: m_vShard ) {
+      if ( pShard->pConnection ) pShard->pConnection->Disconnect();
+    }
     IQFeed_t::Disconnect();
     inherited_t::Disconnect();
   }
 }
 
 void IQFeedProvider::OnIQFeedDisConnected( void ) {
-  m_bConnected = false;
-  ProviderInterfaceBase::OnDisconnected( 0 );
+  HandleShardDisConnected( 0 );
+}
+
+// on request, the last shard to disconnect completes the disconnection,
+//   otherwise a shard dropped, the feed is partial, the first one down reports the disconnection
+// a shard timing out while connecting was never counted, and is not counted down
+void IQFeedProvider::HandleShardDisConnected( size_t ixShard ) {
+  bool bConnected( true );
+  if ( !m_vShard[ ixShard ]->bConnected.compare_exchange_strong( bConnected, false ) ) return; // not counted
+  const size_t cntConnected( --m_cntShardsConnected );
+  if ( ( 0 == cntConnected ) || !m_bDisconnecting.load( std::memory_order_acquire ) ) {
+    bool bReported( true );
+    if ( m_bShardsReported.compare_exchange_strong( bReported, false ) ) {
+      m_bConnected = false;
+      ProviderInterfaceBase::OnDisconnected( 0 );
+    }
+  }
 }
 
 void IQFeedProvider::OnIQFeedError( size_t e ) {
@@ -76,8 +237,10 @@ IQFeedProvider::pSymbol_t IQFeedProvider::NewCSymbol( pInstrument_t pInstrument
 
 void IQFeedProvider::StartQuoteTradeWatch( IQFeedSymbol* pSymbol ) {
   if ( !pSymbol->GetQuoteTradeWatchInProgress() ) {
+    const size_t ixShard( Shard( pSymbol->GetId() ) );
     std::string s = "w" + pSymbol->GetId() + "\n";
-    IQFeed<IQFeedProvider>::Send( s );
+    SendToShard( ixShard, s );
+    m_vShard[ ixShard ]->nSymbols++;
     pSymbol->SetQuoteTradeWatchInProgress();
   }
 }
@@ -87,8 +250,13 @@ void IQFeedProvider::StopQuoteTradeWatch( IQFeedSymbol* pSymbol ) {
     // don't do anything, as stuff still active
   }
   else {
-    std::string s = "r" + pSymbol->GetId() + "\n";
-    IQFeed<IQFeedProvider>::Send( s );
+    if ( pSymbol->GetQuoteTradeWatchInProgress() ) {
+      const size_t ixShard( Shard( pSymbol->GetId() ) );
+      std::string s = "r" + pSymbol->GetId() + "\n";
+      SendToShard( ixShard, s );
+      m_vShard[ ixShard ]->nSymbols--;
+      pSymbol->ResetQuoteTradeWatchInProgress(); // so a later watch is issued again
+    }
   }
 }
 
@@ -108,41 +276,137 @@ void IQFeedProvider::StopTradeWatch(pSymbol_t pSymbol) {
   StopQuoteTradeWatch( dynamic_cast<IQFeedSymbol*>( pSymbol.get() ) );
 }
 
-void IQFeedProvider::OnIQFeedUpdateMessage( linebuffer_t* pBuffer, IQFUpdateMessage *pMsg ) {
+void IQFeedProvider::StartDepthWatch( pSymbol_t pSymbol ) {
+  IQFeedSymbol* pIQFeedSymbol( dynamic_cast<IQFeedSymbol*>( pSymbol.get() ) );
+  if ( !pIQFeedSymbol->GetDepthWatchInProgress() ) {
+    if ( !m_pLevel2 ) {
+      m_pLevel2.reset( new IQFeedProviderLevel2( *this ) );
+      m_pLevel2->Connect();
+    }
+    m_pLevel2->StartDepth( pIQFeedSymbol->GetId() );
+    pIQFeedSymbol->SetDepthWatchInProgress();
+  }
+}
+
+void IQFeedProvider::StopDepthWatch( pSymbol_t pSymbol ) {
+  IQFeedSymbol* pIQFeedSymbol( dynamic_cast<IQFeedSymbol*>( pSymbol.get() ) );
+  if ( pIQFeedSymbol->DepthWatchNeeded() ) {
+    // don't do anything, as stuff still active
+  }
+  else {
+    if ( pIQFeedSymbol->GetDepthWatchInProgress() ) {
+      m_pLevel2->StopDepth( pIQFeedSymbol->GetId() );
+      pIQFeedSymbol->ResetDepthWatchInProgress();
+    }
+  }
+}
+
+// level 2 connection thread
+void IQFeedProvider::OnLevel2Depth( const std::string& sSymbol, const MarketDepth& md ) {
+  inherited_t::mapSymbols_t::iterator mapSymbols_iter = m_mapSymbols.find( sSymbol );
+  if ( m_mapSymbols.end() != mapSymbols_iter ) {
+    mapSymbols_iter->second->HandleDepth( md );
+  }
+}
+
+namespace {
+  template<typename counter_t>
+  inline void Increment( counter_t& counter ) { // single writer
+    counter.store( counter.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+  }
+}
+
+// shard threads
+void IQFeedProvider::HandleUpdate( size_t ixShard, IQFUpdateMessage* pMsg ) {
+  Increment( m_vShard[ ixShard ]->cntMessages );
   inherited_t::mapSymbols_t::iterator mapSymbols_iter;
   mapSymbols_iter = m_mapSymbols.find( pMsg->Field( IQFUpdateMessage::QPSymbol ) );
-  pSymbol_t pSym;
   if ( m_mapSymbols.end() != mapSymbols_iter ) {
-    pSym = mapSymbols_iter -> second;
-    pSym ->HandleUpdateMessage( pMsg );
+    mapSymbols_iter->second->HandleUpdateMessage( pMsg );
   }
-  this->UpdateDone( pBuffer, pMsg );
 }
 
-void IQFeedProvider::OnIQFeedSummaryMessage( linebuffer_t* pBuffer, IQFSummaryMessage *pMsg ) {
+void IQFeedProvider::HandleSummary( size_t ixShard, IQFSummaryMessage* pMsg ) {
+  Increment( m_vShard[ ixShard ]->cntMessages );
   inherited_t::mapSymbols_t::iterator mapSymbols_iter;
   mapSymbols_iter = m_mapSymbols.find( pMsg->Field( IQFSummaryMessage::QPSymbol ) );
-  pSymbol_t pSym;
   if ( m_mapSymbols.end() != mapSymbols_iter ) {
-    pSym = mapSymbols_iter -> second;
-    pSym ->HandleSummaryMessage( pMsg );
+    mapSymbols_iter->second->HandleSummaryMessage( pMsg );
   }
-  this->SummaryDone( pBuffer, pMsg );
 }
 
-void IQFeedProvider::OnIQFeedFundamentalMessage( linebuffer_t* pBuffer, IQFFundamentalMessage *pMsg ) {
+void IQFeedProvider::HandleFundamental( size_t ixShard, IQFFundamentalMessage* pMsg ) {
+  Increment( m_vShard[ ixShard ]->cntMessages );
   inherited_t::mapSymbols_t::iterator mapSymbols_iter;
   mapSymbols_iter = m_mapSymbols.find( pMsg->Field( IQFFundamentalMessage::FSymbol ) );
-  pSymbol_t pSym;
   if ( m_mapSymbols.end() != mapSymbols_iter ) {
-    pSym = mapSymbols_iter -> second;
-    pSym ->HandleFundamentalMessage( pMsg );
+    mapSymbols_iter->second->HandleFundamentalMessage( pMsg );
+  }
+}
+
+// each connection receives the once a second time message, queued behind that connection's updates:
+//   its arrival, compared to the earliest arrival seen, is the shard's backlog
+//   the comparison removes the time zone and clock difference between the feed and this machine
+void IQFeedProvider::HandleTime( size_t ixShard, IQFTimeMessage* pMsg ) {
+  ShardState& state( *m_vShard[ ixShard ] );
+  const int64_t nOffset(
+    ( boost::posix_time::microsec_clock::local_time() - pMsg->TimeStamp() ).total_microseconds() );
+  if ( !state.bOffset || ( nOffset < state.nOffsetMin ) ) {
+    state.nOffsetMin = nOffset;
+    state.bOffset = true;
   }
+  const int64_t nLag( nOffset - state.nOffsetMin );
+  state.nLag.store( nLag, std::memory_order_relaxed );
+  if ( nLag > state.nLagMax.load( std::memory_order_relaxed ) ) {
+    state.nLagMax.store( nLag, std::memory_order_relaxed );
+  }
+}
+
+void IQFeedProvider::OnIQFeedUpdateMessage( linebuffer_t* pBuffer, IQFUpdateMessage *pMsg ) {
+  HandleUpdate( 0, pMsg );
+  this->UpdateDone( pBuffer, pMsg );
+}
+
+void IQFeedProvider::OnIQFeedSummaryMessage( linebuffer_t* pBuffer, IQFSummaryMessage *pMsg ) {
+  HandleSummary( 0, pMsg );
+  this->SummaryDone( pBuffer, pMsg );
+}
+
+void IQFeedProvider::OnIQFeedFundamentalMessage( linebuffer_t* pBuffer, IQFFundamentalMessage *pMsg ) {
+  HandleFundamental( 0, pMsg );
   this->FundamentalDone( pBuffer, pMsg );
 }
 
+void IQFeedProvider::SetNewsScanner( iqfeed::NewsScanner* pNewsScanner ) {
+  m_pNewsScanner.store( pNewsScanner );
+}
+
 void IQFeedProvider::OnIQFeedNewsMessage( linebuffer_t* pBuffer, IQFNewsMessage *pMsg ) {
 
+  iqfeed::NewsScanner* pNewsScanner( m_pNewsScanner.load() );
+  if ( nullptr != pNewsScanner ) {
+    iqfeed::NewsScanner::Headline headline;
+    headline.sDistributor = pMsg->Distributor();
+    headline.sStoryId = pMsg->StoryId();
+    headline.sSymbols = pMsg->SymbolList();
+    headline.sHeadline = pMsg->Headline();
+    // YYYYMMDD HHMMSS, eastern as supplied, digits only for from_iso_string
+    std::string sDateTime;
+    for ( const char ch: pMsg->DateTime() ) {
+      if ( ( '0' <= ch ) && ( '9' >= ch ) ) {
+        sDateTime.push_back( ch );
+        if ( 8 == sDateTime.size() ) sDateTime.push_back( 'T' );
+      }
+    }
+    try {
+      headline.dt = boost::posix_time::from_iso_string( sDateTime );
+    }
+    catch ( const std::exception& ) {
+      headline.dt = boost::posix_time::second_clock::local_time();
+    }
+    pNewsScanner->Scan( headline );
+  }
+
   inherited_t::mapSymbols_t::iterator mapSymbols_iter;
 /*
   const char *ixFstColon = pMsg->m_sSymbolList.c_str();
@@ -182,7 +446,7 @@ void IQFeedProvider::OnIQFeedNewsMessage( linebuffer_t* pBuffer, IQFNewsMessage
 }
 
 void IQFeedProvider::OnIQFeedTimeMessage( linebuffer_t* pBuffer, IQFTimeMessage *pMsg ) {
-  //map<string, CSymbol*>::iterator m_mapSymbols_Iter;
+  HandleTime( 0, pMsg );
   this->TimeDone( pBuffer, pMsg );
 }
 
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
 
 #include "TFTrading/ProviderInterface.h"
@@ -24,11 +28,31 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+class IQFeedProviderLevel2;
+class IQFeedProviderShard;
+
+namespace iqfeed {
+  class NewsScanner;
+}
+
+// Level 1 may be spread over several connections to the IQFeed daemon, SetShards( n ) before Connect
+//   shard 0 is the provider's own connection, shards 1 .. n-1 are additional connections,
+//     each with its own asio thread doing framing, parsing and the symbol's delegates
+//   a symbol is assigned by hashing its root (the name up to the first digit),
+//     so an underlying, its options and its futures options are updated on the one thread
+//   watches are issued once every shard has connected
+//   a shard is counted once, by its own connected flag; when one drops, the provider is reported
+//     disconnected then and there, the rest stay up, and Connect reconnects the shards which are down
+//   m_mapSymbols is read concurrently by the shard threads, symbols are to be added before
+//     their watches start, as with the single connection
+
 class IQFeedProvider :
   public ProviderInterface<IQFeedProvider,IQFeedSymbol>,
   public IQFeed<IQFeedProvider>
 {
   friend IQFeed<IQFeedProvider>;
+  friend IQFeedProviderLevel2;
+  friend IQFeedProviderShard;
 public:
 
   typedef boost::shared_ptr<IQFeedProvider> pProvider_t;
@@ -47,6 +71,23 @@ public:
 
   void SetAlternateInstrumentName( pInstrument_t );
 
+  struct ShardStats {
+    size_t nSymbols;      // quote/trade watches assigned
+    uint64_t cntMessages; // update, summary, fundamental messages since SetShards
+    double dblRate;       // messages per second since the previous call for the shard
+    double dblLag;        // seconds the latest time message arrived behind the earliest seen on the shard
+    double dblLagMax;
+    ShardStats(): nSymbols( 0 ), cntMessages( 0 ), dblRate( 0.0 ), dblLag( 0.0 ), dblLagMax( 0.0 ) {}
+  };
+
+  void SetShards( size_t nShards ); // while disconnected, at least one
+  size_t Shards( void ) const { return m_vShard.size(); }
+  size_t Shard( const std::string& sSymbol ) const; // shard assigned to an iqfeed symbol
+  ShardStats GetShardStats( size_t ixShard ); // call from one thread, it keeps the previous sample for the rate
+
+  // news headlines are passed to the scanner, SetNewsOn still to be called to receive them, nullptr to stop
+  void SetNewsScanner( iqfeed::NewsScanner* );
+
 protected:
 
   void StartQuoteTradeWatch( IQFeedSymbol *pSymbol );
@@ -59,8 +100,9 @@ protected:
   virtual void StartTradeWatch( pSymbol_t pSymbol );
   virtual void  StopTradeWatch( pSymbol_t pSymbol );
 
-  virtual void StartDepthWatch( pSymbol_t pSymbol ) {};
-  virtual void  StopDepthWatch( pSymbol_t pSymbol ) {};
+  // level 2 connection is made on the first depth watch
+  virtual void StartDepthWatch( pSymbol_t pSymbol );
+  virtual void  StopDepthWatch( pSymbol_t pSymbol );
 
   pSymbol_t NewCSymbol( pInstrument_t pInstrument );  // used by Add/Remove x handlers in base class
 
@@ -75,8 +117,33 @@ protected:
   void OnIQFeedConnected( void ); // CRTP on IQFeed
   void OnIQFeedError( size_t );
 
+  void OnLevel2Depth( const std::string& sSymbol, const MarketDepth& );
+
 private:
 
+  struct ShardState;
+  using pShardState_t = std::unique_ptr<ShardState>;
+  using vShard_t = std::vector<pShardState_t>;
+  vShard_t m_vShard;
+
+  std::atomic<size_t> m_cntShardsConnected; // shards with their connected flag set
+  std::atomic<bool> m_bShardsReported; // OnConnected has been reported, OnDisconnected not yet
+  std::atomic<bool> m_bDisconnecting; // by request, reported once every shard is down
+
+  std::unique_ptr<IQFeedProviderLevel2> m_pLevel2;
+
+  std::atomic<iqfeed::NewsScanner*> m_pNewsScanner;
+
+  // shard connection callbacks, on the shard's asio thread
+  void HandleShardConnected( size_t ixShard );
+  void HandleShardDisConnected( size_t ixShard );
+  void HandleUpdate( size_t ixShard, IQFUpdateMessage* );
+  void HandleSummary( size_t ixShard, IQFSummaryMessage* );
+  void HandleFundamental( size_t ixShard, IQFFundamentalMessage* );
+  void HandleTime( size_t ixShard, IQFTimeMessage* );
+
+  void SendToShard( size_t ixShard, const std::string& );
+
 };
 
 } // namespace tf
@@ -16,6 +16,7 @@
 
 #include <iostream>
 
+#include <OUCommon/Latency.h>
 #include <OUCommon/TimeSource.h>
 
 #include "IQFeedSymbol.h"
@@ -153,6 +154,7 @@ void IQFeedSymbol::HandleUpdateMessage( IQFUpdateMessage *pMsg ) {
   }
   if ( qFound == m_QStatus ) {
     DecodePricingMessage<IQFUpdateMessage>( pMsg );
+    OU_LATENCY_MARK( Decode );
     OnUpdateMessage( *this );
     //ptime dt( microsec_clock::local_time() );
     ptime dt( ou::TimeSource::Instance().External() );
@@ -174,5 +176,9 @@ void IQFeedSymbol::HandleUpdateMessage( IQFUpdateMessage *pMsg ) {
 void IQFeedSymbol::HandleNewsMessage( IQFNewsMessage *pMsg ) {
 }
 
+void IQFeedSymbol::HandleDepth( const MarketDepth& md ) {
+  Symbol::m_OnDepth( md );
+}
+
 } // namespace tf
 } // namespace ou
@@ -101,6 +101,7 @@ protected:
   void HandleUpdateMessage( IQFUpdateMessage *pMsg );
   void HandleSummaryMessage( IQFSummaryMessage *pMsg );
   void HandleNewsMessage( IQFNewsMessage *pMsg );
+  void HandleDepth( const MarketDepth& );
 
   template <typename T>
   void DecodePricingMessage( IQFPricingMessage<T> *pMsg );
@@ -0,0 +1,168 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    NewsScanner.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFIQFeed
+ * Created: May 24, 2020, 11:05
+ */
+
+#include <algorithm>
+
+#include "NewsScanner.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace iqfeed { // IQFeed
+
+NewsScanner::NewsScanner( size_t nMaxHeadlines )
+: m_idNext( 1 ),
+  m_nMaxHeadlines( nMaxHeadlines ),
+  m_cntScanned( 0 ), m_cntMatched( 0 )
+{
+  Commit(); // an empty matcher, so Scan need not check
+}
+
+NewsScanner::~NewsScanner() {}
+
+NewsScanner::idSubscriber_t NewsScanner::Subscribe( fHit_t&& fHit ) {
+  std::lock_guard<std::mutex> lock( m_mutexStage );
+  const idSubscriber_t id( m_idNext++ );
+  m_mapSubscriber.emplace( id, std::make_shared<fHit_t>( std::move( fHit ) ) );
+  return id;
+}
+
+void NewsScanner::Unsubscribe( idSubscriber_t id ) {
+  std::lock_guard<std::mutex> lock( m_mutexStage );
+  m_mapSubscriber.erase( id );
+  for ( auto iter = m_mapWatch.begin(); m_mapWatch.end() != iter; ) {
+    iter->second.erase( id );
+    if ( iter->second.empty() ) iter = m_mapWatch.erase( iter );
+    else ++iter;
+  }
+}
+
+void NewsScanner::Watch( idSubscriber_t id, EKind eKind, const std::string& sPattern ) {
+  if ( sPattern.empty() ) return;
+  std::lock_guard<std::mutex> lock( m_mutexStage );
+  if ( m_mapSubscriber.end() != m_mapSubscriber.find( id ) ) {
+    m_mapWatch[ key_t( eKind, sPattern ) ].insert( id );
+  }
+}
+
+void NewsScanner::Unwatch( idSubscriber_t id, EKind eKind, const std::string& sPattern ) {
+  std::lock_guard<std::mutex> lock( m_mutexStage );
+  auto iter = m_mapWatch.find( key_t( eKind, sPattern ) );
+  if ( m_mapWatch.end() != iter ) {
+    iter->second.erase( id );
+    if ( iter->second.empty() ) m_mapWatch.erase( iter );
+  }
+}
+
+void NewsScanner::Commit( void ) {
+  std::shared_ptr<Matcher> pMatcher = std::make_shared<Matcher>();
+  {
+    std::lock_guard<std::mutex> lock( m_mutexStage );
+    pMatcher->vPattern.reserve( m_mapWatch.size() );
+    for ( const auto& vt: m_mapWatch ) {
+      const EKind eKind( vt.first.first );
+      const std::string& sPattern( vt.first.second );
+      const bool bSymbol( EKind::Symbol == eKind );
+      const uint32_t ix = pMatcher->ac.AddPattern( sPattern, bSymbol, bSymbol );
+      pMatcher->vPattern.push_back(
+        Matcher::Pattern{ eKind, sPattern, std::vector<idSubscriber_t>( vt.second.begin(), vt.second.end() ) } );
+      if ( bSymbol ) pMatcher->mapSymbol.emplace( sPattern, ix );
+    }
+    pMatcher->mapSubscriber = m_mapSubscriber;
+  }
+  pMatcher->ac.Build();
+  std::atomic_store( &m_pMatcher, std::shared_ptr<const Matcher>( std::move( pMatcher ) ) );
+}
+
+void NewsScanner::Scan( const Headline& headline ) {
+
+  m_cntScanned.fetch_add( 1, std::memory_order_relaxed );
+  Store( headline );
+
+  std::shared_ptr<const Matcher> pMatcher = std::atomic_load( &m_pMatcher );
+
+  std::vector<uint32_t> vMatch;
+
+  pMatcher->ac.Search( headline.sHeadline, [&vMatch]( uint32_t ixPattern, size_t ){ vMatch.push_back( ixPattern ); } );
+
+  if ( !pMatcher->mapSymbol.empty() ) {
+    const std::string& s( headline.sSymbols );
+    std::string::size_type ixBegin( 0 );
+    while ( ixBegin < s.size() ) {
+      std::string::size_type ixEnd = s.find( ':', ixBegin );
+      if ( std::string::npos == ixEnd ) ixEnd = s.size();
+      if ( ixEnd > ixBegin ) {
+        auto iter = pMatcher->mapSymbol.find( s.substr( ixBegin, ixEnd - ixBegin ) );
+        if ( pMatcher->mapSymbol.end() != iter ) vMatch.push_back( iter->second );
+      }
+      ixBegin = ixEnd + 1;
+    }
+  }
+
+  if ( vMatch.empty() ) return;
+  m_cntMatched.fetch_add( 1, std::memory_order_relaxed );
+
+  std::sort( vMatch.begin(), vMatch.end() );
+  vMatch.erase( std::unique( vMatch.begin(), vMatch.end() ), vMatch.end() );
+
+  std::map<idSubscriber_t, vHit_t> mapHit;
+  for ( const uint32_t ixPattern: vMatch ) {
+    const Matcher::Pattern& pattern( pMatcher->vPattern[ ixPattern ] );
+    for ( const idSubscriber_t id: pattern.vSubscriber ) {
+      mapHit[ id ].push_back( Hit{ pattern.eKind, pattern.sPattern } );
+    }
+  }
+
+  for ( const auto& vt: mapHit ) {
+    auto iter = pMatcher->mapSubscriber.find( vt.first );
+    if ( pMatcher->mapSubscriber.end() != iter ) {
+      ( *iter->second )( headline, vt.second );
+    }
+  }
+}
+
+void NewsScanner::Store( const Headline& headline ) {
+  std::lock_guard<std::mutex> lock( m_mutexHeadline );
+  // usually arrives in order, so usually appended
+  auto iter = std::upper_bound(
+    m_dequeHeadline.begin(), m_dequeHeadline.end(), headline.dt,
+    []( const ptime& dt, const Headline& h ){ return dt < h.dt; } );
+  m_dequeHeadline.insert( iter, headline );
+  while ( m_nMaxHeadlines < m_dequeHeadline.size() ) m_dequeHeadline.pop_front();
+}
+
+void NewsScanner::Headlines( ptime dtBegin, ptime dtEnd, std::vector<Headline>& vHeadline ) const {
+  std::lock_guard<std::mutex> lock( m_mutexHeadline );
+  auto iterBegin = std::lower_bound(
+    m_dequeHeadline.begin(), m_dequeHeadline.end(), dtBegin,
+    []( const Headline& h, const ptime& dt ){ return h.dt < dt; } );
+  auto iterEnd = std::lower_bound(
+    iterBegin, m_dequeHeadline.end(), dtEnd,
+    []( const Headline& h, const ptime& dt ){ return h.dt < dt; } );
+  vHeadline.insert( vHeadline.end(), iterBegin, iterEnd );
+}
+
+size_t NewsScanner::Stored( void ) const {
+  std::lock_guard<std::mutex> lock( m_mutexHeadline );
+  return m_dequeHeadline.size();
+}
+
+} // namespace iqfeed
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,132 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    NewsScanner.h
+ * Author:  raymond@burkholder.net
+ * Project: TFIQFeed
+ * Created: May 24, 2020, 11:05
+ */
+
+// headlines matched against the symbols and keywords watched by subscribers, in one pass per headline
+//   IQFeedProvider::SetNewsScanner feeds it the 'N' messages, anything else may call Scan
+//   symbols: case sensitive, whole word in the headline, or listed in the headline's symbol list
+//   keywords: case insensitive, anywhere in the headline ("downgrade" finds "Downgraded")
+//   Subscribe, Watch, Unwatch and Unsubscribe are staged, Commit builds a new matcher
+//     and swaps it in atomically, a Scan in progress finishes with the matcher it started with
+//   a subscriber's handler is called on the scanning thread (the IQFeed thread), once per headline,
+//     with all of its hits in that headline
+//   headlines are kept by time, to nMaxHeadlines, the oldest dropped
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <OUCommon/AhoCorasick.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace iqfeed { // IQFeed
+
+class NewsScanner {
+public:
+
+  using ptime = boost::posix_time::ptime;
+
+  struct Headline {
+    ptime dt;
+    std::string sDistributor;
+    std::string sStoryId;
+    std::string sSymbols; // as supplied: :AAPL:MSFT:
+    std::string sHeadline;
+  };
+
+  enum class EKind { Symbol, Keyword };
+
+  struct Hit {
+    EKind eKind;
+    std::string sPattern;
+  };
+  using vHit_t = std::vector<Hit>;
+
+  using idSubscriber_t = uint32_t;
+  using fHit_t = std::function<void(const Headline&, const vHit_t&)>;
+
+  explicit NewsScanner( size_t nMaxHeadlines = 100000 );
+  ~NewsScanner();
+
+  idSubscriber_t Subscribe( fHit_t&& );
+  void Unsubscribe( idSubscriber_t );
+  void Watch( idSubscriber_t, EKind, const std::string& sPattern );
+  void Unwatch( idSubscriber_t, EKind, const std::string& sPattern );
+  void Commit( void ); // staged changes take effect
+
+  void Scan( const Headline& ); // stores, matches, dispatches
+
+  // stored headlines with dtBegin <= dt < dtEnd, in time order
+  void Headlines( ptime dtBegin, ptime dtEnd, std::vector<Headline>& ) const;
+
+  size_t Stored( void ) const;
+  uint64_t Scanned( void ) const { return m_cntScanned.load( std::memory_order_relaxed ); }
+  uint64_t Matched( void ) const { return m_cntMatched.load( std::memory_order_relaxed ); } // headlines with a hit
+
+protected:
+private:
+
+  using key_t = std::pair<EKind, std::string>;
+  using setSubscriber_t = std::set<idSubscriber_t>;
+
+  // staged, under m_mutexStage
+  mutable std::mutex m_mutexStage;
+  idSubscriber_t m_idNext;
+  std::map<idSubscriber_t, std::shared_ptr<fHit_t> > m_mapSubscriber;
+  std::map<key_t, setSubscriber_t> m_mapWatch;
+
+  // built by Commit, read only once published
+  struct Matcher {
+    struct Pattern {
+      EKind eKind;
+      std::string sPattern;
+      std::vector<idSubscriber_t> vSubscriber;
+    };
+    std::vector<Pattern> vPattern;
+    ou::AhoCorasick ac; // pattern index in the automaton is the index into vPattern
+    std::unordered_map<std::string, uint32_t> mapSymbol; // for the symbol list
+    std::map<idSubscriber_t, std::shared_ptr<fHit_t> > mapSubscriber;
+  };
+  std::shared_ptr<const Matcher> m_pMatcher; // std::atomic_load / std::atomic_store
+
+  size_t m_nMaxHeadlines;
+  mutable std::mutex m_mutexHeadline;
+  std::deque<Headline> m_dequeHeadline; // by time
+
+  std::atomic<uint64_t> m_cntScanned;
+  std::atomic<uint64_t> m_cntMatched;
+
+  void Store( const Headline& );
+};
+
+} // namespace iqfeed
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,217 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ContractDetailsCache.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFInteractiveBrokers
+ * Created: May 23, 2020, 11:40
+ */
+
+#ifdef _WIN32
+#include "StdAfx.h"
+#else
+#include "linux/StdAfx.h"
+#endif
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+
+#include "ContractDetailsCache.h"
+
+namespace boost {
+namespace serialization {
+
+// the TWS structures are not ours to change, so are archived from outside
+
+template<class Archive>
+void serialize( Archive& ar, ::Contract& contract, const unsigned int version ) {
+  ar & contract.conId;
+  ar & contract.symbol;
+  ar & contract.secType;
+  ar & contract.expiry;
+  ar & contract.strike;
+  ar & contract.right;
+  ar & contract.multiplier;
+  ar & contract.exchange;
+  ar & contract.primaryExchange;
+  ar & contract.currency;
+  ar & contract.localSymbol;
+  ar & contract.tradingClass;
+  ar & contract.includeExpired;
+  ar & contract.secIdType;
+  ar & contract.secId;
+  ar & contract.comboLegsDescrip;
+}
+
+template<class Archive>
+void serialize( Archive& ar, ::ContractDetails& details, const unsigned int version ) {
+  ar & details.summary;
+  ar & details.marketName;
+  ar & details.minTick;
+  ar & details.orderTypes;
+  ar & details.validExchanges;
+  ar & details.priceMagnifier;
+  ar & details.underConId;
+  ar & details.longName;
+  ar & details.contractMonth;
+  ar & details.industry;
+  ar & details.category;
+  ar & details.subcategory;
+  ar & details.timeZoneId;
+  ar & details.tradingHours;
+  ar & details.liquidHours;
+  ar & details.evRule;
+  ar & details.evMultiplier;
+  ar & details.cusip;
+  ar & details.ratings;
+  ar & details.descAppend;
+  ar & details.bondType;
+  ar & details.couponType;
+  ar & details.callable;
+  ar & details.putable;
+  ar & details.coupon;
+  ar & details.convertible;
+  ar & details.maturity;
+  ar & details.issueDate;
+  ar & details.nextOptionDate;
+  ar & details.nextOptionType;
+  ar & details.nextOptionPartial;
+  ar & details.notes;
+}
+
+} // namespace serialization
+} // namespace boost
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+ContractDetailsCache::ContractDetailsCache()
+: m_nDays( 0 )
+{}
+
+ContractDetailsCache::~ContractDetailsCache() {}
+
+std::string ContractDetailsCache::Key( const ::Contract& contract ) {
+  std::stringstream ss;
+  if ( 0 != contract.conId ) {
+    ss << "conId=" << contract.conId << '|' << contract.exchange;
+  }
+  else {
+    ss
+      << contract.symbol << '|'
+      << contract.secType << '|'
+      << contract.expiry << '|'
+      << std::fixed << std::setprecision( 10 ) << contract.strike << '|'  // default precision merges strikes past six digits
+      << contract.right << '|'
+      << contract.multiplier << '|'
+      << contract.exchange << '|'
+      << contract.primaryExchange << '|'
+      << contract.currency << '|'
+      << contract.localSymbol << '|'
+      << contract.tradingClass << '|'
+      << contract.includeExpired << '|'
+      << contract.secIdType << '|'
+      << contract.secId
+      ;
+  }
+  return ss.str();
+}
+
+std::string ContractDetailsCache::Today( void ) {
+  return boost::gregorian::to_iso_string( boost::gregorian::day_clock::local_day() );
+}
+
+void ContractDetailsCache::Load( const std::string& sPath ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_sPath = sPath;
+  m_mapEntry.clear();
+  std::ifstream ifs( sPath, std::ios::binary );
+  if ( ifs ) {
+    try {
+      boost::archive::binary_iarchive ia( ifs );
+      ia >> m_mapEntry;
+    }
+    catch ( const std::exception& e ) {
+      std::cout << "ContractDetailsCache::Load " << sPath << ": " << e.what() << ", starting empty" << std::endl;
+      m_mapEntry.clear();
+    }
+  }
+}
+
+void ContractDetailsCache::Save( void ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( m_sPath.empty() ) return;
+  const std::string sToday( Today() );
+  mapEntry_t::iterator iter = m_mapEntry.begin();
+  while ( m_mapEntry.end() != iter ) {
+    if ( iter->second.sExpires < sToday ) {
+      iter = m_mapEntry.erase( iter );
+    }
+    else ++iter;
+  }
+  std::ofstream ofs( m_sPath, std::ios::binary );
+  if ( ofs ) {
+    boost::archive::binary_oarchive oa( ofs );
+    oa << m_mapEntry;
+  }
+  else {
+    std::cout << "ContractDetailsCache::Save can not write " << m_sPath << std::endl;
+  }
+}
+
+bool ContractDetailsCache::Find( const std::string& sKey, vContractDetails_t& vContractDetails ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  mapEntry_t::const_iterator iter = m_mapEntry.find( sKey );
+  if ( m_mapEntry.end() == iter ) return false;
+  if ( iter->second.sExpires < Today() ) return false;
+  vContractDetails = iter->second.vContractDetails;
+  return true;
+}
+
+void ContractDetailsCache::Add( const std::string& sKey, const vContractDetails_t& vContractDetails ) {
+  if ( vContractDetails.empty() ) return;
+
+  std::string sExpires(
+    boost::gregorian::to_iso_string( boost::gregorian::day_clock::local_day() + boost::gregorian::days( m_nDays ) ) );
+  for ( const ::ContractDetails& details: vContractDetails ) {
+    std::string sExpiry( details.summary.expiry.substr( 0, 8 ) ); // yyyymmdd, or yyyymm for a contract month
+    if ( 6 == sExpiry.size() ) sExpiry += "31";
+    if ( ( 8 == sExpiry.size() ) && ( sExpiry < sExpires ) ) {
+      sExpires = sExpiry;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+  Entry& entry( m_mapEntry[ sKey ] );
+  entry.sExpires = std::move( sExpires );
+  entry.vContractDetails = vContractDetails;
+}
+
+size_t ContractDetailsCache::Size( void ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return m_mapEntry.size();
+}
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,85 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ContractDetailsCache.h
+ * Author:  raymond@burkholder.net
+ * Project: TFInteractiveBrokers
+ * Created: May 23, 2020, 11:40
+ */
+
+// contract details from earlier sessions, so a restart need not ask TWS again
+//   keyed by the requesting contract: the contract id when supplied, otherwise its describing fields
+//   an entry is good through today plus nDays, and never past the expiry of its contracts
+//     trading and liquid hours are given for the coming days, so the default keeps an entry for today only
+//   a binary boost archive, loaded at start, expired entries dropped when saved
+//   combo legs, delta neutral components, and security id lists are not kept
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Shared/Contract.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class ContractDetailsCache {
+public:
+
+  using vContractDetails_t = std::vector<::ContractDetails>;
+
+  ContractDetailsCache();
+  ~ContractDetailsCache();
+
+  static std::string Key( const ::Contract& );
+
+  void SetDays( unsigned int nDays ) { m_nDays = nDays; }
+
+  void Load( const std::string& sPath ); // a missing file starts an empty cache
+  void Save( void );
+
+  bool Find( const std::string& sKey, vContractDetails_t& ) const; // false when absent or expired
+  void Add( const std::string& sKey, const vContractDetails_t& );
+
+  size_t Size( void ) const;
+
+protected:
+private:
+
+  struct Entry {
+    std::string sExpires; // yyyymmdd, last day of use
+    vContractDetails_t vContractDetails;
+    template<typename Archive>
+    void serialize( Archive& ar, const unsigned int version ) {
+      ar & sExpires;
+      ar & vContractDetails;
+    }
+  };
+
+  using mapEntry_t = std::map<std::string, Entry>;
+
+  std::string m_sPath;
+  unsigned int m_nDays;
+
+  mutable std::mutex m_mutex;
+  mapEntry_t m_mapEntry;
+
+  static std::string Today( void );
+};
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,252 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ContractDetailsScheduler.h
+ * Author:  raymond@burkholder.net
+ * Project: TFInteractiveBrokers
+ * Created: May 23, 2020, 10:15
+ */
+
+// contract detail requests to TWS, in arrival order, with a limited number outstanding
+//   requests for the same key, while one is queued or outstanding, share the one request to TWS
+//   the window of outstanding requests adapts:
+//     a completion adds a credit, a window's worth of credits widens the window by one, up to nMax
+//     a pacing violation halves the window, returns the request to the front of the queue,
+//       and holds submissions for a cool down period
+//       TWS reports the violation with id -1, so the request last submitted is the one returned
+//   a request returned to the queue, by pacing or a lost connection, starts its collection over,
+//     on resubmission, details already delivered, by detail id, are collected but not delivered again
+//   the subscribers of a request are shared, not copied, with each detail delivered,
+//     a request coalesced mid stream replaces the list, deliveries under way keep the old one
+//   the submit function wraps EClientSocketBase::reqContractDetails, or is a stand in for testing,
+//     it returns false when there is no connection, the request then waits at the front of the queue
+//   not locked, the owner serializes the calls (IBTWS uses m_mutexContractRequest)
+//   Deferred() is safe to poll without the lock: true when requests wait on a cool down,
+//     the owner then calls Pump() periodically (IBTWS from its message loop)
+
+#pragma once
+
+#include <map>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+template<typename Contract, typename ContractDetails, typename Subscriber>
+class ContractDetailsScheduler {
+public:
+
+  using reqId_t = int;
+  using idDetail_t = long; // identifies a detail within a request, the conId for TWS
+  using vSubscriber_t = std::vector<Subscriber>;
+  using pvSubscriber_t = std::shared_ptr<const vSubscriber_t>;
+  using vContractDetails_t = std::vector<ContractDetails>;
+  using fSubmit_t = std::function<bool(reqId_t, const Contract&)>;
+  using clock_t = std::chrono::steady_clock;
+
+  struct Completed {
+    std::string sKey;
+    pvSubscriber_t pvSubscriber;
+    vContractDetails_t vContractDetails; // when collecting
+  };
+
+  // ids are offset so errors for tickers and orders are not taken for contract requests
+  explicit ContractDetailsScheduler( fSubmit_t&& fSubmit, reqId_t idFirst = 1000000000 )
+  : m_fSubmit( std::move( fSubmit ) ),
+    m_nxtReqId( idFirst ), m_idLastSubmitted( 0 ),
+    m_nWindow( 5 ), m_nWindowMax( 50 ), m_nCredit( 0 ),
+    m_durCoolDown( std::chrono::seconds( 1 ) ),
+    m_bCollect( false ), m_bDeferred( false ),
+    m_cntSubmitted( 0 ), m_cntCoalesced( 0 ), m_cntPaced( 0 )
+  {}
+
+  void SetWindow( size_t nInitial, size_t nMax ) {
+    m_nWindowMax = std::max<size_t>( 1, nMax );
+    m_nWindow = std::min( std::max<size_t>( 1, nInitial ), m_nWindowMax );
+  }
+  void SetCoolDown( clock_t::duration dur ) { m_durCoolDown = dur; }
+  void SetCollect( bool bCollect ) { m_bCollect = bCollect; } // keep the details of each request for Completed
+
+  // returns true when coalesced with a request already queued or outstanding
+  bool Request( const std::string& sKey, const Contract& contract, Subscriber&& subscriber ) {
+    typename mapRequest_t::iterator iter = m_mapRequest.find( sKey );
+    if ( m_mapRequest.end() != iter ) {
+      std::shared_ptr<vSubscriber_t> pvSubscriber( new vSubscriber_t( *iter->second->pvSubscriber ) );
+      pvSubscriber->emplace_back( std::move( subscriber ) );
+      iter->second->pvSubscriber = std::move( pvSubscriber );
+      m_cntCoalesced++;
+      return true;
+    }
+    pRequest_t pRequest( new Request_( sKey, contract ) );
+    std::shared_ptr<vSubscriber_t> pvSubscriber( new vSubscriber_t );
+    pvSubscriber->emplace_back( std::move( subscriber ) );
+    pRequest->pvSubscriber = std::move( pvSubscriber );
+    m_dequeWaiting.push_back( pRequest.get() );
+    m_mapRequest.emplace( sKey, std::move( pRequest ) );
+    Pump();
+    return false;
+  }
+
+  // a detail arrived: the subscribers are shared out for delivery outside the lock,
+  //   pvSubscriber is left empty when the detail was delivered before the request was resubmitted
+  bool Detail( reqId_t id, idDetail_t idDetail, const ContractDetails& details, pvSubscriber_t& pvSubscriber ) {
+    typename mapActive_t::iterator iter = m_mapActive.find( id );
+    if ( m_mapActive.end() == iter ) return false;
+    Request_& request( *iter->second );
+    if ( m_bCollect ) request.vContractDetails.push_back( details );
+    if ( request.setDelivered.insert( idDetail ).second ) pvSubscriber = request.pvSubscriber;
+    else pvSubscriber.reset();
+    return true;
+  }
+
+  // end of details for the request: its slot is released, the window may widen
+  bool Complete( reqId_t id, Completed& completed ) {
+    if ( !Remove( id, completed ) ) return false;
+    m_nCredit++;
+    if ( m_nCredit >= m_nWindow ) {
+      m_nCredit = 0;
+      if ( m_nWindow < m_nWindowMax ) m_nWindow++;
+    }
+    Pump();
+    return true;
+  }
+
+  // request rejected, eg no security definition: the slot is released, the window is unchanged
+  bool Failed( reqId_t id, Completed& completed ) {
+    if ( !Remove( id, completed ) ) return false;
+    Pump();
+    return true;
+  }
+
+  // pacing violation: returns true when an outstanding request is queued again,
+  //   the one with the id, else, as TWS sends -1, the one last submitted
+  bool Paced( reqId_t id ) {
+    m_cntPaced++;
+    m_nWindow = std::max<size_t>( 1, m_nWindow / 2 );
+    m_nCredit = 0;
+    m_tpResume = clock_t::now() + m_durCoolDown;
+    typename mapActive_t::iterator iter = m_mapActive.find( id );
+    if ( m_mapActive.end() == iter ) iter = m_mapActive.find( m_idLastSubmitted );
+    const bool bFound( m_mapActive.end() != iter );
+    if ( bFound ) {
+      iter->second->vContractDetails.clear(); // collected again from the resubmission
+      m_dequeWaiting.push_front( iter->second );
+      m_mapActive.erase( iter );
+    }
+    Pump();
+    return bFound;
+  }
+
+  // connection lost: outstanding requests go back to the front of the queue, in their original order
+  void Requeue( void ) {
+    for ( typename mapActive_t::reverse_iterator iter = m_mapActive.rbegin(); m_mapActive.rend() != iter; ++iter ) {
+      iter->second->vContractDetails.clear(); // collected again from the resubmission
+      m_dequeWaiting.push_front( iter->second );
+    }
+    m_mapActive.clear();
+    m_bDeferred = !m_dequeWaiting.empty();
+  }
+
+  // submits while the window and the cool down allow
+  void Pump( void ) {
+    const bool bCooling( !m_dequeWaiting.empty() && ( clock_t::now() < m_tpResume ) );
+    if ( !bCooling ) {
+      while ( !m_dequeWaiting.empty() && ( m_mapActive.size() < m_nWindow ) ) {
+        Request_* pRequest = m_dequeWaiting.front();
+        if ( !m_fSubmit( m_nxtReqId, pRequest->contract ) ) break;
+        m_dequeWaiting.pop_front();
+        pRequest->id = m_nxtReqId++;
+        m_idLastSubmitted = pRequest->id;
+        m_mapActive.emplace( pRequest->id, pRequest );
+        m_cntSubmitted++;
+      }
+    }
+    m_bDeferred = bCooling;
+  }
+
+  bool Deferred( void ) const { return m_bDeferred.load( std::memory_order_relaxed ); }
+
+  size_t Window( void ) const { return m_nWindow; }
+  size_t Outstanding( void ) const { return m_mapActive.size(); }
+  size_t Waiting( void ) const { return m_dequeWaiting.size(); }
+  size_t Submitted( void ) const { return m_cntSubmitted; }
+  size_t Coalesced( void ) const { return m_cntCoalesced; }
+  size_t PacingViolations( void ) const { return m_cntPaced; }
+  reqId_t LastSubmitted( void ) const { return m_idLastSubmitted; }
+
+protected:
+private:
+
+  struct Request_ {
+    reqId_t id;
+    std::string sKey;
+    Contract contract;
+    pvSubscriber_t pvSubscriber;
+    vContractDetails_t vContractDetails;
+    std::unordered_set<idDetail_t> setDelivered; // survives a resubmission
+    Request_( const std::string& sKey_, const Contract& contract_ )
+    : id( 0 ), sKey( sKey_ ), contract( contract_ ) {}
+  };
+  using pRequest_t = std::unique_ptr<Request_>;
+
+  using mapRequest_t = std::unordered_map<std::string, pRequest_t>; // owns queued and outstanding requests
+  mapRequest_t m_mapRequest;
+  std::deque<Request_*> m_dequeWaiting;
+  using mapActive_t = std::map<reqId_t, Request_*>; // ordered, for Requeue
+  mapActive_t m_mapActive;
+
+  fSubmit_t m_fSubmit;
+  reqId_t m_nxtReqId;
+  reqId_t m_idLastSubmitted; // pacing violations arrive without the id of the request
+
+  size_t m_nWindow;
+  size_t m_nWindowMax;
+  size_t m_nCredit;
+  clock_t::duration m_durCoolDown;
+  clock_t::time_point m_tpResume;
+
+  bool m_bCollect;
+  std::atomic<bool> m_bDeferred;
+
+  size_t m_cntSubmitted;
+  size_t m_cntCoalesced;
+  size_t m_cntPaced;
+
+  bool Remove( reqId_t id, Completed& completed ) {
+    typename mapActive_t::iterator iter = m_mapActive.find( id );
+    if ( m_mapActive.end() == iter ) return false;
+    typename mapRequest_t::iterator iterRequest = m_mapRequest.find( iter->second->sKey );
+    m_mapActive.erase( iter );
+    Request_& request( *iterRequest->second );
+    completed.sKey = std::move( request.sKey );
+    completed.pvSubscriber = std::move( request.pvSubscriber );
+    completed.vContractDetails = std::move( request.vContractDetails );
+    m_mapRequest.erase( iterRequest );
+    return true;
+  }
+
+};
+
+} // namespace tf
+} // namespace ou
@@ -30,6 +30,7 @@
 
 #include <OUCommon/KeyWordMatch.h>
 #include <OUCommon/Debug.h>
+#include <OUCommon/BinaryLog.h>
 
 #include <TFTrading/KeyTypes.h>
 #include <TFTrading/OrderManager.h>
@@ -41,6 +42,10 @@
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+namespace {
+  const ou::BinaryLog::category_t catIB( ou::BinaryLog::Category( "IB" ) );
+}
+
 struct DecodeStatusWord {
   enum enumStatus{ Unknown, PreSubmitted, PendingSubmit, PendingCancel, Submitted, Cancelled, Filled, Inactive };
   DecodeStatusWord( void ): kwm( Unknown, 50 ) {
@@ -66,7 +71,14 @@ IBTWS::IBTWS( const std::string &acctCode, const std::string &address, unsigned
   m_sAccountCode( acctCode ), m_sIPAddress( address ), m_nPort( port ), m_curTickerId( 0 ),
 //  m_dblPortfolioDelta( 0 ),
   m_idClient( 0 ),
-  m_nxtReqId( 0 )
+  m_ContractDetailsScheduler(
+    [this]( reqId_t id, const Contract& contract )->bool { // called with m_mutexContractRequest held
+      if ( !m_bConnected || ( NULL == pTWS ) ) return false;
+      pTWS->reqContractDetails( id, contract );
+      return true;
+    } ),
+  m_bContractDetailsCache( false ),
+  m_bCachedContractDetails( false )
 {
   m_sName = "IB";
   m_nID = keytypes::EProviderIB;
@@ -105,7 +117,19 @@ void IBTWS::ContractExpiryField( Contract& contract, boost::uint16_t nYear, boos
 void IBTWS::Connect() {
   if ( NULL == pTWS ) {
     OnConnecting( 0 );
+    if ( !m_sCapturePath.empty() ) { // before the socket, so a failure to open leaves nothing to clean up
+      try {
+        m_pCapture.reset( new ou::FeedCapture( m_sCapturePath, m_nPort ) );
+      }
+      catch (...) {
+        OnDisconnected( 0 ); // back out of the connecting state
+        throw;
+      }
+    }
     pTWS = new EPosixClientSocket( this );
+    if ( m_pCapture ) {
+      pTWS->setCapture( m_pCapture.get() ); // before the connection handshake
+    }
     bool bReturn = pTWS->eConnect( m_sIPAddress.c_str(), m_nPort, m_idClient );
     if ( bReturn ) {
       m_bConnected = true;
@@ -116,6 +140,10 @@ void IBTWS::Connect() {
       //ExecutionFilter filter;
       //pTWS->reqExecutions( filter );
       pTWS->reqAccountUpdates( true, "" );
+      {
+        boost::mutex::scoped_lock lock( m_mutexContractRequest );
+        m_ContractDetailsScheduler.Pump();  // requests made while disconnected
+      }
       OnConnected( 0 );
     }
     else {
@@ -139,8 +167,14 @@ void IBTWS::DisconnectCommon( bool bSignalEnd ){
       pTWS->eDisconnect();
       m_thrdIBMessages.join();  // wait for message processing to exit
     }
+    {
+      boost::mutex::scoped_lock lock( m_mutexContractRequest );
+      m_ContractDetailsScheduler.Requeue();  // outstanding requests are submitted again on the next connection
+    }
+    if ( m_bContractDetailsCache ) m_ContractDetailsCache.Save();
     delete pTWS;
     pTWS = NULL;
+    m_pCapture.reset();
     OnDisconnected( 0 );
     m_ss.str("");
     m_ss << "IB Disconnected " << std::endl;
@@ -156,6 +190,13 @@ void IBTWS::ProcessMessages( void ) {
   //   but will lose something when receiving market data
   //while ( m_bConnected ) {
     bOK = pTWS->checkMessages();  // code in EClientSocketBaseImpl.h has code change on linux for select()
+    if ( m_bCachedContractDetails.load( std::memory_order_relaxed ) ) {
+      DeliverCachedContractDetails();
+    }
+    if ( m_ContractDetailsScheduler.Deferred() ) {  // a pacing cool down may have run its course
+      boost::mutex::scoped_lock lock( m_mutexContractRequest );
+      m_ContractDetailsScheduler.Pump();
+    }
   }
   m_bConnected = false;  // placeholder for debug
 
@@ -163,6 +204,32 @@ void IBTWS::ProcessMessages( void ) {
   // maybe a state machine would keep track
 }
 
+void IBTWS::CacheContractDetails( const std::string& sPath, unsigned int nDays ) {
+  m_ContractDetailsCache.SetDays( nDays );
+  m_ContractDetailsCache.Load( sPath );
+  boost::mutex::scoped_lock lock( m_mutexContractRequest );
+  m_ContractDetailsScheduler.SetCollect( true );
+  m_bContractDetailsCache = true;
+}
+
+// cache answers go through the same path as those from TWS, on the message thread
+void IBTWS::DeliverCachedContractDetails( void ) {
+  std::vector<CachedContractDetails> vCached;
+  {
+    boost::mutex::scoped_lock lock( m_mutexContractRequest );
+    vCached.swap( m_vCachedContractDetails );
+    m_bCachedContractDetails = false;
+  }
+  for ( CachedContractDetails& cached: vCached ) {
+    for ( const ContractDetails& details: cached.vContractDetails ) {
+      ProcessContractDetails( details, cached.subscriber.pInstrument, cached.subscriber.fOnContractDetail );
+    }
+    if ( nullptr != cached.subscriber.fOnContractDetailDone ) {
+      cached.subscriber.fOnContractDetailDone();
+    }
+  }
+}
+
 // ** associate the instrument with the request structure.  buildinstrumentfrom contract then can fill/check/validate as needed
 
 // deprecated
@@ -277,37 +344,21 @@ void IBTWS::RequestContractDetails(
   const Contract& contract, fOnContractDetail_t fProcess, fOnContractDetailDone_t fDone, pInstrument_t pInstrument ) {
   // 2014/01/28 not complete yet, BuildInstrumentFromContract not converted over
   // pInstrument can be empty, or can have an instrument
-  // results supplied at contractDetails()
-  structRequest_t* pRequest = nullptr;
-  // needs to be thread protected:
-  boost::mutex::scoped_lock lock(m_mutexContractRequest);
-  if ( 0 == m_vInActiveRequestId.size() ) {
-    pRequest = new structRequest_t( m_nxtReqId++, fProcess, fDone, pInstrument );
-  }
-  else {
-    pRequest = m_vInActiveRequestId.back();
-    m_vInActiveRequestId.pop_back();
-    pRequest->id = m_nxtReqId++;
-    pRequest->fOnContractDetail = fProcess;
-    pRequest->fOnContractDetailDone = fDone;
-    pRequest->pInstrument = pInstrument;
-  }
-  m_mapActiveRequestId[ pRequest->id ] = pRequest;
-
-  if ( 5 < m_mapActiveRequestId.size() ) {
-    std::cout
-      << pRequest->id << ": "
-      << "m_mapActiveRequestId size=" << m_mapActiveRequestId.size()
-      << ", " << pInstrument->GetInstrumentName( )
-      << " submission delayed"
-      << std::endl;
-    pRequest->contract = contract;
-    pRequest->bResubmitContract = true;
-  }
-  else {
-    pTWS->reqContractDetails( pRequest->id, contract );
+  // results supplied at contractDetails(), or from the cache at DeliverCachedContractDetails()
+  const std::string sKey( ContractDetailsCache::Key( contract ) );
+  ContractDetailSubscriber subscriber{ std::move( fProcess ), std::move( fDone ), pInstrument };
+  if ( m_bContractDetailsCache ) {
+    ContractDetailsCache::vContractDetails_t vContractDetails;
+    if ( m_ContractDetailsCache.Find( sKey, vContractDetails ) ) {
+      boost::mutex::scoped_lock lock( m_mutexContractRequest );
+      m_vCachedContractDetails.emplace_back( CachedContractDetails{ std::move( vContractDetails ), std::move( subscriber ) } );
+      m_bCachedContractDetails = true;
+      return;
+    }
   }
-
+  // queued, or joined to a request for the same contract already queued or outstanding
+  boost::mutex::scoped_lock lock( m_mutexContractRequest );
+  m_ContractDetailsScheduler.Request( sKey, contract, std::move( subscriber ) );
 }
 
 //IBSymbol *IBTWS::NewCSymbol( const std::string &sSymbolName ) {
@@ -730,9 +781,32 @@ void IBTWS::error(const int id, const int errorCode, const std::string errorStri
       break;
     case 2104:  // datafarm connected ok
       break;
+    case 100:  // max rate of messages per second has been exceeded
+      {
+        boost::mutex::scoped_lock lock( m_mutexContractRequest );
+        const bool bRequeued( m_ContractDetailsScheduler.Paced( id ) );  // id is -1, the last request sent is requeued
+        OU_LOG( ou::BinaryLog::Warn, catIB, "error {}, {}, {}, contract detail window {}, request {} requeued {}",
+          id, errorCode, errorString, m_ContractDetailsScheduler.Window(), m_ContractDetailsScheduler.LastSubmitted(), bRequeued );
+        std::cout
+          << "error " << id << ", " << errorCode << ", " << errorString
+          << ", contract detail window " << m_ContractDetailsScheduler.Window()
+          << ", request " << m_ContractDetailsScheduler.LastSubmitted()
+          << ( bRequeued ? " requeued" : " not requeued" )
+          << std::endl;
+      }
+      break;
     case 200:  // no security definition has been found
+      {
+        ContractDetailsScheduler_t::Completed completed; // subscribers are not called, as before
+        boost::mutex::scoped_lock lock( m_mutexContractRequest );
+        m_ContractDetailsScheduler.Failed( id, completed );  // frees the slot when id is a contract detail request
+      }
       if ( 0 != OnSecurityDefinitionNotFound ) OnSecurityDefinitionNotFound();
       break;
+    case 201:  // order rejected, id is the order id
+      std::cout << "error " << id << ", " << errorCode << ", " << errorString << std::endl;
+      OrderManager::Instance().ReportErrors( id, OrderErrors::Rejected );  // releases its risk usage
+      break;
     default:
 //      m_ss.str("");
 //      m_ss << "error " << id << ", " << errorCode << ", " << errorString << std::endl;
@@ -883,19 +957,27 @@ void IBTWS::contractDetails( int reqId, const ContractDetails& contractDetails )
 
   assert( 0 < contractDetails.summary.conId );
 
-  fOnContractDetail_t handler = nullptr;
-  pInstrument_t pInstrument;
+  ContractDetailsScheduler_t::pvSubscriber_t pvSubscriber;  // more than one when requests were coalesced
   {
-    mapActiveRequestId_t::iterator iterRequest;
-    boost::mutex::scoped_lock lock(m_mutexContractRequest);  // locks map updates
-    iterRequest = m_mapActiveRequestId.find( reqId );  // entry removed with contractDetailsEnd
-    if ( m_mapActiveRequestId.end() == iterRequest ) {
-      throw std::runtime_error( "contractDetails out of sync" );  // this means the requests are in sync, and so could use linked list instead
+    boost::mutex::scoped_lock lock(m_mutexContractRequest);  // locks scheduler updates
+    if ( !m_ContractDetailsScheduler.Detail( reqId, contractDetails.summary.conId, contractDetails, pvSubscriber ) ) {  // entry removed with contractDetailsEnd
+      // a request requeued after a pacing violation may yet answer under its old id
+      OU_LOG( ou::BinaryLog::Warn, catIB, "contractDetails no request for {}", reqId );
+      std::cout << "IBTWS::contractDetails no request for " << reqId << std::endl;
+      return;
     }
-    handler = std::move( iterRequest->second->fOnContractDetail );
-    pInstrument = iterRequest->second->pInstrument;  // might be empty
   }
 
+  if ( !pvSubscriber ) return;  // delivered before the request was resubmitted
+
+  for ( const ContractDetailSubscriber& subscriber: *pvSubscriber ) {
+    ProcessContractDetails( contractDetails, subscriber.pInstrument, subscriber.fOnContractDetail );  // instrument might be empty
+  }
+
+}
+
+void IBTWS::ProcessContractDetails( const ContractDetails& contractDetails, pInstrument_t pInstrument, const fOnContractDetail_t& handler ) {
+
   // need some logic here:
   // * if instrument is supplied, only supplement some existing information
   // * if instrument not supplied, then go through whole building instrument exercise, or will BuildInstrument supply additional information
@@ -1001,49 +1083,22 @@ void IBTWS::contractDetails( int reqId, const ContractDetails& contractDetails )
 
 void IBTWS::contractDetailsEnd( int reqId ) {
   // not called when no symbol available
-  fOnContractDetailDone_t handler = nullptr;
+  ContractDetailsScheduler_t::Completed completed;
   {
     boost::mutex::scoped_lock lock(m_mutexContractRequest);
-    mapActiveRequestId_t::iterator iterRequest = m_mapActiveRequestId.find( reqId );
-    if ( m_mapActiveRequestId.end() == iterRequest ) {
-      throw std::runtime_error( "contractDetailsEnd out of sync" );
+    if ( !m_ContractDetailsScheduler.Complete( reqId, completed ) ) {  // the next queued request is submitted
+      OU_LOG( ou::BinaryLog::Warn, catIB, "contractDetailsEnd no request for {}", reqId );
+      std::cout << "IBTWS::contractDetailsEnd no request for " << reqId << std::endl;
+      return;
     }
-    //reqId_t id = iterRequest->second->id;
-    handler = std::move( iterRequest->second->fOnContractDetailDone );
-
-    iterRequest->second->fOnContractDetail = nullptr;
-    iterRequest->second->fOnContractDetailDone = nullptr;
-    iterRequest->second->pInstrument.reset();
-
-    m_vInActiveRequestId.push_back( iterRequest->second );
-    m_mapActiveRequestId.erase( iterRequest );
-
-    for ( mapActiveRequestId_t::value_type& vt: m_mapActiveRequestId ) {
-      // find first available contract to submit, should be first come first served
-      auto [key, request ] = vt;
-      if ( request->bResubmitContract ) {
-        request->bResubmitContract = false;
-        std::cout
-          << request->id << ": "
-          << "m_mapActiveRequestId size=" << m_mapActiveRequestId.size()
-          << ", " << request->pInstrument->GetInstrumentName( )
-          << " resubmitted"
-          << std::endl;
-        pTWS->reqContractDetails( request->id, request->contract );
-        break;
-      }
-    }
-
-//    while ( 0 != m_mapActiveRequestId.size() ) {
-      // check for expired / ignored requests
-//      iterRequest = m_mapActiveRequestId.begin();
-//      if ( id < iterRequest->second->id ) break;
-//      m_vInActiveRequestId.push_back( iterRequest->second );
-//      m_mapActiveRequestId.erase( iterRequest );
-//    }
   }
-  if ( nullptr != handler )
-    handler();
+  if ( m_bContractDetailsCache ) {
+    m_ContractDetailsCache.Add( completed.sKey, completed.vContractDetails );
+  }
+  for ( const ContractDetailSubscriber& subscriber: *completed.pvSubscriber ) {
+    if ( nullptr != subscriber.fOnContractDetailDone )
+      subscriber.fOnContractDetailDone();
+  }
 }
 
 void IBTWS::bondContractDetails( int reqId, const ContractDetails& contractDetails ) {
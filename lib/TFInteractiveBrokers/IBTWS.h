@@ -17,6 +17,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <memory>
 #include <sstream>
 #include <functional>
 
@@ -34,6 +36,7 @@ using namespace boost::gregorian;
 
 #include <OUCommon/FastDelegate.h>
 #include <OUCommon/Delegate.h>
+#include <OUCommon/FeedCapture.h>
 //#include <OUCommon/MSWindows.h>   // commented out 2015/02/22 not needed in linux, required in msw?
 
 #include <TFTrading/TradingEnumerations.h>
@@ -59,6 +62,9 @@ using namespace boost::gregorian;
 #include "Shared/OrderState.h"
 #include "Shared/Execution.h"
 
+#include "ContractDetailsCache.h"
+#include "ContractDetailsScheduler.h"
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
@@ -86,6 +92,13 @@ public:
 
   void SetClientId( int idClient ) { m_idClient = idClient; }
 
+  // received bytes of the next connection are written to sPath for FeedReplay, empty for no capture
+  void Capture( const std::string& sPath ) { m_sCapturePath = sPath; }
+
+  // contract details are kept in sPath across sessions, answered from there until expired, saved on disconnect
+  //   nDays beyond today, 0 keeps them for the day, as trading hours are dated
+  void CacheContractDetails( const std::string& sPath, unsigned int nDays = 0 );
+
   // From ProviderInterface Execution Section
   void PlaceOrder( pOrder_t order );
   void PlaceOrder( pOrder_t order, long idParent, bool bTransmit );
@@ -299,28 +312,37 @@ private:
 
   boost::thread m_thrdIBMessages;
 
+  std::string m_sCapturePath;
+  std::unique_ptr<ou::FeedCapture> m_pCapture; // for the life of the connection
+
   void ProcessMessages( void );
 
   void DecodeMarketHours( const std::string&, ptime& dtOpen, ptime& dtClose );
 
-  struct structRequest_t {
-    reqId_t id;
-    bool bResubmitContract;
-    pInstrument_t pInstrument;  // add info to existing pInstrument, future use with BuildInstrumentFromContract
+  struct ContractDetailSubscriber {
     fOnContractDetail_t fOnContractDetail;
     fOnContractDetailDone_t fOnContractDetailDone;
-    Contract contract; // used when having to resubmit
-    structRequest_t( reqId_t id_, fOnContractDetail_t fProcess_, fOnContractDetailDone_t fDone_, pInstrument_t pInstrument_ )
-      : id( id_ ), fOnContractDetail( fProcess_ ), fOnContractDetailDone( fDone_ ), pInstrument( pInstrument_ ),
-        bResubmitContract( false )
-      {};
+    pInstrument_t pInstrument;  // add info to existing pInstrument, future use with BuildInstrumentFromContract
+  };
+  using ContractDetailsScheduler_t = ContractDetailsScheduler<Contract, ContractDetails, ContractDetailSubscriber>;
+
+  // requests queue in arrival order, a window of them outstanding at TWS, which shrinks on pacing violations
+  ContractDetailsScheduler_t m_ContractDetailsScheduler;
+  boost::mutex m_mutexContractRequest; // scheduler, and cached answers
+
+  bool m_bContractDetailsCache;
+  ContractDetailsCache m_ContractDetailsCache;
+
+  // answers from the cache, delivered from the message thread as are those from TWS
+  struct CachedContractDetails {
+    ContractDetailsCache::vContractDetails_t vContractDetails;
+    ContractDetailSubscriber subscriber;
   };
+  std::vector<CachedContractDetails> m_vCachedContractDetails;
+  std::atomic<bool> m_bCachedContractDetails;
 
-  reqId_t m_nxtReqId;
-  std::vector<structRequest_t*> m_vInActiveRequestId;  // can this be re-written with lockless structure?
-  typedef std::map<reqId_t, structRequest_t*> mapActiveRequestId_t;
-  mapActiveRequestId_t m_mapActiveRequestId;
-  boost::mutex m_mutexContractRequest;
+  void DeliverCachedContractDetails( void );
+  void ProcessContractDetails( const ContractDetails&, pInstrument_t, const fOnContractDetail_t& );
 
   void DisconnectCommon( bool bSignalEnd );
 
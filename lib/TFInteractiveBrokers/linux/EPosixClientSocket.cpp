@@ -12,9 +12,11 @@
 #include <string.h>
 #include <assert.h>
 
+#include <OUCommon/FeedCapture.h>
+
 ///////////////////////////////////////////////////////////
 // member funcs
-EPosixClientSocket::EPosixClientSocket( EWrapper *ptr) : EClientSocketBase( ptr)
+EPosixClientSocket::EPosixClientSocket( EWrapper *ptr) : EClientSocketBase( ptr), m_pCapture( 0)
 {
 	m_fd = SocketsInit() ? -1 : -2;
 }
@@ -228,6 +230,9 @@ int EPosixClientSocket::receive(char* buf, size_t sz)
 	if( nResult <= 0) {
 		return 0;
 	}
+	if( m_pCapture) {
+		m_pCapture->Write( buf, nResult);
+	}
 	return nResult;
 }
 
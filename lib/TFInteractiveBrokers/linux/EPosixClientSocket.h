@@ -7,6 +7,8 @@
 
 class EWrapper;
 
+namespace ou { class FeedCapture; } // 2020/05/22 capture of received bytes for replay
+
 class TWSAPIDLLEXP EPosixClientSocket : public EClientSocketBase
 {
 public:
@@ -22,6 +24,8 @@ public:
 	int fd() const;
         bool isReadBytesReady() const;
 
+	void setCapture( ou::FeedCapture* pCapture ) { m_pCapture = pCapture; } // 2020/05/22 before eConnect, owned by caller
+
 private:
 
 	bool eConnectImpl(int clientId, bool extraAuth, ConnState* stateOutPt);
@@ -49,4 +53,5 @@ public:
 private:
 
 	int m_fd;
+	ou::FeedCapture* m_pCapture;
 };
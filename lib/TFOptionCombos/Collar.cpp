@@ -284,11 +284,8 @@ double Collar::GetNet( double price ) {
   double dblConstructedValue {};
 
   for ( Leg& leg: m_vLeg ) {
-    dblNet += leg.GetNet( price ); // out: leg stats
-    double dblLegConstructedValue = leg.ConstructedValue();
-    std::cout << ",constructed@" << dblLegConstructedValue;
-    dblConstructedValue += dblLegConstructedValue;
-    std::cout << std::endl;
+    dblNet += leg.GetNet( price ); // logs leg stats
+    dblConstructedValue += leg.ConstructedValue();
   }
 
   double profitTotal {};
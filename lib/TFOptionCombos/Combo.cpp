@@ -19,12 +19,18 @@
  * Created on June 7, 2019, 5:08 PM
  */
 
+#include <OUCommon/BinaryLog.h>
+
 #include "Combo.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 namespace option { // options
 
+namespace {
+  const ou::BinaryLog::category_t catCombo( ou::BinaryLog::Category( "Combo" ) );
+}
+
 const double Combo::m_dblMaxStrikeDelta( 0.51 );       // not 0.50 to prevent rounding problems.
 const double Combo::m_dblMaxStrangleDelta( 1.01 );     // not 1.00 to prevent rounding problems
 
@@ -129,16 +135,23 @@ double Combo::GetNet( double price ) {
   double dblNet {};
   double dblConstructedValue {};
   for ( Leg& leg: m_vLeg ) {
-    dblNet += leg.GetNet( price );
-    double dblLegConstructedValue = leg.ConstructedValue();
-    std::cout << ",constructed@" << dblLegConstructedValue;
-    dblConstructedValue += dblLegConstructedValue;
-    std::cout << std::endl;
+    dblNet += leg.GetNet( price ); // logs leg stats
+    dblConstructedValue += leg.ConstructedValue();
   }
-  std::cout << "  combo constructed: " << dblConstructedValue << std::endl;
+  OU_LOG( ou::BinaryLog::Debug, catCombo, "combo constructed: {}", dblConstructedValue );
   return dblNet;
 }
 
+void Combo::Snapshot( ptime dtUtcNow, ou::tf::option::ScenarioRisk::vLeg_t& vLeg ) {
+  vLeg.clear();
+  for ( Leg& leg: m_vLeg ) {
+    ou::tf::option::ScenarioRisk::Leg snapshot;
+    if ( leg.Snapshot( dtUtcNow, snapshot ) ) {
+      vLeg.push_back( snapshot );
+    }
+  }
+}
+
 bool Combo::CloseItmLeg( double price ) {
   bool bClosed( false );
   for ( Leg& leg: m_vLeg ) {
@@ -110,6 +110,9 @@ public:
 
   virtual double GetNet( double price );
 
+  // the active legs, for ScenarioRisk, the caller fills in the underlying, its price and the rate
+  void Snapshot( ptime dtUtcNow, ou::tf::option::ScenarioRisk::vLeg_t& );
+
   void CloseForProfits( double price );
   void TakeProfits( double price );
   void CloseExpiryItm( double price, const boost::gregorian::date date );
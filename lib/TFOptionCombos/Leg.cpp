@@ -19,11 +19,17 @@
  * Created on May 25, 2019, 4:46 PM
  */
 
+#include <OUCommon/BinaryLog.h>
+
 #include "Leg.h"
 
 namespace ou {
 namespace tf {
 
+namespace {
+  const ou::BinaryLog::category_t catCombo( ou::BinaryLog::Category( "Combo" ) );
+}
+
 Leg::Leg()
 : m_bOption( false )
 {
@@ -283,42 +289,38 @@ double Leg::GetNet( double price ) {
   double dblValue {};
   if ( m_pPosition ) {
     dblValue = m_pPosition->GetUnRealizedPL();
-    std::cout
-      << "  leg: "
-      << m_pPosition->GetInstrument()->GetInstrumentName()
-      << "=>"
-      << m_pPosition->GetActiveSize()
-      << "@"
-      << dblValue;
-    if ( m_bOption ) {
-      pOption_t pOption = boost::dynamic_pointer_cast<ou::tf::option::Option>( m_pPosition->GetWatch() );
-      switch ( pOption->GetInstrument()->GetOptionSide() ) {
-        case ou::tf::OptionSide::Call:
-          if ( price > m_pPosition->GetInstrument()->GetStrike() ) {
-            std::cout << "(ITM)";
-          }
-          if ( price < m_pPosition->GetInstrument()->GetStrike() ) {
-            std::cout << "(otm)";
-          }
-          break;
-        case ou::tf::OptionSide::Put:
-          if ( price < m_pPosition->GetInstrument()->GetStrike() ) {
-            std::cout << "(ITM)";
-          }
-          if ( price > m_pPosition->GetInstrument()->GetStrike() ) {
-            std::cout << "(otm)";
-          }
-          break;
+    if ( ou::BinaryLog::Enabled( ou::BinaryLog::Debug, catCombo ) ) {
+      const char* szMoneyness = "";
+      if ( m_bOption ) {
+        pOption_t pOption = boost::dynamic_pointer_cast<ou::tf::option::Option>( m_pPosition->GetWatch() );
+        switch ( pOption->GetInstrument()->GetOptionSide() ) {
+          case ou::tf::OptionSide::Call:
+            if ( price > m_pPosition->GetInstrument()->GetStrike() ) {
+              szMoneyness = "(ITM)";
+            }
+            if ( price < m_pPosition->GetInstrument()->GetStrike() ) {
+              szMoneyness = "(otm)";
+            }
+            break;
+          case ou::tf::OptionSide::Put:
+            if ( price < m_pPosition->GetInstrument()->GetStrike() ) {
+              szMoneyness = "(ITM)";
+            }
+            if ( price > m_pPosition->GetInstrument()->GetStrike() ) {
+              szMoneyness = "(otm)";
+            }
+            break;
+        }
       }
-    }
-//    if ( 0.0 == dblValue ) {
       const ou::tf::Quote& quote( m_pPosition->GetWatch()->LastQuote() );
-      std::cout
-        << ",b" << quote.Bid()
-        << ",a" << quote.Ask()
-        ;
-//    }
-//    std::cout << std::endl;
+      OU_LOG( ou::BinaryLog::Debug, catCombo, "leg: {}=>{}@{}{},b{},a{},constructed@{}",
+        m_pPosition->GetInstrument()->GetInstrumentName(),
+        m_pPosition->GetActiveSize(),
+        dblValue, szMoneyness,
+        quote.Bid(), quote.Ask(),
+        ConstructedValue()
+        );
+    }
   }
   return dblValue;
 }
@@ -339,6 +341,36 @@ double Leg::ConstructedValue() const {
   return value;
 }
 
+bool Leg::Snapshot( ptime dtUtcNow, ou::tf::option::ScenarioRisk::Leg& leg ) {
+  if ( !m_pPosition ) return false;
+  const ou::tf::Position::TableRowDef& row( m_pPosition->GetRow() );
+  double dblQuantity {};
+  switch ( row.eOrderSideActive ) { // signed as PositionGreek::AddGreeks
+    case ou::tf::OrderSide::Buy:
+      dblQuantity = row.nPositionActive;
+      break;
+    case ou::tf::OrderSide::Sell:
+      dblQuantity = -(double)row.nPositionActive;
+      break;
+    default:
+      return false;
+  }
+  if ( 0 == row.nPositionActive ) return false;
+  ou::tf::Instrument::pInstrument_t pInstrument( m_pPosition->GetInstrument() );
+  leg = ou::tf::option::ScenarioRisk::Leg();
+  leg.dblQuantity = dblQuantity * pInstrument->GetMultiplier();
+  if ( m_bOption ) {
+    pOption_t pOption = boost::dynamic_pointer_cast<ou::tf::option::Option>( m_pPosition->GetWatch() );
+    const double dblVolatility( pOption->ImpliedVolatility() );
+    if ( 0.0 >= dblVolatility ) return false;
+    leg.side = pInstrument->GetOptionSide();
+    leg.dblStrike = pOption->GetStrike();
+    leg.dblYears = (double) ( pOption->GetExpiryUtc() - dtUtcNow ).total_seconds() / ( 365.0 * 24.0 * 60.0 * 60.0 );
+    leg.dblVolatility = dblVolatility;
+  }
+  return true;
+}
+
 void Leg::Init() {
 }
 
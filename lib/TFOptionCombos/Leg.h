@@ -29,6 +29,7 @@
 #include <TFTrading/MonitorOrder.h>
 
 #include <TFOptions/Option.h>
+#include <TFOptions/ScenarioRisk.h>
 
 namespace ou {
 namespace tf {
@@ -72,6 +73,9 @@ public:
   double GetNet( double price );
   double ConstructedValue() const;
 
+  // false without an active quantity, or for an option without an implied volatility yet
+  bool Snapshot( ptime dtUtcNow, ou::tf::option::ScenarioRisk::Leg& );
+
 private:
   bool m_bOption;  // only set upon assignment of appropriate position
   pPosition_t m_pPosition;
@@ -21,6 +21,8 @@
 
 #include <array>
 
+#include <OUCommon/BinaryLog.h>
+
 #include "LegDef.h"
 #include "Strangle.h"
 
@@ -31,6 +33,7 @@ namespace option { // options
 namespace {
 
   static const size_t nLegs( 2 );
+  const ou::BinaryLog::category_t catCombo( ou::BinaryLog::Category( "Combo" ) );
   static const boost::gregorian::days nDaysToExpiry( 1 );
 
   using LegDef = ou::tf::option::LegDef;
@@ -239,11 +242,8 @@ double Strangle::GetNet( double price ) {
   double strikeLower {};
   //double multiplier {};
   for ( Leg& leg: m_vLeg ) {
-    dblNet += leg.GetNet( price ); // out: leg stats
-    double dblLegConstructedValue = leg.ConstructedValue();
-    std::cout << ",constructed@" << dblLegConstructedValue;
-    dblConstructedValue += dblLegConstructedValue;
-    std::cout << std::endl;
+    dblNet += leg.GetNet( price ); // logs leg stats
+    dblConstructedValue += leg.ConstructedValue();
     double strike = leg.GetPosition()->GetInstrument()->GetStrike();
     //multiplier = leg.GetPosition()->GetInstrument()->GetRow().nMultiplier;
     if ( 0.0 == strikeUpper ) {
@@ -253,7 +253,7 @@ double Strangle::GetNet( double price ) {
       if ( strike > strikeUpper ) strikeUpper = strike;
       else {
         if ( strike < strikeLower ) strikeLower = strike;
-        else std::cout << "don't know what happened" << std::endl;
+        else OU_LOG( ou::BinaryLog::Warn, catCombo, "strangle strike {} between {} and {}", strike, strikeLower, strikeUpper );
       }
     }
   }
@@ -265,7 +265,7 @@ double Strangle::GetNet( double price ) {
   double profit = adjustment;
   double profitTotal {};
 
-  std::string status;
+  const char* status;
   if ( ( price > strikeLower ) && ( price < strikeUpper ) ) {
     status = "expires";
   }
@@ -284,13 +284,8 @@ double Strangle::GetNet( double price ) {
 
   profitTotal += profit;
 
-  std::cout
-    << "  constructed: " << adjustment
-    << ",lowerBE: " << lower
-    << ",upperBE: " << upper
-    << "=>" << status
-    << "@" << profit
-    << std::endl;
+  OU_LOG( ou::BinaryLog::Debug, catCombo, "constructed: {},lowerBE: {},upperBE: {}=>{}@{}",
+    adjustment, lower, upper, status, profit );
   return profitTotal;
 }
 
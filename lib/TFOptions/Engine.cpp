@@ -158,6 +158,7 @@ void OptionEntry::Calc( const fCalc_t& fCalc ) {
 
 Engine::Engine( const ou::tf::LiborFromIQFeed& feed ): 
   m_InterestRateFeed( feed ), 
+  m_curve( feed ),
   m_srvcWork(boost::asio::make_work_guard( m_srvc )),
   m_timerScan( m_srvc )
 {
@@ -395,7 +396,6 @@ void Engine::ProcessOptionEntryOperationQueue() {
   }
 }
 
-// TODO: sort map by expiry?  // then Option::CalcRate is required less often
 void Engine::ScanOptionEntryQueue() {
 
   ProcessOptionEntryOperationQueue();
@@ -413,21 +413,25 @@ void Engine::ScanOptionEntryQueue() {
                 [this, dtUtcNow](mapOptionEntry_t::value_type& vt){
                   //std::cout << "for each " << vt.second.GetUnderlying()->GetInstrument()->GetInstrumentName() << std::endl;
                   //std::cout << "         " << vt.second.GetOption()->GetInstrument()->GetInstrumentName() << std::endl;
+                  const double dblVolatility( m_fVolatilityEstimate ? m_fVolatilityEstimate( vt.second.UnderlyingName() ) : 0.0 );
                   vt.second.Calc( 
-                    [this, dtUtcNow](OptionEntry::pOption_t pOption, const ou::tf::Quote& quoteUnderlying, fCallbackWithGreek_t& fCallbackWithGreek ){
+                    [this, dtUtcNow, dblVolatility](OptionEntry::pOption_t pOption, const ou::tf::Quote& quoteUnderlying, fCallbackWithGreek_t& fCallbackWithGreek ){
                       double midpointUnderlying( quoteUnderlying.Midpoint() );
                       if ( 0.0 < midpointUnderlying ) {  // only start calculations once underlying has quotes
                         // TODO: add flag to start calculation only after previous calculation is complete
                         boost::asio::post( m_srvc, 
-                          [this, dtUtcNow, pOption, midpointUnderlying, fCallbackWithGreek](){
+                          [this, dtUtcNow, pOption, midpointUnderlying, dblVolatility, fCallbackWithGreek](){
                             try {
                               //boost::timer::auto_cpu_timer t;
                               ou::tf::option::binomial::structInput input;
                               input.S = midpointUnderlying;
-                              pOption->CalcRate( input, dtUtcNow, m_InterestRateFeed );
-                              pOption->CalcGreeks( input, dtUtcNow, true );
-                              if ( nullptr != fCallbackWithGreek ) {
-                                fCallbackWithGreek( pOption->LastGreek() ); // need to create the method
+                              if ( pOption->CalcRate( input, dtUtcNow, m_curve ) ) { // skips the expired
+                                const bool bNeedsGuess( 0.0 >= dblVolatility );
+                                if ( !bNeedsGuess ) input.v = dblVolatility;
+                                pOption->CalcGreeks( input, dtUtcNow, bNeedsGuess );
+                                if ( nullptr != fCallbackWithGreek ) {
+                                  fCallbackWithGreek( pOption->LastGreek() ); // need to create the method
+                                }
                               }
                             }
                             catch ( std::runtime_error& e ) {
@@ -121,6 +121,9 @@ public:
   using fBuildWatch_t = std::function<pWatch_t(pInstrument_t)>;  // constructed elsewhere as it needs provider
   using fBuildOption_t = std::function<pOption_t(pInstrument_t)>;  // constructed elsewhere as it needs provider
 
+  // annualized volatility of an underlying, by name, 0.0 when none (eg statistics::VolatilityEngine::Volatility)
+  using fVolatilityEstimate_t = std::function<double(const std::string&)>;
+
   explicit Engine( const ou::tf::LiborFromIQFeed& );
   virtual ~Engine( );
 
@@ -141,6 +144,10 @@ public:
   fBuildWatch_t m_fBuildWatch;
   fBuildOption_t m_fBuildOption;
 
+  // the implied volatility solver starts from the estimate rather than the Manaster and Koehler guess,
+  //   called on the scan timer, set before options are added
+  void SetVolatilityEstimate( fVolatilityEstimate_t&& f ) { m_fVolatilityEstimate = std::move( f ); }
+
 private:
 
   enum Action { Unknown, AddOption, RemoveOption };
@@ -162,6 +169,9 @@ private:
 //  OptionEntry::fCalc_t m_fCalc;
 
   const LiborFromIQFeed& m_InterestRateFeed;
+  RateCurve m_curve; // T and r by expiry, shared by the options of an expiry
+
+  fVolatilityEstimate_t m_fVolatilityEstimate;
 
   struct OptionEntryOperation {
     Action m_action;
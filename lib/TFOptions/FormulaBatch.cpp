@@ -0,0 +1,244 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FormulaBatch.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 2, 2020, 14:10
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "FormulaBatch.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace bsm { // black scholes merton, batch
+
+namespace {
+  const double c_dblVolMin = 0.0001;
+  const double c_dblVolMax = 5.0;
+  const double c_dblSeedMin = 0.05;
+  const double c_dblSeedMax = 3.0;
+  const double c_dblVegaMin = 1e-12;
+}
+
+void structChainInput::Check( void ) const {
+  assert( 0.0 != S );
+  assert( 0.0 < T );
+  assert( vX.size() == vPrice.size() );
+  assert( vX.size() == vSide.size() );
+}
+
+void structChainOutput::Resize( size_t n ) {
+  vOption.resize( n );
+  vIV.resize( n );
+  vDelta.resize( n );
+  vGamma.resize( n );
+  vTheta.resize( n );
+  vVega.resize( n );
+  vRho.resize( n );
+  vConverged.resize( n );
+}
+
+namespace {
+
+// common terms for a chain, calculated once per call
+struct Terms {
+  double S;
+  double T;
+  double r;
+  double b;
+  double SqrtT;
+  double EToCarryLessRate; // exp( ( b - r ) * T )
+  double EToRate; // exp( -r * T )
+  explicit Terms( const structChainInput& input )
+  : S( input.S ), T( input.T ), r( input.r ), b( input.b ),
+    SqrtT( std::sqrt( input.T ) ),
+    EToCarryLessRate( std::exp( ( input.b - input.r ) * input.T ) ),
+    EToRate( std::exp( -input.r * input.T ) )
+  {}
+};
+
+inline double Side( ou::tf::OptionSide::enumOptionSide side ) {
+  return ( ou::tf::OptionSide::Put == side ) ? -1.0 : 1.0;
+}
+
+// price and vega only, used by the newton-raphson passes
+inline void PriceVega( const Terms& t, double z, double X, double vol, double& price, double& vega ) {
+  const double VolSqrtT = vol * t.SqrtT;
+  const double d1 = ( std::log( t.S / X ) + ( t.b + 0.5 * vol * vol ) * t.T ) / VolSqrtT;
+  const double d2 = d1 - VolSqrtT;
+  const double SE = t.S * t.EToCarryLessRate;
+  price = z * ( SE * NormalCDF( z * d1 ) - X * t.EToRate * NormalCDF( z * d2 ) );
+  vega = SE * NormalPDF( d1 ) * t.SqrtT;
+}
+
+// initial volatility guess, clamped to keep newton away from the flat vega regions
+inline double Seed( const Terms& t, double X ) {
+  // Manaster and Koehler, pg 454 Option Pricing Formulas
+  const double seed = std::sqrt( std::fabs( std::log( t.S / X ) + t.b * t.T ) * 2.0 / t.T );
+  return std::min( std::max( seed, c_dblSeedMin ), c_dblSeedMax );
+}
+
+} // namespace anonymous
+
+void CalcGreeks( const structChainInput& input, structChainOutput& output ) {
+
+  input.Check();
+
+  const size_t n( input.Size() );
+  output.Resize( n );
+
+  const Terms t( input );
+  const bool bFutures( 0.0 == t.b ); // Black (1976) rho, pg 7 Option Pricing Formulas
+
+  const double* pX = input.vX.data();
+  const ou::tf::OptionSide::enumOptionSide* pSide = input.vSide.data();
+  const double* pIV = output.vIV.data();
+  double* pOption = output.vOption.data();
+  double* pDelta = output.vDelta.data();
+  double* pGamma = output.vGamma.data();
+  double* pTheta = output.vTheta.data();
+  double* pVega = output.vVega.data();
+  double* pRho = output.vRho.data();
+
+  for ( size_t ix = 0; ix < n; ++ix ) {
+    const double z = Side( pSide[ ix ] );
+    const double X = pX[ ix ];
+    const double vol = pIV[ ix ];
+    const double VolSqrtT = vol * t.SqrtT;
+    const double d1 = ( std::log( t.S / X ) + ( t.b + 0.5 * vol * vol ) * t.T ) / VolSqrtT;
+    const double d2 = d1 - VolSqrtT;
+    const double Nd1 = NormalCDF( z * d1 );
+    const double Nd2 = NormalCDF( z * d2 );
+    const double npd1 = NormalPDF( d1 );
+    const double SE = t.S * t.EToCarryLessRate;
+    const double XE = X * t.EToRate;
+    const double option = z * ( SE * Nd1 - XE * Nd2 );
+    pOption[ ix ] = option;
+    pDelta[ ix ] = z * t.EToCarryLessRate * Nd1;
+    pGamma[ ix ] = npd1 * t.EToCarryLessRate / ( t.S * VolSqrtT );
+    pTheta[ ix ] = ( -SE * npd1 * vol / ( 2.0 * t.SqrtT ) - z * ( t.b - t.r ) * SE * Nd1 - z * t.r * XE * Nd2 ) / 365.0;
+    pVega[ ix ] = SE * npd1 * t.SqrtT * 0.01;
+    pRho[ ix ] = bFutures ? ( -t.T * option ) : ( z * t.T * XE * Nd2 );
+  }
+}
+
+size_t CalcImpliedVolatility( const structChainInput& input, structChainOutput& output, double epsilon, size_t nMaxIterations ) {
+
+  input.Check();
+
+  const size_t n( input.Size() );
+  output.Resize( n );
+
+  const Terms t( input );
+
+  const double* pX = input.vX.data();
+  const double* pPrice = input.vPrice.data();
+  const ou::tf::OptionSide::enumOptionSide* pSide = input.vSide.data();
+  double* pIV = output.vIV.data();
+  char* pConverged = output.vConverged.data();
+
+  if ( 0.0 < input.v ) {
+    const double seed( std::min( std::max( input.v, c_dblSeedMin ), c_dblSeedMax ) );
+    for ( size_t ix = 0; ix < n; ++ix ) {
+      pIV[ ix ] = seed;
+    }
+  }
+  else {
+    for ( size_t ix = 0; ix < n; ++ix ) {
+      pIV[ ix ] = Seed( t, pX[ ix ] );
+    }
+  }
+
+  // every pass touches every entry, converged entries take a zero step,
+  //   keeps the loop free of branches and gathers
+  for ( size_t iteration = 0; iteration < nMaxIterations; ++iteration ) {
+    size_t nActive( 0 );
+    for ( size_t ix = 0; ix < n; ++ix ) {
+      double price, vega;
+      const double vol = pIV[ ix ];
+      PriceVega( t, Side( pSide[ ix ] ), pX[ ix ], vol, price, vega );
+      const double diff = price - pPrice[ ix ];
+      const bool bActive = ( epsilon < std::fabs( diff ) ) && ( c_dblVegaMin < vega );
+      const double step = bActive ? ( diff / vega ) : 0.0;
+      pIV[ ix ] = std::min( std::max( vol - step, c_dblVolMin ), c_dblVolMax );
+      nActive += bActive ? 1 : 0;
+    }
+    if ( 0 == nActive ) break;
+  }
+
+  CalcGreeks( input, output );
+
+  size_t nConverged( 0 );
+  const double* pOption = output.vOption.data();
+  for ( size_t ix = 0; ix < n; ++ix ) {
+    const bool bConverged = std::fabs( pOption[ ix ] - pPrice[ ix ] ) <= epsilon;
+    pConverged[ ix ] = bConverged ? 1 : 0;
+    nConverged += bConverged ? 1 : 0;
+  }
+
+  return nConverged;
+}
+
+void structPointInput::Check( void ) const {
+  const size_t n( vX.size() );
+  assert( n == vS.size() );
+  assert( n == vT.size() );
+  assert( n == vR.size() );
+  assert( n == vB.size() );
+  assert( n == vV.size() );
+  assert( n == vSide.size() );
+}
+
+void CalcValues( const structPointInput& input, std::vector<double>& vOption ) {
+
+  input.Check();
+
+  const size_t n( input.Size() );
+  vOption.resize( n );
+
+  const double* pS = input.vS.data();
+  const double* pX = input.vX.data();
+  const double* pT = input.vT.data();
+  const double* pR = input.vR.data();
+  const double* pB = input.vB.data();
+  const double* pV = input.vV.data();
+  const ou::tf::OptionSide::enumOptionSide* pSide = input.vSide.data();
+  double* pOption = vOption.data();
+
+  for ( size_t ix = 0; ix < n; ++ix ) {
+    const double z = Side( pSide[ ix ] );
+    const double S = pS[ ix ];
+    const double X = pX[ ix ];
+    const double T = std::max( pT[ ix ], 1e-8 ); // the expired are replaced below, this keeps the loop free of nan
+    const double vol = std::max( pV[ ix ], c_dblVolMin );
+    const double VolSqrtT = vol * std::sqrt( T );
+    const double d1 = ( std::log( S / X ) + ( pB[ ix ] + 0.5 * vol * vol ) * T ) / VolSqrtT;
+    const double d2 = d1 - VolSqrtT;
+    const double SE = S * std::exp( ( pB[ ix ] - pR[ ix ] ) * T );
+    const double XE = X * std::exp( -pR[ ix ] * T );
+    const double option = z * ( SE * NormalCDF( z * d1 ) - XE * NormalCDF( z * d2 ) );
+    const double intrinsic = std::max( z * ( S - X ), 0.0 );
+    pOption[ ix ] = ( 0.0 < pT[ ix ] ) ? option : intrinsic;
+  }
+}
+
+} // namespace bsm
+} // namespace option
+} // namespace tf
+} // namespace ou
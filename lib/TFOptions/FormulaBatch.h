@@ -0,0 +1,132 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FormulaBatch.h
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 2, 2020, 14:10
+ */
+
+// Generalized Black Scholes Merton, closed form, evaluated across a whole expiry at once
+// pg 2-7, 20 Option Pricing Formulas, 2e (cost of carry b selects the model):
+//   b = r:     Black Scholes (1973) stock option
+//   b = r - q: Merton (1973) stock option with continuous dividend yield q
+//   b = 0:     Black (1976) futures option, S is the futures price
+
+// Inputs and outputs are structure-of-arrays so the inner loops are branch free
+//   and can be vectorized by the compiler (build with -O3, -march as appropriate)
+// Greek scaling matches binomial::CalcImpliedVolatility: theta per day, vega per 1% vol
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <TFTrading/TradingEnumerations.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+namespace bsm { // black scholes merton, batch
+
+struct structChainInput {
+  double S; // price of underlying
+  double T; // time to expiry, fraction of year
+  double r; // risk free interest rate
+  double b; // cost of carry
+  double v; // starting volatility for CalcImpliedVolatility (eg a realized estimate), 0.0 for Manaster and Koehler
+  std::vector<double> vX;  // strike price
+  std::vector<double> vPrice; // option market price (typically the mid)
+  std::vector<ou::tf::OptionSide::enumOptionSide> vSide;
+  structChainInput( void ): S( 0.0 ), T( 0.0 ), r( 0.0 ), b( 0.0 ), v( 0.0 ) {}
+  void Reserve( size_t n ) {
+    vX.reserve( n ); vPrice.reserve( n ); vSide.reserve( n );
+  }
+  void Clear( void ) {
+    vX.clear(); vPrice.clear(); vSide.clear();
+  }
+  void Append( double X, double price, ou::tf::OptionSide::enumOptionSide side ) {
+    vX.push_back( X ); vPrice.push_back( price ); vSide.push_back( side );
+  }
+  size_t Size( void ) const { return vX.size(); }
+  void Check( void ) const;
+};
+
+struct structChainOutput {
+  std::vector<double> vOption; // theoretical value at vIV
+  std::vector<double> vIV;
+  std::vector<double> vDelta;
+  std::vector<double> vGamma;
+  std::vector<double> vTheta;
+  std::vector<double> vVega;
+  std::vector<double> vRho;
+  std::vector<char> vConverged; // 1 when implied volatility met epsilon
+  void Resize( size_t n );
+  size_t Size( void ) const { return vIV.size(); }
+};
+
+// price and greeks with vIV already set in output (eg, supplied from a surface or historical)
+void CalcGreeks( const structChainInput& input, structChainOutput& output );
+
+// implied volatility from vPrice, then price and greeks at the implied volatility
+// vectorized newton-raphson with Manaster and Koehler seeds, pg 453 Option Pricing Formulas, or from input.v
+// entries not converging within nMaxIterations have vConverged[ix] = 0
+//   (price outside of no-arbitrage bounds, no time value, ...)
+// returns number converged
+size_t CalcImpliedVolatility( const structChainInput& input, structChainOutput& output, double epsilon = 0.0001, size_t nMaxIterations = 20 );
+
+// value only, each entry with its own S, T, r, b and volatility, as for a grid of scenarios:
+//   many points on few contracts, rather than one point on a chain
+//   T <= 0 gives the intrinsic value, volatility is floored as for the solver
+struct structPointInput {
+  std::vector<double> vS; // price of underlying
+  std::vector<double> vX; // strike price
+  std::vector<double> vT; // time to expiry, fraction of year
+  std::vector<double> vR; // risk free interest rate
+  std::vector<double> vB; // cost of carry
+  std::vector<double> vV; // volatility
+  std::vector<ou::tf::OptionSide::enumOptionSide> vSide;
+  void Resize( size_t n ) {
+    vS.resize( n ); vX.resize( n ); vT.resize( n ); vR.resize( n ); vB.resize( n ); vV.resize( n ); vSide.resize( n );
+  }
+  size_t Size( void ) const { return vX.size(); }
+  void Check( void ) const;
+};
+
+void CalcValues( const structPointInput& input, std::vector<double>& vOption );
+
+// standard normal density and cumulative distribution, branch free, for use in the vectorized loops
+inline double NormalPDF( double x ) {
+  static const double b = 0.398942280401432678; // 1 / sqrt( 2 pi )
+  return b * std::exp( -0.5 * x * x );
+}
+
+// absolute error < 7.5e-8, pg 932 Abramowitz and Stegun 26.2.17
+inline double NormalCDF( double x ) {
+  static const double p  =  0.2316419;
+  static const double b1 =  0.319381530;
+  static const double b2 = -0.356563782;
+  static const double b3 =  1.781477937;
+  static const double b4 = -1.821255978;
+  static const double b5 =  1.330274429;
+  const double ax = std::fabs( x );
+  const double t = 1.0 / ( 1.0 + p * ax );
+  const double tail = NormalPDF( ax ) * t * ( b1 + t * ( b2 + t * ( b3 + t * ( b4 + t * b5 ) ) ) );
+  return ( 0.0 <= x ) ? 1.0 - tail : tail;
+}
+
+} // namespace bsm
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -24,7 +24,7 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 NoRiskInterestRateSeries::NoRiskInterestRateSeries( void ) 
-  : m_bInitialized( false ), m_bWatching( false ), m_sDescription( "rates")
+  : m_bInitialized( false ), m_bWatching( false ), m_nUpdates( 0 ), m_sDescription( "rates")
 {
 }
 
@@ -43,9 +43,14 @@ void NoRiskInterestRateSeries::Initialize( void ) {
       pInstrument = mgr.ConstructInstrument( iter->Symbol, "INDEX", ou::tf::InstrumentType::Index );
     }
     iter->pWatch.reset( new Watch( pInstrument, m_pProvider ) );
+    iter->pWatch->OnTrade.Add( MakeDelegate( this, &NoRiskInterestRateSeries::HandleTrade ) );
   }
 }
 
+void NoRiskInterestRateSeries::HandleTrade( const ou::tf::Trade& ) {
+  m_nUpdates.fetch_add( 1, std::memory_order_release );
+}
+
 void NoRiskInterestRateSeries::SetWatchOn( pProvider_t pProvider ) {
   assert( ou::tf::keytypes::EProviderIQF == pProvider->ID() );
   if ( !m_bInitialized) {
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -56,6 +57,9 @@ public:
   void SetWatchOff( void );
 
   double ValueAt( boost::posix_time::time_duration td ) const;  // index to determine appropriate interest rate
+
+  // incremented on each trade of a rate, a cache of ValueAt results is stale when this changes
+  unsigned int Updates( void ) const { return m_nUpdates.load( std::memory_order_acquire ); }
   
   bool Watching( void ) const { return m_bWatching; }
   
@@ -95,11 +99,15 @@ private:
 
   bool m_bInitialized;
   bool m_bWatching;
+
+  std::atomic<unsigned int> m_nUpdates;
   
   pProvider_t m_pProvider;
 
   void Initialize( void );
 
+  void HandleTrade( const ou::tf::Trade& );
+
 };
 
 std::ostream& operator<<( std::ostream& os, const NoRiskInterestRateSeries& nrirs );
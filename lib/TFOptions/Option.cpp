@@ -77,6 +77,7 @@ void Option::Initialize( void ) {
   if ( 0 != m_pGreekProvider.get() ) 
     assert( m_pGreekProvider->ProvidesGreeks() );
   m_greeks.Reserve( 1024 );  // reduce startup allocations
+  m_dtExpiryUtc = m_pInstrument->GetExpiryUtc();
 }
 
 bool Option::StartWatch( void ) {
@@ -125,7 +126,7 @@ void Option::CalcRate( // version 2, calls version 1, uses instrument expiry dat
 //          ou::TimeSource::Instance().
 //              ConvertRegionalToUtc( dtUtcNow.date(), dtUtcNow.time_of_day(), "America/New_York", true );  
 
-  ptime dtUtcExpiry( m_pInstrument->GetExpiryUtc() );
+  const ptime dtUtcExpiry( m_dtExpiryUtc );
   if ( dtUtcNow < dtUtcExpiry ) {
   }
   else {
@@ -137,6 +138,19 @@ void Option::CalcRate( // version 2, calls version 1, uses instrument expiry dat
   CalcRate( input, libor, dtUtcNow, dtUtcExpiry );
 }
 
+bool Option::CalcRate( // version 3, expiry info from the curve's table
+  ou::tf::option::binomial::structInput& input,
+        const boost::posix_time::ptime dtUtcNow, const RateCurve& curve ) {
+  RateCurve::Point point;
+  if ( curve.Value( m_dtExpiryUtc, dtUtcNow, point ) ) {
+    input.T = point.dblYears;
+    input.r = point.dblRate;
+    input.b = point.dblRate; // as in version 1
+    return true;
+  }
+  return false;
+}
+
 void Option::CalcGreeks( 
   ou::tf::option::binomial::structInput& input, ptime dtUtcNow, bool bNeedsGuess ) {
   // example caller: void ExpiryBundle::CalcGreeksAtStrike
@@ -21,6 +21,7 @@
 #include <TFTrading/Watch.h>
 
 #include "NoRiskInterestRateSeries.h"
+#include "RateCurve.h"
 #include "Binomial.h"
 
 namespace ou { // One Unified
@@ -47,6 +48,7 @@ public:
   bool virtual operator<=( const Option& rhs ) const { return m_dblStrike <= rhs.m_dblStrike; };
 
   double GetStrike( void ) const { return m_dblStrike; };
+  ptime GetExpiryUtc( void ) const { return m_dtExpiryUtc; } // cached from the instrument
 
   static void CalcRate( // basic libor calcs
     ou::tf::option::binomial::structInput& input,
@@ -54,6 +56,8 @@ public:
     boost::posix_time::ptime dtUtcNow, boost::posix_time::ptime dtUtcExpiry );
   // calls static CalcRate with specific expiry info
   void CalcRate( ou::tf::option::binomial::structInput& input, const ptime dtUtcNow, const ou::tf::LiborFromIQFeed& libor );
+  // from the curve's cached point for this expiry, false (no exception) when expired
+  bool CalcRate( ou::tf::option::binomial::structInput& input, const ptime dtUtcNow, const RateCurve& curve );
   // caller needs to have updated input with CalcRate
   void CalcGreeks( ou::tf::option::binomial::structInput& input, ptime dtUtcNow, bool bNeedsGuess = true ); // Calc and Append
 
@@ -83,6 +87,7 @@ protected:
   std::string m_sSide;
 
   double m_dblStrike;
+  ptime m_dtExpiryUtc; // Instrument::GetExpiryUtc converts time zones on each call
   Greek m_greek;
 
   ou::tf::Greeks m_greeks;
@@ -0,0 +1,179 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RateCurve.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 27, 2020, 10:05
+ */
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "RateCurve.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+namespace {
+
+  const boost::posix_time::ptime c_dtEpoch( boost::gregorian::date( 1970, 1, 1 ) );
+  const double c_dblSecondsPerDay( 24.0 * 60.0 * 60.0 );
+
+  std::atomic<uint64_t> s_nVersion( 0 ); // shared by all curves, a thread's cache is then never mistaken for another curve's
+  bool IsWeekday( const boost::gregorian::date& date ) {
+    const auto dow( date.day_of_week() );
+    return ( boost::date_time::Saturday != dow ) && ( boost::date_time::Sunday != dow );
+  }
+
+  double WeekdaySeconds( boost::posix_time::ptime dtFrom, boost::posix_time::ptime dtTo ) {
+    const boost::gregorian::date dateFrom( dtFrom.date() );
+    const boost::gregorian::date dateTo( dtTo.date() );
+    if ( dateFrom == dateTo ) {
+      return IsWeekday( dateFrom ) ? (double) ( dtTo - dtFrom ).total_seconds() : 0.0;
+    }
+    double dblSeconds {};
+    if ( IsWeekday( dateFrom ) ) dblSeconds += c_dblSecondsPerDay - dtFrom.time_of_day().total_seconds();
+    if ( IsWeekday( dateTo ) )   dblSeconds += dtTo.time_of_day().total_seconds();
+    // whole days in between: five weekdays to a week, then the remainder one by one
+    const long nDays( ( dateTo - dateFrom ).days() - 1 );
+    long nWeekdays( 5 * ( nDays / 7 ) );
+    boost::gregorian::date date( dateFrom + boost::gregorian::days( 1 + 7 * ( nDays / 7 ) ) );
+    for ( ; date < dateTo; date += boost::gregorian::days( 1 ) ) {
+      if ( IsWeekday( date ) ) ++nWeekdays;
+    }
+    return dblSeconds + nWeekdays * c_dblSecondsPerDay;
+  }
+}
+
+RateCurve::RateCurve( const NoRiskInterestRateSeries& series, EDayCount eDayCount, time_duration tdBucket )
+: m_series( series ), m_eDayCount( eDayCount ),
+  m_nTicksPerBucket( std::max<int64_t>( 1, tdBucket.ticks() ) ),
+  m_nVersion( 0 ),
+  m_cntRebuilds( 0 )
+{}
+
+RateCurve::~RateCurve() {}
+
+double RateCurve::YearFraction( ptime dtUtcFrom, ptime dtUtcTo ) const {
+  const double dblSeconds( (double) ( dtUtcTo - dtUtcFrom ).total_seconds() );
+  switch ( m_eDayCount ) {
+    case EDayCount::Actual365Fixed: return dblSeconds / ( 365.0 * c_dblSecondsPerDay );
+    case EDayCount::Actual360:      return dblSeconds / ( 360.0 * c_dblSecondsPerDay );
+    case EDayCount::Actual365_25:   return dblSeconds / ( 365.25 * c_dblSecondsPerDay );
+    case EDayCount::Weekday252:     return WeekdaySeconds( dtUtcFrom, dtUtcTo ) / ( 252.0 * c_dblSecondsPerDay );
+  }
+  return 0.0;
+}
+
+int64_t RateCurve::Bucket( ptime dt ) const {
+  return ( dt - c_dtEpoch ).ticks() / m_nTicksPerBucket;
+}
+
+bool RateCurve::Value( ptime dtUtcExpiry, ptime dtUtcNow, Point& point ) const {
+
+  assert( boost::posix_time::not_a_date_time != dtUtcNow );
+  assert( boost::posix_time::not_a_date_time != dtUtcExpiry );
+
+  if ( dtUtcNow >= dtUtcExpiry ) return false;
+
+  const int64_t nBucket( Bucket( dtUtcNow ) );
+  const unsigned int nUpdates( m_series.Updates() );
+
+  static thread_local Cache cache;
+  const uint64_t nVersion( m_nVersion.load( std::memory_order_acquire ) );
+  if ( cache.nVersion != nVersion ) {
+    pTable_t pLatest( std::atomic_load( &m_pTable ) );
+    cache.nVersion = pLatest ? pLatest->nVersion : 0;
+    cache.pTable = std::move( pLatest );
+  }
+  const Table* pTable( cache.pTable.get() );
+
+  vEntry_t::const_iterator iter;
+  bool bFound( false );
+
+  // a caller behind the current bucket uses the table as it is, the table only rolls forward
+  if ( pTable && ( nBucket <= pTable->nBucket ) && ( nUpdates == pTable->nUpdates ) ) {
+    iter = std::lower_bound( pTable->vEntry.begin(), pTable->vEntry.end(), dtUtcExpiry );
+    bFound = ( pTable->vEntry.end() != iter ) && ( dtUtcExpiry == iter->dtExpiry );
+  }
+
+  if ( !bFound ) {
+    pTable_t pRebuilt( Rebuild( nBucket, nUpdates, dtUtcExpiry ) );
+    cache.nVersion = pRebuilt->nVersion;
+    cache.pTable = pRebuilt;
+    pTable = pRebuilt.get();
+    iter = std::lower_bound( pTable->vEntry.begin(), pTable->vEntry.end(), dtUtcExpiry );
+    assert( ( pTable->vEntry.end() != iter ) && ( dtUtcExpiry == iter->dtExpiry ) );
+  }
+
+  point = iter->point;
+  return 0.0 < point.dblYears;
+}
+
+RateCurve::pTable_t RateCurve::Rebuild( int64_t nBucket, unsigned int nUpdates, ptime dtUtcExpiry ) const {
+
+  std::lock_guard<std::mutex> lock( m_mutexRebuild );
+
+  pTable_t pCurrent( std::atomic_load( &m_pTable ) );
+
+  if ( pCurrent ) {
+    if ( ( nBucket <= pCurrent->nBucket ) && ( nUpdates == pCurrent->nUpdates ) ) {
+      // another thread may have just built what is needed
+      vEntry_t::const_iterator iter = std::lower_bound( pCurrent->vEntry.begin(), pCurrent->vEntry.end(), dtUtcExpiry );
+      if ( ( pCurrent->vEntry.end() != iter ) && ( dtUtcExpiry == iter->dtExpiry ) ) return pCurrent;
+    }
+    nBucket = std::max( nBucket, pCurrent->nBucket );
+  }
+
+  const ptime dtBucket( c_dtEpoch + time_duration( 0, 0, 0, nBucket * m_nTicksPerBucket ) );
+
+  std::shared_ptr<Table> pTable( std::make_shared<Table>() );
+  pTable->nVersion = ++s_nVersion;
+  pTable->nBucket = nBucket;
+  pTable->nUpdates = nUpdates;
+
+  // carry the expiries yet to pass, and add the new one
+  if ( pCurrent ) {
+    pTable->vEntry.reserve( pCurrent->vEntry.size() + 1 );
+    for ( const Entry& entry: pCurrent->vEntry ) {
+      if ( dtBucket < entry.dtExpiry ) pTable->vEntry.push_back( Entry{ entry.dtExpiry, Point() } );
+    }
+  }
+  vEntry_t::iterator iter = std::lower_bound( pTable->vEntry.begin(), pTable->vEntry.end(), dtUtcExpiry );
+  if ( ( pTable->vEntry.end() == iter ) || ( dtUtcExpiry != iter->dtExpiry ) ) {
+    pTable->vEntry.insert( iter, Entry{ dtUtcExpiry, Point() } );
+  }
+
+  for ( Entry& entry: pTable->vEntry ) {
+    // for a caller behind the current bucket, its expiry may come before the bucket start
+    const ptime dtFrom( std::min( dtBucket, entry.dtExpiry ) );
+    Point& point( entry.point );
+    point.dblYears = YearFraction( dtFrom, entry.dtExpiry );
+    point.dblRate = m_series.ValueAt( entry.dtExpiry - dtFrom ) / 100.0;
+    point.dblDiscount = std::exp( -point.dblRate * point.dblYears );
+  }
+
+  std::atomic_store( &m_pTable, pTable_t( pTable ) );
+  m_nVersion.store( pTable->nVersion, std::memory_order_release );
+  m_cntRebuilds++;
+
+  return pTable;
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,119 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RateCurve.h
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 27, 2020, 10:05
+ */
+
+// time to expiry, rate and discount factor, by expiry, from a NoRiskInterestRateSeries
+//   options sharing an expiry share a point, rather than each running ValueAt on every pass
+//   the table is rebuilt when the time bucket rolls (default one second) or a rate in the series trades,
+//     a point reflects the start of its bucket
+//   a rebuild swaps in a new table under a mutex, an expiry not yet in the table is added by the rebuild
+//   each reader thread keeps the table it last used, and checks an atomic version before using it,
+//     so a read takes no lock (std::atomic_load of a shared_ptr does, in libstdc++)
+//   the default day count, actual/365 fixed, matches Option::CalcRate
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "NoRiskInterestRateSeries.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+class RateCurve {
+public:
+
+  using ptime = boost::posix_time::ptime;
+  using time_duration = boost::posix_time::time_duration;
+
+  enum class EDayCount {
+    Actual365Fixed, // calendar seconds / 365 days
+    Actual360,      // calendar seconds / 360 days, money market
+    Actual365_25,   // calendar seconds / 365.25 days, averages the leap years
+    Weekday252      // seconds on monday through friday / 252 days, holidays are not removed
+  };
+
+  struct Point {
+    double dblYears;    // T
+    double dblRate;     // r, as a fraction
+    double dblDiscount; // exp( -r T )
+    Point(): dblYears {}, dblRate {}, dblDiscount( 1.0 ) {}
+  };
+
+  explicit RateCurve(
+    const NoRiskInterestRateSeries&,
+    EDayCount = EDayCount::Actual365Fixed,
+    time_duration tdBucket = boost::posix_time::seconds( 1 ) );
+  ~RateCurve();
+
+  // false when expired, or expiring before the current bucket, no exception
+  bool Value( ptime dtUtcExpiry, ptime dtUtcNow, Point& ) const;
+
+  double YearFraction( ptime dtUtcFrom, ptime dtUtcTo ) const; // with the day count
+
+  size_t Rebuilds() const { return m_cntRebuilds.load(); }
+
+protected:
+private:
+
+  struct Entry {
+    ptime dtExpiry;
+    Point point;
+    bool operator<( const ptime& dt ) const { return dtExpiry < dt; }
+  };
+
+  using vEntry_t = std::vector<Entry>; // sorted by expiry
+
+  struct Table {
+    uint64_t nVersion; // unique across curves
+    int64_t nBucket;
+    unsigned int nUpdates; // series updates seen at the build
+    vEntry_t vEntry;
+  };
+
+  using pTable_t = std::shared_ptr<const Table>;
+
+  struct Cache { // one per reader thread
+    uint64_t nVersion;
+    pTable_t pTable;
+    Cache(): nVersion( 0 ) {}
+  };
+
+  const NoRiskInterestRateSeries& m_series;
+  const EDayCount m_eDayCount;
+  const int64_t m_nTicksPerBucket;
+
+  mutable pTable_t m_pTable; // std::atomic_load/store only
+  mutable std::atomic<uint64_t> m_nVersion; // of m_pTable, stored after it
+  mutable std::mutex m_mutexRebuild;
+  mutable std::atomic<size_t> m_cntRebuilds;
+
+  int64_t Bucket( ptime ) const;
+  pTable_t Rebuild( int64_t nBucket, unsigned int nUpdates, ptime dtUtcExpiry ) const;
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,221 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ScenarioRisk.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 29, 2020, 10:30
+ */
+
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <algorithm>
+
+#include "FormulaBatch.h"
+#include "ScenarioRisk.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+namespace {
+
+  const double c_dblDaysPerYear( 365.0 ); // as RateCurve's default day count
+
+  const ScenarioRisk::vPL_t c_vEmpty;
+
+  // one combo: its option legs, each at the snapshot and at every shock, in one batch
+  void Revalue(
+    const ScenarioRisk::Snapshot& snapshot, const std::vector<ScenarioRisk::Shock>& vShock,
+    ScenarioRisk::vPL_t& vPL,
+    bsm::structPointInput& input, std::vector<double>& vValue
+  ) {
+
+    const size_t nScenario( vShock.size() );
+    vPL.assign( nScenario, 0.0 );
+
+    const double S( snapshot.dblUnderlying );
+
+    size_t nOption {};
+    for ( const ScenarioRisk::Leg& leg: snapshot.vLeg ) {
+      if ( ou::tf::OptionSide::Unknown == leg.side ) {
+        for ( size_t ix = 0; ix < nScenario; ++ix ) {
+          vPL[ ix ] += leg.dblQuantity * S * vShock[ ix ].dblUnderlying;
+        }
+      }
+      else ++nOption;
+    }
+    if ( 0 == nOption ) return;
+
+    const size_t nStride( nScenario + 1 ); // the snapshot first, then the shocks
+    input.Resize( nOption * nStride );
+
+    size_t ix {};
+    for ( const ScenarioRisk::Leg& leg: snapshot.vLeg ) {
+      if ( ou::tf::OptionSide::Unknown == leg.side ) continue;
+      input.vS[ ix ] = S;
+      input.vX[ ix ] = leg.dblStrike;
+      input.vT[ ix ] = leg.dblYears;
+      input.vR[ ix ] = snapshot.dblRate;
+      input.vB[ ix ] = snapshot.dblCarry;
+      input.vV[ ix ] = leg.dblVolatility;
+      input.vSide[ ix ] = leg.side;
+      ++ix;
+      for ( const ScenarioRisk::Shock& shock: vShock ) {
+        input.vS[ ix ] = S * ( 1.0 + shock.dblUnderlying );
+        input.vX[ ix ] = leg.dblStrike;
+        input.vT[ ix ] = leg.dblYears - shock.dblDays / c_dblDaysPerYear;
+        input.vR[ ix ] = snapshot.dblRate + shock.dblRate;
+        input.vB[ ix ] = snapshot.dblCarry + shock.dblRate;
+        input.vV[ ix ] = leg.dblVolatility + shock.dblVolatility;
+        input.vSide[ ix ] = leg.side;
+        ++ix;
+      }
+    }
+
+    bsm::CalcValues( input, vValue );
+
+    const double* pValue( vValue.data() );
+    for ( const ScenarioRisk::Leg& leg: snapshot.vLeg ) {
+      if ( ou::tf::OptionSide::Unknown == leg.side ) continue;
+      const double dblBase( pValue[ 0 ] );
+      for ( size_t ixScenario = 0; ixScenario < nScenario; ++ixScenario ) {
+        vPL[ ixScenario ] += leg.dblQuantity * ( pValue[ 1 + ixScenario ] - dblBase );
+      }
+      pValue += nStride;
+    }
+  }
+
+}
+
+ScenarioRisk::ScenarioRisk() {
+  SetGrid( m_grid );
+}
+
+ScenarioRisk::~ScenarioRisk() {}
+
+void ScenarioRisk::SetGrid( const Grid& grid ) {
+
+  assert( !grid.vUnderlying.empty() );
+  assert( !grid.vVolatility.empty() );
+  assert( !grid.vDays.empty() );
+  assert( !grid.vRate.empty() );
+
+  m_grid = grid;
+
+  m_vShock.clear();
+  m_vShock.reserve( grid.vUnderlying.size() * grid.vVolatility.size() * grid.vDays.size() * grid.vRate.size() );
+  for ( double dblUnderlying: grid.vUnderlying ) {
+    for ( double dblVolatility: grid.vVolatility ) {
+      for ( double dblDays: grid.vDays ) {
+        for ( double dblRate: grid.vRate ) {
+          m_vShock.push_back( Shock{ dblUnderlying, dblVolatility, dblDays, dblRate } );
+        }
+      }
+    }
+  }
+
+  for ( structCombo& combo: m_vCombo ) combo.bMarked = true;
+}
+
+size_t ScenarioRisk::Scenario( size_t ixUnderlying, size_t ixVolatility, size_t ixDays, size_t ixRate ) const {
+  assert( ixUnderlying < m_grid.vUnderlying.size() );
+  assert( ixVolatility < m_grid.vVolatility.size() );
+  assert( ixDays < m_grid.vDays.size() );
+  assert( ixRate < m_grid.vRate.size() );
+  return ( ( ixUnderlying * m_grid.vVolatility.size() + ixVolatility ) * m_grid.vDays.size() + ixDays ) * m_grid.vRate.size() + ixRate;
+}
+
+ScenarioRisk::idCombo_t ScenarioRisk::Add( const Snapshot& snapshot ) {
+  m_vCombo.emplace_back();
+  m_vCombo.back().snapshot = snapshot;
+  return m_vCombo.size() - 1;
+}
+
+void ScenarioRisk::Set( idCombo_t id, const Snapshot& snapshot ) {
+  assert( id < m_vCombo.size() );
+  structCombo& combo( m_vCombo[ id ] );
+  combo.snapshot = snapshot;
+  combo.bMarked = true;
+}
+
+void ScenarioRisk::Remove( idCombo_t id ) {
+  Set( id, Snapshot() );
+}
+
+size_t ScenarioRisk::Calculate( size_t nThreads ) {
+
+  std::vector<structCombo*> vMarked;
+  for ( structCombo& combo: m_vCombo ) {
+    if ( combo.bMarked ) vMarked.push_back( &combo );
+  }
+
+  if ( 0 == nThreads ) {
+    nThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+  }
+  nThreads = std::max<size_t>( 1, std::min( nThreads, vMarked.size() ) );
+
+  std::atomic<size_t> ixNext( 0 );
+
+  auto worker =
+    [this,&vMarked,&ixNext](){
+      bsm::structPointInput input;
+      std::vector<double> vValue;
+      for ( size_t ix = ixNext++; ix < vMarked.size(); ix = ixNext++ ) {
+        structCombo& combo( *vMarked[ ix ] );
+        Revalue( combo.snapshot, m_vShock, combo.vPL, input, vValue );
+        combo.bMarked = false;
+      }
+    };
+
+  if ( 1 == nThreads ) {
+    worker();
+  }
+  else {
+    std::vector<std::thread> vThread;
+    vThread.reserve( nThreads );
+    for ( size_t ix = 0; ix < nThreads; ++ix ) {
+      vThread.emplace_back( worker );
+    }
+    for ( std::thread& thread: vThread ) {
+      thread.join();
+    }
+  }
+
+  // the sums are redone in full, a pass over combos by scenarios, small beside the revaluation
+  const size_t nScenario( m_vShock.size() );
+  m_vPortfolio.assign( nScenario, 0.0 );
+  m_mapUnderlying.clear();
+  for ( const structCombo& combo: m_vCombo ) {
+    if ( combo.snapshot.vLeg.empty() ) continue;
+    vPL_t& vUnderlying( m_mapUnderlying[ combo.snapshot.sUnderlying ] );
+    vUnderlying.resize( nScenario, 0.0 );
+    for ( size_t ix = 0; ix < nScenario; ++ix ) {
+      vUnderlying[ ix ] += combo.vPL[ ix ];
+      m_vPortfolio[ ix ] += combo.vPL[ ix ];
+    }
+  }
+
+  return vMarked.size();
+}
+
+const ScenarioRisk::vPL_t& ScenarioRisk::Underlying( const std::string& sUnderlying ) const {
+  mapUnderlying_t::const_iterator iter = m_mapUnderlying.find( sUnderlying );
+  return ( m_mapUnderlying.end() == iter ) ? c_vEmpty : iter->second;
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,131 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ScenarioRisk.h
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 29, 2020, 10:30
+ */
+
+// profit and loss of a book of combos across a grid of shocks: underlying, volatility, days forward and rate
+//   each combo is a snapshot of its legs, taken by the owner (eg Combo::Snapshot), the engine holds no positions
+//   a scenario is one point of the grid, every axis crossed with every other
+//   a leg's change is its value at the shocked point less its value at the snapshot, both from bsm::CalcValues,
+//     so the model's distance from the market does not show up as profit or loss, a leg in the underlying
+//     itself moves with the price only
+//   european values, the early exercise of american options is not modelled
+//   Set marks a combo, Calculate revalues the marked combos only, across threads, one combo at a time to a thread,
+//     then sums the combos by underlying and for the book
+//   not thread safe, the owner makes its calls from one thread, Calculate runs and joins its own workers
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <TFTrading/TradingEnumerations.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+class ScenarioRisk {
+public:
+
+  using EOptionSide = ou::tf::OptionSide::enumOptionSide;
+
+  struct Leg {
+    EOptionSide side;     // OptionSide::Unknown for a position in the underlying
+    double dblStrike;
+    double dblYears;      // to expiry
+    double dblVolatility; // implied
+    double dblQuantity;   // signed, long is positive, times the multiplier
+    Leg(): side( ou::tf::OptionSide::Unknown ), dblStrike {}, dblYears {}, dblVolatility {}, dblQuantity {} {}
+  };
+
+  using vLeg_t = std::vector<Leg>;
+
+  struct Snapshot {
+    std::string sUnderlying;
+    double dblUnderlying; // price
+    double dblRate;       // r
+    double dblCarry;      // b, the rate for a stock, rate less dividend yield for an index
+    vLeg_t vLeg;
+    Snapshot(): dblUnderlying {}, dblRate {}, dblCarry {} {}
+  };
+
+  struct Grid { // each axis needs at least one value, 0.0 for no shock
+    std::vector<double> vUnderlying; // fraction of price, 0.05 is up 5%
+    std::vector<double> vVolatility; // added, 0.10 is up 10 vol points
+    std::vector<double> vDays;       // calendar days forward
+    std::vector<double> vRate;       // added to rate and carry
+    Grid(): vUnderlying( 1, 0.0 ), vVolatility( 1, 0.0 ), vDays( 1, 0.0 ), vRate( 1, 0.0 ) {}
+  };
+
+  struct Shock {
+    double dblUnderlying;
+    double dblVolatility;
+    double dblDays;
+    double dblRate;
+  };
+
+  using idCombo_t = size_t;
+  using vPL_t = std::vector<double>; // by scenario
+
+  ScenarioRisk();
+  ~ScenarioRisk();
+
+  void SetGrid( const Grid& ); // marks every combo
+  size_t Scenarios() const { return m_vShock.size(); }
+  const Shock& Scenario( size_t ixScenario ) const { return m_vShock[ ixScenario ]; }
+  // ix = ( ( ixUnderlying * nVolatility + ixVolatility ) * nDays + ixDays ) * nRate + ixRate
+  size_t Scenario( size_t ixUnderlying, size_t ixVolatility, size_t ixDays, size_t ixRate ) const;
+
+  idCombo_t Add( const Snapshot& );
+  void Set( idCombo_t, const Snapshot& ); // replaces, and marks for the next Calculate
+  void Remove( idCombo_t ); // the id stays, with an empty snapshot
+  size_t Combos() const { return m_vCombo.size(); }
+
+  size_t Calculate( size_t nThreads = 0 ); // the hardware concurrency for 0, returns combos revalued
+
+  const vPL_t& Combo( idCombo_t id ) const { return m_vCombo[ id ].vPL; }
+  const vPL_t& Underlying( const std::string& ) const; // empty when no combo has the underlying
+  const vPL_t& Portfolio() const { return m_vPortfolio; }
+
+protected:
+private:
+
+  struct structCombo {
+    Snapshot snapshot;
+    vPL_t vPL;
+    bool bMarked;
+    structCombo(): bMarked( true ) {}
+  };
+
+  using vCombo_t = std::vector<structCombo>;
+  using mapUnderlying_t = std::map<std::string, vPL_t>;
+
+  Grid m_grid;
+  std::vector<Shock> m_vShock;
+
+  vCombo_t m_vCombo;
+
+  mapUnderlying_t m_mapUnderlying;
+  vPL_t m_vPortfolio;
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,350 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    Surface.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 9, 2020, 16:25
+ */
+
+#include <utility>
+#include <iostream>
+#include <algorithm>
+
+#include <TFHDF5TimeSeries/HDF5DataManager.h>
+#include <TFHDF5TimeSeries/HDF5TimeSeriesContainer.h>
+#include <TFHDF5TimeSeries/HDF5Attribute.h>
+
+#include "Surface.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+// ================ Surface::Smile =================
+
+Surface::Smile::Point::Point( double strike_ )
+: strike( strike_ ), x( 0.0 ), y( 0.0 ), bInFit( false )
+{
+  iv.fill( 0.0 );
+  delta.fill( 0.0 );
+  bHas.fill( false );
+}
+
+double Surface::Smile::Point::Blended() const {
+  if ( bHas[ Call ] && bHas[ Put ] ) return 0.5 * ( iv[ Call ] + iv[ Put ] );
+  return bHas[ Call ] ? iv[ Call ] : iv[ Put ];
+}
+
+Surface::Smile::Smile()
+: m_dblStrikeReference( 0.0 ), m_cntUpdates( 0 ),
+  m_bFitDirty( true ), m_bDeltaDirty( true )
+{
+  m_sumX.fill( 0.0 );
+  m_sumXY.fill( 0.0 );
+  m_coef.fill( 0.0 );
+  m_rDeltaIV.fill( 0.0 );
+}
+
+size_t Surface::Smile::Index( double dblStrike ) {
+  mapIndex_t::const_iterator iter = m_mapIndex.find( Key( dblStrike ) );
+  if ( m_mapIndex.end() != iter ) return iter->second;
+
+  // new strike, happens only while the chain fills in
+  if ( 0.0 == m_dblStrikeReference ) m_dblStrikeReference = dblStrike;
+  vPoint_t::iterator iterPoint = std::lower_bound(
+    m_vPoint.begin(), m_vPoint.end(), dblStrike,
+    []( const Point& point, double strike ){ return point.strike < strike; } );
+  size_t ix = iterPoint - m_vPoint.begin();
+  Point point( dblStrike );
+  point.x = Normalize( dblStrike );
+  m_vPoint.insert( iterPoint, point );
+  for ( size_t ixShift = ix; ixShift < m_vPoint.size(); ++ixShift ) {
+    m_mapIndex[ Key( m_vPoint[ ixShift ].strike ) ] = ixShift;
+  }
+  return ix;
+}
+
+void Surface::Smile::Accumulate( const Point& point, double sign ) {
+  const double x1 = point.x;
+  const double x2 = x1 * x1;
+  m_sumX[ 0 ] += sign;
+  m_sumX[ 1 ] += sign * x1;
+  m_sumX[ 2 ] += sign * x2;
+  m_sumX[ 3 ] += sign * x2 * x1;
+  m_sumX[ 4 ] += sign * x2 * x2;
+  m_sumXY[ 0 ] += sign * point.y;
+  m_sumXY[ 1 ] += sign * point.y * x1;
+  m_sumXY[ 2 ] += sign * point.y * x2;
+}
+
+void Surface::Smile::RebuildSums() {
+  m_sumX.fill( 0.0 );
+  m_sumXY.fill( 0.0 );
+  for ( const Point& point: m_vPoint ) {
+    if ( point.bInFit ) Accumulate( point, 1.0 );
+  }
+  m_cntUpdates = 0;
+}
+
+void Surface::Smile::Update( double dblStrike, side_t side, double dblIV, double dblDelta ) {
+
+  Point& point( m_vPoint[ Index( dblStrike ) ] );
+  const ESide eSide = ( ou::tf::OptionSide::Put == side ) ? Put : Call;
+
+  if ( point.bInFit ) Accumulate( point, -1.0 );
+
+  if ( 0.0 < dblIV ) { // failed calculations arrive as zero
+    point.iv[ eSide ] = dblIV;
+    point.delta[ eSide ] = dblDelta;
+    point.bHas[ eSide ] = true;
+  }
+  else {
+    point.bHas[ eSide ] = false;
+  }
+
+  point.bInFit = point.Available();
+  if ( point.bInFit ) {
+    point.y = point.Blended();
+    Accumulate( point, 1.0 );
+  }
+
+  m_bFitDirty = true;
+  m_bDeltaDirty = true;
+
+  m_cntUpdates++;
+  if ( nRebuildSums <= m_cntUpdates ) RebuildSums();
+}
+
+void Surface::Smile::SolveFit() const {
+
+  // normal equations for least squares quadratic, Cramer's rule
+  const double s0 = m_sumX[ 0 ], s1 = m_sumX[ 1 ], s2 = m_sumX[ 2 ], s3 = m_sumX[ 3 ], s4 = m_sumX[ 4 ];
+  const double t0 = m_sumXY[ 0 ], t1 = m_sumXY[ 1 ], t2 = m_sumXY[ 2 ];
+
+  m_coef.fill( 0.0 );
+
+  if ( 0.5 > s0 ) {} // nothing available
+  else {
+    const double det3 = s0 * ( s2 * s4 - s3 * s3 ) - s1 * ( s1 * s4 - s3 * s2 ) + s2 * ( s1 * s3 - s2 * s2 );
+    const double det2 = s0 * s2 - s1 * s1;
+    if ( ( 2.5 < s0 ) && ( 1e-18 < std::abs( det3 ) ) ) {
+      m_coef[ 0 ] = ( t0 * ( s2 * s4 - s3 * s3 ) - s1 * ( t1 * s4 - s3 * t2 ) + s2 * ( t1 * s3 - s2 * t2 ) ) / det3;
+      m_coef[ 1 ] = ( s0 * ( t1 * s4 - t2 * s3 ) - t0 * ( s1 * s4 - s3 * s2 ) + s2 * ( s1 * t2 - t1 * s2 ) ) / det3;
+      m_coef[ 2 ] = ( s0 * ( s2 * t2 - s3 * t1 ) - s1 * ( s1 * t2 - t1 * s2 ) + t0 * ( s1 * s3 - s2 * s2 ) ) / det3;
+    }
+    else {
+      if ( ( 1.5 < s0 ) && ( 1e-18 < std::abs( det2 ) ) ) { // linear
+        m_coef[ 1 ] = ( s0 * t1 - s1 * t0 ) / det2;
+        m_coef[ 0 ] = ( t0 - m_coef[ 1 ] * s1 ) / s0;
+      }
+      else { // flat
+        m_coef[ 0 ] = t0 / s0;
+      }
+    }
+  }
+
+  m_bFitDirty = false;
+}
+
+double Surface::Smile::Fit( double dblStrike ) const {
+  if ( m_bFitDirty ) SolveFit();
+  if ( 0.0 == m_dblStrikeReference ) return 0.0;
+  const double x = Normalize( dblStrike );
+  const double iv = m_coef[ 0 ] + x * ( m_coef[ 1 ] + x * m_coef[ 2 ] );
+  return std::max( 0.0, iv );
+}
+
+double Surface::Smile::ImpliedVolatility( double dblStrike ) const {
+  mapIndex_t::const_iterator iter = m_mapIndex.find( Key( dblStrike ) );
+  if ( m_mapIndex.end() != iter ) {
+    const Point& point( m_vPoint[ iter->second ] );
+    if ( point.bInFit ) return point.y;
+  }
+  return Fit( dblStrike );
+}
+
+void Surface::Smile::BuildDeltaTable() const {
+
+  // observed ( call equivalent delta, iv ) pairs, put delta mapped with 1 + delta
+  using pair_t = std::pair<double,double>;
+  std::vector<pair_t> vPair;
+  vPair.reserve( 2 * m_vPoint.size() );
+  for ( const Point& point: m_vPoint ) {
+    if ( point.bHas[ Call ] ) vPair.emplace_back( point.delta[ Call ], point.iv[ Call ] );
+    if ( point.bHas[ Put ] )  vPair.emplace_back( 1.0 + point.delta[ Put ], point.iv[ Put ] );
+  }
+  std::sort( vPair.begin(), vPair.end() );
+
+  if ( vPair.empty() ) {
+    m_rDeltaIV.fill( 0.0 );
+  }
+  else {
+    std::vector<pair_t>::const_iterator iterUpper = vPair.begin();
+    for ( size_t ix = 0; ix < nDeltaBuckets; ++ix ) {
+      const double delta = (double)ix / (double)( nDeltaBuckets - 1 );
+      while ( ( vPair.end() != iterUpper ) && ( iterUpper->first < delta ) ) ++iterUpper;
+      if ( vPair.begin() == iterUpper ) {
+        m_rDeltaIV[ ix ] = iterUpper->second; // flat below
+      }
+      else {
+        if ( vPair.end() == iterUpper ) {
+          m_rDeltaIV[ ix ] = vPair.back().second; // flat above
+        }
+        else {
+          std::vector<pair_t>::const_iterator iterLower = iterUpper - 1;
+          const double span = iterUpper->first - iterLower->first;
+          const double ratio = ( 0.0 == span ) ? 0.0 : ( delta - iterLower->first ) / span;
+          m_rDeltaIV[ ix ] = iterLower->second + ratio * ( iterUpper->second - iterLower->second );
+        }
+      }
+    }
+  }
+
+  m_bDeltaDirty = false;
+}
+
+double Surface::Smile::ImpliedVolatilityByDelta( double dblDelta ) const {
+  if ( m_bDeltaDirty ) BuildDeltaTable();
+  double delta = ( 0.0 > dblDelta ) ? ( 1.0 + dblDelta ) : dblDelta;
+  delta = std::min( std::max( delta, 0.0 ), 1.0 );
+  const double position = delta * (double)( nDeltaBuckets - 1 );
+  const size_t ix = std::min( (size_t)position, nDeltaBuckets - 2 );
+  const double ratio = position - (double)ix;
+  return m_rDeltaIV[ ix ] + ratio * ( m_rDeltaIV[ ix + 1 ] - m_rDeltaIV[ ix ] );
+}
+
+void Surface::Smile::Emit( std::ostream& os ) const {
+  if ( m_bFitDirty ) SolveFit();
+  os << "  fit: " << m_coef[ 0 ] << "," << m_coef[ 1 ] << "," << m_coef[ 2 ] << std::endl;
+  for ( const Point& point: m_vPoint ) {
+    os << "  " << point.strike << ": ";
+    if ( point.bHas[ Call ] ) os << "C " << point.iv[ Call ] << "@" << point.delta[ Call ] << " ";
+    if ( point.bHas[ Put ] )  os << "P " << point.iv[ Put ]  << "@" << point.delta[ Put ]  << " ";
+    os << std::endl;
+  }
+}
+
+// ================ Surface =================
+
+Surface::Surface() {}
+
+Surface::~Surface() {
+  for ( mapSubscription_t::value_type& vt: m_mapSubscription ) {
+    vt.second.pOption->OnGreek.Remove( MakeDelegate( &vt.second, &Subscription::HandleGreek ) );
+  }
+  m_mapSubscription.clear();
+}
+
+void Surface::Add( pOption_t pOption ) {
+  Option* p( pOption.get() );
+  assert( nullptr != p );
+  mapSubscription_t::iterator iter = m_mapSubscription.find( p );
+  if ( m_mapSubscription.end() == iter ) {
+    const ou::tf::Instrument::pInstrument_t pInstrument( pOption->GetInstrument() );
+    Subscription subscription;
+    subscription.pSurface = this;
+    subscription.pOption = pOption;
+    subscription.expiry = pInstrument->GetExpiry();
+    subscription.dblStrike = pInstrument->GetStrike();
+    subscription.side = pInstrument->GetOptionSide();
+    iter = m_mapSubscription.emplace( p, std::move( subscription ) ).first;
+    pOption->OnGreek.Add( MakeDelegate( &iter->second, &Subscription::HandleGreek ) );
+  }
+}
+
+void Surface::Remove( pOption_t pOption ) {
+  mapSubscription_t::iterator iter = m_mapSubscription.find( pOption.get() );
+  if ( m_mapSubscription.end() != iter ) {
+    pOption->OnGreek.Remove( MakeDelegate( &iter->second, &Subscription::HandleGreek ) );
+    m_mapSubscription.erase( iter );
+  }
+}
+
+void Surface::Update( date_t expiry, double dblStrike, side_t side, const ou::tf::Greek& greek ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_mapSmile[ Key( expiry ) ].Update( dblStrike, side, greek.ImpliedVolatility(), greek.Delta() );
+}
+
+size_t Surface::Replay( const std::string& sPathGreeks ) {
+
+  ou::tf::HDF5DataManager dm( ou::tf::HDF5DataManager::RO );
+
+  HDF5Attributes attributes( dm, sPathGreeks );
+  HDF5Attributes::structOption option;
+  attributes.GetOptionAttributes( &option );
+  const date_t expiry( option.nYear, option.nMonth, option.nDay );
+
+  HDF5TimeSeriesContainer<Greek> repository( dm, sPathGreeks );
+  HDF5TimeSeriesContainer<Greek>::iterator begin, end;
+  begin = repository.begin();
+  end = repository.end();
+  ou::tf::Greeks greeks;
+  greeks.Resize( end - begin );
+  repository.Read( begin, end, &greeks );
+
+  for ( const ou::tf::Greek& greek: greeks ) {
+    Update( expiry, option.dblStrike, option.eSide, greek );
+  }
+
+  return greeks.Size();
+}
+
+const Surface::Smile* Surface::Find( date_t expiry ) const {
+  mapSmile_t::const_iterator iter = m_mapSmile.find( Key( expiry ) );
+  return ( m_mapSmile.end() == iter ) ? nullptr : &iter->second;
+}
+
+double Surface::ImpliedVolatility( date_t expiry, double dblStrike ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  const Smile* pSmile = Find( expiry );
+  return ( nullptr == pSmile ) ? 0.0 : pSmile->ImpliedVolatility( dblStrike );
+}
+
+double Surface::ImpliedVolatilityByDelta( date_t expiry, double dblDelta ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  const Smile* pSmile = Find( expiry );
+  return ( nullptr == pSmile ) ? 0.0 : pSmile->ImpliedVolatilityByDelta( dblDelta );
+}
+
+double Surface::ImpliedVolatilityFit( date_t expiry, double dblStrike ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  const Smile* pSmile = Find( expiry );
+  return ( nullptr == pSmile ) ? 0.0 : pSmile->Fit( dblStrike );
+}
+
+bool Surface::HasExpiry( date_t expiry ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return nullptr != Find( expiry );
+}
+
+size_t Surface::Strikes( date_t expiry ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  const Smile* pSmile = Find( expiry );
+  return ( nullptr == pSmile ) ? 0 : pSmile->Strikes();
+}
+
+void Surface::EmitValues() const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  std::map<key_t,const Smile*> mapSorted;
+  for ( const mapSmile_t::value_type& vt: m_mapSmile ) mapSorted[ vt.first ] = &vt.second;
+  for ( const std::map<key_t,const Smile*>::value_type& vt: mapSorted ) {
+    std::cout << date_t( vt.first ) << std::endl;
+    vt.second->Emit( std::cout );
+  }
+}
+
+} // namespace option
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,177 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    Surface.h
+ * Author:  raymond@burkholder.net
+ * Project: TFOptions
+ * Created: May 9, 2020, 16:25
+ */
+
+// implied volatility surface across expiries
+//   IvAtm tracks atm only, this tracks the whole smile for each expiry
+//   subscribes to Option::OnGreek (from Engine or a greek provider),
+//   updates are incremental: only the strike which changed is touched,
+//   the per expiry smile fit is maintained as running normal-equation sums
+//   lookups by ( expiry, strike ) or ( expiry, delta ) are hash/array based
+
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include <map>
+#include <cmath>
+#include <mutex>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+
+#include <TFOptions/Option.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace option { // options
+
+class Surface {
+public:
+
+  using pOption_t = Option::pOption_t;
+  using date_t = boost::gregorian::date;
+  using side_t = ou::tf::OptionSide::enumOptionSide;
+
+  Surface();
+  Surface( const Surface& ) = delete;
+  virtual ~Surface();
+
+  void Add( pOption_t );  // subscribe to greeks, expiry/strike/side from the instrument
+  void Remove( pOption_t );
+
+  // subscriptions and replay come through here, can be used directly
+  void Update( date_t expiry, double dblStrike, side_t, const ou::tf::Greek& );
+
+  // replay a recorded greek series, eg sPrefix + "/greeks/" + name as written by Option::SaveSeries
+  // returns number of greeks applied
+  size_t Replay( const std::string& sPathGreeks );
+
+  // lookups return 0.0 when nothing is available
+  double ImpliedVolatility( date_t expiry, double dblStrike ) const; // observed at strike, otherwise smile fit
+  double ImpliedVolatilityByDelta( date_t expiry, double dblDelta ) const; // call: 0..1, put: -1..0
+  double ImpliedVolatilityFit( date_t expiry, double dblStrike ) const; // smile fit only
+
+  bool HasExpiry( date_t ) const;
+  size_t Strikes( date_t ) const;
+
+  void EmitValues() const;
+
+protected:
+private:
+
+  // one expiry
+  class Smile {
+  public:
+
+    Smile();
+
+    void Update( double dblStrike, side_t, double dblIV, double dblDelta );
+
+    double ImpliedVolatility( double dblStrike ) const;
+    double ImpliedVolatilityByDelta( double dblDelta ) const;
+    double Fit( double dblStrike ) const;
+
+    size_t Strikes() const { return m_vPoint.size(); }
+
+    void Emit( std::ostream& ) const;
+
+  private:
+
+    enum ESide { Call = 0, Put = 1 };
+
+    struct Point {
+      double strike;
+      double x; // normalized strike used in the fit
+      std::array<double,2> iv;
+      std::array<double,2> delta;
+      std::array<bool,2> bHas;
+      double y; // contribution in the regression sums
+      bool bInFit;
+      explicit Point( double strike_ );
+      bool Available() const { return bHas[ Call ] || bHas[ Put ]; }
+      double Blended() const;
+    };
+
+    using vPoint_t = std::vector<Point>;
+    using mapIndex_t = std::unordered_map<int64_t,size_t>; // strike key -> index into m_vPoint
+
+    static const size_t nDeltaBuckets = 101; // call delta in 0.01 increments
+    static const size_t nRebuildSums = 4096; // refresh running sums to flush rounding drift
+
+    double m_dblStrikeReference;
+
+    vPoint_t m_vPoint; // sorted by strike
+    mapIndex_t m_mapIndex;
+
+    // weighted sums for iv = a + b*x + c*x^2
+    std::array<double,5> m_sumX;  // sum x^0 .. x^4
+    std::array<double,3> m_sumXY; // sum y*x^0 .. y*x^2
+    size_t m_cntUpdates;
+
+    mutable bool m_bFitDirty;
+    mutable std::array<double,3> m_coef;
+
+    mutable bool m_bDeltaDirty;
+    mutable std::array<double,nDeltaBuckets> m_rDeltaIV;
+
+    static int64_t Key( double dblStrike ) { return (int64_t)std::llround( dblStrike * 10000.0 ); }
+    size_t Index( double dblStrike );
+    double Normalize( double dblStrike ) const { return dblStrike / m_dblStrikeReference - 1.0; }
+
+    void Accumulate( const Point&, double sign );
+    void RebuildSums();
+    void SolveFit() const;
+    void BuildDeltaTable() const;
+  };
+
+  using key_t = uint32_t; // date day number
+  using mapSmile_t = std::unordered_map<key_t,Smile>;
+
+  struct Subscription {
+    Surface* pSurface;
+    pOption_t pOption;
+    date_t expiry;
+    double dblStrike;
+    side_t side;
+    void HandleGreek( const ou::tf::Greek& greek ) {
+      pSurface->Update( expiry, dblStrike, side, greek );
+    }
+  };
+
+  using mapSubscription_t = std::map<Option*,Subscription>; // node addresses stable for the delegate
+
+  mutable std::mutex m_mutex;
+
+  mapSmile_t m_mapSmile;
+  mapSubscription_t m_mapSubscription;
+
+  static key_t Key( date_t date ) { return date.day_number(); }
+  const Smile* Find( date_t ) const;
+
+};
+
+} // namespace option
+} // namespace tf
+} // namespace ou
+
+#endif /* SURFACE_H */
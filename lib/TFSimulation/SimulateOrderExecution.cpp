@@ -23,8 +23,56 @@ namespace tf { // TradeFrame
 
 int SimulateOrderExecution::m_nExecId( 1000 );
 
+SimulateOrderExecution::Book::Book( void )
+: m_tickBase( 0 ), m_tickLow( 0 ), m_tickHigh( 0 ), m_nOrders( 0 )
+{
+}
+
+SimulateOrderExecution::lLevel_iter_t SimulateOrderExecution::Book::Insert( int64_t tick, const structEntry& entry ) {
+  if ( m_dequeLevel.empty() ) {
+    m_tickBase = tick;
+    m_dequeLevel.push_back( lLevel_t() );
+  }
+  else {
+    while ( tick < m_tickBase ) {
+      m_dequeLevel.push_front( lLevel_t() );
+      --m_tickBase;
+    }
+    while ( tick >= ( m_tickBase + (int64_t)m_dequeLevel.size() ) ) {
+      m_dequeLevel.push_back( lLevel_t() );
+    }
+  }
+  if ( 0 == m_nOrders ) {
+    m_tickLow = m_tickHigh = tick;
+  }
+  else {
+    if ( tick < m_tickLow ) m_tickLow = tick;
+    if ( tick > m_tickHigh ) m_tickHigh = tick;
+  }
+  ++m_nOrders;
+  lLevel_t& level( Level( tick ) );
+  return level.insert( level.end(), entry );
+}
+
+void SimulateOrderExecution::Book::Erase( int64_t tick, lLevel_iter_t iter ) {
+  assert( 0 < m_nOrders );
+  Level( tick ).erase( iter );
+  --m_nOrders;
+  if ( 0 == m_nOrders ) {
+    m_dequeLevel.clear();  // start fresh around the next price, keeps the span from creeping with the market
+  }
+  else {
+    if ( tick == m_tickLow ) {
+      while ( Level( m_tickLow ).empty() ) ++m_tickLow;
+    }
+    if ( tick == m_tickHigh ) {
+      while ( Level( m_tickHigh ).empty() ) --m_tickHigh;
+    }
+  }
+}
+
 SimulateOrderExecution::SimulateOrderExecution(void)
-: m_dtQueueDelay( milliseconds( 500 ) ), m_dblCommission( 1.00 )//, m_ea( EAQuotes )
+: m_dtQueueDelay( milliseconds( 500 ) ), m_dblCommission( 1.00 ), m_dblTickSize( 0.0 )//, m_ea( EAQuotes )
 {
 }
 
@@ -42,6 +90,9 @@ void SimulateOrderExecution::NewQuote( const Quote& quote ) {
 
 void SimulateOrderExecution::SubmitOrder( pOrder_t pOrder ) {
   m_lOrderDelay.push_back( pOrder );
+  std::pair<mapLocator_t::iterator,bool> pair
+    = m_mapLocator.insert( mapLocator_t::value_type( pOrder->GetOrderId(), structLocator( --m_lOrderDelay.end() ) ) );
+  assert( pair.second );
 }
 
 void SimulateOrderExecution::CancelOrder( Order::idOrder_t nOrderId ) {
@@ -49,6 +100,17 @@ void SimulateOrderExecution::CancelOrder( Order::idOrder_t nOrderId ) {
   m_lCancelDelay.push_back( co );
 }
 
+SimulateOrderExecution::Book& SimulateOrderExecution::BookFor( EWhere where ) {
+  switch ( where ) {
+    case EWhere::Ask: return m_bookAsks;
+    case EWhere::Bid: return m_bookBids;
+    case EWhere::SellStop: return m_bookSellStops;
+    case EWhere::BuyStop: return m_bookBuyStops;
+    default:
+      throw std::runtime_error( "SimulateOrderExecution::BookFor not a book" );
+  }
+}
+
 void SimulateOrderExecution::CalculateCommission( Order* pOrder, Trade::tradesize_t quan ) {
   // Order or CInstrument should have commission calculation?
   if ( 0 != quan ) {
@@ -150,57 +212,93 @@ bool SimulateOrderExecution::ProcessMarketOrders( const Quote& quote ) {
     // what happens on cancelled orders and partial fills?
     if ( 0 == nOrderQuanRemaining ) {
       CalculateCommission( pOrderFrontOfQueue.get(), pOrderFrontOfQueue->GetQuanFilled() );
+      m_mapLocator.erase( pOrderFrontOfQueue->GetOrderId() );
       m_lOrderMarket.pop_front();
     }
   }
   return bProcessed;
 }
 
+void SimulateOrderExecution::Fill( const pOrder_t& pOrder, double dblPrice, Trade::tradesize_t quan, const char* szDescription ) {
+  if ( 0 != OnOrderFill ) {
+    std::string id;
+    GetExecId( &id );
+    Execution exec( dblPrice, quan, pOrder->GetOrderSide(), szDescription, id );
+    OnOrderFill( pOrder->GetOrderId(), exec );
+  }
+  else {
+    throw std::runtime_error( "no onorderfill to keep housekeeping in place" );
+  }
+}
+
+Trade::tradesize_t SimulateOrderExecution::FillLevel(
+  Book& book, int64_t tick, double dblPrice, Trade::tradesize_t quan, const char* szDescription, bool bQueue
+) {
+
+  Trade::tradesize_t nUsed( 0 );
+  lLevel_t& level( book.Level( tick ) );
+  lLevel_iter_t iter = level.begin();
+
+  while ( ( level.end() != iter ) && ( nUsed < quan ) ) {
+    const Trade::tradesize_t nReaching = quan - nUsed;  // what gets past our own orders earlier in the level
+    structEntry& entry( *iter );
+    if ( bQueue && ( entry.nAhead >= nReaching ) ) {
+      entry.nAhead -= nReaching;  // still working through the queue
+      ++iter;
+    }
+    else {
+      const Trade::tradesize_t nAvail = bQueue ? ( nReaching - entry.nAhead ) : nReaching;
+      entry.nAhead = 0;
+      pOrder_t pOrder( entry.pOrder );  // held across the erase
+      const Trade::tradesize_t nOrderQuanRemaining = pOrder->GetQuanRemaining();
+      assert( 0 != nOrderQuanRemaining );
+      const Trade::tradesize_t nFill = std::min<Trade::tradesize_t>( nAvail, nOrderQuanRemaining );
+      Fill( pOrder, dblPrice, nFill, szDescription );
+      nUsed += nFill;
+      if ( nFill == nOrderQuanRemaining ) {
+        CalculateCommission( pOrder.get(), pOrder->GetQuanFilled() );
+        m_mapLocator.erase( pOrder->GetOrderId() );
+        book.Erase( tick, iter++ );
+        if ( book.Empty() ) break;  // levels have been released
+      }
+    }
+  }
+
+  return nUsed;
+}
+
 bool SimulateOrderExecution::ProcessLimitOrders( const Quote& quote ) {
 
-  pOrder_t pOrderFrontOfQueue; // change this so we reference the order directly, makes things a bit faster
   bool bProcessed = false;
-  boost::uint32_t nOrderQuanRemaining = 0;
 
   // todo: what about self's own crossing orders, could fill with out qoute
 
-  if ( !m_mapAsks.empty() ) {
-    if ( quote.Bid() >= m_mapAsks.begin()->first ) { 
+  // quote crossing resting orders fills at the quote, ahead of any queue, best prices first
+  if ( !m_bookAsks.Empty() ) {
+    const int64_t tickBid = Tick( quote.Bid() );
+    Trade::tradesize_t nAvail = quote.BidSize();
+    while ( !m_bookAsks.Empty() && ( 0 < nAvail ) && ( m_bookAsks.Low() <= tickBid ) ) {
+      nAvail -= FillLevel( m_bookAsks, m_bookAsks.Low(), quote.Bid(), nAvail, "SIMLmtSell", false );
       bProcessed = true;
-      pOrderFrontOfQueue = m_mapAsks.begin()->second;
-      nOrderQuanRemaining = pOrderFrontOfQueue->GetQuanRemaining();
-      assert( 0 != nOrderQuanRemaining );
-      Trade::tradesize_t quanAvail = std::min<Trade::tradesize_t>( nOrderQuanRemaining, quote.BidSize() );
-      if ( 0 != OnOrderFill ) {
-        std::string id;
-        GetExecId( &id );
-        Execution exec( quote.Bid(), quanAvail, OrderSide::Sell, "SIMLmtSell", id );
-        OnOrderFill( pOrderFrontOfQueue->GetOrderId(), exec );
-        nOrderQuanRemaining -= quanAvail;
-        if ( 0 == nOrderQuanRemaining ) {
-          CalculateCommission( pOrderFrontOfQueue.get(), pOrderFrontOfQueue->GetQuanFilled() );
-          m_mapAsks.erase( m_mapAsks.begin() );
-        }
+    }
+    // quantity ahead shrinks with the displayed size at the inside (cancels assumed ahead of us)
+    if ( !m_bookAsks.Empty() && ( Tick( quote.Ask() ) == m_bookAsks.Low() ) ) {
+      for ( structEntry& entry: m_bookAsks.Level( m_bookAsks.Low() ) ) {
+        entry.nAhead = std::min<Trade::tradesize_t>( entry.nAhead, quote.AskSize() );
       }
     }
   }
-  if ( !m_mapBids.empty() && !bProcessed) {
-    if ( quote.Ask() <= m_mapBids.rbegin()->first ) {
+
+  if ( !m_bookBids.Empty() ) {
+    const int64_t tickAsk = Tick( quote.Ask() );
+    Trade::tradesize_t nAvail = quote.AskSize();
+    while ( !m_bookBids.Empty() && ( 0 < nAvail ) && ( m_bookBids.High() >= tickAsk ) ) {
+      nAvail -= FillLevel( m_bookBids, m_bookBids.High(), quote.Ask(), nAvail, "SIMLmtBuy", false );
       bProcessed = true;
-      pOrderFrontOfQueue = m_mapBids.rbegin()->second;
-      nOrderQuanRemaining = pOrderFrontOfQueue->GetQuanRemaining();
-      assert( 0 != nOrderQuanRemaining );
-      Trade::tradesize_t quanAvail = std::min<Trade::tradesize_t>( nOrderQuanRemaining, quote.AskSize() );
-      if ( 0 != OnOrderFill ) {
-        std::string id;
-        GetExecId( &id );
-        Execution exec( quote.Ask(), quanAvail, OrderSide::Buy, "SIMLmtBuy", id );
-        OnOrderFill( pOrderFrontOfQueue->GetOrderId(), exec );
-        nOrderQuanRemaining -= quanAvail;
-        if ( 0 == nOrderQuanRemaining ) {
-          CalculateCommission( pOrderFrontOfQueue.get(), pOrderFrontOfQueue->GetQuanFilled() );
-          m_mapBids.erase( --m_mapBids.rbegin().base() );
-        }
+    }
+    if ( !m_bookBids.Empty() && ( Tick( quote.Bid() ) == m_bookBids.High() ) ) {
+      for ( structEntry& entry: m_bookBids.Level( m_bookBids.High() ) ) {
+        entry.nAhead = std::min<Trade::tradesize_t>( entry.nAhead, quote.BidSize() );
       }
     }
   }
@@ -208,22 +306,92 @@ bool SimulateOrderExecution::ProcessLimitOrders( const Quote& quote ) {
   return bProcessed;
 }
 
+// trade volume at a resting order's price works through the queue ahead of the order first,
+//   trading through the price fills the order at its limit
 bool SimulateOrderExecution::ProcessLimitOrders( const Trade& trade ) {
-  //bool bAllow( true );
-  double bid( trade.Price() );
-  double ask( trade.Price() );
-  if ( !m_mapAsks.empty() ) {
-    if ( m_lastQuote.Ask() <= m_mapAsks.begin()->first ) {
-      ask = m_lastQuote.Ask();
+
+  bool bProcessed = false;
+
+  if ( !m_bookAsks.Empty() ) {
+    const int64_t tickTrade = Tick( trade.Price() );
+    Trade::tradesize_t nAvail = trade.Volume();
+    while ( !m_bookAsks.Empty() && ( 0 < nAvail ) && ( m_bookAsks.Low() <= tickTrade ) ) {
+      const int64_t tick = m_bookAsks.Low();
+      const double dblPrice = m_bookAsks.Level( tick ).front().pOrder->GetPrice1();
+      const Trade::tradesize_t nUsed = FillLevel( m_bookAsks, tick, dblPrice, nAvail, "SIMLmtSell", tick == tickTrade );
+      if ( 0 != nUsed ) bProcessed = true;
+      nAvail -= nUsed;
+      if ( tick == tickTrade ) break;
     }
   }
-  if ( !m_mapBids.empty() ) {
-    if ( m_lastQuote.Bid() >= m_mapBids.rbegin()->first ) {
-      bid = m_lastQuote.Bid();
+
+  if ( !m_bookBids.Empty() ) {
+    const int64_t tickTrade = Tick( trade.Price() );
+    Trade::tradesize_t nAvail = trade.Volume();
+    while ( !m_bookBids.Empty() && ( 0 < nAvail ) && ( m_bookBids.High() >= tickTrade ) ) {
+      const int64_t tick = m_bookBids.High();
+      const double dblPrice = m_bookBids.Level( tick ).front().pOrder->GetPrice1();
+      const Trade::tradesize_t nUsed = FillLevel( m_bookBids, tick, dblPrice, nAvail, "SIMLmtBuy", tick == tickTrade );
+      if ( 0 != nUsed ) bProcessed = true;
+      nAvail -= nUsed;
+      if ( tick == tickTrade ) break;
     }
   }
-  Quote quote( trade.DateTime(), bid, trade.Volume(), ask, trade.Volume() );
-  return ProcessLimitOrders( quote );
+
+  return bProcessed;
+}
+
+void SimulateOrderExecution::Rest( const pOrder_t& pOrder, const Quote& quote ) {
+
+  assert( 0 < pOrder->GetPrice1() );
+
+  if ( 0.0 == m_dblTickSize ) {
+    m_dblTickSize = pOrder->GetInstrument()->GetMinTick();
+    if ( 0.0 >= m_dblTickSize ) m_dblTickSize = 0.01;
+  }
+
+  const int64_t tick = Tick( pOrder->GetPrice1() );
+  Trade::tradesize_t nAhead( 0 );  // depth behind the inside is not visible, no queue assumed there
+
+  EWhere where;
+  switch ( pOrder->GetOrderType() ) {
+    case OrderType::Limit:
+      switch ( pOrder->GetOrderSide() ) {
+        case OrderSide::Buy:
+          where = EWhere::Bid;
+          if ( Tick( quote.Bid() ) == tick ) nAhead = quote.BidSize();  // joining the inside
+          break;
+        case OrderSide::Sell:
+          where = EWhere::Ask;
+          if ( Tick( quote.Ask() ) == tick ) nAhead = quote.AskSize();
+          break;
+        default:
+          m_mapLocator.erase( pOrder->GetOrderId() );
+          return;
+      }
+      break;
+    case OrderType::Stop:
+      switch ( pOrder->GetOrderSide() ) {
+        case OrderSide::Buy:
+          where = EWhere::BuyStop;
+          break;
+        case OrderSide::Sell:
+          where = EWhere::SellStop;
+          break;
+        default:
+          m_mapLocator.erase( pOrder->GetOrderId() );
+          return;
+      }
+      break;
+    default:
+      m_mapLocator.erase( pOrder->GetOrderId() );
+      return;
+  }
+
+  structLocator& locator( m_mapLocator.at( pOrder->GetOrderId() ) );
+  locator.where = where;
+  locator.tick = tick;
+  locator.iterLevel = BookFor( where ).Insert( tick, structEntry( pOrder, nAhead ) );
 }
 
 void SimulateOrderExecution::ProcessDelayQueue( const Quote& quote ) {
@@ -241,49 +409,24 @@ void SimulateOrderExecution::ProcessDelayQueue( const Quote& quote ) {
       switch ( pOrderFrontOfQueue->GetOrderType() ) {
         case OrderType::Market:
           // place into market order book
-          if ( 0 == m_lOrderMarket.size() ) {
+          if ( m_lOrderMarket.empty() || ( pOrderFrontOfQueue->GetOrderSide() == m_lOrderMarket.front()->GetOrderSide() ) ) {
             m_lOrderMarket.push_back( pOrderFrontOfQueue );
+            structLocator& locator( m_mapLocator.at( pOrderFrontOfQueue->GetOrderId() ) );
+            locator.where = EWhere::Market;
+            locator.iterQueue = --m_lOrderMarket.end();
           }
           else {
-            if ( pOrderFrontOfQueue->GetOrderSide() == m_lOrderMarket.front()->GetOrderSide() ) {
-              m_lOrderMarket.push_back( pOrderFrontOfQueue );
-            }
-            else {
-              // can't have market orders in two different directions
-              if ( 0 != OnOrderCancelled ) OnOrderCancelled( pOrderFrontOfQueue->GetOrderId() );
-            }
+            // can't have market orders in two different directions
+            m_mapLocator.erase( pOrderFrontOfQueue->GetOrderId() );
+            if ( 0 != OnOrderCancelled ) OnOrderCancelled( pOrderFrontOfQueue->GetOrderId() );
           }
-          
           break;
         case OrderType::Limit:
-          // place into limit book
-          assert( 0 < pOrderFrontOfQueue->GetPrice1() );
-          switch ( pOrderFrontOfQueue->GetOrderSide() ) {
-            case OrderSide::Buy:
-              m_mapBids.insert( mapOrderBook_pair_t( pOrderFrontOfQueue->GetPrice1(), pOrderFrontOfQueue ) );
-              break;
-            case OrderSide::Sell:
-              m_mapAsks.insert( mapOrderBook_pair_t( pOrderFrontOfQueue->GetPrice1(), pOrderFrontOfQueue ) );
-              break;
-            default:
-              break;
-          }
-          break;
         case OrderType::Stop:
-          // place into stop book
-          assert( 0 < pOrderFrontOfQueue->GetPrice1() );
-          switch ( pOrderFrontOfQueue->GetOrderSide() ) {
-            case OrderSide::Buy:
-              m_mapBuyStops.insert( mapOrderBook_pair_t( pOrderFrontOfQueue->GetPrice1(), pOrderFrontOfQueue ) );
-              break;
-            case OrderSide::Sell:
-              m_mapSellStops.insert( mapOrderBook_pair_t( pOrderFrontOfQueue->GetPrice1(), pOrderFrontOfQueue ) );
-              break;
-            default:
-              break;
-          }
+          Rest( pOrderFrontOfQueue, quote );  // place into limit or stop book
           break;
         default:
+          m_mapLocator.erase( pOrderFrontOfQueue->GetOrderId() );
           break;
       }
     }
@@ -299,102 +442,47 @@ void SimulateOrderExecution::ProcessCancelQueue( const Quote& quote ) {
       break;  // havn't waited long enough to simulate cancel submission
     }
     else {
-      structCancelOrder& co = m_lCancelDelay.front();  // capture the information
-      bool bOrderFound = false;
-
-      // need a fusion array based upon orders so can zero in on order without looping through all the structures
+      const Order::idOrder_t nOrderId = m_lCancelDelay.front().nOrderId;  // capture the information
+      m_lCancelDelay.pop_front();  // remove from list
 
-      // check the delay queue
-      for ( lOrderQueue_iter_t iter = m_lOrderDelay.begin(); iter != m_lOrderDelay.end(); ++iter ) {
-        if ( co.nOrderId == (*iter)->GetOrderId() ) {
-          m_lOrderDelay.erase( iter );
-          bOrderFound = true;
-          break;
-        }
+      mapLocator_t::iterator iterLocator = m_mapLocator.find( nOrderId );
+      if ( m_mapLocator.end() == iterLocator ) {  // need an event for this, as it could be legitimate crossing execution prior to cancel
+        // todo:  propogate this into the OrderManager
+        if ( 0 != OnNoOrderFound ) OnNoOrderFound( nOrderId );
       }
-
-      // check the market order queue
-      if ( !bOrderFound ) {
-        for ( lOrderQueue_iter_t iter = m_lOrderMarket.begin(); iter != m_lOrderMarket.end(); ++iter ) {
-          if ( co.nOrderId == (*iter)->GetOrderId() ) {
-            if ( co.nOrderId == m_lOrderMarket.front()->GetOrderId() ) { // check order front of queue
-              boost::uint32_t nOrderQuanProcessed = (*iter)->GetQuanFilled();
-              if ( 0 != nOrderQuanProcessed ) {  // partially processed order, so commission it out before full cancel
-                CalculateCommission( (*iter).get(), nOrderQuanProcessed );
-              }
-            }
-            m_lOrderMarket.erase( iter );
-            bOrderFound = true;
+      else {
+        structLocator& locator( iterLocator->second );
+        switch ( locator.where ) {
+          case EWhere::Delay:
+            m_lOrderDelay.erase( locator.iterQueue );
             break;
-          }
-        }
-      }
-
-      // need to check orders in ask limit list
-      if ( !bOrderFound ) { 
-        for ( mapOrderBook_iter_t iter = m_mapAsks.begin(); iter != m_mapAsks.end(); ++iter ) {
-          if ( co.nOrderId == iter->second->GetOrderId() ) {
-            if ( co.nOrderId == m_mapAsks.begin()->second->GetOrderId() ) {
-              boost::uint32_t nOrderQuanProcessed = iter->second->GetQuanFilled();
+          case EWhere::Market:
+            {
+              boost::uint32_t nOrderQuanProcessed = (*locator.iterQueue)->GetQuanFilled();
               if ( 0 != nOrderQuanProcessed ) {  // partially processed order, so commission it out before full cancel
-                CalculateCommission( iter->second.get(), nOrderQuanProcessed );
+                CalculateCommission( (*locator.iterQueue).get(), nOrderQuanProcessed );
               }
+              m_lOrderMarket.erase( locator.iterQueue );
             }
-            m_mapAsks.erase( iter );
-            bOrderFound = true;
             break;
-          }
-        }
-      }
-
-      // need to check orders in bid limit list
-      if ( !bOrderFound ) { 
-        for ( mapOrderBook_iter_t iter = m_mapBids.begin(); iter != m_mapBids.end(); ++iter ) {
-          if ( co.nOrderId == iter->second->GetOrderId() ) {
-            if ( co.nOrderId == m_mapBids.rbegin()->second->GetOrderId() ) {
-              boost::uint32_t nOrderQuanProcessed = iter->second->GetQuanFilled();
+          case EWhere::Ask:
+          case EWhere::Bid:
+            {
+              boost::uint32_t nOrderQuanProcessed = locator.iterLevel->pOrder->GetQuanFilled();
               if ( 0 != nOrderQuanProcessed ) {  // partially processed order, so commission it out before full cancel
-                CalculateCommission( iter->second.get(), nOrderQuanProcessed );
+                CalculateCommission( locator.iterLevel->pOrder.get(), nOrderQuanProcessed );
               }
             }
-            m_mapBids.erase( iter );
-            bOrderFound = true;
-            break;
-          }
-        }
-      }
-
-      // need to check orders in stop list sells
-      if ( !bOrderFound ) { 
-        for ( mapOrderBook_iter_t iter = m_mapSellStops.begin(); iter != m_mapSellStops.end(); ++iter ) {
-          if ( co.nOrderId == iter->second->GetOrderId() ) {
-            m_mapSellStops.erase( iter );
-            bOrderFound = true;
+            BookFor( locator.where ).Erase( locator.tick, locator.iterLevel );
             break;
-          }
-        }
-      }
-
-      // need to check orders in stop list buys
-      if ( !bOrderFound ) { 
-        for ( mapOrderBook_iter_t iter = m_mapBuyStops.begin(); iter != m_mapBuyStops.end(); ++iter ) {
-          if ( co.nOrderId == iter->second->GetOrderId() ) {
-            m_mapBuyStops.erase( iter );
-            bOrderFound = true;
+          case EWhere::SellStop:
+          case EWhere::BuyStop:
+            BookFor( locator.where ).Erase( locator.tick, locator.iterLevel );
             break;
-          }
         }
+        m_mapLocator.erase( iterLocator );
+        if ( 0 != OnOrderCancelled ) OnOrderCancelled( nOrderId );
       }
-
-      if ( !bOrderFound ) {  // need an event for this, as it could be legitimate crossing execution prior to cancel
-//        std::cout << "no order found to cancel: " << co.nOrderId << std::endl;
-        // todo:  propogate this into the OrderManager
-        if ( 0 != OnNoOrderFound ) OnNoOrderFound( co.nOrderId );   
-      }
-      else {
-        if ( 0 != OnOrderCancelled ) OnOrderCancelled( co.nOrderId );
-      }
-      m_lCancelDelay.pop_front();  // remove from list
     }
   }
 
@@ -17,14 +17,16 @@
 // 2012/01/01  could find a way to feed live data in and simulate executions against live quote/tick data
 // is this really needed?  useful if no paper trading available
 
-#include <map>
 #include <list>
+#include <cmath>
+#include <deque>
 #include <string>
+#include <cstdint>
+#include <unordered_map>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 using namespace boost::posix_time;
 using namespace boost::gregorian;
-#include <boost/lexical_cast.hpp>
 
 #include <OUCommon/FastDelegate.h>
 using namespace fastdelegate;
@@ -63,6 +65,7 @@ public:
 
   void SetOrderDelay( const time_duration &dtOrderDelay ) { m_dtQueueDelay = dtOrderDelay; };
   void SetCommission( double Commission ) { m_dblCommission = Commission; };
+  void SetTickSize( double dblTickSize ) { m_dblTickSize = dblTickSize; }; // default: instrument min tick of first order
 
   void NewTrade( const Trade& trade );
   void NewQuote( const Quote& quote );
@@ -88,19 +91,65 @@ protected:
   OnNoOrderFoundHandler OnNoOrderFound;
   OnCommissionHandler OnCommission;
 
+  // the delay is the same for every order and cancel, so expiry order is arrival order:
+  //   the delay queues are fifo, only the front is ever inspected
   typedef std::list<pOrder_t> lOrderQueue_t;
   typedef lOrderQueue_t::iterator lOrderQueue_iter_t;
   std::list<structCancelOrder> m_lCancelDelay; // separate structure for the cancellations, since not an order
   lOrderQueue_t m_lOrderDelay;  // all orders put in delay queue, taken out then processed as limit or market or stop
   lOrderQueue_t m_lOrderMarket;  // market orders to be processed
 
-  typedef std::multimap<double,pOrder_t> mapOrderBook_t;
-  typedef mapOrderBook_t::iterator mapOrderBook_iter_t;
-  typedef std::pair<double,pOrder_t> mapOrderBook_pair_t;
-  mapOrderBook_t m_mapAsks; // lowest at beginning
-  mapOrderBook_t m_mapBids; // highest at end
-  mapOrderBook_t m_mapSellStops;  // pending sell stops, turned into market order when touched
-  mapOrderBook_t m_mapBuyStops;  // pending buy stops, turned into market order when touched
+  struct structEntry {  // resting order
+    pOrder_t pOrder;
+    Trade::tradesize_t nAhead;  // market volume queued ahead at this price, worked off by trades at the price
+    structEntry( pOrder_t pOrder_, Trade::tradesize_t nAhead_ ): pOrder( pOrder_ ), nAhead( nAhead_ ) {};
+  };
+  typedef std::list<structEntry> lLevel_t;  // orders at one price, in time priority
+  typedef lLevel_t::iterator lLevel_iter_t;
+
+  class Book {  // price levels indexed by tick offset, grows at either end as required
+  public:
+    Book( void );
+    bool Empty( void ) const { return 0 == m_nOrders; };
+    int64_t Low( void ) const { return m_tickLow; };  // lowest non-empty level, valid when not Empty
+    int64_t High( void ) const { return m_tickHigh; };  // highest non-empty level, valid when not Empty
+    lLevel_t& Level( int64_t tick ) { return m_dequeLevel[ tick - m_tickBase ]; }; // tick within Low .. High
+    lLevel_iter_t Insert( int64_t tick, const structEntry& entry );
+    void Erase( int64_t tick, lLevel_iter_t iter );
+  private:
+    int64_t m_tickBase;  // tick of m_dequeLevel[ 0 ]
+    int64_t m_tickLow;
+    int64_t m_tickHigh;
+    size_t m_nOrders;
+    std::deque<lLevel_t> m_dequeLevel;  // deque: levels don't move when growing, so entry iterators remain valid
+  };
+
+  Book m_bookAsks; // resting sell limits, best is Low
+  Book m_bookBids; // resting buy limits, best is High
+  Book m_bookSellStops;  // pending sell stops, turned into market order when touched
+  Book m_bookBuyStops;  // pending buy stops, turned into market order when touched
+
+  // where each outstanding order lives, for cancellation without searching
+  enum class EWhere { Delay, Market, Ask, Bid, SellStop, BuyStop };
+  struct structLocator {
+    EWhere where;
+    lOrderQueue_iter_t iterQueue; // Delay, Market
+    int64_t tick;                 // books
+    lLevel_iter_t iterLevel;      // books
+    structLocator( lOrderQueue_iter_t iter ): where( EWhere::Delay ), iterQueue( iter ), tick( 0 ) {};
+  };
+  typedef std::unordered_map<Order::idOrder_t,structLocator> mapLocator_t;
+  mapLocator_t m_mapLocator;
+
+  double m_dblTickSize;
+
+  int64_t Tick( double dblPrice ) const { return (int64_t)std::llround( dblPrice / m_dblTickSize ); };
+  Book& BookFor( EWhere where );
+  void Rest( const pOrder_t& pOrder, const Quote& quote ); // limit or stop leaving the delay queue
+  void Fill( const pOrder_t& pOrder, double dblPrice, Trade::tradesize_t quan, const char* szDescription );
+  // fills orders at a level in time priority, returns quantity used
+  //   bQueue: volume has to work through the market quantity ahead of each order first
+  Trade::tradesize_t FillLevel( Book& book, int64_t tick, double dblPrice, Trade::tradesize_t quan, const char* szDescription, bool bQueue );
 
   void ProcessOrderQueues( const Quote& quote );
   void CalculateCommission( Order* pOrder, Trade::tradesize_t quan );
@@ -113,7 +162,7 @@ protected:
 
   static int m_nExecId;  // static provides unique number across universe of symbols
   void GetExecId( std::string* sId ) { 
-    *sId = boost::lexical_cast<std::string>( m_nExecId++ );
+    *sId = std::to_string( m_nExecId++ );
     assert( 0 != sId->length() );
     return;
   }
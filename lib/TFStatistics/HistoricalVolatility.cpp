@@ -19,12 +19,15 @@
  * Created on May 1, 2019, 10:07 PM
  */
 
+#include <cmath>
+#include <algorithm>
+
 #include "HistoricalVolatility.h"
 
 namespace ou {
 
 HistoricalVolatility::HistoricalVolatility()
-: bFirstFound( false ), dblPrevious {}, nPrices {}, dblSumNatLogReturns {}
+: bFirstFound( false ), dblPrevious {}, nPrices {}, dblSumNatLogReturns {}, dblSumSquaredNatLogReturns {}
 {}
 
 void HistoricalVolatility::operator()( const ou::tf::Bar& bar ) {
@@ -33,7 +36,7 @@ void HistoricalVolatility::operator()( const ou::tf::Bar& bar ) {
     double dblReturn = std::log( dblPrice / dblPrevious );
     dblPrevious = dblPrice;
     dblSumNatLogReturns += dblReturn;
-    vReturns.push_back( dblReturn );
+    dblSumSquaredNatLogReturns += dblReturn * dblReturn;
   }
   else {
     dblPrevious = bar.Close();
@@ -43,15 +46,11 @@ void HistoricalVolatility::operator()( const ou::tf::Bar& bar ) {
 }
 
  HistoricalVolatility::operator double() {
-  double dblSums {};
-  double dblAverage = dblSumNatLogReturns / nPrices;  // might be nPrices - 1 or vReturns.size()
-  std::for_each(
-    vReturns.begin(), vReturns.end(),
-    [&dblSums,dblAverage](double dblReturn){
-      double dblDiff = dblReturn - dblAverage;
-      dblSums += dblDiff * dblDiff;
-    });
-  double dblVariance = dblSums / ( nPrices - 1 );
+  const double nReturns( nPrices - 1 );
+  double dblAverage = dblSumNatLogReturns / nPrices;  // might be nPrices - 1
+  // sum of ( return - average )^2, expanded
+  double dblSums = dblSumSquaredNatLogReturns - 2.0 * dblAverage * dblSumNatLogReturns + nReturns * dblAverage * dblAverage;
+  double dblVariance = std::max( 0.0, dblSums ) / ( nPrices - 1 );
   return std::sqrt( dblVariance );
 }
 
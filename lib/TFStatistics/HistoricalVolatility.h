@@ -24,8 +24,6 @@
 
 // aka std dev?
 
-#include <vector>
-
 #include <TFTimeSeries/DatedDatum.h>
 
 namespace ou {
@@ -41,7 +39,7 @@ private:
   int nPrices;
   double dblPrevious;
   double dblSumNatLogReturns;
-  std::vector<double> vReturns;
+  double dblSumSquaredNatLogReturns; // the deviations are expanded, no second pass over the returns
 };
 
 } // namespace ou
@@ -0,0 +1,187 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RangeVolatility.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFStatistics
+ * Created: May 26, 2020, 09:40
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "RangeVolatility.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace statistics {
+
+namespace {
+  const double c_dblLn2( std::log( 2.0 ) );
+  const double c_dblParkinson( 1.0 / ( 4.0 * c_dblLn2 ) );
+  const double c_dblGarmanKlass( 2.0 * c_dblLn2 - 1.0 );
+}
+
+double RangeVolatility::Estimate::Get( EEstimator estimator ) const {
+  switch ( estimator ) {
+    case EEstimator::CloseToClose:   return dblCloseToClose;
+    case EEstimator::Parkinson:      return dblParkinson;
+    case EEstimator::GarmanKlass:    return dblGarmanKlass;
+    case EEstimator::RogersSatchell: return dblRogersSatchell;
+    case EEstimator::YangZhang:      return dblYangZhang;
+  }
+  return 0.0;
+}
+
+void RangeVolatility::Sums::Add( const Terms& t ) {
+  r += t.r; r2 += t.r * t.r;
+  o += t.o; o2 += t.o * t.o;
+  c += t.c; c2 += t.c * t.c;
+  pk += t.pk; gk += t.gk; rs += t.rs;
+}
+
+void RangeVolatility::Sums::Sub( const Terms& t ) {
+  r -= t.r; r2 -= t.r * t.r;
+  o -= t.o; o2 -= t.o * t.o;
+  c -= t.c; c2 -= t.c * t.c;
+  pk -= t.pk; gk -= t.gk; rs -= t.rs;
+}
+
+RangeVolatility::RangeVolatility( const vWindow_t& vWindow, double dblPeriodsPerYear )
+: m_dblPeriodsPerYear( dblPeriodsPerYear ),
+  m_bPrevious( false ), m_dblPreviousClose {},
+  m_ixNext( 0 ), m_cntTerms( 0 )
+{
+  if ( vWindow.empty() ) {
+    throw std::invalid_argument( "RangeVolatility: no windows" );
+  }
+  size_t nMax( 0 );
+  for ( const size_t n: vWindow ) {
+    if ( 2 > n ) {
+      throw std::invalid_argument( "RangeVolatility: window of less than two bars" );
+    }
+    m_vWindow.emplace_back( structWindow( n ) );
+    nMax = std::max( nMax, n );
+  }
+  m_vTerms.resize( nMax );
+}
+
+RangeVolatility::~RangeVolatility() {}
+
+void RangeVolatility::Reset() {
+  m_bPrevious = false;
+  m_ixNext = 0;
+  m_cntTerms = 0;
+  for ( structWindow& window: m_vWindow ) {
+    window.cntSinceRebuild = 0;
+    window.sums = Sums();
+  }
+}
+
+const RangeVolatility::Terms& RangeVolatility::Back( size_t nAgo ) const {
+  const size_t nRing( m_vTerms.size() );
+  return m_vTerms[ ( m_ixNext + nRing - 1 - nAgo ) % nRing ];
+}
+
+void RangeVolatility::Rebuild( structWindow& window ) {
+  window.sums = Sums();
+  const size_t n( std::min( window.nWindow, m_cntTerms ) );
+  for ( size_t ix = 0; ix < n; ++ix ) {
+    window.sums.Add( Back( ix ) );
+  }
+  window.cntSinceRebuild = 0;
+}
+
+void RangeVolatility::Append( double dblOpen, double dblHigh, double dblLow, double dblClose ) {
+
+  if ( ( 0.0 >= dblOpen ) || ( 0.0 >= dblHigh ) || ( 0.0 >= dblLow ) || ( 0.0 >= dblClose ) ) return;
+
+  if ( !m_bPrevious ) {
+    m_bPrevious = true;
+    m_dblPreviousClose = dblClose;
+    return;
+  }
+
+  Terms terms;
+  const double h( std::log( dblHigh / dblOpen ) );
+  const double l( std::log( dblLow / dblOpen ) );
+  const double c( std::log( dblClose / dblOpen ) );
+  const double hl( h - l );
+  terms.r = std::log( dblClose / m_dblPreviousClose );
+  terms.o = std::log( dblOpen / m_dblPreviousClose );
+  terms.c = c;
+  terms.pk = hl * hl * c_dblParkinson;
+  terms.gk = 0.5 * hl * hl - c_dblGarmanKlass * c * c;
+  terms.rs = h * ( h - c ) + l * ( l - c );
+  m_dblPreviousClose = dblClose;
+
+  const size_t nRing( m_vTerms.size() );
+
+  // retire from each window the bar which falls out of it, before the ring slot is overwritten
+  for ( structWindow& window: m_vWindow ) {
+    if ( window.nWindow <= m_cntTerms ) {
+      window.sums.Sub( m_vTerms[ ( m_ixNext + nRing - window.nWindow ) % nRing ] );
+    }
+  }
+
+  m_vTerms[ m_ixNext ] = terms;
+  m_ixNext = ( m_ixNext + 1 ) % nRing;
+  ++m_cntTerms;
+
+  for ( structWindow& window: m_vWindow ) {
+    window.sums.Add( terms );
+    if ( window.nWindow <= ++window.cntSinceRebuild ) {
+      Rebuild( window );
+    }
+  }
+}
+
+bool RangeVolatility::Calculate( size_t ixWindow, Estimate& estimate ) const {
+
+  const structWindow& window( m_vWindow[ ixWindow ] );
+  if ( window.nWindow > m_cntTerms ) return false;
+
+  const Sums& s( window.sums );
+  const double n( window.nWindow );
+
+  const double varCC( ( s.r2 - s.r * s.r / n ) / ( n - 1.0 ) );
+  const double varO( ( s.o2 - s.o * s.o / n ) / ( n - 1.0 ) );
+  const double varC( ( s.c2 - s.c * s.c / n ) / ( n - 1.0 ) );
+  const double varPK( s.pk / n );
+  const double varGK( s.gk / n );
+  const double varRS( s.rs / n );
+  const double k( 0.34 / ( 1.34 + ( n + 1.0 ) / ( n - 1.0 ) ) );
+  const double varYZ( varO + k * varC + ( 1.0 - k ) * varRS );
+
+  auto annualize = [this]( double var )->double{ return std::sqrt( std::max( 0.0, var ) * m_dblPeriodsPerYear ); };
+
+  estimate.nBars = window.nWindow;
+  estimate.dblCloseToClose = annualize( varCC );
+  estimate.dblParkinson = annualize( varPK );
+  estimate.dblGarmanKlass = annualize( varGK );
+  estimate.dblRogersSatchell = annualize( varRS );
+  estimate.dblYangZhang = annualize( varYZ );
+
+  return true;
+}
+
+double RangeVolatility::Volatility( size_t ixWindow, EEstimator estimator ) const {
+  Estimate estimate;
+  return Calculate( ixWindow, estimate ) ? estimate.Get( estimator ) : 0.0;
+}
+
+} // namespace statistics
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,115 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    RangeVolatility.h
+ * Author:  raymond@burkholder.net
+ * Project: TFStatistics
+ * Created: May 26, 2020, 09:40
+ */
+
+// rolling volatility of one series of bars, over several windows (in bars) at once
+//   close to close, Parkinson, Garman-Klass, Rogers-Satchell and Yang-Zhang
+//   (Yang & Zhang 2000, with their k = 0.34 / ( 1.34 + ( n + 1 ) / ( n - 1 ) ))
+//   each bar is reduced once to its log terms, kept in a ring sized to the longest window,
+//     each window keeps running sums: a bar in, the bar leaving that window out
+//   the sums are rebuilt from the ring once per window length, to flush rounding drift
+//   the first bar only supplies the previous close, bars with a price <= 0 are ignored
+//   results are annualized with periods per year: 252 for daily bars, 252 * 390 for minute bars, ...
+
+#pragma once
+
+#include <vector>
+
+#include <TFTimeSeries/DatedDatum.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace statistics {
+
+class RangeVolatility {
+public:
+
+  enum class EEstimator { CloseToClose, Parkinson, GarmanKlass, RogersSatchell, YangZhang };
+
+  struct Estimate { // annualized
+    size_t nBars;
+    double dblCloseToClose;
+    double dblParkinson;
+    double dblGarmanKlass;
+    double dblRogersSatchell;
+    double dblYangZhang;
+    Estimate(): nBars( 0 ), dblCloseToClose {}, dblParkinson {}, dblGarmanKlass {}, dblRogersSatchell {}, dblYangZhang {} {}
+    double Get( EEstimator ) const;
+  };
+
+  using vWindow_t = std::vector<size_t>;
+
+  RangeVolatility( const vWindow_t& vWindow, double dblPeriodsPerYear = 252.0 ); // windows of 2 or more bars
+  ~RangeVolatility();
+
+  void Append( const ou::tf::Bar& bar ) { Append( bar.Open(), bar.High(), bar.Low(), bar.Close() ); }
+  void Append( double dblOpen, double dblHigh, double dblLow, double dblClose );
+  void Reset();
+
+  size_t Windows() const { return m_vWindow.size(); }
+  size_t Window( size_t ixWindow ) const { return m_vWindow[ ixWindow ].nWindow; }
+  size_t Bars() const { return m_cntTerms; } // bars with terms, since construction or Reset
+
+  bool Calculate( size_t ixWindow, Estimate& ) const; // false until the window is full
+  double Volatility( size_t ixWindow, EEstimator ) const; // 0.0 until the window is full
+
+protected:
+private:
+
+  struct Terms { // one bar
+    double r;  // ln( C / C[-1] ), close to close
+    double o;  // ln( O / C[-1] ), overnight, or across the bar boundary
+    double c;  // ln( C / O )
+    double pk; // ln( H / L )^2 / ( 4 ln 2 )
+    double gk; // 0.5 ln( H / L )^2 - ( 2 ln 2 - 1 ) ln( C / O )^2
+    double rs; // ln( H / O ) ln( H / C ) + ln( L / O ) ln( L / C )
+  };
+
+  struct Sums {
+    double r, r2, o, o2, c, c2, pk, gk, rs;
+    Sums(): r {}, r2 {}, o {}, o2 {}, c {}, c2 {}, pk {}, gk {}, rs {} {}
+    void Add( const Terms& );
+    void Sub( const Terms& );
+  };
+
+  struct structWindow {
+    size_t nWindow;
+    size_t cntSinceRebuild;
+    Sums sums;
+    explicit structWindow( size_t n ): nWindow( n ), cntSinceRebuild( 0 ) {}
+  };
+
+  double m_dblPeriodsPerYear;
+
+  bool m_bPrevious;
+  double m_dblPreviousClose;
+
+  std::vector<Terms> m_vTerms; // ring
+  size_t m_ixNext;   // where the next bar goes in the ring
+  size_t m_cntTerms;
+
+  std::vector<structWindow> m_vWindow;
+
+  const Terms& Back( size_t nAgo ) const; // 0 is the latest
+  void Rebuild( structWindow& );
+};
+
+} // namespace statistics
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,187 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    VolatilityEngine.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFStatistics
+ * Created: May 26, 2020, 13:20
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <TFHDF5TimeSeries/HDF5DataManager.h>
+#include <TFHDF5TimeSeries/HDF5IterateGroups.h>
+#include <TFHDF5TimeSeries/HDF5TimeSeriesContainer.h>
+
+#include "VolatilityEngine.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace statistics {
+
+VolatilityEngine::VolatilityEngine( const vWindow_t& vWindow, double dblPeriodsPerYear, size_t nSecondsPerBar )
+: m_vWindow( vWindow ), m_dblPeriodsPerYear( dblPeriodsPerYear ), m_nSecondsPerBar( nSecondsPerBar )
+{
+  RangeVolatility check( m_vWindow, m_dblPeriodsPerYear ); // throws on bad windows now, rather than on the first symbol
+}
+
+VolatilityEngine::~VolatilityEngine() {}
+
+VolatilityEngine::pSymbol_t VolatilityEngine::Find( const std::string& sName ) const {
+  std::lock_guard<std::mutex> lock( m_mutexMap );
+  mapEntry_t::const_iterator iter = m_mapEntry.find( sName );
+  return ( m_mapEntry.end() == iter ) ? nullptr : iter->second.get();
+}
+
+VolatilityEngine::pSymbol_t VolatilityEngine::Symbol( const std::string& sName ) {
+  std::lock_guard<std::mutex> lock( m_mutexMap );
+  std::unique_ptr<Entry>& pEntry( m_mapEntry[ sName ] );
+  if ( !pEntry ) {
+    pEntry = std::make_unique<Entry>( m_vWindow, m_dblPeriodsPerYear );
+  }
+  return pEntry.get();
+}
+
+void VolatilityEngine::Append( pSymbol_t pEntry, const ou::tf::Bar& bar ) {
+  std::lock_guard<std::mutex> lock( pEntry->mutex );
+  pEntry->rv.Append( bar );
+}
+
+void VolatilityEngine::Append( pSymbol_t pEntry, const ou::tf::Trade& trade ) {
+  std::lock_guard<std::mutex> lock( pEntry->mutex );
+  if ( !pEntry->pLadder ) { // the ladder is owned by the entry, and called under its lock
+    pEntry->pLadder = std::make_unique<ou::tf::BarLadder>(
+      ou::tf::BarLadder::vResolution_t( 1, ou::tf::BarLadder::Resolution::Seconds( m_nSecondsPerBar ) ),
+      [pEntry]( size_t, const ou::tf::Bar& bar ){ pEntry->rv.Append( bar ); } );
+  }
+  pEntry->pLadder->Add( trade );
+}
+
+void VolatilityEngine::Flush() {
+  std::vector<pSymbol_t> vEntry;
+  {
+    std::lock_guard<std::mutex> lock( m_mutexMap );
+    vEntry.reserve( m_mapEntry.size() );
+    for ( const mapEntry_t::value_type& vt: m_mapEntry ) vEntry.push_back( vt.second.get() );
+  }
+  for ( pSymbol_t pEntry: vEntry ) {
+    std::lock_guard<std::mutex> lock( pEntry->mutex );
+    if ( pEntry->pLadder ) pEntry->pLadder->Flush();
+  }
+}
+
+void VolatilityEngine::Load( const std::string& sName, const ou::tf::Bars& bars ) {
+  RangeVolatility rv( m_vWindow, m_dblPeriodsPerYear ); // built without the lock
+  for ( ou::tf::Bars::const_iterator iter = bars.begin(); bars.end() != iter; ++iter ) {
+    rv.Append( *iter );
+  }
+  pSymbol_t pEntry( Symbol( sName ) );
+  std::lock_guard<std::mutex> lock( pEntry->mutex );
+  pEntry->rv = std::move( rv );
+  if ( pEntry->pLadder ) pEntry->pLadder->Reset();
+}
+
+size_t VolatilityEngine::Load( const std::string& sPath, ptime dtBegin, ptime dtEnd, size_t nThreads ) {
+
+  struct Series {
+    std::string sPath;
+    std::string sName;
+  };
+  std::vector<Series> vSeries;
+
+  ou::tf::hdf5::IterateGroups ig(
+    sPath,
+    []( const std::string&, const std::string& ){},
+    [&vSeries]( const std::string& sObjectPath, const std::string& sObjectName ){
+      vSeries.push_back( Series{ sObjectPath, sObjectName } );
+    } );
+
+  if ( 0 == nThreads ) {
+    nThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+  }
+  nThreads = std::max<size_t>( 1, std::min( nThreads, vSeries.size() ) );
+
+  ou::tf::HDF5DataManager dm( ou::tf::HDF5DataManager::RO );
+  std::mutex mutexHdf5;
+  std::atomic<size_t> ixNext( 0 );
+  std::atomic<size_t> cntLoaded( 0 );
+
+  auto worker =
+    [this,&vSeries,&dm,&mutexHdf5,&ixNext,&cntLoaded,dtBegin,dtEnd](){
+      ou::tf::Bars bars;
+      for ( size_t ix = ixNext++; ix < vSeries.size(); ix = ixNext++ ) {
+        const Series& series( vSeries[ ix ] );
+        try {
+          std::lock_guard<std::mutex> lock( mutexHdf5 );
+          ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar> repository( dm, series.sPath );
+          ou::tf::HDF5TimeSeriesContainer<ou::tf::Bar>::iterator begin, end;
+          begin = std::lower_bound( repository.begin(), repository.end(), dtBegin );
+          end   = std::lower_bound( begin, repository.end(), dtEnd );
+          bars.Clear();
+          bars.Resize( end - begin );
+          repository.Read( begin, end, &bars );
+        }
+        catch ( std::exception& e ) {
+          std::cout << "VolatilityEngine::Load " << series.sPath << ": " << e.what() << std::endl;
+          continue;
+        }
+        Load( series.sName, bars );
+        ++cntLoaded;
+      }
+    };
+
+  if ( 1 == nThreads ) {
+    worker();
+  }
+  else {
+    std::vector<std::thread> vThread;
+    vThread.reserve( nThreads );
+    for ( size_t ix = 0; ix < nThreads; ++ix ) {
+      vThread.emplace_back( worker );
+    }
+    for ( std::thread& thread: vThread ) {
+      thread.join();
+    }
+  }
+
+  return cntLoaded.load();
+}
+
+bool VolatilityEngine::Calculate( pSymbol_t pEntry, size_t ixWindow, Estimate& estimate ) const {
+  std::lock_guard<std::mutex> lock( pEntry->mutex );
+  return pEntry->rv.Calculate( ixWindow, estimate );
+}
+
+bool VolatilityEngine::Calculate( const std::string& sName, size_t ixWindow, Estimate& estimate ) const {
+  pSymbol_t pEntry( Find( sName ) );
+  return ( nullptr == pEntry ) ? false : Calculate( pEntry, ixWindow, estimate );
+}
+
+double VolatilityEngine::Volatility( const std::string& sName, size_t ixWindow, EEstimator estimator ) const {
+  Estimate estimate;
+  return Calculate( sName, ixWindow, estimate ) ? estimate.Get( estimator ) : 0.0;
+}
+
+size_t VolatilityEngine::Symbols() const {
+  std::lock_guard<std::mutex> lock( m_mutexMap );
+  return m_mapEntry.size();
+}
+
+} // namespace statistics
+} // namespace tf
+} // namespace ou
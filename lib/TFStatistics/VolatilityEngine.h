@@ -0,0 +1,103 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    VolatilityEngine.h
+ * Author:  raymond@burkholder.net
+ * Project: TFStatistics
+ * Created: May 26, 2020, 13:20
+ */
+
+// RangeVolatility for a universe of symbols, by name, all with the same windows and bar width
+//   streaming: Append bars, or trades which are made into bars of nSecondsPerBar with a BarLadder
+//   batch: Load every bar series under an hdf5 group (eg /bar/86400/), replacing what was there;
+//     the hdf5 library is not thread safe, so series are read one at a time and
+//     the estimates are computed on the worker threads
+//   symbols are independent, each has its own lock, Append and the queries may come from any thread
+//   a symbol is looked up by name on each call, or once with Symbol() for a handle, valid for the engine's life
+//   Volatility( sName, ... ) suits option::Engine::SetVolatilityEstimate as the solver's starting guess
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <TFTimeSeries/TimeSeries.h>
+#include <TFTimeSeries/BarLadder.h>
+
+#include "RangeVolatility.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+namespace statistics {
+
+class VolatilityEngine {
+public:
+
+  using EEstimator = RangeVolatility::EEstimator;
+  using Estimate = RangeVolatility::Estimate;
+  using vWindow_t = RangeVolatility::vWindow_t;
+  using ptime = boost::posix_time::ptime;
+
+  struct Entry;
+  using pSymbol_t = Entry*;
+
+  VolatilityEngine( const vWindow_t& vWindow, double dblPeriodsPerYear = 252.0, size_t nSecondsPerBar = 86400 );
+  ~VolatilityEngine();
+
+  pSymbol_t Symbol( const std::string& sName ); // added if not present
+
+  void Append( pSymbol_t, const ou::tf::Bar& );
+  void Append( pSymbol_t, const ou::tf::Trade& );
+  void Append( const std::string& sName, const ou::tf::Bar& bar ) { Append( Symbol( sName ), bar ); }
+  void Append( const std::string& sName, const ou::tf::Trade& trade ) { Append( Symbol( sName ), trade ); }
+  void Flush(); // complete the trade bars in progress, as at the end of a session
+
+  void Load( const std::string& sName, const ou::tf::Bars& ); // replaces the symbol's state
+  // every series under sPath with bars in [dtBegin, dtEnd), nThreads of 0 uses the hardware concurrency
+  size_t Load( const std::string& sPath, ptime dtBegin, ptime dtEnd, size_t nThreads = 0 ); // returns series loaded
+
+  bool Calculate( pSymbol_t, size_t ixWindow, Estimate& ) const; // false if the window is not full
+  bool Calculate( const std::string& sName, size_t ixWindow, Estimate& ) const; // false if unknown, or the window not full
+  double Volatility( const std::string& sName, size_t ixWindow, EEstimator ) const; // 0.0 if not available
+
+  size_t Symbols() const;
+  size_t Windows() const { return m_vWindow.size(); }
+
+  struct Entry {
+    mutable std::mutex mutex;
+    RangeVolatility rv;
+    std::unique_ptr<ou::tf::BarLadder> pLadder; // on the first trade
+    Entry( const vWindow_t& vWindow, double dblPeriodsPerYear ): rv( vWindow, dblPeriodsPerYear ) {}
+  };
+
+protected:
+private:
+
+  using mapEntry_t = std::unordered_map<std::string, std::unique_ptr<Entry> >; // entries are not removed
+
+  const vWindow_t m_vWindow;
+  const double m_dblPeriodsPerYear;
+  const size_t m_nSecondsPerBar;
+
+  mutable std::mutex m_mutexMap; // the map only, not the entries
+  mapEntry_t m_mapEntry;
+
+  pSymbol_t Find( const std::string& ) const;
+};
+
+} // namespace statistics
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,230 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    BarLadder.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFTimeSeries
+ * Created: May 21, 2020, 10:15
+ */
+
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "BarLadder.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+  const int64_t nSecondsPerDay( 86400 );
+  const double dblRangeEpsilon( 1e-9 ); // prices such as 0.01 are not exact in binary
+  const ptime dtEpoch( boost::gregorian::date( 1970, 1, 1 ) ); // integer seconds are counted from here
+}
+
+BarLadder::BarLadder() {}
+
+BarLadder::BarLadder( const vResolution_t& vResolution, fBarComplete_t&& fBarComplete )
+: m_fBarComplete( std::move( fBarComplete ) )
+{
+  for ( const Resolution& resolution: vResolution ) {
+    Add( resolution );
+  }
+}
+
+BarLadder::~BarLadder() {
+  m_fBarComplete = nullptr;
+}
+
+size_t BarLadder::Add( const Resolution& resolution_ ) {
+  Resolution resolution( resolution_ );
+  switch ( resolution.eBasis ) {
+    case EBasis::Time:
+      resolution.nSize = std::min<uint64_t>( std::max<uint64_t>( 1, resolution.nSize ), nSecondsPerDay );
+      break;
+    case EBasis::Tick:
+    case EBasis::Volume:
+      resolution.nSize = std::max<uint64_t>( 1, resolution.nSize );
+      break;
+    case EBasis::Range:
+      resolution.dblRange = std::max<price_t>( 0.0, resolution.dblRange );
+      break;
+  }
+  m_vRung.emplace_back( Rung( resolution ) );
+  return m_vRung.size() - 1;
+}
+
+BarLadder::seconds_t BarLadder::Seconds( const ptime& dt ) {
+  // a subtraction of tick counts and one division, rather than the calendar arithmetic of date() and time_of_day()
+  const time_duration td( dt - dtEpoch );
+  const seconds_t nSeconds( td.total_seconds() );
+  return ( td.is_negative() && ( td != boost::posix_time::seconds( nSeconds ) ) ) ? nSeconds - 1 : nSeconds; // floor
+}
+
+ptime BarLadder::Time( seconds_t nSeconds ) {
+  return dtEpoch + boost::posix_time::seconds( nSeconds );
+}
+
+void BarLadder::Start( Rung& rung, seconds_t nSeconds, const ptime& dt, price_t price, volume_t volume ) {
+  rung.bActive = true;
+  rung.dblOpen = rung.dblHigh = rung.dblLow = rung.dblClose = price;
+  rung.nVolume = volume;
+  switch ( rung.resolution.eBasis ) {
+    case EBasis::Time:
+      {
+        const seconds_t nWidth( rung.resolution.nSize );
+        seconds_t nTimeOfDay( nSeconds % nSecondsPerDay );
+        if ( 0 > nTimeOfDay ) nTimeOfDay += nSecondsPerDay;
+        const seconds_t nDay( nSeconds - nTimeOfDay );
+        const seconds_t nBegin( ( nTimeOfDay / nWidth ) * nWidth );
+        rung.nBegin = nDay + nBegin;
+        rung.nEnd = nDay + std::min<seconds_t>( nBegin + nWidth, nSecondsPerDay );
+      }
+      break;
+    case EBasis::Tick:
+      rung.nCount = 1;
+      rung.dtStart = dt;
+      break;
+    case EBasis::Volume:
+      rung.nCount = volume;
+      rung.dtStart = dt;
+      break;
+    case EBasis::Range:
+      rung.dtStart = dt;
+      break;
+  }
+}
+
+Bar BarLadder::MakeBar( const Rung& rung ) {
+  return Bar(
+    ( EBasis::Time == rung.resolution.eBasis ) ? Time( rung.nBegin ) : rung.dtStart,
+    rung.dblOpen, rung.dblHigh, rung.dblLow, rung.dblClose, rung.nVolume );
+}
+
+void BarLadder::Complete( size_t ix ) {
+  Rung& rung( m_vRung[ ix ] );
+  rung.bActive = false;
+  if ( nullptr != m_fBarComplete ) {
+    m_fBarComplete( ix, MakeBar( rung ) );
+  }
+}
+
+void BarLadder::Add( const ptime& dt, price_t price, volume_t volume ) {
+
+  const seconds_t nSeconds( Seconds( dt ) );
+
+  for ( size_t ix = 0; ix < m_vRung.size(); ++ix ) {
+    Rung& rung( m_vRung[ ix ] );
+
+    if ( !rung.bActive ) {
+      Start( rung, nSeconds, dt, price, volume );
+    }
+    else {
+      switch ( rung.resolution.eBasis ) {
+        case EBasis::Time:
+          if ( nSeconds >= rung.nEnd ) {
+            Complete( ix );
+            Start( rung, nSeconds, dt, price, volume );
+            continue;
+          }
+          break;
+        case EBasis::Tick:
+          rung.nCount++;
+          break;
+        case EBasis::Volume:
+          rung.nCount += volume;
+          break;
+        case EBasis::Range:
+          if ( ( std::max( rung.dblHigh, price ) - std::min( rung.dblLow, price ) )
+               > ( rung.resolution.dblRange + dblRangeEpsilon ) ) {
+            Complete( ix );
+            Start( rung, nSeconds, dt, price, volume );
+            continue;
+          }
+          break;
+      }
+      if ( price > rung.dblHigh ) rung.dblHigh = price;
+      if ( price < rung.dblLow ) rung.dblLow = price;
+      rung.dblClose = price;
+      rung.nVolume += volume;
+    }
+
+    switch ( rung.resolution.eBasis ) {
+      case EBasis::Tick:
+      case EBasis::Volume:
+        if ( rung.nCount >= rung.resolution.nSize ) {
+          Complete( ix );
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void BarLadder::Advance( const ptime& dt ) {
+  const seconds_t nSeconds( Seconds( dt ) );
+  for ( size_t ix = 0; ix < m_vRung.size(); ++ix ) {
+    const Rung& rung( m_vRung[ ix ] );
+    if ( rung.bActive && ( EBasis::Time == rung.resolution.eBasis ) && ( nSeconds >= rung.nEnd ) ) {
+      Complete( ix );
+    }
+  }
+}
+
+void BarLadder::Flush() {
+  for ( size_t ix = 0; ix < m_vRung.size(); ++ix ) {
+    if ( m_vRung[ ix ].bActive ) {
+      Complete( ix );
+    }
+  }
+}
+
+void BarLadder::Reset() {
+  for ( Rung& rung: m_vRung ) {
+    rung.bActive = false;
+  }
+}
+
+Bar BarLadder::Current( size_t ix ) const {
+  const Rung& rung( m_vRung[ ix ] );
+  if ( rung.bActive ) {
+    return MakeBar( rung );
+  }
+  else {
+    return Bar();
+  }
+}
+
+void BarLadder::Replay( const Trades& trades ) {
+  Reset();
+  for ( const Trade& trade: trades ) {
+    Add( trade.DateTime(), trade.Price(), trade.Volume() );
+  }
+  Flush();
+}
+
+void BarLadder::Build( const vResolution_t& vResolution, const Trades& trades, std::vector<Bars>& vBars ) {
+  vBars.clear();
+  vBars.resize( vResolution.size() );
+  BarLadder ladder(
+    vResolution,
+    [&vBars]( size_t ix, const Bar& bar ){
+      vBars[ ix ].Append( bar );
+    } );
+  ladder.Replay( trades );
+}
+
+} // namespace tf
+} // namespace ou
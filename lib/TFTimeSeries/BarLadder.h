@@ -0,0 +1,129 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    BarLadder.h
+ * Author:  raymond@burkholder.net
+ * Project: TFTimeSeries
+ * Created: May 21, 2020, 10:15
+ */
+
+// one bar aggregator per instrument for a ladder of resolutions, in place of a BarFactory per width
+//   each trade is converted once to integer seconds, each time rung then needs one comparison against
+//     the end of its current interval, a ptime is built only when a bar is emitted
+//   time rungs are aligned on the time of day, as with BarFactory, the last interval ends at midnight,
+//     86400 seconds is a daily bar
+//   tick, volume and range rungs are stamped with the time of their first trade:
+//     a tick bar completes on its n'th trade, a volume bar on the trade reaching its volume (not split),
+//     a range bar when a trade would take it beyond its range, that trade opens the next bar
+//   time bars complete on the first trade of a later interval, or through Advance from a timer
+//   a trade stamped before the current interval (out of order) is added to the current bar
+//   completions, of all rungs, go to the one callback with the index returned by Add( Resolution )
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "TimeSeries.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class BarLadder {
+public:
+
+  using price_t = Bar::price_t;
+  using volume_t = Bar::volume_t;
+
+  enum class EBasis: uint8_t { Time, Tick, Volume, Range };
+
+  struct Resolution {
+    EBasis eBasis;
+    uint64_t nSize; // seconds, trades, or volume
+    price_t dblRange;
+    static Resolution Seconds( uint64_t n ) { return Resolution{ EBasis::Time, n, 0.0 }; }
+    static Resolution Minutes( uint64_t n ) { return Seconds( 60 * n ); }
+    static Resolution Daily() { return Seconds( 86400 ); }
+    static Resolution Ticks( uint64_t n ) { return Resolution{ EBasis::Tick, n, 0.0 }; }
+    static Resolution Volume( uint64_t n ) { return Resolution{ EBasis::Volume, n, 0.0 }; }
+    static Resolution Range( price_t dbl ) { return Resolution{ EBasis::Range, 0, dbl }; }
+  };
+
+  using vResolution_t = std::vector<Resolution>;
+  using fBarComplete_t = std::function<void( size_t ixResolution, const Bar& )>;
+
+  BarLadder();
+  BarLadder( const vResolution_t&, fBarComplete_t&& );
+  virtual ~BarLadder();
+
+  size_t Add( const Resolution& ); // returns the index supplied with completions
+  size_t Size() const { return m_vRung.size(); }
+  const Resolution& GetResolution( size_t ix ) const { return m_vRung[ ix ].resolution; }
+
+  void SetOnBarComplete( fBarComplete_t&& f ) { m_fBarComplete = std::move( f ); }
+
+  void Add( const ptime&, price_t, volume_t );
+  void Add( const Trade& trade ) { Add( trade.DateTime(), trade.Price(), trade.Volume() ); }
+
+  void Advance( const ptime& ); // complete time bars whose interval ended before this time
+  void Flush(); // complete the bars in progress, as at the end of a session
+  void Reset(); // discard the bars in progress
+
+  bool Active( size_t ix ) const { return m_vRung[ ix ].bActive; }
+  Bar Current( size_t ix ) const; // the bar in progress, null if none
+
+  // batch: reset, run the series through the ladder, flush; completions through the callback
+  void Replay( const Trades& );
+  // batch: a bar series per resolution, in the order of vResolution_t
+  static void Build( const vResolution_t&, const Trades&, std::vector<Bars>& );
+
+protected:
+private:
+
+  using seconds_t = int64_t;
+
+  struct Rung {
+    Resolution resolution;
+    bool bActive;
+    seconds_t nBegin; // time rungs: the current interval
+    seconds_t nEnd;
+    uint64_t nCount; // tick rungs: trades, volume rungs: volume
+    ptime dtStart; // other rungs: the first trade
+    price_t dblOpen;
+    price_t dblHigh;
+    price_t dblLow;
+    price_t dblClose;
+    volume_t nVolume;
+    explicit Rung( const Resolution& resolution_ )
+    : resolution( resolution_ ), bActive( false ), nBegin( 0 ), nEnd( 0 ), nCount( 0 ),
+      dblOpen( 0.0 ), dblHigh( 0.0 ), dblLow( 0.0 ), dblClose( 0.0 ), nVolume( 0 )
+    {}
+  };
+
+  using vRung_t = std::vector<Rung>;
+  vRung_t m_vRung;
+
+  fBarComplete_t m_fBarComplete;
+
+  void Start( Rung&, seconds_t, const ptime&, price_t, volume_t );
+  void Complete( size_t ix );
+  static Bar MakeBar( const Rung& );
+
+  static seconds_t Seconds( const ptime& ); // since 1970-01-01, truncated
+  static ptime Time( seconds_t );
+};
+
+} // namespace tf
+} // namespace ou
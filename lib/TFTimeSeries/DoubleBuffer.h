@@ -17,11 +17,13 @@
 #ifndef DOUBLEBUFFER_H
 #define DOUBLEBUFFER_H
 
-#include <vector>
 #include <queue>
+#include <atomic>
+#include <vector>
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -171,6 +173,51 @@ private:
   qDatum_t m_qDatum;
 };
 
+//
+// =================
+//
+
+// Queue for one producer thread and one consumer thread, with no lock in the usual case:
+//   Append goes to a lock free ring, when the ring is full (consumer not keeping up, or not running,
+//   as with a chart not on screen) it spills into a locked overflow queue, and keeps spilling until
+//   the consumer has drained the overflow, so order is preserved
+template<typename datum_t>
+class QueueSingleProducer {
+public:
+  explicit QueueSingleProducer( size_t nCapacity = 1024 ): m_ring( nCapacity ), m_bOverflow( false ) {}
+  virtual ~QueueSingleProducer() {}
+
+  void Append( const datum_t& datum ) { // producer thread
+    if ( !m_bOverflow.load( std::memory_order_acquire ) ) {
+      if ( m_ring.push( datum ) ) return;
+    }
+    boost::lock_guard<boost::mutex> guard( m_mutex );
+    m_qOverflow.push( datum );
+    m_bOverflow.store( true, std::memory_order_release );
+  }
+
+  template<typename Function>
+  void Sync( Function f ) { // consumer thread
+    m_ring.consume_all( f );
+    if ( m_bOverflow.load( std::memory_order_acquire ) ) {
+      boost::lock_guard<boost::mutex> guard( m_mutex );
+      m_ring.consume_all( f ); // anything in the ring precedes the overflow
+      while ( !m_qOverflow.empty() ) {
+        f( m_qOverflow.front() );
+        m_qOverflow.pop();
+      }
+      m_bOverflow.store( false, std::memory_order_release );
+    }
+  }
+
+protected:
+private:
+  boost::lockfree::spsc_queue<datum_t> m_ring;
+  std::atomic<bool> m_bOverflow;
+  boost::mutex m_mutex;
+  std::queue<datum_t> m_qOverflow;
+};
+
 } // namespace tf
 } // namespace ou
 
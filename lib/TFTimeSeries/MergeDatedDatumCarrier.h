@@ -14,7 +14,12 @@
 
 #pragma once
 
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <cstdint>
 #include <stdexcept>
+#include <condition_variable>
 
 #include <OUCommon/FastDelegate.h>
 using namespace fastdelegate;
@@ -27,6 +32,10 @@ using namespace fastdelegate;
 // The current DatedDatum timestamp is maintained for the merge process to figure out which DatedDatum to 
 // send into the merge process
 
+// The timestamp is held as an integer key, converted once per datum, so the merge compares plain integers.
+// A carrier emits a run of datums per call, the merge supplies the key of the next best carrier as the limit,
+// so the per datum cost is a typed loop rather than a virtual call and a re-ordering of the carriers.
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
@@ -34,24 +43,64 @@ class MergeCarrierBase {
   friend class MergeDatedDatums;
 public:
   typedef FastDelegate1<const DatedDatum &> OnDatumHandler;
-  MergeCarrierBase( void ) {};
+  typedef int64_t key_t;
+  static const key_t keyEnd = INT64_MAX;  // carrier has been depleted
+  MergeCarrierBase( void ): m_pDatum( 0 ), m_key( keyEnd ) {};
   virtual ~MergeCarrierBase( void ) {};
-  virtual void ProcessDatum( void ) 
-    { throw std::runtime_error( "ProcessDatum not defined" ); };
+  virtual void Prime( void ) {}; // called at start of merge, carriers not yet holding their first datum obtain it
+  // emit the current datum, then following datums while key < keyLimit (or == keyLimit when bInclusive),
+  //   to a maximum of nMax or the end of the carrier, returns count emitted
+  virtual size_t ProcessRun( key_t keyLimit, bool bInclusive, size_t nMax ) 
+    { throw std::runtime_error( "ProcessRun not defined" ); };
   virtual void Reset( void ) 
     { throw std::runtime_error( "Reset not defined" ); };
+  virtual void Interrupt( void ) {}; // release a carrier waiting on data
   inline const ptime &GetDateTime( void ) { return m_dt; };
   const DatedDatum* GetDatedDatum( void ) const { return m_pDatum; };
-  bool operator<( const MergeCarrierBase& other ) const { return m_dt < other.m_dt; };
-  bool operator<( const MergeCarrierBase* pOther ) const { return m_dt < pOther->m_dt; };
-  static bool lt( MergeCarrierBase* plhs, MergeCarrierBase *prhs ) { return plhs->m_dt < prhs->m_dt; };
+  key_t GetKey( void ) const { return m_key; };
+  static key_t Key( const ptime& dt ) { 
+    static const ptime dtEpoch( boost::gregorian::date( 1970, 1, 1 ) );
+    return ( dt - dtEpoch ).ticks(); 
+  };
 protected:
-  ptime m_dt;  // datetime of datum to be merged (used in comparison)
+  ptime m_dt;  // datetime of datum to be merged
   const DatedDatum* m_pDatum;
+  key_t m_key; // m_dt as integer, used in comparison
   OnDatumHandler OnDatum;
+  void Load( const DatedDatum* pDatum ) {
+    m_pDatum = pDatum;
+    if ( 0 == pDatum ) {
+      m_dt = boost::date_time::special_values::not_a_date_time;
+      m_key = keyEnd;
+    }
+    else {
+      m_dt = pDatum->DateTime();
+      m_key = Key( m_dt );
+    }
+  }
+  template<typename Next>
+  size_t Run( key_t keyLimit, bool bInclusive, size_t nMax, Next next );
 private:
 };
 
+// the typed inner loop shared by the carriers, next() supplies the following datum
+template<typename Next>
+size_t MergeCarrierBase::Run( key_t keyLimit, bool bInclusive, size_t nMax, Next next ) {
+  ou::TimeSource& ts( ou::TimeSource::LocalCommonInstance() );
+  const bool bSimulation( ts.GetSimulationMode() );
+  size_t cnt( 0 );
+  do {
+    if ( bSimulation ) {
+      ts.SetSimulationTime( m_dt );
+    }
+    if ( 0 != OnDatum ) 
+      OnDatum( *m_pDatum );
+    ++cnt;
+    Load( next() );
+  } while ( ( 0 != m_pDatum ) && ( cnt < nMax ) && ( ( m_key < keyLimit ) || ( bInclusive && ( m_key == keyLimit ) ) ) );
+  return cnt;
+}
+
 template<class T> 
 class MergeCarrier: public MergeCarrierBase {
   // T is a DatedDatum type
@@ -59,7 +108,7 @@ class MergeCarrier: public MergeCarrierBase {
 public:
   MergeCarrier<T>( TimeSeries<T>& series, OnDatumHandler function );
   virtual ~MergeCarrier<T>( void );
-  void ProcessDatum( void );
+  size_t ProcessRun( key_t keyLimit, bool bInclusive, size_t nMax );
   void Reset( void );
 protected:
   TimeSeries<T>& m_series;  // series from which a datum is to be merged to output
@@ -72,10 +121,7 @@ MergeCarrier<T>::MergeCarrier( TimeSeries<T>& series, OnDatumHandler function )
 {
   assert( 0 != m_series.Size() );
   OnDatum = function;
-  m_pDatum = m_series.First();  // preload with first datum so we have it's time available for comparison
-  m_dt = ( 0 == m_pDatum ) 
-    ? boost::date_time::special_values::not_a_date_time 
-    : m_pDatum->DateTime();
+  Load( m_series.First() );  // preload with first datum so we have it's time available for comparison
 }
 
 template<class T> 
@@ -83,24 +129,125 @@ MergeCarrier<T>::~MergeCarrier() {
 }
 
 template<class T> 
-void MergeCarrier<T>::ProcessDatum(void) {
-  if ( ou::TimeSource::LocalCommonInstance().GetSimulationMode() ) {
-    ou::TimeSource::LocalCommonInstance().SetSimulationTime( m_pDatum->DateTime() );
-  }
-  if ( 0 != OnDatum ) 
-    OnDatum( *m_pDatum );
-  m_pDatum = m_series.Next();
-  m_dt = ( NULL == m_pDatum ) 
-    ? boost::date_time::special_values::not_a_date_time 
-    : m_pDatum->DateTime();
+size_t MergeCarrier<T>::ProcessRun( key_t keyLimit, bool bInclusive, size_t nMax ) {
+  return Run( keyLimit, bInclusive, nMax, [this](){ return m_series.Next(); } );
 }
 
 template<class T> 
 void MergeCarrier<T>::Reset() {
-  m_pDatum = m_series.First();  // preload with first datum so we have it's time available for comparison
-  m_dt = ( 0 == m_pDatum ) 
-    ? boost::date_time::special_values::not_a_date_time 
-    : m_pDatum->DateTime();
+  Load( m_series.First() );  // preload with first datum so we have it's time available for comparison
+}
+
+// carrier fed from a producer thread (eg, a loader reading a symbol's series),
+//   producer calls Append for each datum in chronological order, then Close
+//   datums are handed across in blocks to keep locking off the per datum path
+//   the merge waits on a carrier which has no datum available and has not been closed
+template<class T>
+class MergeCarrierFeed: public MergeCarrierBase {
+  friend class MergeDatedDatums;
+public:
+  MergeCarrierFeed<T>( OnDatumHandler function, size_t nBlock = 4096 );
+  virtual ~MergeCarrierFeed<T>( void );
+  // producer side
+  void Append( const T& datum );
+  void Close( void );
+  // merge side
+  void Prime( void );
+  size_t ProcessRun( key_t keyLimit, bool bInclusive, size_t nMax );
+  void Interrupt( void );
+protected:
+private:
+  typedef std::vector<T> vDatum_t;
+  const size_t m_nBlock;
+  vDatum_t m_vProducer;  // accessed by producer only
+  vDatum_t m_vConsumer;  // accessed by merge only
+  size_t m_ixConsumer;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<vDatum_t> m_dequeBlock; // hand over
+  bool m_bClosed;
+  bool m_bInterrupted;
+  void HandOver( void );
+  const T* Next( void );
+};
+
+template<class T>
+MergeCarrierFeed<T>::MergeCarrierFeed( OnDatumHandler function, size_t nBlock )
+: MergeCarrierBase(), m_nBlock( nBlock ), m_ixConsumer( 0 ), m_bClosed( false ), m_bInterrupted( false )
+{
+  assert( 0 < m_nBlock );
+  OnDatum = function;
+  m_vProducer.reserve( m_nBlock );
+}
+
+template<class T>
+MergeCarrierFeed<T>::~MergeCarrierFeed() {
+}
+
+template<class T>
+void MergeCarrierFeed<T>::Append( const T& datum ) {
+  m_vProducer.push_back( datum );
+  if ( m_nBlock <= m_vProducer.size() ) {
+    HandOver();
+  }
+}
+
+template<class T>
+void MergeCarrierFeed<T>::Close() {
+  HandOver();
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_bClosed = true;
+  m_cv.notify_one();
+}
+
+template<class T>
+void MergeCarrierFeed<T>::HandOver() {
+  if ( !m_vProducer.empty() ) {
+    vDatum_t v;
+    v.reserve( m_nBlock );
+    v.swap( m_vProducer );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_dequeBlock.push_back( std::move( v ) );
+    m_cv.notify_one();
+  }
+}
+
+template<class T>
+void MergeCarrierFeed<T>::Interrupt() {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_bInterrupted = true;
+  m_cv.notify_one();
+}
+
+template<class T>
+const T* MergeCarrierFeed<T>::Next() {
+  if ( m_ixConsumer < m_vConsumer.size() ) {
+    return &m_vConsumer[ m_ixConsumer++ ];
+  }
+  else {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_cv.wait( lock, [this]{ return !m_dequeBlock.empty() || m_bClosed || m_bInterrupted; } );
+    if ( m_dequeBlock.empty() || m_bInterrupted ) {
+      return 0; // depleted
+    }
+    m_vConsumer.swap( m_dequeBlock.front() );
+    m_dequeBlock.pop_front();
+    lock.unlock();
+    m_ixConsumer = 0;
+    return &m_vConsumer[ m_ixConsumer++ ];
+  }
+}
+
+template<class T>
+void MergeCarrierFeed<T>::Prime() {
+  if ( 0 == m_pDatum ) {
+    Load( Next() );
+  }
+}
+
+template<class T>
+size_t MergeCarrierFeed<T>::ProcessRun( key_t keyLimit, bool bInclusive, size_t nMax ) {
+  return Run( keyLimit, bInclusive, nMax, [this](){ return Next(); } );
 }
 
 } // namespace tf
@@ -16,6 +16,8 @@
 
 //#include "LibCommon/Log.h"
 
+#include <algorithm>
+
 #include "MergeDatedDatums.h"
 
 namespace ou { // One Unified
@@ -31,74 +33,93 @@ MergeDatedDatums::MergeDatedDatums(void)
 }
 
 MergeDatedDatums::~MergeDatedDatums(void) {
-  while ( !m_mhCarriers.Empty() ) {
-    MergeCarrierBase *p = m_mhCarriers.RemoveEnd();
+  for ( MergeCarrierBase* p: m_vCarriers ) {
     delete p;
   }
+  m_vCarriers.clear();
 }
 
 void MergeDatedDatums::Add( TimeSeries<Quote>& series, MergeDatedDatums::OnDatumHandler function) {
-  m_mhCarriers.Append( new MergeCarrier<Quote>( series, function ) );
+  m_vCarriers.push_back( new MergeCarrier<Quote>( series, function ) );
 }
 
 void MergeDatedDatums::Add( TimeSeries<Trade>& series, MergeDatedDatums::OnDatumHandler function) {
-  m_mhCarriers.Append( new MergeCarrier<Trade>( series, function ) );
+  m_vCarriers.push_back( new MergeCarrier<Trade>( series, function ) );
 }
 
 void MergeDatedDatums::Add( TimeSeries<Bar>& series, MergeDatedDatums::OnDatumHandler function) {
-  m_mhCarriers.Append( new MergeCarrier<Bar>( series, function ) );
+  m_vCarriers.push_back( new MergeCarrier<Bar>( series, function ) );
 }
 
 void MergeDatedDatums::Add( TimeSeries<Greek>& series, MergeDatedDatums::OnDatumHandler function) {
-  m_mhCarriers.Append( new MergeCarrier<Greek>( series, function ) );
+  m_vCarriers.push_back( new MergeCarrier<Greek>( series, function ) );
 }
 
 void MergeDatedDatums::Add( TimeSeries<MarketDepth>& series, MergeDatedDatums::OnDatumHandler function) {
-  m_mhCarriers.Append( new MergeCarrier<MarketDepth>( series, function ) );
+  m_vCarriers.push_back( new MergeCarrier<MarketDepth>( series, function ) );
 }
 
-// http://www.codeguru.com/forum/archive/index.php/t-344661.html
+void MergeDatedDatums::Build() {
+  m_vHeap.clear();
+  for ( size_t ix = 0; ix < m_vCarriers.size(); ++ix ) {
+    const MergeCarrierBase::key_t key( m_vCarriers[ ix ]->m_key );
+    if ( MergeCarrierBase::keyEnd != key ) m_vHeap.push_back( Entry{ key, ix } );
+  }
+  std::make_heap( m_vHeap.begin(), m_vHeap.end(), []( const Entry& a, const Entry& b ){ return b < a; } );
+}
 
-/*
-struct SortByMergeCarrier {
-public:
-  SortByMergeCarrier( std::vector<MergeCarrierBase *> *v ): m_v( v ) {};
-  bool operator() ( size_t lhs, size_t rhs ) { return (*m_v)[lhs]->GetDateTime() < (*m_v)[rhs]->GetDateTime(); };
-protected:
-  std::vector<MergeCarrierBase *> *m_v;
-};
-*/
+void MergeDatedDatums::SiftDown() {
+  const size_t n( m_vHeap.size() );
+  const Entry entry( m_vHeap[ 0 ] );
+  size_t ix( 0 );
+  for ( size_t ixChild = 1; ixChild < n; ixChild = 2 * ix + 1 ) {
+    if ( ( ixChild + 1 < n ) && ( m_vHeap[ ixChild + 1 ] < m_vHeap[ ixChild ] ) ) ++ixChild;
+    if ( !( m_vHeap[ ixChild ] < entry ) ) break;
+    m_vHeap[ ix ] = m_vHeap[ ixChild ];
+    ix = ixChild;
+  }
+  m_vHeap[ ix ] = entry;
+}
 
 // be aware that this maybe running in alternate thread
 // the thread is not created in this class 
 // for example, see CSimulationProvider
 void MergeDatedDatums::Run() {
   m_request = eRun;
-  size_t cntCarriers = m_mhCarriers.Size();
-//  LOG << "#carriers: " << cntCarriers;  // need cross thread writing 
-  MergeCarrierBase *pCarrier;
   m_cntProcessedDatums = 0;
   m_state = eRunning;
-  while ( ( 0 != cntCarriers ) && ( eRun == m_request ) ) {  // once all series have been depleted, end of run
-    pCarrier = m_mhCarriers.GetRoot();
-    pCarrier->ProcessDatum();  // automatically loads next datum when done
-    ++m_cntProcessedDatums;
-    if ( NULL == pCarrier->GetDatedDatum() ) {
-      // retire the consumed carrier
-      m_mhCarriers.ArchiveRoot();
-      --cntCarriers;
+  for ( MergeCarrierBase* pCarrier: m_vCarriers ) {
+    pCarrier->Prime();
+  }
+  Build();
+  while ( ( !m_vHeap.empty() ) && ( eRun == m_request ) ) {  // once all series have been depleted, end of run
+    Entry& root( m_vHeap[ 0 ] );
+    MergeCarrierBase* pCarrier( m_vCarriers[ root.ix ] );
+    const size_t n( m_vHeap.size() );
+    if ( 1 == n ) {
+      m_cntProcessedDatums += pCarrier->ProcessRun( MergeCarrierBase::keyEnd, false, nMaxRun );
     }
     else {
-      // reorder the carriers
-      m_mhCarriers.SiftDown();
+      // carrier continues until it passes the next best carrier
+      const Entry& runnerup( ( ( 2 < n ) && ( m_vHeap[ 2 ] < m_vHeap[ 1 ] ) ) ? m_vHeap[ 2 ] : m_vHeap[ 1 ] );
+      m_cntProcessedDatums += pCarrier->ProcessRun( runnerup.key, root.ix < runnerup.ix, nMaxRun );
     }
+    root.key = pCarrier->m_key;
+    if ( MergeCarrierBase::keyEnd == root.key ) { // retire the depleted carrier
+      root = m_vHeap.back();
+      m_vHeap.pop_back();
+      if ( m_vHeap.empty() ) break;
+    }
+    SiftDown();
   }
   m_state = eStopped;
-//  LOG << "Merge stats: " << m_cntProcessedDatums << ", " << m_cntReorders;
 }
 
 void MergeDatedDatums::Stop( void ) {
   m_request = eStop;
+  for ( MergeCarrierBase* pCarrier: m_vCarriers ) {
+    pCarrier->Interrupt();  // feeds may be waiting on their producers
+  }
 }
 
 } // namespace tf
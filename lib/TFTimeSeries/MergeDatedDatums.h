@@ -16,9 +16,6 @@
 
 #include <vector>
 
-// 2012/08/12 could try using std:priority_queue instead or boost::max_heap
-#include <OUCommon/MinHeap.h>
-
 #include <OUCommon/FastDelegate.h>
 using namespace fastdelegate;
 
@@ -43,6 +40,15 @@ public:
   void Add( TimeSeries<Bar>& series, OnDatumHandler );
   void Add( TimeSeries<Greek>& series, OnDatumHandler );
   void Add( TimeSeries<MarketDepth>& series, OnDatumHandler );
+
+  // carrier fed by a producer thread, owned by the merge, producer calls Append .. Close
+  template<class T>
+  MergeCarrierFeed<T>* AddFeed( OnDatumHandler function, size_t nBlock = 4096 ) {
+    MergeCarrierFeed<T>* pCarrier = new MergeCarrierFeed<T>( function, nBlock );
+    m_vCarriers.push_back( pCarrier );
+    return pCarrier;
+  }
+
   void Run( void );
   void Stop( void );
 
@@ -52,7 +58,25 @@ public:
 
 protected:
 
-  ou::CMinHeap<MergeCarrierBase*, MergeCarrierBase> m_mhCarriers;
+  // binary min heap of the carriers by key, held as key and index, so a sift reads the heap only:
+  //   the root is the carrier to emit, the runner up is the better of the root's children,
+  //   the root emits a run until it passes the runner up, then sifts down, usually not far
+  struct Entry {
+    MergeCarrierBase::key_t key;
+    size_t ix;
+    bool operator<( const Entry& rhs ) const { // ties go to the earlier carrier, keeps the merge deterministic
+      return ( key < rhs.key ) || ( ( key == rhs.key ) && ( ix < rhs.ix ) );
+    }
+  };
+  typedef std::vector<MergeCarrierBase*> vCarrier_t;
+  typedef std::vector<Entry> vEntry_t;
+  vCarrier_t m_vCarriers;
+  vEntry_t m_vHeap; // depleted carriers are dropped
+
+  static const size_t nMaxRun = 1024; // bounds a run so Stop is seen promptly
+
+  void Build( void );
+  void SiftDown( void ); // root has a new key
 
   // not all states or commands are implemented yet
   enum enumMergingCommands { eUnknown, eRun, eStop, ePause, eResume, eReset };
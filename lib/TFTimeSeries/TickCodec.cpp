@@ -0,0 +1,391 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    TickCodec.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFTimeSeries
+ * Created: May 20, 2020, 09:40
+ */
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <cstring>
+#include <cassert>
+#include <numeric>
+
+#include "TickCodec.h"
+
+// block: version, varint record count, varint record size, then one column per field,
+//   Price and Integer columns start with the common divisor of their (delta) values
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+
+  const double dblMaxTicks( 4503599627370496.0 ); // 2^52, ticks are exact below this
+
+  inline uint64_t ZigZag( uint64_t n ) { // n holds a two's complement value
+    return ( n << 1 ) ^ ( 0 - ( n >> 63 ) );
+  }
+
+  inline uint64_t UnZigZag( uint64_t n ) {
+    return ( n >> 1 ) ^ ( 0 - ( n & 1 ) );
+  }
+
+  inline uint64_t Magnitude( uint64_t n ) { // of a two's complement value
+    return ( n >> 63 ) ? ( 0 - n ) : n;
+  }
+
+  // running common divisor, n holds a two's complement value
+  inline uint64_t Divisor( uint64_t divisor, uint64_t n ) {
+    const uint64_t m( Magnitude( n ) );
+    if ( ( 0 != divisor ) && ( 0 == ( m % divisor ) ) ) return divisor;
+    return std::gcd( divisor, m );
+  }
+
+  inline int64_t Divide( int64_t n, uint64_t divisor ) {
+    return ( 1 == divisor ) ? n : n / static_cast<int64_t>( divisor );
+  }
+
+  inline uint64_t Integer( const uint8_t* pField, uint32_t nWidth ) { // sign extended
+    if ( 4 == nWidth ) {
+      int32_t n;
+      std::memcpy( &n, pField, 4 );
+      return static_cast<uint64_t>( static_cast<int64_t>( n ) );
+    }
+    else {
+      uint64_t n;
+      std::memcpy( &n, pField, 8 );
+      return n;
+    }
+  }
+
+  inline uint8_t* PutVarint( uint8_t* p, uint64_t n ) {
+    while ( 0x80 <= n ) {
+      *p++ = static_cast<uint8_t>( n ) | 0x80;
+      n >>= 7;
+    }
+    *p++ = static_cast<uint8_t>( n );
+    return p;
+  }
+
+  struct Reader {
+    const uint8_t* p;
+    const uint8_t* const pEnd;
+    bool bOk;
+    Reader( const uint8_t* p_, size_t n ): p( p_ ), pEnd( p_ + n ), bOk( true ) {}
+    uint64_t Varint() {
+      uint64_t n( 0 );
+      for ( unsigned int shift = 0; shift < 64; shift += 7 ) {
+        if ( p == pEnd ) break;
+        const uint8_t b( *p++ );
+        n |= static_cast<uint64_t>( b & 0x7f ) << shift;
+        if ( 0 == ( b & 0x80 ) ) return n;
+      }
+      bOk = false;
+      return 0;
+    }
+    void Bytes( void* pDest, size_t n ) {
+      if ( n <= static_cast<size_t>( pEnd - p ) ) {
+        std::memcpy( pDest, p, n );
+        p += n;
+      }
+      else {
+        bOk = false;
+      }
+    }
+  };
+
+  size_t MaxFieldSize( const TickCodec::Field& field ) {
+    switch ( field.eKind ) {
+      case TickCodec::EKind::Time:
+      case TickCodec::EKind::Integer:
+        return 10;
+      case TickCodec::EKind::Price:
+        return 10; // varint, or escape byte and the double
+      case TickCodec::EKind::Raw:
+      default:
+        return field.nWidth;
+    }
+  }
+
+} // namespace anonymous
+
+void TickCodec::Layout::Append( EKind eKind, uint32_t nWidth ) {
+  vField.push_back( Field{ eKind, nWidth, static_cast<uint32_t>( nRecordSize ) } );
+  nRecordSize += nWidth;
+}
+
+bool TickCodec::Layout::Valid() const {
+  if ( 0 == nRecordSize ) return false;
+  for ( const Field& field: vField ) {
+    if ( nRecordSize < field.nOffset + field.nWidth ) return false;
+    switch ( field.eKind ) {
+      case EKind::Time:
+      case EKind::Price:
+        if ( 8 != field.nWidth ) return false;
+        break;
+      case EKind::Integer:
+        if ( ( 4 != field.nWidth ) && ( 8 != field.nWidth ) ) return false;
+        break;
+      case EKind::Raw:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+TickCodec::Layout TickCodec::Layout::Quote() {
+  Layout layout;
+  layout.Append( EKind::Time, 8 );
+  layout.Append( EKind::Price, 8 );
+  layout.Append( EKind::Price, 8 );
+  layout.Append( EKind::Integer, 4 );
+  layout.Append( EKind::Integer, 4 );
+  return layout;
+}
+
+TickCodec::Layout TickCodec::Layout::Trade() {
+  Layout layout;
+  layout.Append( EKind::Time, 8 );
+  layout.Append( EKind::Price, 8 );
+  layout.Append( EKind::Integer, 4 );
+  return layout;
+}
+
+TickCodec::TickCodec( const Layout& layout, uint32_t nPriceScale )
+: m_layout( layout ), m_nPriceScale( nPriceScale ), m_dblPriceScale( nPriceScale )
+{
+  assert( m_layout.Valid() );
+  assert( 0 < m_nPriceScale );
+}
+
+size_t TickCodec::MaxEncodedSize( size_t nBytes ) const {
+  size_t nPerRecord( 0 );
+  for ( const Field& field: m_layout.vField ) {
+    nPerRecord += MaxFieldSize( field );
+  }
+  return 1 + 10 + 10 + 10 * m_layout.vField.size() + ( nBytes / m_layout.nRecordSize ) * nPerRecord;
+}
+
+size_t TickCodec::Encode( const void* pRecords, size_t nBytes, vByte_t& v ) const {
+  v.resize( MaxEncodedSize( nBytes ) );
+  const size_t n( Encode( pRecords, nBytes, v.data(), v.size() ) );
+  v.resize( n );
+  return n;
+}
+
+size_t TickCodec::Encode( const void* pRecords, size_t nBytes, uint8_t* pOut, size_t nOut ) const {
+
+  if ( 0 != ( nBytes % m_layout.nRecordSize ) ) return 0;
+  if ( nOut < MaxEncodedSize( nBytes ) ) return 0;
+
+  const uint8_t* pBegin( static_cast<const uint8_t*>( pRecords ) );
+  const size_t nRecords( nBytes / m_layout.nRecordSize );
+  const size_t nStride( m_layout.nRecordSize );
+
+  // price in ticks, false when off the grid (or not finite), it is then stored as is
+  auto Ticks = [this]( const uint8_t* pField, int64_t& ticks )->bool {
+    double dblPrice;
+    std::memcpy( &dblPrice, pField, 8 );
+    const double dblTicks( dblPrice * m_dblPriceScale );
+    if ( std::isfinite( dblTicks ) && ( dblMaxTicks > std::fabs( dblTicks ) ) ) {
+      ticks = std::llround( dblTicks );
+      const double dblDecoded( static_cast<double>( ticks ) / m_dblPriceScale );
+      return 0 == std::memcmp( &dblDecoded, &dblPrice, 8 ); // bitwise, keeps -0.0
+    }
+    return false;
+  };
+
+  uint8_t* p( pOut );
+  *p++ = nVersion;
+  p = PutVarint( p, nRecords );
+  p = PutVarint( p, nStride );
+
+  for ( const Field& field: m_layout.vField ) {
+    const uint8_t* pField( pBegin + field.nOffset );
+    switch ( field.eKind ) {
+      case EKind::Time:
+        {
+          uint64_t prev( 0 );
+          uint64_t deltaPrev( 0 );
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            uint64_t t;
+            std::memcpy( &t, pField, 8 );
+            const uint64_t delta( t - prev );
+            p = PutVarint( p, ZigZag( delta - deltaPrev ) );
+            prev = t;
+            deltaPrev = delta;
+          }
+        }
+        break;
+      case EKind::Price:
+        {
+          // first pass for the common divisor of the tick deltas (ES moves in 25 ticks of 0.01)
+          uint64_t divisor( 0 );
+          int64_t ticksPrev( 0 );
+          int64_t ticks;
+          for ( size_t ix = 0; ( ix < nRecords ) && ( 1 != divisor ); ++ix, pField += nStride ) {
+            if ( Ticks( pField, ticks ) ) {
+              divisor = Divisor( divisor, static_cast<uint64_t>( ticks ) - static_cast<uint64_t>( ticksPrev ) );
+              ticksPrev = ticks;
+            }
+          }
+          if ( 0 == divisor ) divisor = 1;
+          p = PutVarint( p, divisor );
+          pField = pBegin + field.nOffset;
+          ticksPrev = 0;
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            if ( Ticks( pField, ticks ) ) {
+              const int64_t delta( static_cast<int64_t>( static_cast<uint64_t>( ticks ) - static_cast<uint64_t>( ticksPrev ) ) );
+              p = PutVarint( p, ZigZag( static_cast<uint64_t>( Divide( delta, divisor ) ) ) << 1 );
+              ticksPrev = ticks;
+            }
+            else {
+              *p++ = 1; // escape
+              std::memcpy( p, pField, 8 );
+              p += 8;
+            }
+          }
+        }
+        break;
+      case EKind::Integer:
+        {
+          // common divisor of the values, sizes are often in round lots
+          uint64_t divisor( 0 );
+          for ( size_t ix = 0; ( ix < nRecords ) && ( 1 != divisor ); ++ix, pField += nStride ) {
+            divisor = Divisor( divisor, Integer( pField, field.nWidth ) );
+          }
+          if ( 0 == divisor ) divisor = 1;
+          p = PutVarint( p, divisor );
+          pField = pBegin + field.nOffset;
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            const int64_t n( static_cast<int64_t>( Integer( pField, field.nWidth ) ) );
+            p = PutVarint( p, ZigZag( static_cast<uint64_t>( Divide( n, divisor ) ) ) );
+          }
+        }
+        break;
+      case EKind::Raw:
+        for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+          std::memcpy( p, pField, field.nWidth );
+          p += field.nWidth;
+        }
+        break;
+    }
+  }
+
+  assert( static_cast<size_t>( p - pOut ) <= nOut );
+  return p - pOut;
+}
+
+size_t TickCodec::DecodedSize( const void* pBlock, size_t nBytes ) {
+  Reader reader( static_cast<const uint8_t*>( pBlock ), nBytes );
+  uint8_t version( 0 );
+  reader.Bytes( &version, 1 );
+  const uint64_t nRecords( reader.Varint() );
+  const uint64_t nStride( reader.Varint() );
+  if ( !reader.bOk || ( nVersion != version ) ) return 0;
+  return nRecords * nStride;
+}
+
+size_t TickCodec::Decode( const void* pBlock, size_t nBytes, vByte_t& v ) const {
+  v.resize( DecodedSize( pBlock, nBytes ) );
+  const size_t n( v.empty() ? 0 : Decode( pBlock, nBytes, v.data(), v.size() ) );
+  v.resize( n );
+  return n;
+}
+
+size_t TickCodec::Decode( const void* pBlock, size_t nBytes, uint8_t* pOut, size_t nOut ) const {
+
+  Reader reader( static_cast<const uint8_t*>( pBlock ), nBytes );
+
+  uint8_t version( 0 );
+  reader.Bytes( &version, 1 );
+  const uint64_t nRecords( reader.Varint() );
+  const uint64_t nStride( reader.Varint() );
+  if ( !reader.bOk || ( nVersion != version ) || ( m_layout.nRecordSize != nStride ) ) return 0;
+  if ( nOut < nRecords * nStride ) return 0;
+
+  size_t nCovered( 0 );
+  for ( const Field& field: m_layout.vField ) nCovered += field.nWidth;
+  if ( nCovered < nStride ) std::memset( pOut, 0, nRecords * nStride ); // padding not described by a field
+
+  for ( const Field& field: m_layout.vField ) {
+    uint8_t* pField( pOut + field.nOffset );
+    switch ( field.eKind ) {
+      case EKind::Time:
+        {
+          uint64_t prev( 0 );
+          uint64_t deltaPrev( 0 );
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            const uint64_t delta( deltaPrev + UnZigZag( reader.Varint() ) );
+            const uint64_t t( prev + delta );
+            std::memcpy( pField, &t, 8 );
+            prev = t;
+            deltaPrev = delta;
+          }
+        }
+        break;
+      case EKind::Price:
+        {
+          const int64_t divisor( reader.Varint() );
+          int64_t ticksPrev( 0 );
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            const uint64_t n( reader.Varint() );
+            if ( 0 == ( n & 1 ) ) {
+              const uint64_t delta( static_cast<uint64_t>( static_cast<int64_t>( UnZigZag( n >> 1 ) ) * divisor ) );
+              const int64_t ticks( static_cast<int64_t>( static_cast<uint64_t>( ticksPrev ) + delta ) );
+              const double dblPrice( static_cast<double>( ticks ) / m_dblPriceScale );
+              std::memcpy( pField, &dblPrice, 8 );
+              ticksPrev = ticks;
+            }
+            else {
+              reader.Bytes( pField, 8 );
+            }
+          }
+        }
+        break;
+      case EKind::Integer:
+        {
+          const int64_t divisor( reader.Varint() );
+          for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+            const uint64_t n( static_cast<uint64_t>( static_cast<int64_t>( UnZigZag( reader.Varint() ) ) * divisor ) );
+            if ( 4 == field.nWidth ) {
+              const int32_t n32( static_cast<int32_t>( n ) );
+              std::memcpy( pField, &n32, 4 );
+            }
+            else {
+              std::memcpy( pField, &n, 8 );
+            }
+          }
+        }
+        break;
+      case EKind::Raw:
+        for ( size_t ix = 0; ix < nRecords; ++ix, pField += nStride ) {
+          reader.Bytes( pField, field.nWidth );
+        }
+        break;
+    }
+    if ( !reader.bOk ) return 0;
+  }
+
+  return reader.bOk ? nRecords * nStride : 0;
+}
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,92 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    TickCodec.h
+ * Author:  raymond@burkholder.net
+ * Project: TFTimeSeries
+ * Created: May 20, 2020, 09:40
+ */
+
+// lossless codec for blocks of packed records, as HDF5 stores Quote, Trade, Bar (a compound type after pack())
+//   records are split into columns, each column coded by what it holds:
+//     Time: the DatedDatum timestamp as int64, delta of delta, zigzag varint
+//     Price: double, delta in ticks of 1 / nPriceScale, zigzag varint,
+//       a price off the grid (or not finite) is escaped and stored as is
+//     Integer: 4 or 8 bytes, zigzag varint of the value (sizes are small, but not ordered)
+//     Raw: copied
+//   a block is self contained, the codec holds no state between blocks
+//   no dependency on a storage library, HDF5TickFilter registers it as an HDF5 filter
+//   little endian records, as written by HDF5 native types on x86
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class TickCodec {
+public:
+
+  enum class EKind: uint8_t { Raw = 0, Time, Price, Integer };
+
+  struct Field {
+    EKind eKind;
+    uint32_t nWidth; // bytes
+    uint32_t nOffset; // in the record
+  };
+
+  struct Layout {
+    std::vector<Field> vField;
+    size_t nRecordSize;
+    Layout(): nRecordSize( 0 ) {}
+    void Append( EKind, uint32_t nWidth ); // at the end of the record
+    bool Valid() const;
+    // packed layouts matching DefineDataType
+    static Layout Quote(); // DateTime, Bid, Ask, BidSize, AskSize
+    static Layout Trade(); // DateTime, Price, Size
+  };
+
+  using vByte_t = std::vector<uint8_t>;
+
+  static const uint8_t nVersion = 1;
+
+  TickCodec( const Layout&, uint32_t nPriceScale ); // nPriceScale: 100 for prices in cents
+
+  const Layout& GetLayout() const { return m_layout; }
+  uint32_t PriceScale() const { return m_nPriceScale; }
+
+  size_t MaxEncodedSize( size_t nBytes ) const;
+
+  // nBytes a multiple of the record size, encoded block replaces the content of v, returns its size, 0 on failure
+  size_t Encode( const void* pRecords, size_t nBytes, vByte_t& v ) const;
+  size_t Encode( const void* pRecords, size_t nBytes, uint8_t* pOut, size_t nOut ) const;
+
+  // decoded records replace the content of v, returns their size, 0 on a malformed block
+  size_t Decode( const void* pBlock, size_t nBytes, vByte_t& v ) const;
+  static size_t DecodedSize( const void* pBlock, size_t nBytes ); // from the block header, 0 if malformed
+  size_t Decode( const void* pBlock, size_t nBytes, uint8_t* pOut, size_t nOut ) const;
+
+protected:
+private:
+
+  const Layout m_layout;
+  const uint32_t m_nPriceScale;
+  const double m_dblPriceScale;
+};
+
+} // namespace tf
+} // namespace ou
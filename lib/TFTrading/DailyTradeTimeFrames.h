@@ -17,10 +17,14 @@
 // timezone reference:
 // https://en.wikipedia.org/wiki/List_of_tz_database_time_zones
 
+#include <atomic>
+
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <OUCommon/TimeSource.h>
 
+#include "SessionScheduler.h"
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
@@ -31,13 +35,26 @@ namespace tf { // TradeFrame
 //  during one shots:  emit event for all DD types
 //  during periods:  simply call the crtp method
 
+// 20200517 Schedule attaches to a shared SessionScheduler session:
+//   transitions arrive from the scheduler's timer wheel (on the thread advancing the scheduler),
+//   TimeTick then only dispatches on the current timeframe, and quiet symbols still transition
+//   the one shots are only flagged by the scheduler thread, they run on the next TimeTick, on the feed thread,
+//     as they did when TimeTick drove the transitions, the timeframe shows BellHeard, Cancel or GoNeutral until then
+//   boundaries which passed before Schedule set the timeframe only, their one shots are not run
+//   the scheduler thread touches only the members of this class, never T, so unsubscribing
+//     in ~DailyTradeTimeFrame, after T is gone, is safe
+
 template<class T> // CRTP type call for the overrides
-class DailyTradeTimeFrame {
+class DailyTradeTimeFrame: private SessionScheduler::Subscriber {
 public:
 
   DailyTradeTimeFrame(void); // uses today's date
   DailyTradeTimeFrame( boost::gregorian::date );  // simulation date
-  virtual ~DailyTradeTimeFrame(void) {};
+  virtual ~DailyTradeTimeFrame(void) { Unschedule(); };
+
+  // boundaries then come from the session, rather than the Set/Init methods
+  void Schedule( SessionScheduler&, SessionScheduler::idSession_t );
+  void Unschedule( void );
 
   template<typename DD>  // DD is DatedDatum construct
   void TimeTick( DD& dd );
@@ -69,7 +86,7 @@ protected:
 
   enum class TimeFrame { Closed, PreRH, BellHeard, PauseForQuotes, RHTrading, Cancel, Cancelling, GoNeutral, GoingNeutral, WaitForRHClose, AfterRH };
 
-  TimeFrame CurrentTimeFrame() const { return m_stateTimeFrame; }
+  TimeFrame CurrentTimeFrame() const { return m_stateTimeFrame.load( std::memory_order_acquire ); }
 
   // per type
   template<typename DD> void HandleCommon( const DD& dd ) {};
@@ -96,15 +113,29 @@ private:
   boost::posix_time::ptime m_dtRHClose;
   boost::posix_time::ptime m_dtMarketClose;
 
-  TimeFrame m_stateTimeFrame;
+  std::atomic<TimeFrame> m_stateTimeFrame;
+
+  SessionScheduler* m_pScheduler;
+  SessionScheduler::idSession_t m_idSession;
+  std::atomic<bool> m_bEndOfMarket; // scheduled: HandleEndOfMarket on the first tick after MarketClose
+
+  enum EOneShot: unsigned int { OneShotBellHeard = 1, OneShotCancel = 2, OneShotGoNeutral = 4 };
+  std::atomic<unsigned int> m_fOneShot; // scheduled: flagged on the scheduler thread, run on the next tick
 
   void InitForUSEquityExchanges( boost::gregorian::date );
 
+  template<typename DD>
+  void ScheduledTimeTick( DD& dd );
+  void OneShots( void );
+
+  void SessionBoundary( SessionScheduler::Boundary, const SessionScheduler::rBoundary_t&, bool bCatchUp ) override;
+
 };
 
 template<class T>
 DailyTradeTimeFrame<T>::DailyTradeTimeFrame( void )
   : m_stateTimeFrame( TimeFrame::Closed )
+  , m_pScheduler( nullptr ), m_idSession( 0 ), m_bEndOfMarket( false ), m_fOneShot( 0 )
   // turn these into traits:  equities, futures, currencies
 {
   InitForUSEquityExchanges( ou::TimeSource::Instance().External().date() );
@@ -113,6 +144,7 @@ DailyTradeTimeFrame<T>::DailyTradeTimeFrame( void )
 template<class T>
 DailyTradeTimeFrame<T>::DailyTradeTimeFrame( boost::gregorian::date date )
   : m_stateTimeFrame( TimeFrame::Closed )
+  , m_pScheduler( nullptr ), m_idSession( 0 ), m_bEndOfMarket( false ), m_fOneShot( 0 )
   // turn these into traits:  equities, futures, currencies
 {
   InitForUSEquityExchanges( date );
@@ -156,10 +188,160 @@ void DailyTradeTimeFrame<T>::InitForUS24HourFutures( boost::gregorian::date date
   m_dtMarketClose         = Normalize( date + boost::gregorian::date_duration(1), boost::posix_time::time_duration( 17, 15,  0 ), "America/New_York" );
 }
 
+template<class T>
+void DailyTradeTimeFrame<T>::Schedule( SessionScheduler& scheduler, SessionScheduler::idSession_t idSession ) {
+  Unschedule();
+  m_pScheduler = &scheduler;
+  m_idSession = idSession;
+  SessionBoundary( SessionScheduler::Boundary::MarketClose, scheduler.Boundaries( idSession ), true ); // start closed, take on the boundaries
+  m_bEndOfMarket = false;
+  scheduler.Subscribe( idSession, this ); // boundaries already passed today are delivered here
+}
+
+template<class T>
+void DailyTradeTimeFrame<T>::Unschedule() {
+  if ( nullptr != m_pScheduler ) {
+    m_pScheduler->Unsubscribe( m_idSession, this );
+    m_pScheduler = nullptr;
+  }
+}
+
+template<class T>
+void DailyTradeTimeFrame<T>::SessionBoundary(
+  SessionScheduler::Boundary boundary, const SessionScheduler::rBoundary_t& rBoundary, bool bCatchUp
+) {
+  // on the scheduler thread: no calls into T, one shots are flagged for the next tick
+  using Boundary = SessionScheduler::Boundary;
+  switch ( boundary ) {
+  case Boundary::MarketOpen:
+    m_stateTimeFrame = TimeFrame::PreRH;
+    break;
+  case Boundary::RHOpen:
+    if ( bCatchUp ) m_stateTimeFrame = TimeFrame::PauseForQuotes;
+    else {
+      m_stateTimeFrame = TimeFrame::BellHeard;
+      m_fOneShot.fetch_or( OneShotBellHeard, std::memory_order_release );
+    }
+    break;
+  case Boundary::StartTrading:
+    m_stateTimeFrame = TimeFrame::RHTrading;
+    break;
+  case Boundary::Cancellation:
+    if ( bCatchUp ) m_stateTimeFrame = TimeFrame::Cancelling;
+    else {
+      m_stateTimeFrame = TimeFrame::Cancel;
+      m_fOneShot.fetch_or( OneShotCancel, std::memory_order_release );
+    }
+    break;
+  case Boundary::GoNeutral:
+    if ( bCatchUp ) m_stateTimeFrame = TimeFrame::GoingNeutral;
+    else {
+      m_stateTimeFrame = TimeFrame::GoNeutral;
+      m_fOneShot.fetch_or( OneShotGoNeutral, std::memory_order_release );
+    }
+    break;
+  case Boundary::WaitForRHClose:
+    m_stateTimeFrame = TimeFrame::WaitForRHClose;
+    break;
+  case Boundary::RHClose:
+    m_stateTimeFrame = TimeFrame::AfterRH;
+    break;
+  case Boundary::MarketClose:
+    // boundaries are those of the next trading date
+    m_dtMarketOpen          = rBoundary[ (size_t)Boundary::MarketOpen ];
+    m_dtRHOpen              = rBoundary[ (size_t)Boundary::RHOpen ];
+    m_dtStartTrading        = rBoundary[ (size_t)Boundary::StartTrading ];
+    m_dtTimeForCancellation = rBoundary[ (size_t)Boundary::Cancellation ];
+    m_dtGoNeutral           = rBoundary[ (size_t)Boundary::GoNeutral ];
+    m_dtWaitForRHClose      = rBoundary[ (size_t)Boundary::WaitForRHClose ];
+    m_dtRHClose             = rBoundary[ (size_t)Boundary::RHClose ];
+    m_dtMarketClose         = rBoundary[ (size_t)Boundary::MarketClose ];
+    m_stateTimeFrame = TimeFrame::Closed;
+    m_fOneShot = 0; // a day with no ticks does not run its one shots after the close
+    m_bEndOfMarket = !bCatchUp;
+    break;
+  }
+}
+
+template<class T>
+void DailyTradeTimeFrame<T>::OneShots() { // on the feed thread, in the order of the boundaries
+  const unsigned int fOneShot( m_fOneShot.exchange( 0, std::memory_order_acq_rel ) );
+  if ( OneShotBellHeard & fOneShot ) {
+    static_cast<T*>(this)->HandleBellHeard();  // one shot
+    TimeFrame tf( TimeFrame::BellHeard );
+    m_stateTimeFrame.compare_exchange_strong( tf, TimeFrame::PauseForQuotes ); // unless a later boundary has passed
+  }
+  if ( OneShotCancel & fOneShot ) {
+    static_cast<T*>(this)->HandleCancel();  // one shot
+    TimeFrame tf( TimeFrame::Cancel );
+    m_stateTimeFrame.compare_exchange_strong( tf, TimeFrame::Cancelling );
+  }
+  if ( OneShotGoNeutral & fOneShot ) {
+    static_cast<T*>(this)->HandleGoNeutral();  // one shot
+    TimeFrame tf( TimeFrame::GoNeutral );
+    m_stateTimeFrame.compare_exchange_strong( tf, TimeFrame::GoingNeutral );
+  }
+}
+
+template<class T>
+template<typename DD>
+void DailyTradeTimeFrame<T>::ScheduledTimeTick( DD& dd ) {
+
+  if ( m_pScheduler->Simulated() ) {
+    m_pScheduler->Advance( dd.DateTime() ); // a single load unless a new resolution tick has been reached
+  }
+
+  static_cast<T*>(this)->HandleCommon( dd );
+
+  if ( 0 != m_fOneShot.load( std::memory_order_relaxed ) ) {
+    OneShots();
+  }
+
+  switch ( m_stateTimeFrame.load( std::memory_order_acquire ) ) {
+  case TimeFrame::Closed:
+    if ( m_bEndOfMarket.load( std::memory_order_relaxed ) && m_bEndOfMarket.exchange( false ) ) {
+      static_cast<T*>(this)->HandleEndOfMarket( dd );
+    }
+    else {
+      static_cast<T*>(this)->HandleMarketClosed( dd );
+    }
+    break;
+  case TimeFrame::PreRH:
+    static_cast<T*>(this)->HandlePreOpen( dd );
+    break;
+  case TimeFrame::BellHeard: // one shot flagged by a boundary passing since OneShots ran
+  case TimeFrame::PauseForQuotes:
+    static_cast<T*>(this)->HandlePauseForQuotes( dd );
+    break;
+  case TimeFrame::RHTrading:
+    static_cast<T*>(this)->HandleRHTrading( dd );
+    break;
+  case TimeFrame::Cancel:
+  case TimeFrame::Cancelling:
+    static_cast<T*>(this)->HandleCancelling( dd );
+    break;
+  case TimeFrame::GoNeutral:
+  case TimeFrame::GoingNeutral:
+    static_cast<T*>(this)->HandleGoingNeutral( dd );
+    break;
+  case TimeFrame::WaitForRHClose:
+    static_cast<T*>(this)->HandleWaitForRHClose( dd );
+    break;
+  case TimeFrame::AfterRH:
+    static_cast<T*>(this)->HandleAfterRH( dd );
+    break;
+  }
+}
+
 template<class T>
 template<typename DD>
 void DailyTradeTimeFrame<T>::TimeTick( DD& dd ) {  // DD is DatedDatum
 
+  if ( nullptr != m_pScheduler ) {
+    ScheduledTimeTick( dd );
+    return;
+  }
+
   std::stringstream ss;
 
   //time_duration td( dd.DateTime().time_of_day() );
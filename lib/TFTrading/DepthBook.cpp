@@ -0,0 +1,302 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    DepthBook.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 19, 2020, 11:05
+ */
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "DepthBook.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+  uint64_t MarketMakerKey( DepthBook::MMID_t mmid, DepthBook::ESide eSide ) {
+    return ( static_cast<uint64_t>( mmid ) << 1 ) | ( ( MarketDepth::Ask == eSide ) ? 1 : 0 );
+  }
+}
+
+DepthBook::DepthBook( price_t dblTickSize, size_t nDepthTicks, size_t nWindow )
+: m_dblTickSize( dblTickSize ), m_nDepthTicks( nDepthTicks ), m_nWindow( nWindow ),
+  m_bid( 1 ), m_ask( -1 ),
+  m_cntRecentre( 0 )
+{
+  assert( 0.0 < m_dblTickSize );
+  assert( 0 < m_nDepthTicks );
+  assert( 8 <= m_nWindow );
+  m_bid.vEntry.resize( m_nWindow );
+  m_ask.vEntry.resize( m_nWindow );
+}
+
+void DepthBook::Clear() {
+  m_mapMarketMaker.clear();
+  for ( Side* pSide: { &m_bid, &m_ask } ) {
+    Side& side( *pSide );
+    std::fill( side.vEntry.begin(), side.vEntry.end(), Entry() );
+    side.vRow.clear();
+    side.keyBase = 0;
+    side.keyBest = keyNone;
+    side.volumeDepth = 0;
+    side.cntOutside = 0;
+  }
+}
+
+int64_t DepthBook::Key( const Side& side, price_t price ) const {
+  return side.sign * std::llround( price / m_dblTickSize );
+}
+
+// the source of a quote (market maker map or row) is updated before Add, and after Remove,
+//   as Recentre rebuilds the window from the sources
+void DepthBook::Apply( const MarketDepth& md ) {
+  if ( MarketDepth::None == md.m_eSide ) return;
+  Side& side( SideOf( md.m_eSide ) );
+  const uint64_t key( MarketMakerKey( md.MMID(), md.m_eSide ) );
+  mapMarketMaker_t::iterator iter = m_mapMarketMaker.find( key );
+  if ( m_mapMarketMaker.end() != iter ) {
+    const MarketMakerQuote quote( iter->second );
+    m_mapMarketMaker.erase( iter );
+    Remove( side, quote.key, quote.volume );
+  }
+  if ( 0 != md.Volume() ) {
+    const MarketMakerQuote quote{ Key( side, md.Price() ), md.Volume() };
+    m_mapMarketMaker.emplace( key, quote );
+    Add( side, quote.key, quote.volume );
+  }
+}
+
+bool DepthBook::Insert( ESide eSide, size_t ixPosition, price_t price, volume_t volume ) {
+  if ( MarketDepth::None == eSide ) return false;
+  Side& side( SideOf( eSide ) );
+  if ( ixPosition > side.vRow.size() ) return false;
+  const Row row{ Key( side, price ), volume };
+  side.vRow.insert( side.vRow.begin() + ixPosition, row );
+  Add( side, row.key, row.volume );
+  return true;
+}
+
+bool DepthBook::Update( ESide eSide, size_t ixPosition, price_t price, volume_t volume ) {
+  if ( MarketDepth::None == eSide ) return false;
+  Side& side( SideOf( eSide ) );
+  if ( ixPosition >= side.vRow.size() ) return false;
+  Row& row( side.vRow[ ixPosition ] );
+  const Row rowOld( row );
+  row.key = keyNone;
+  Remove( side, rowOld.key, rowOld.volume );
+  row.key = Key( side, price );
+  row.volume = volume;
+  Add( side, row.key, row.volume );
+  return true;
+}
+
+bool DepthBook::Delete( ESide eSide, size_t ixPosition ) {
+  if ( MarketDepth::None == eSide ) return false;
+  Side& side( SideOf( eSide ) );
+  if ( ixPosition >= side.vRow.size() ) return false;
+  const Row row( side.vRow[ ixPosition ] );
+  side.vRow.erase( side.vRow.begin() + ixPosition );
+  Remove( side, row.key, row.volume );
+  return true;
+}
+
+void DepthBook::Add( Side& side, int64_t key, volume_t volume ) {
+  if ( ( keyNone == side.keyBest ) && ( 0 == side.cntOutside ) ) {
+    Recentre( side, key ); // first quote on the side
+  }
+  else {
+    if ( key >= side.keyBase + m_nWindow ) {
+      Recentre( side, key ); // a new inside beyond the window
+    }
+    else {
+      if ( key < side.keyBase ) {
+        ++side.cntOutside;
+      }
+      else {
+        Entry& entry( side.vEntry[ key - side.keyBase ] );
+        entry.volume += volume;
+        ++entry.cnt;
+        if ( key > side.keyBest ) {
+          side.keyBest = key;
+          SumDepth( side );
+        }
+        else {
+          if ( key > side.keyBest - m_nDepthTicks ) {
+            side.volumeDepth += volume;
+          }
+        }
+      }
+    }
+  }
+}
+
+void DepthBook::Remove( Side& side, int64_t key, volume_t volume ) {
+  if ( key < side.keyBase ) {
+    assert( 0 < side.cntOutside );
+    --side.cntOutside;
+  }
+  else {
+    assert( InWindow( side, key ) );
+    Entry& entry( side.vEntry[ key - side.keyBase ] );
+    assert( 0 < entry.cnt );
+    assert( volume <= entry.volume );
+    entry.volume -= volume;
+    --entry.cnt;
+    if ( ( key == side.keyBest ) && ( 0 == entry.cnt ) ) {
+      FindBest( side, key - 1 );
+    }
+    else {
+      if ( key > side.keyBest - m_nDepthTicks ) {
+        side.volumeDepth -= volume;
+      }
+    }
+  }
+}
+
+// the inside was emptied, walk towards the base for the next level
+void DepthBook::FindBest( Side& side, int64_t keyFrom ) {
+  for ( int64_t key = keyFrom; key >= side.keyBase; --key ) {
+    if ( 0 != side.vEntry[ key - side.keyBase ].cnt ) {
+      if ( ( 0 != side.cntOutside ) && ( ( key - side.keyBase ) < ( m_nWindow / 8 ) ) ) {
+        Recentre( side, key ); // bring deeper quotes back into the window
+      }
+      else {
+        side.keyBest = key;
+        SumDepth( side );
+      }
+      return;
+    }
+  }
+  if ( 0 == side.cntOutside ) {
+    side.keyBest = keyNone;
+    side.volumeDepth = 0;
+  }
+  else {
+    Recentre( side, keyNone );
+  }
+}
+
+void DepthBook::SumDepth( Side& side ) {
+  side.volumeDepth = 0;
+  const int64_t keyEnd( std::max( side.keyBest - m_nDepthTicks, side.keyBase - 1 ) );
+  for ( int64_t key = side.keyBest; key > keyEnd; --key ) {
+    side.volumeDepth += side.vEntry[ key - side.keyBase ].volume;
+  }
+}
+
+// rebuild the side's window with key, or the largest key held when keyNone, at three quarters up,
+//   leaving room for the inside to improve
+void DepthBook::Recentre( Side& side, int64_t key ) {
+
+  const uint64_t bitSide( ( &side == &m_ask ) ? 1 : 0 );
+
+  if ( keyNone == key ) {
+    for ( const mapMarketMaker_t::value_type& vt: m_mapMarketMaker ) {
+      if ( bitSide == ( vt.first & 1 ) ) key = std::max( key, vt.second.key );
+    }
+    for ( const Row& row: side.vRow ) {
+      key = std::max( key, row.key );
+    }
+    assert( keyNone != key );
+  }
+
+  ++m_cntRecentre;
+
+  std::fill( side.vEntry.begin(), side.vEntry.end(), Entry() );
+  side.keyBase = key - ( 3 * m_nWindow ) / 4;
+  side.keyBest = keyNone;
+  side.cntOutside = 0;
+
+  auto fAdd = [this,&side]( int64_t key, volume_t volume ){
+    if ( key < side.keyBase ) {
+      ++side.cntOutside;
+    }
+    else {
+      assert( InWindow( side, key ) );
+      Entry& entry( side.vEntry[ key - side.keyBase ] );
+      entry.volume += volume;
+      ++entry.cnt;
+      side.keyBest = std::max( side.keyBest, key );
+    }
+  };
+
+  for ( const mapMarketMaker_t::value_type& vt: m_mapMarketMaker ) {
+    if ( bitSide == ( vt.first & 1 ) ) fAdd( vt.second.key, vt.second.volume );
+  }
+  for ( const Row& row: side.vRow ) {
+    if ( keyNone != row.key ) fAdd( row.key, row.volume );
+  }
+
+  if ( keyNone == side.keyBest ) {
+    side.volumeDepth = 0;
+  }
+  else {
+    SumDepth( side );
+  }
+}
+
+double DepthBook::Imbalance() const {
+  const double dblBid( BestBidVolume() );
+  const double dblAsk( BestAskVolume() );
+  const double dblTotal( dblBid + dblAsk );
+  return ( 0.0 == dblTotal ) ? 0.0 : ( dblBid - dblAsk ) / dblTotal;
+}
+
+double DepthBook::DepthImbalance() const {
+  const double dblBid( m_bid.volumeDepth );
+  const double dblAsk( m_ask.volumeDepth );
+  const double dblTotal( dblBid + dblAsk );
+  return ( 0.0 == dblTotal ) ? 0.0 : ( dblBid - dblAsk ) / dblTotal;
+}
+
+double DepthBook::MicroPrice() const {
+  if ( HasBid() && HasAsk() ) {
+    const double dblBidVolume( BestBidVolume() );
+    const double dblAskVolume( BestAskVolume() );
+    const double dblTotal( dblBidVolume + dblAskVolume );
+    if ( 0.0 == dblTotal ) {
+      return ( BestBid() + BestAsk() ) / 2.0;
+    }
+    else {
+      return ( BestBid() * dblAskVolume + BestAsk() * dblBidVolume ) / dblTotal;
+    }
+  }
+  else {
+    return HasBid() ? BestBid() : BestAsk(); // 0.0 when both are empty
+  }
+}
+
+size_t DepthBook::Levels( ESide eSide, size_t n, vLevel_t& vLevel ) const {
+  vLevel.clear();
+  if ( MarketDepth::None == eSide ) return 0;
+  const Side& side( ( MarketDepth::Ask == eSide ) ? m_ask : m_bid );
+  if ( keyNone != side.keyBest ) {
+    for ( int64_t key = side.keyBest; ( key >= side.keyBase ) && ( vLevel.size() < n ); --key ) {
+      const Entry& entry( side.vEntry[ key - side.keyBase ] );
+      if ( 0 != entry.cnt ) {
+        vLevel.push_back( Level{ Price( side, key ), entry.volume, entry.cnt } );
+      }
+    }
+  }
+  return vLevel.size();
+}
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,153 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    DepthBook.h
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 19, 2020, 11:05
+ */
+
+// level 2 book for one symbol, built from MarketDepth updates
+//   each side aggregates into a contiguous array of price levels indexed by tick, a window around the inside,
+//     an update touches one slot, the inside and the depth within n ticks of it are maintained as slots change
+//   two ways of feeding a book, use one or the other:
+//     by market maker (IQFeed level 2, IB market maker depth): Apply, a quote replaces the market maker's
+//       previous quote on that side, a zero volume removes it
+//     by position (IB depth rows): Insert/Update/Delete, position 0 is the inside
+//   quotes which fall outside the window are retained, they are counted in the slots when the window re-centres
+//   not thread safe, feed and query from the provider thread, or lock externally
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <TFTimeSeries/DatedDatum.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class DepthBook {
+public:
+
+  using price_t = MarketDepth::price_t;
+  using volume_t = MarketDepth::volume_t;
+  using MMID_t = MarketDepth::MMID_t;
+  using ESide = MarketDepth::ESide;
+
+  struct Level {
+    price_t price;
+    volume_t volume;
+    unsigned int cnt; // market makers or rows at the price
+  };
+  using vLevel_t = std::vector<Level>;
+
+  // nDepthTicks: span of BidDepth/AskDepth, nWindow: price levels held in each side's array
+  DepthBook( price_t dblTickSize, size_t nDepthTicks = 5, size_t nWindow = 1024 );
+  DepthBook( const DepthBook& ) = delete;
+
+  void Clear();
+
+  price_t TickSize() const { return m_dblTickSize; }
+
+  // by market maker
+  void Apply( const MarketDepth& );
+
+  // by position, false when the position does not exist
+  bool Insert( ESide, size_t ixPosition, price_t, volume_t );
+  bool Update( ESide, size_t ixPosition, price_t, volume_t );
+  bool Delete( ESide, size_t ixPosition );
+
+  bool HasBid() const { return keyNone != m_bid.keyBest; }
+  bool HasAsk() const { return keyNone != m_ask.keyBest; }
+
+  price_t BestBid() const { return HasBid() ? Price( m_bid, m_bid.keyBest ) : 0.0; }
+  price_t BestAsk() const { return HasAsk() ? Price( m_ask, m_ask.keyBest ) : 0.0; }
+  volume_t BestBidVolume() const { return HasBid() ? Slot( m_bid, m_bid.keyBest ).volume : 0; }
+  volume_t BestAskVolume() const { return HasAsk() ? Slot( m_ask, m_ask.keyBest ).volume : 0; }
+
+  volume_t BidDepth() const { return m_bid.volumeDepth; } // volume within nDepthTicks of the inside
+  volume_t AskDepth() const { return m_ask.volumeDepth; }
+
+  double Imbalance() const; // inside volume, -1 (ask heavy) .. 1 (bid heavy)
+  double DepthImbalance() const; // same over nDepthTicks
+  double MicroPrice() const; // inside prices weighted by the opposite side's volume
+
+  size_t Levels( ESide, size_t n, vLevel_t& ) const; // up to n non-empty levels in the window, from the inside out
+
+  size_t Quotes() const { return m_mapMarketMaker.size() + m_bid.vRow.size() + m_ask.vRow.size(); }
+  size_t Recentres() const { return m_cntRecentre; }
+
+protected:
+private:
+
+  static const int64_t keyNone = INT64_MIN;
+
+  struct Entry {
+    volume_t volume;
+    unsigned int cnt;
+    Entry(): volume( 0 ), cnt( 0 ) {}
+  };
+
+  struct Row {
+    int64_t key; // keyNone while being replaced
+    volume_t volume;
+  };
+
+  // key is the tick for bids, the negated tick for asks, so the inside is the largest key on either side
+  struct Side {
+    const int64_t sign;
+    int64_t keyBase; // key of vEntry[ 0 ]
+    int64_t keyBest; // keyNone when empty
+    volume_t volumeDepth;
+    size_t cntOutside; // quotes held but not counted in the window
+    std::vector<Entry> vEntry;
+    std::vector<Row> vRow; // by position
+    explicit Side( int64_t sign_ )
+    : sign( sign_ ), keyBase( 0 ), keyBest( keyNone ), volumeDepth( 0 ), cntOutside( 0 ) {}
+  };
+
+  struct MarketMakerQuote {
+    int64_t key;
+    volume_t volume;
+  };
+  using mapMarketMaker_t = std::unordered_map<uint64_t,MarketMakerQuote>; // ( mmid, side ) -> quote
+
+  const price_t m_dblTickSize;
+  const int64_t m_nDepthTicks;
+  const int64_t m_nWindow;
+
+  Side m_bid;
+  Side m_ask;
+
+  mapMarketMaker_t m_mapMarketMaker;
+
+  size_t m_cntRecentre;
+
+  Side& SideOf( ESide eSide ) { return ( MarketDepth::Ask == eSide ) ? m_ask : m_bid; }
+  int64_t Key( const Side& side, price_t price ) const;
+  price_t Price( const Side& side, int64_t key ) const { return side.sign * key * m_dblTickSize; }
+  bool InWindow( const Side& side, int64_t key ) const { return ( key >= side.keyBase ) && ( key < side.keyBase + m_nWindow ); }
+  const Entry& Slot( const Side& side, int64_t key ) const { return side.vEntry[ key - side.keyBase ]; }
+
+  void Add( Side&, int64_t key, volume_t );
+  void Remove( Side&, int64_t key, volume_t );
+  void FindBest( Side&, int64_t keyFrom );
+  void SumDepth( Side& );
+  void Recentre( Side&, int64_t key );
+};
+
+} // namespace tf
+} // namespace ou
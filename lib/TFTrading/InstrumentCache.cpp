@@ -0,0 +1,361 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    InstrumentCache.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 18, 2020, 09:15
+ */
+
+#include "stdafx.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "InstrumentCache.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+
+  // header: magic, version, byte order check
+  const char rMagic[ 4 ] = { 'T', 'F', 'I', 'C' };
+  const uint32_t nByteOrder = 0x01020304;
+  const size_t nHeader = sizeof( rMagic ) + sizeof( uint32_t ) + sizeof( uint32_t );
+
+  class Writer {
+  public:
+    explicit Writer( std::string& s ): m_s( s ) {}
+    template<typename T>
+    void Pod( T t ) { m_s.append( reinterpret_cast<const char*>( &t ), sizeof( T ) ); }
+    void Str( const std::string& s ) {
+      Pod<uint16_t>( (uint16_t)s.size() );
+      m_s.append( s );
+    }
+  private:
+    std::string& m_s;
+  };
+
+  class Reader {
+  public:
+    Reader( const char* pBegin, const char* pEnd ): m_p( pBegin ), m_pEnd( pEnd ), m_bOk( true ) {}
+    template<typename T>
+    T Pod() {
+      T t {};
+      if ( m_bOk && ( sizeof( T ) <= (size_t)( m_pEnd - m_p ) ) ) {
+        std::memcpy( &t, m_p, sizeof( T ) );
+        m_p += sizeof( T );
+      }
+      else m_bOk = false;
+      return t;
+    }
+    void Str( std::string& s ) {
+      const uint16_t n( Pod<uint16_t>() );
+      if ( m_bOk && ( n <= (size_t)( m_pEnd - m_p ) ) ) {
+        s.assign( m_p, n );
+        m_p += n;
+      }
+      else m_bOk = false;
+    }
+    bool Ok() const { return m_bOk; }
+  private:
+    const char* m_p;
+    const char* m_pEnd;
+    bool m_bOk;
+  };
+
+  // record: uint32 length of what follows, then the fields, the instrument name first for the index
+  void Encode( const InstrumentCache::Record& record, std::string& s ) {
+    const Instrument::TableRowDef& row( record.row );
+    std::string sPayload;
+    Writer w( sPayload );
+    w.Str( row.idInstrument );
+    w.Pod<int32_t>( row.eType );
+    w.Str( row.sDescription );
+    w.Str( row.idExchange );
+    w.Pod<int32_t>( row.eCurrency );
+    w.Pod<int32_t>( row.eCounterCurrency );
+    w.Pod<int32_t>( row.eOptionSide );
+    w.Pod<uint16_t>( row.nYear );
+    w.Pod<uint16_t>( row.nMonth );
+    w.Pod<uint16_t>( row.nDay );
+    w.Pod<double>( row.dblStrike );
+    w.Pod<int32_t>( row.nIBContract );
+    w.Pod<uint32_t>( row.nMultiplier );
+    w.Pod<double>( row.dblMinTick );
+    w.Pod<uint8_t>( row.nSignificantDigits );
+    w.Pod<uint16_t>( (uint16_t)record.vAlternate.size() );
+    for ( const InstrumentCache::vAlternate_t::value_type& alternate: record.vAlternate ) {
+      w.Pod<int32_t>( alternate.first );
+      w.Str( alternate.second );
+    }
+    Writer( s ).Pod<uint32_t>( (uint32_t)sPayload.size() );
+    s.append( sPayload );
+  }
+
+  void Header( std::string& s ) {
+    s.append( rMagic, sizeof( rMagic ) );
+    Writer w( s );
+    w.Pod<uint32_t>( InstrumentCache::nVersion );
+    w.Pod<uint32_t>( nByteOrder );
+  }
+
+} // namespace anonymous
+
+InstrumentCache::InstrumentCache()
+: m_pBegin( nullptr ), m_pEnd( nullptr ), m_bRewrite( false ), m_cntRecordsInFile( 0 )
+{}
+
+InstrumentCache::~InstrumentCache() {
+  Close();
+}
+
+bool InstrumentCache::Open( const std::string& sPath ) {
+  Close();
+  std::lock_guard<std::mutex> lock( m_mutex );
+  m_sPath = sPath;
+  return Map();
+}
+
+void InstrumentCache::Close() {
+  Flush();
+  std::lock_guard<std::mutex> lock( m_mutex );
+  Unmap();
+  m_mapRecord.clear();
+  m_setDirty.clear();
+  m_sPath.clear();
+}
+
+void InstrumentCache::Unmap() {
+  m_pRegion.reset();
+  m_pFileMapping.reset();
+  m_pBegin = m_pEnd = nullptr;
+  m_mapOffset.clear();
+  m_cntRecordsInFile = 0;
+  m_bRewrite = false;
+}
+
+// builds the index from the snapshot at m_sPath
+bool InstrumentCache::Map() {
+
+  Unmap();
+
+  {
+    std::ifstream file( m_sPath, std::ios::binary | std::ios::ate );
+    if ( !file.is_open() || ( nHeader > (size_t)file.tellg() ) ) return false; // nothing usable, mapping an empty file fails
+  }
+
+  try {
+    m_pFileMapping.reset( new boost::interprocess::file_mapping( m_sPath.c_str(), boost::interprocess::read_only ) );
+    m_pRegion.reset( new boost::interprocess::mapped_region( *m_pFileMapping, boost::interprocess::read_only ) );
+  }
+  catch ( const std::exception& e ) {
+    std::cout << "InstrumentCache::Map " << m_sPath << ": " << e.what() << std::endl;
+    Unmap();
+    return false;
+  }
+
+  const char* pBegin = static_cast<const char*>( m_pRegion->get_address() );
+  const char* pEnd = pBegin + m_pRegion->get_size();
+
+  Reader header( pBegin, pEnd );
+  const bool bMagic( 0 == std::memcmp( pBegin, rMagic, sizeof( rMagic ) ) );
+  header.Pod<uint32_t>(); // magic
+  const uint32_t version( header.Pod<uint32_t>() );
+  const uint32_t order( header.Pod<uint32_t>() );
+  if ( !bMagic || ( nVersion != version ) || ( nByteOrder != order ) ) {
+    std::cout << "InstrumentCache::Map " << m_sPath << ": different version, will be rebuilt" << std::endl;
+    Unmap();
+    m_bRewrite = true;
+    return false;
+  }
+
+  m_pBegin = pBegin;
+  const char* p = pBegin + nHeader;
+  std::string sName;
+  while ( sizeof( uint32_t ) <= (size_t)( pEnd - p ) ) {
+    uint32_t nLength;
+    std::memcpy( &nLength, p, sizeof( nLength ) );
+    const char* pRecord = p + sizeof( nLength );
+    if ( nLength > (size_t)( pEnd - pRecord ) ) break; // torn by an interrupted Flush
+    Reader reader( pRecord, pRecord + nLength );
+    reader.Str( sName );
+    if ( !reader.Ok() ) break;
+    m_mapOffset[ sName ] = p - pBegin; // later records supersede
+    ++m_cntRecordsInFile;
+    p = pRecord + nLength;
+  }
+  m_pEnd = p;
+  m_bRewrite = ( pEnd != p ) || ( m_mapOffset.size() < m_cntRecordsInFile / 2 );
+
+  return true;
+}
+
+bool InstrumentCache::Decode( size_t offset, Record& record ) const {
+
+  uint32_t nLength;
+  std::memcpy( &nLength, m_pBegin + offset, sizeof( nLength ) );
+  const char* pRecord = m_pBegin + offset + sizeof( nLength );
+  Reader r( pRecord, pRecord + nLength );
+
+  Instrument::TableRowDef& row( record.row );
+  r.Str( row.idInstrument );
+  row.eType = static_cast<InstrumentType::enumInstrumentTypes>( r.Pod<int32_t>() );
+  r.Str( row.sDescription );
+  r.Str( row.idExchange );
+  row.eCurrency = static_cast<Currency::enumCurrency>( r.Pod<int32_t>() );
+  row.eCounterCurrency = static_cast<Currency::enumCurrency>( r.Pod<int32_t>() );
+  row.eOptionSide = static_cast<OptionSide::enumOptionSide>( r.Pod<int32_t>() );
+  row.nYear = r.Pod<uint16_t>();
+  row.nMonth = r.Pod<uint16_t>();
+  row.nDay = r.Pod<uint16_t>();
+  row.dblStrike = r.Pod<double>();
+  row.nIBContract = r.Pod<int32_t>();
+  row.nMultiplier = r.Pod<uint32_t>();
+  row.dblMinTick = r.Pod<double>();
+  row.nSignificantDigits = r.Pod<uint8_t>();
+
+  const uint16_t nAlternate( r.Pod<uint16_t>() );
+  record.vAlternate.clear();
+  for ( uint16_t ix = 0; r.Ok() && ( ix < nAlternate ); ++ix ) {
+    const eidProvider_t id( static_cast<eidProvider_t>( r.Pod<int32_t>() ) );
+    std::string sAlternate;
+    r.Str( sAlternate );
+    record.vAlternate.emplace_back( id, std::move( sAlternate ) );
+  }
+
+  return r.Ok();
+}
+
+size_t InstrumentCache::Size() const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  size_t n( m_mapOffset.size() );
+  for ( const mapRecord_t::value_type& vt: m_mapRecord ) {
+    if ( m_mapOffset.end() == m_mapOffset.find( vt.first ) ) ++n;
+  }
+  return n;
+}
+
+bool InstrumentCache::Find( const idInstrument_t& id, Record& record ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  mapRecord_t::const_iterator iterRecord = m_mapRecord.find( id );
+  if ( m_mapRecord.end() != iterRecord ) {
+    record = iterRecord->second;
+    return true;
+  }
+  mapOffset_t::const_iterator iterOffset = m_mapOffset.find( id );
+  if ( m_mapOffset.end() != iterOffset ) {
+    return Decode( iterOffset->second, record );
+  }
+  return false;
+}
+
+void InstrumentCache::Update( const Instrument& instrument ) {
+  Record record;
+  record.row = instrument.GetRow();
+  const_cast<Instrument&>( instrument ).ScanAlternateNames(
+    [&record]( const eidProvider_t& id, const idInstrument_t& sAlternate, const idInstrument_t& ){
+      record.vAlternate.emplace_back( id, sAlternate );
+    } );
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( !m_sPath.empty() ) {
+    const idInstrument_t id( record.row.idInstrument );
+    m_mapRecord[ id ] = std::move( record );
+    m_setDirty.insert( id );
+  }
+}
+
+size_t InstrumentCache::Flush() {
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  if ( m_sPath.empty() || m_setDirty.empty() ) return 0;
+
+  const size_t nDirty( m_setDirty.size() );
+
+  if ( m_bRewrite || ( nullptr == m_pBegin ) ) {
+    CompactLocked();
+  }
+  else {
+    std::string s;
+    for ( const idInstrument_t& id: m_setDirty ) {
+      Encode( m_mapRecord[ id ], s );
+    }
+    std::ofstream file( m_sPath, std::ios::binary | std::ios::app );
+    file.write( s.data(), s.size() );
+    if ( !file ) {
+      std::cout << "InstrumentCache::Flush " << m_sPath << ": write failed" << std::endl;
+      return 0;
+    }
+    m_setDirty.clear();
+  }
+
+  return nDirty;
+}
+
+void InstrumentCache::Compact() {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( !m_sPath.empty() ) {
+    CompactLocked();
+  }
+}
+
+// decode everything, unmap (required before replacing the file on windows), write, rename, map again
+void InstrumentCache::CompactLocked() {
+
+  for ( const mapOffset_t::value_type& vt: m_mapOffset ) {
+    if ( m_mapRecord.end() == m_mapRecord.find( vt.first ) ) {
+      Record record;
+      if ( Decode( vt.second, record ) ) {
+        m_mapRecord.emplace( vt.first, std::move( record ) );
+      }
+    }
+  }
+  Unmap();
+
+  std::string s;
+  Header( s );
+  for ( const mapRecord_t::value_type& vt: m_mapRecord ) {
+    Encode( vt.second, s );
+  }
+
+  const std::string sTemp( m_sPath + ".tmp" );
+  {
+    std::ofstream file( sTemp, std::ios::binary | std::ios::trunc );
+    file.write( s.data(), s.size() );
+    if ( !file ) {
+      std::cout << "InstrumentCache::Compact " << sTemp << ": write failed" << std::endl;
+      return; // records remain in memory
+    }
+  }
+  std::remove( m_sPath.c_str() );
+  if ( 0 != std::rename( sTemp.c_str(), m_sPath.c_str() ) ) {
+    std::cout << "InstrumentCache::Compact " << m_sPath << ": rename failed" << std::endl;
+    return;
+  }
+
+  m_setDirty.clear();
+  if ( Map() ) {
+    m_mapRecord.clear(); // all in the mapping now
+  }
+}
+
+} // namespace tf
+} // namespace ou
@@ -0,0 +1,113 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    InstrumentCache.h
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 18, 2020, 09:15
+ */
+
+// on-disk snapshot of instrument rows and their alternate names, used by InstrumentManager ahead of the database
+//   the file is a versioned header followed by length-prefixed records, memory mapped on Open,
+//     only an index (instrument name -> offset) is built, a record is decoded when it is asked for
+//   updates are appended on Flush, a later record supersedes an earlier one for the same instrument,
+//     Compact rewrites the file with the latest record of each instrument
+//   the snapshot mirrors the database it was built from, remove the file to have it rebuilt
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "KeyTypes.h"
+#include "Instrument.h"
+
+namespace boost {
+namespace interprocess {
+  class file_mapping;
+  class mapped_region;
+}
+}
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class InstrumentCache {
+public:
+
+  using idInstrument_t = keytypes::idInstrument_t;
+  using eidProvider_t = keytypes::eidProvider_t;
+  using vAlternate_t = std::vector<std::pair<eidProvider_t,idInstrument_t> >;
+
+  struct Record {
+    Instrument::TableRowDef row;
+    vAlternate_t vAlternate;
+  };
+
+  static const uint32_t nVersion = 1; // increment when the record layout or TableRowDef changes
+
+  InstrumentCache();
+  InstrumentCache( const InstrumentCache& ) = delete;
+  ~InstrumentCache();
+
+  // false if there is no snapshot or it is from another version, the path is used by Flush regardless
+  bool Open( const std::string& sPath );
+  void Close(); // flushes
+
+  bool IsOpen() const { return !m_sPath.empty(); }
+  size_t Size() const;
+
+  bool Find( const idInstrument_t&, Record& ) const;
+
+  void Update( const Instrument& ); // queued for Flush
+  size_t Flush(); // appends queued records, returns the number written
+  void Compact();
+
+protected:
+private:
+
+  using mapOffset_t = std::unordered_map<idInstrument_t,size_t>; // into the mapping
+  using mapRecord_t = std::unordered_map<idInstrument_t,Record>; // updated since Open
+  using setDirty_t = std::unordered_set<idInstrument_t>;
+
+  mutable std::mutex m_mutex;
+
+  std::string m_sPath;
+
+  std::unique_ptr<boost::interprocess::file_mapping> m_pFileMapping;
+  std::unique_ptr<boost::interprocess::mapped_region> m_pRegion;
+  const char* m_pBegin;
+  const char* m_pEnd; // end of the last complete record
+
+  bool m_bRewrite; // torn tail or superseded records, Flush compacts
+  size_t m_cntRecordsInFile;
+
+  mapOffset_t m_mapOffset;
+  mapRecord_t m_mapRecord;
+  setDirty_t m_setDirty;
+
+  void Unmap();
+  bool Map();
+  bool Decode( size_t offset, Record& ) const;
+  void CompactLocked();
+};
+
+} // namespace tf
+} // namespace ou
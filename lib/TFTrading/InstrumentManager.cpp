@@ -14,8 +14,11 @@
 
 #include "stdafx.h"
 
+#include <thread>
 #include <stdexcept>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/assign/std/vector.hpp>
 using namespace boost::assign;
@@ -30,6 +33,21 @@ using namespace boost::assign;
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+namespace {
+
+  const size_t nBatch = 500; // ids per query, below the sqlite limit on bound variables
+  const size_t nParallel = 1024; // construct in parallel beyond this many
+
+  InstrumentManager::pInstrument_t Construct( const InstrumentCache::Record& record ) {
+    InstrumentManager::pInstrument_t pInstrument( new Instrument( record.row ) );
+    for ( const InstrumentCache::vAlternate_t::value_type& alternate: record.vAlternate ) {
+      pInstrument->SetAlternateName( alternate.first, alternate.second );  // does not signal, RegisterAlternateNames follows the Assign
+    }
+    return pInstrument;
+  }
+
+}
+
 InstrumentManager::InstrumentManager(void) {
 //  file.OpenIQFSymbols();
 }
@@ -113,6 +131,7 @@ void InstrumentManager::Register( pInstrument_t& pInstrument ) {
     pInstrument->ScanAlternateNames( boost::phoenix::bind(
       static_cast<void(InstrumentManager::*)(const keytypes::eidProvider_t&, const keytypes::idInstrument_t&, const keytypes::idInstrument_t&)>(&InstrumentManager::SaveAlternateInstrumentName),
         this, boost::phoenix::arg_names::arg1, boost::phoenix::arg_names::arg2, boost::phoenix::arg_names::arg3 ) );
+    m_cache.Update( *pInstrument );
   }
 }
 
@@ -202,6 +221,22 @@ namespace InstrumentManagerQueries {
     const ou::tf::keytypes::idInstrument_t& idInstrument;
     InstrumentKey( const ou::tf::keytypes::idInstrument_t& idInstrument_ ): idInstrument( idInstrument_ ) {};
   };
+  struct InstrumentKeys { // for 'instrumentid in ( ?, ... )'
+    template<class A>
+    void Fields( A& a ) {
+      for ( ou::tf::keytypes::idInstrument_t& idInstrument: vidInstrument ) {
+        ou::db::Field( a, "instrumentid", idInstrument );
+      }
+    }
+    std::vector<ou::tf::keytypes::idInstrument_t> vidInstrument;
+    std::string Where( void ) const {
+      std::string sWhere( "instrumentid in ( ?" );
+      for ( size_t ix = 1; ix < vidInstrument.size(); ++ix ) sWhere += ", ?";
+      sWhere += " )";
+      return sWhere;
+    }
+    explicit InstrumentKeys( const std::vector<ou::tf::keytypes::idInstrument_t>& vid ): vidInstrument( vid ) {};
+  };
 }
 
 bool InstrumentManager::LoadInstrument( idInstrument_t id, pInstrument_t& pInstrument ) {
@@ -211,6 +246,15 @@ bool InstrumentManager::LoadInstrument( idInstrument_t id, pInstrument_t& pInstr
   assert( m_map.end() == m_map.find( id ) );  // ensures we havn't already loaded an instrument
 
   bool bFound = false;
+
+  InstrumentCache::Record record;
+  if ( m_cache.IsOpen() && m_cache.Find( id, record ) ) {
+    pInstrument = Construct( record );
+    Assign( pInstrument );
+    RegisterAlternateNames( pInstrument );
+    return true;
+  }
+
   InstrumentManagerQueries::InstrumentKey idInstrument( id );
   ou::db::QueryFields<InstrumentManagerQueries::InstrumentKey>::pQueryFields_t pExistsQuery // shouldn't do a * as fields may change order
     = m_pSession->SQL<InstrumentManagerQueries::InstrumentKey>( "select * from instruments", idInstrument ).Where( "instrumentid = ?" ).NoExecute();
@@ -225,6 +269,8 @@ bool InstrumentManager::LoadInstrument( idInstrument_t id, pInstrument_t& pInstr
       pInstrument.reset( new Instrument( instrument ) );
       Assign( pInstrument );
       LoadAlternateInstrumentNames( pInstrument );  // comes after assign
+      RegisterAlternateNames( pInstrument );
+      m_cache.Update( *pInstrument );
       bFound = true;
 //    }
 //    else {
@@ -249,6 +295,119 @@ bool InstrumentManager::LoadInstrument( idInstrument_t id, pInstrument_t& pInstr
   return bFound;
 }
 
+size_t InstrumentManager::Load( const vidInstrument_t& vid, vInstrument_t& vInstrument ) {
+
+  std::lock_guard<std::mutex> lock( m_mutexLoadInstrument );
+
+  // unique ids not yet in the map
+  vidInstrument_t vidMissing;
+  {
+    std::unordered_set<idInstrument_t> setSeen;
+    for ( const idInstrument_t& id: vid ) {
+      if ( ( m_map.end() == m_map.find( id ) ) && setSeen.insert( id ).second ) {
+        vidMissing.push_back( id );
+      }
+    }
+  }
+
+  std::vector<InstrumentCache::Record> vRecord;
+  size_t nFromCache( 0 ); // vRecord[ 0 .. nFromCache ) came from the cache, the remainder from the database
+
+  if ( !vidMissing.empty() && ( nullptr != m_pSession ) ) {
+
+    vidInstrument_t vidQuery;
+    InstrumentCache::Record record;
+    for ( const idInstrument_t& id: vidMissing ) {
+      if ( m_cache.IsOpen() && m_cache.Find( id, record ) ) {
+        vRecord.push_back( std::move( record ) );
+      }
+      else {
+        vidQuery.push_back( id );
+      }
+    }
+    nFromCache = vRecord.size();
+
+    for ( size_t ix = 0; ix < vidQuery.size(); ix += nBatch ) {
+      const vidInstrument_t vidBatch(
+        vidQuery.begin() + ix, vidQuery.begin() + std::min( ix + nBatch, vidQuery.size() ) );
+      LoadRecords( vidBatch, vRecord );
+    }
+  }
+
+  // construction is independent per instrument, registration in the map is not
+  vInstrument_t vConstructed( vRecord.size() );
+  auto construct = [&vRecord,&vConstructed]( size_t ixBegin, size_t ixEnd ){
+    for ( size_t ix = ixBegin; ix < ixEnd; ++ix ) {
+      vConstructed[ ix ] = Construct( vRecord[ ix ] );
+    }
+  };
+  const size_t nThreads( std::max<size_t>( 1, std::thread::hardware_concurrency() ) );
+  if ( ( nParallel > vRecord.size() ) || ( 1 == nThreads ) ) {
+    construct( 0, vRecord.size() );
+  }
+  else {
+    std::vector<std::thread> vThread;
+    const size_t nBlock( ( vRecord.size() + nThreads - 1 ) / nThreads );
+    for ( size_t ix = 0; ix < vRecord.size(); ix += nBlock ) {
+      vThread.emplace_back( construct, ix, std::min( ix + nBlock, vRecord.size() ) );
+    }
+    for ( std::thread& thread: vThread ) thread.join();
+  }
+
+  for ( size_t ix = 0; ix < vConstructed.size(); ++ix ) {
+    Assign( vConstructed[ ix ] );
+    RegisterAlternateNames( vConstructed[ ix ] );
+    if ( nFromCache <= ix ) {
+      m_cache.Update( *vConstructed[ ix ] );
+    }
+  }
+
+  size_t nFound( 0 );
+  vInstrument.assign( vid.size(), pInstrument_t() );
+  for ( size_t ix = 0; ix < vid.size(); ++ix ) {
+    iterMap iter = m_map.find( vid[ ix ] );
+    if ( m_map.end() != iter ) {
+      vInstrument[ ix ] = iter->second;
+      ++nFound;
+    }
+  }
+  return nFound;
+}
+
+// two queries for the batch: the instrument rows, then their alternate names
+void InstrumentManager::LoadRecords( const vidInstrument_t& vid, std::vector<InstrumentCache::Record>& vRecord ) {
+
+  assert( nullptr != m_pSession );
+
+  InstrumentManagerQueries::InstrumentKeys keys( vid );
+  std::unordered_map<idInstrument_t,size_t> mapIndex; // into vRecord
+
+  ou::db::QueryFields<InstrumentManagerQueries::InstrumentKeys>::pQueryFields_t pInstrumentQuery
+    = m_pSession->SQL<InstrumentManagerQueries::InstrumentKeys>( "select * from instruments", keys ).Where( keys.Where() ).NoExecute();
+  m_pSession->Bind<InstrumentManagerQueries::InstrumentKeys>( pInstrumentQuery );
+  Instrument::TableRowDef instrument;
+  while ( m_pSession->Execute( pInstrumentQuery ) ) {
+    m_pSession->Columns<InstrumentManagerQueries::InstrumentKeys, Instrument::TableRowDef>( pInstrumentQuery, instrument );
+    mapIndex[ instrument.idInstrument ] = vRecord.size();
+    vRecord.emplace_back( InstrumentCache::Record() );
+    vRecord.back().row = instrument;
+  }
+
+  if ( mapIndex.empty() ) return;
+
+  ou::db::QueryFields<InstrumentManagerQueries::InstrumentKeys>::pQueryFields_t pAlternateQuery
+    = m_pSession->SQL<InstrumentManagerQueries::InstrumentKeys>( "select * from altinstrumentnames", keys ).Where( keys.Where() ).NoExecute();
+  m_pSession->Bind<InstrumentManagerQueries::InstrumentKeys>( pAlternateQuery );
+  AlternateInstrumentName::TableRowDef altname;
+  while ( m_pSession->Execute( pAlternateQuery ) ) {
+    m_pSession->Columns<InstrumentManagerQueries::InstrumentKeys, AlternateInstrumentName::TableRowDef>( pAlternateQuery, altname );
+    std::unordered_map<idInstrument_t,size_t>::const_iterator iter = mapIndex.find( altname.idInstrument );
+    if ( mapIndex.end() != iter ) {
+      vRecord[ iter->second ].vAlternate.emplace_back( altname.idProvider, altname.idAlternate );
+    }
+  }
+}
+
 void InstrumentManager::Delete( idInstrument_cref idInstrument ) {
   // check if has dependencies first, and exception if there are
   // then delete alternate instrument names
@@ -268,6 +427,17 @@ void InstrumentManager::LoadAlternateInstrumentNames( pInstrument_t& pInstrument
   }
 }
 
+// SetAlternateName does not signal an added name, so loaded alternates are put into the map here,
+//   an alternate already naming another instrument is left as it is
+void InstrumentManager::RegisterAlternateNames( pInstrument_cref pInstrument ) {
+  pInstrument->ScanAlternateNames(
+    [this,&pInstrument]( const keytypes::eidProvider_t&, const keytypes::idInstrument_t& idAlternate, const keytypes::idInstrument_t& ){
+      if ( m_map.end() == m_map.find( idAlternate ) ) {
+        m_map.insert( pair_t( idAlternate, pInstrument ) );
+      }
+    } );
+}
+
 void InstrumentManager::HandleAlternateNameAdded( const Instrument::AlternateNameChangeInfo_t& info ) {
   iterMap iterKey = m_map.find( info.s1 );
   iterMap iterAlt = m_map.find( info.s2 );
@@ -277,6 +447,7 @@ void InstrumentManager::HandleAlternateNameAdded( const Instrument::AlternateNam
     throw std::runtime_error( "InstrumentManager::HandleAlternateNameAdded alt exists" );
   m_map.insert( pair_t( info.s2, iterKey->second ) );
   SaveAlternateInstrumentName( info.id, info.s2, info.s1 );
+  if ( nullptr != m_pSession ) m_cache.Update( *iterKey->second );
 }
 
 void InstrumentManager::HandleAlternateNameChanged( const Instrument::AlternateNameChangeInfo_t& info ) { // todo: need to update database
@@ -287,6 +458,7 @@ void InstrumentManager::HandleAlternateNameChanged( const Instrument::AlternateN
   if ( m_map.end() != iterNew )
     throw std::runtime_error( "InstrumentManager::HandleAlternateNameChanged new name already exists" );
   m_map.insert( pair_t( info.s2, iterOld->second ) );
+  if ( nullptr != m_pSession ) m_cache.Update( *iterOld->second );
   iterOld = m_map.find( info.s1 );  // load again to ensure proper copy
   m_map.erase( iterOld );
   // need database delete
@@ -18,6 +18,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <OUCommon/ManagerBase.h>
 
@@ -26,6 +27,7 @@
 #include "Instrument.h"
 #include "AlternateInstrumentNames.h"
 #include "Exchange.h"
+#include "InstrumentCache.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
@@ -38,6 +40,8 @@ public:
   typedef Instrument::pInstrument_cref pInstrument_cref;
   typedef Instrument::idInstrument_t idInstrument_t;
   typedef Instrument::idInstrument_cref idInstrument_cref;
+  typedef std::vector<idInstrument_t> vidInstrument_t;
+  typedef std::vector<pInstrument_t> vInstrument_t;
 
   InstrumentManager(void);
   virtual ~InstrumentManager(void);
@@ -73,6 +77,15 @@ public:
   bool Exists( idInstrument_cref, pInstrument_t& );
   bool Exists( pInstrument_cref );
   pInstrument_t Get( idInstrument_cref ); // for getting existing associated with id
+
+  // bulk Exists, eg for an option chain: map, then cache, then the database in batched queries,
+  //   instruments are constructed in parallel, vInstrument is parallel to vid with empty entries where not found,
+  //   returns the number found
+  size_t Load( const vidInstrument_t& vid, vInstrument_t& vInstrument );
+
+  // snapshot of the instruments table and alternate names, consulted ahead of the database while a session is attached
+  bool OpenCache( const std::string& sPath ) { return m_cache.Open( sPath ); }
+  size_t FlushCache( void ) { return m_cache.Flush(); }
   void Delete( idInstrument_cref );
 
   template<typename F> void ScanOptions( F f, idInstrument_cref, boost::uint16_t year, boost::uint16_t month, boost::uint16_t day );
@@ -91,6 +104,7 @@ protected:
   void Assign( pInstrument_cref pInstrument );
   bool LoadInstrument( idInstrument_t idInstrument, pInstrument_t& pInstrument );
   void LoadAlternateInstrumentNames( pInstrument_t& pInstrument );
+  void RegisterAlternateNames( pInstrument_cref pInstrument ); // comes after assign
 
 private:
 
@@ -102,6 +116,10 @@ private:
 
   map_t m_map;
 
+  InstrumentCache m_cache;
+
+  void LoadRecords( const vidInstrument_t&, std::vector<InstrumentCache::Record>& ); // one batch from the database
+
   void SaveAlternateInstrumentName( const AlternateInstrumentName::TableRowDef& );
   void SaveAlternateInstrumentName(
     const keytypes::eidProvider_t&, const keytypes::idInstrument_t&, const keytypes::idInstrument_t& );
@@ -187,10 +187,12 @@ void Order::ActOnError(OrderErrors::enumOrderErrors eError) {
   switch( eError ) {
     case OrderErrors::Cancelled:
       m_row.eOrderStatus = OrderStatus::Cancelled;
+      OnOrderCancelled( *this );
       break;
     case OrderErrors::Rejected:
     case OrderErrors::InstrumentNotFound:
       m_row.eOrderStatus = OrderStatus::Rejected;
+      OnOrderRejected( *this );
       break;
     case OrderErrors::NotCancellable:
       break;
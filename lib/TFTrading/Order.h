@@ -231,6 +231,7 @@ public:
 
   ou::Delegate<const std::pair<const Order&, const Execution&>& > OnExecution;
   ou::Delegate<const Order&> OnOrderCancelled;
+  ou::Delegate<const Order&> OnOrderRejected; // by the risk checks or the provider, or instrument not found
   ou::Delegate<const Order&> OnPartialFill; // on intermediate fills only
   ou::Delegate<const Order&> OnOrderFilled; // on final fill
   ou::Delegate<const Order&> OnCommission;
@@ -13,6 +13,7 @@
 
 #include <boost/smart_ptr.hpp>
 
+#include <OUCommon/Latency.h>
 #include <OUCommon/TimeSource.h>
 
 #include "OrderManager.h"
@@ -128,6 +129,8 @@ namespace OrderManagerQueries {
 
 void OrderManager::PlaceOrder(ProviderInterfaceBase *pProvider, pOrder_t pOrder) {
 
+  OU_LATENCY_MARK( Order );
+
   try {
     iterOrders_t iter;
     if ( LocateOrder( pOrder->GetOrderId(), iter ) ) {
@@ -15,23 +15,33 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include <boost/lexical_cast.hpp>
 
+#include "RiskManager.h"
 #include "OrdersOutstanding.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-OrdersOutstanding::OrdersOutstanding( pPosition_t pPosition ) : 
+OrdersOutstanding::OrdersOutstanding( pPosition_t pPosition, ou::tf::OrderSide::enumOrderSide sideEntry ) : 
   m_pPosition( pPosition ), m_cntRoundTrips( 0 ),
   m_durRoundTripTime( 0, 0, 0 ), 
   m_durForceRoundTripClose( 0, 60, 0 ),  // try something from 5 minutes to 10 minutes
   m_durOrderOpenTimeOut( 0, 0, 30 ), 
   m_dblGlobalStop( 0.0 ),
-  m_bCancelAndCloseInProgress( false )
+  m_bCancelAndCloseInProgress( false ),
+  m_dblSign( ou::tf::OrderSide::Sell == sideEntry ? -1.0 : 1.0 ),
+  m_sideExit( ou::tf::OrderSide::Sell == sideEntry ? ou::tf::OrderSide::Buy : ou::tf::OrderSide::Sell ),
+  m_szSide( ou::tf::OrderSide::Sell == sideEntry ? "Short" : "Long" ),
+  m_nKillSwitch( RiskManager::LocalCommonInstance().KillSwitchGeneration() )
 {
 }
 
+OrdersOutstanding::~OrdersOutstanding( void ) {
+}
+
 void OrdersOutstanding::AddOrderFilling( structRoundTrip* pTrip ) {
   assert( !m_bCancelAndCloseInProgress );
   ou::tf::Order& order( *pTrip->pOrderEntry.get() );
@@ -40,9 +50,15 @@ void OrdersOutstanding::AddOrderFilling( structRoundTrip* pTrip ) {
   m_mapEntryOrdersFilling[ idOrder ] = pRoundTrip_t( pTrip );
   order.OnOrderFilled.Add( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderFilled ) );  // yes, this belongs here as it will be unconditionally removed later
   order.OnOrderCancelled.Add( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
+  order.OnOrderRejected.Add( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
   if ( 0 == order.GetQuanRemaining() ) {
     HandleBaseOrderFilled( order );
   }
+  else {
+    if ( OrderStatus::Rejected == order.GetRow().eOrderStatus ) {
+      HandleBaseOrderCancelled( order );
+    }
+  }
 }
 
 void OrdersOutstanding::HandleBaseOrderCancelled( const ou::tf::Order& order ) {
@@ -53,6 +69,7 @@ void OrdersOutstanding::HandleBaseOrderCancelled( const ou::tf::Order& order ) {
   }
   const_cast<ou::tf::Order&>( order ).OnOrderFilled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderFilled ) );
   const_cast<ou::tf::Order&>( order ).OnOrderCancelled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
+  const_cast<ou::tf::Order&>( order ).OnOrderRejected.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
 
   iter->second->eState = EStateCancelled;
 
@@ -67,16 +84,68 @@ void OrdersOutstanding::HandleBaseOrderFilled( const ou::tf::Order& order ) {
   }
   const_cast<ou::tf::Order&>( order ).OnOrderFilled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderFilled ) );
   const_cast<ou::tf::Order&>( order ).OnOrderCancelled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
+  const_cast<ou::tf::Order&>( order ).OnOrderRejected.Remove( MakeDelegate( this, &OrdersOutstanding::HandleBaseOrderCancelled ) );
 
   iter->second->eState = EStateOpen;
 
   double dblBasis = order.GetAverageFillPrice();
   iter->second->dblBasis = dblBasis;
   m_mapOrdersToMatch.insert( mapOrders_pair_t( dblBasis, iter->second ) );
+  m_mapTriggers[ iter->second.get() ];
+  Index( iter->second );
 
   m_mapEntryOrdersFilling.erase( iter ); 
 }
 
+void OrdersOutstanding::Index( const pRoundTrip_t& pRoundTrip ) {
+  mapTriggers_t::iterator iter = m_mapTriggers.find( pRoundTrip.get() );
+  if ( m_mapTriggers.end() == iter ) return; // completed
+  structTriggers& triggers( iter->second );
+  Unfile( triggers );
+  const structRoundTrip& trip( *pRoundTrip );
+  if ( 0 == trip.pOrderExit.use_count() ) {
+    triggers.eTrigger = ETriggerWaiting;
+    triggers.iterBasis = m_mapWaitingBasis.insert( mapLadder_t::value_type( m_dblSign * trip.dblBasis, pRoundTrip ) );
+    triggers.bStop = ( 0.0 != trip.dblStop );
+    if ( triggers.bStop ) {
+      triggers.iterStop = m_mapWaitingStop.insert( mapLadder_t::value_type( m_dblSign * trip.dblStop, pRoundTrip ) );
+    }
+    triggers.iterForceClose = m_mapForceClose.insert(
+      mapForceClose_t::value_type( trip.pOrderEntry->GetDateTimeOrderFilled() + m_durForceRoundTripClose, pRoundTrip ) );
+  }
+  else {
+    if ( ( EStateClosing != trip.eState ) && !triggers.bCancelSent ) {
+      triggers.eTrigger = ETriggerWorking;
+      triggers.iterBasis = m_mapWorkingBasis.insert( mapLadder_t::value_type( m_dblSign * trip.dblBasis, pRoundTrip ) );
+    }
+    // otherwise a market exit or a cancel is in progress, its order event will re-index
+  }
+}
+
+void OrdersOutstanding::Unfile( structTriggers& triggers ) {
+  switch ( triggers.eTrigger ) {
+  case ETriggerWaiting:
+    m_mapWaitingBasis.erase( triggers.iterBasis );
+    if ( triggers.bStop ) m_mapWaitingStop.erase( triggers.iterStop );
+    m_mapForceClose.erase( triggers.iterForceClose );
+    break;
+  case ETriggerWorking:
+    m_mapWorkingBasis.erase( triggers.iterBasis );
+    break;
+  case ETriggerNone:
+    break;
+  }
+  triggers.eTrigger = ETriggerNone;
+}
+
+void OrdersOutstanding::Unindex( const structRoundTrip& trip ) {
+  mapTriggers_t::iterator iter = m_mapTriggers.find( &trip );
+  if ( m_mapTriggers.end() != iter ) {
+    Unfile( iter->second );
+    m_mapTriggers.erase( iter );
+  }
+}
+
 void OrdersOutstanding::CheckBaseOrder( const ou::tf::Quote& quote ) { // cancel after minimal pending time
   for ( mapOrdersFilling_iter_t iter = m_mapEntryOrdersFilling.begin(); m_mapEntryOrdersFilling.end() != iter; ++iter ) {
     if ( EStateOpenWaitingFill == iter->second->eState ) {
@@ -105,7 +174,8 @@ void OrdersOutstanding::CancelAllButNEntryOrders( unsigned int n ) {
 void OrdersOutstanding::CancelAllMatchingOrders( void ) {
   for ( mapOrders_iter_t iter = m_mapOrdersToMatch.begin(); m_mapOrdersToMatch.end() != iter; ++iter ) {
     if ( 0 != iter->second->pOrderExit.use_count() ) {
-      m_pPosition->CancelOrder( iter->second->pOrderExit->GetOrderId() );  // what happens if filled during cancel?
+      CancelExit( *iter->second );  // what happens if filled during cancel?
+      Index( iter->second );
 //      iter->second.pOrderClosing.reset();
     }
   }
@@ -127,7 +197,8 @@ void OrdersOutstanding::CancelAndCloseAllOrders( void ) {
   }
   for ( mapOrders_iter_t iter = m_mapOrdersToMatch.begin(); m_mapOrdersToMatch.end() != iter; ++iter ) {
     if ( 0 != iter->second->pOrderExit.use_count() ) {
-      m_pPosition->CancelOrder( iter->second->pOrderExit->GetOrderId() );
+      CancelExit( *iter->second );
+      Index( iter->second );
     }
   }
   m_stateCancelAndClose = CACWaitingForEntryCancels;
@@ -162,6 +233,7 @@ bool OrdersOutstanding::CancelAndCloseInProgress( void ) {
               iter->second->eState = EStateClosing;
               break;
             }
+            Index( iter->second );
           }
           m_stateCancelAndClose = CACWaitingForMatchingCloses;
         }
@@ -172,6 +244,14 @@ bool OrdersOutstanding::CancelAndCloseInProgress( void ) {
         m_stateCancelAndClose = CACDone;
         m_bCancelAndCloseInProgress = false;
       }
+      else {
+        for ( mapOrders_iter_t iter = m_mapOrdersToMatch.begin(); m_mapOrdersToMatch.end() != iter; ++iter ) {
+          if ( 0 == iter->second->pOrderExit.use_count() ) { // the close was rejected, try again
+            PlaceExit( *iter->second, "Cancel&Close", ou::tf::OrderType::Market );
+            Index( iter->second );
+          }
+        }
+      }
       break;
     case CACStarted: // shouldn't reach this
       break;
@@ -194,8 +274,12 @@ void OrdersOutstanding::HandleMatchingOrderCancelled( const ou::tf::Order& order
       if ( id == order.GetOrderId() ) {
         order.OnOrderFilled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderFilled ) );
         order.OnOrderCancelled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );
+        order.OnOrderRejected.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );
         //m_mapOrdersToMatch.erase( iter );
         iter->second->pOrderExit.reset();
+        mapTriggers_t::iterator iterTriggers = m_mapTriggers.find( iter->second.get() );
+        if ( m_mapTriggers.end() != iterTriggers ) iterTriggers->second.bCancelSent = false;
+        Index( iter->second );  // waiting again
         break;
       }
     }
@@ -215,7 +299,9 @@ void OrdersOutstanding::HandleMatchingOrderFilled( const ou::tf::Order& order )
         ++m_cntRoundTrips;
         order.OnOrderFilled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderFilled ) );
         order.OnOrderCancelled.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );
+        order.OnOrderRejected.Remove( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );
         m_vCompletedRoundTrips.push_back( iter->second );
+        Unindex( *iter->second );
         m_mapOrdersToMatch.erase( iter );
         break;
       }
@@ -223,94 +309,103 @@ void OrdersOutstanding::HandleMatchingOrderFilled( const ou::tf::Order& order )
   }
 }
 
-void OrdersOutstandingLongs::HandleQuote( const ou::tf::Quote& quote ) {
+// only the round trips whose trigger the price or time has crossed are visited
+// an engaged kill switch is acted upon here, on the quote thread which owns the round trips
+void OrdersOutstanding::HandleQuote( const ou::tf::Quote& quote, double dblPrice ) {
+  const unsigned int nKillSwitch( RiskManager::LocalCommonInstance().KillSwitchGeneration() );
+  if ( m_nKillSwitch != nKillSwitch ) {
+    m_nKillSwitch = nKillSwitch;
+    if ( RiskManager::LocalCommonInstance().KillSwitchEngaged() && !m_bCancelAndCloseInProgress ) {
+      CancelAndCloseAllOrders();
+    }
+  }
   if ( !CancelAndCloseInProgress() ) {
     CheckBaseOrder( quote );
-    double ask = quote.Ask();
-    if ( 0.0 != ask ) {
-      for ( mapOrders_iter_t iter = m_mapOrdersToMatch.begin(); m_mapOrdersToMatch.end() != iter; ++iter ) {
-        std::string sId( boost::lexical_cast<std::string>( iter->second->pOrderEntry->GetOrderId() ) );
-        if ( iter->first >= ask ) { // price is outside of profitable range
-          if ( 0 == iter->second->pOrderExit.use_count() ) { 
-            if ( iter->second->pOrderEntry->GetDateTimeOrderFilled() + m_durForceRoundTripClose < quote.DateTime() ) {
-              // close out round trip
-              PlaceOrder( iter->second->pOrderExit, "LongClose " + sId, ou::tf::OrderType::Market, ou::tf::OrderSide::Sell, 1 );
-              iter->second->eState = EStateClosing;
-            }
-            else { // check stop
-              if ( 0.0 != iter->second->dblStop ) {
-                if ( iter->second->dblStop > ask ) {
-                  PlaceOrder( iter->second->pOrderExit, "LongStop " + sId, ou::tf::OrderType::Market, ou::tf::OrderSide::Sell, 1 );
-                  iter->second->eState = EStateClosing;
-                }
-              }
-            }
-          }
-          else { // cancel existing order, but only do once, so look at status
-            if ( EStateClosing != iter->second->eState ) {
-                m_pPosition->CancelOrder( iter->second->pOrderExit->GetOrderId() );  // what happens if filled during cancel?
-                //iter->second.pOrderClosing.reset();  // this will be a problem if order is filled during cancellation
-            }
-          }
-        }
-        else { // price is inside profitable range
-          if ( 0 == iter->second->pOrderExit.use_count() ) { // create a limit order to attempt profit
-            // may need to do some rounding when using larger quantities
-            // use quantities from opening order, also will need to deal with fractional quantities on partial filled orders
-            PlaceOrder( iter->second->pOrderExit, "LongProfit " + sId, ou::tf::OrderType::Limit, ou::tf::OrderSide::Sell, 1, iter->second->dblTarget );
-          }
-          else { // do nothing
-          }
+    if ( 0.0 != dblPrice ) {
+      const double dblSigned( m_dblSign * dblPrice );
+      m_vCandidates.clear();
+      // waiting, price has moved into the profitable range
+      for ( mapLadder_t::iterator iter = m_mapWaitingBasis.begin(); ( m_mapWaitingBasis.end() != iter ) && ( iter->first < dblSigned ); ++iter ) {
+        m_vCandidates.push_back( iter->second );
+      }
+      // waiting, price has crossed the stop
+      for ( mapLadder_t::reverse_iterator iter = m_mapWaitingStop.rbegin(); ( m_mapWaitingStop.rend() != iter ) && ( iter->first > dblSigned ); ++iter ) {
+        m_vCandidates.push_back( iter->second );
+      }
+      // waiting, held past the forced close
+      for ( mapForceClose_t::iterator iter = m_mapForceClose.begin(); ( m_mapForceClose.end() != iter ) && ( iter->first < quote.DateTime() ); ++iter ) {
+        m_vCandidates.push_back( iter->second );
+      }
+      // profit limit outstanding, price has moved out of the profitable range
+      for ( mapLadder_t::reverse_iterator iter = m_mapWorkingBasis.rbegin(); ( m_mapWorkingBasis.rend() != iter ) && ( iter->first >= dblSigned ); ++iter ) {
+        m_vCandidates.push_back( iter->second );
+      }
+      if ( 1 < m_vCandidates.size() ) { // a round trip may be on more than one ladder
+        std::sort( m_vCandidates.begin(), m_vCandidates.end() );
+        m_vCandidates.erase( std::unique( m_vCandidates.begin(), m_vCandidates.end() ), m_vCandidates.end() );
+      }
+      for ( vRoundTrip_t::const_iterator iter = m_vCandidates.begin(); m_vCandidates.end() != iter; ++iter ) {
+        if ( m_mapTriggers.end() != m_mapTriggers.find( iter->get() ) ) { // may have completed on an earlier candidate's order
+          Evaluate( *iter, quote, dblSigned );
+          Index( *iter );
         }
       }
     }
   }
 }
 
-void OrdersOutstandingShorts::HandleQuote( const ou::tf::Quote& quote ) {
-  if ( !CancelAndCloseInProgress() ) {
-    CheckBaseOrder( quote );
-    double bid = quote.Bid();
-    if ( 0.0 != bid ) {
-      for ( mapOrders_iter_t iter = m_mapOrdersToMatch.begin(); m_mapOrdersToMatch.end() != iter; ++iter ) {
-        std::string sId( boost::lexical_cast<std::string>( iter->second->pOrderEntry->GetOrderId() ) );
-        if ( iter->first <= bid ) { // price is outside of profitable range
-          if ( 0 == iter->second->pOrderExit.use_count() ) {
-            if ( iter->second->pOrderEntry->GetDateTimeOrderFilled() + m_durForceRoundTripClose < quote.DateTime() ) {
-              // close out round trip
-              PlaceOrder( iter->second->pOrderExit, "ShortClose " + sId, ou::tf::OrderType::Market, ou::tf::OrderSide::Buy, 1 );
-              iter->second->eState = EStateClosing;
-            }
-            else { // check stop
-              if ( 0.0 != iter->second->dblStop ) {
-                if ( iter->second->dblStop < bid ) {
-                  PlaceOrder( iter->second->pOrderExit, "ShortStop " + sId, ou::tf::OrderType::Market, ou::tf::OrderSide::Buy, 1 );
-                  iter->second->eState = EStateClosing;
-                }
-              }
-            }
-          }
-          else { // cancel existing order, but only do once, so look at status
-            if ( EStateClosing != iter->second->eState ) {
-              m_pPosition->CancelOrder( iter->second->pOrderExit->GetOrderId() );  // what happens if filled during cancel?
-              //iter->second.pOrderClosing.reset();  // this will be a problem if order is filled during cancellation
-            }
-          }
-        }
-        else { // price is inside profitable range
-          if ( 0 == iter->second->pOrderExit.use_count() ) { // create a limit order to attempt profit
-            // may need to do some rounding when using larger quantities
-            // use quantities from opening order, also will need to deal with fractional quantities on partial filled orders
-            PlaceOrder( iter->second->pOrderExit, "ShortProfit " + sId, ou::tf::OrderType::Limit, ou::tf::OrderSide::Buy, 1, iter->second->dblTarget );
-          }
-          else { // do nothing
-          }
+void OrdersOutstanding::Evaluate( const pRoundTrip_t& pRoundTrip, const ou::tf::Quote& quote, double dblSigned ) {
+  structRoundTrip& trip( *pRoundTrip );
+  if ( m_dblSign * trip.dblBasis >= dblSigned ) { // price is outside of profitable range
+    if ( 0 == trip.pOrderExit.use_count() ) {
+      if ( trip.pOrderEntry->GetDateTimeOrderFilled() + m_durForceRoundTripClose < quote.DateTime() ) {
+        // close out round trip
+        PlaceExit( trip, "Close", ou::tf::OrderType::Market );
+      }
+      else { // check stop
+        if ( ( 0.0 != trip.dblStop ) && ( m_dblSign * trip.dblStop > dblSigned ) ) {
+          PlaceExit( trip, "Stop", ou::tf::OrderType::Market );
         }
       }
     }
+    else { // cancel existing order, but only do once
+      if ( EStateClosing != trip.eState ) {
+        CancelExit( trip );  // what happens if filled during cancel?
+      }
+    }
+  }
+  else { // price is inside profitable range
+    if ( 0 == trip.pOrderExit.use_count() ) { // create a limit order to attempt profit
+      // may need to do some rounding when using larger quantities
+      // use quantities from opening order, also will need to deal with fractional quantities on partial filled orders
+      PlaceExit( trip, "Profit", ou::tf::OrderType::Limit );
+    }
   }
 }
 
+// the description is built only when an order is placed
+void OrdersOutstanding::PlaceExit( structRoundTrip& trip, const char* szAction, ou::tf::OrderType::enumOrderType type ) {
+  std::string sDescription( m_szSide );
+  sDescription += szAction;
+  sDescription += ' ';
+  sDescription += boost::lexical_cast<std::string>( trip.pOrderEntry->GetOrderId() );
+  mapTriggers_t::iterator iter = m_mapTriggers.find( &trip );
+  if ( m_mapTriggers.end() != iter ) iter->second.bCancelSent = false;
+  if ( ou::tf::OrderType::Limit == type ) {
+    PlaceOrder( trip.pOrderExit, sDescription, type, m_sideExit, 1, trip.dblTarget );
+  }
+  else {
+    trip.eState = EStateClosing;  // before placing, the fill may arrive within
+    PlaceOrder( trip.pOrderExit, sDescription, type, m_sideExit, 1 );
+  }
+}
+
+void OrdersOutstanding::CancelExit( structRoundTrip& trip ) {
+  mapTriggers_t::iterator iter = m_mapTriggers.find( &trip );
+  if ( m_mapTriggers.end() != iter ) iter->second.bCancelSent = true;  // before cancelling, the cancel may arrive within
+  m_pPosition->CancelOrder( trip.pOrderExit->GetOrderId() );
+}
+
 void OrdersOutstanding::PostMortemReport( void ) {
   double dif( 0.0 );
   long td( 0 );
@@ -361,6 +456,7 @@ void OrdersOutstanding::PlaceOrder( pOrder_t& pOrder ) {
   ou::tf::Order& order( *pOrder.get() );
   order.OnOrderFilled.Add( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderFilled ) );
   order.OnOrderCancelled.Add( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );
+  order.OnOrderRejected.Add( MakeDelegate( this, &OrdersOutstanding::HandleMatchingOrderCancelled ) );  // a rejected exit leaves the round trip waiting
   m_pPosition->PlaceOrder( pOrder );
 }
 
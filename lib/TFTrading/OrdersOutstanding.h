@@ -14,12 +14,19 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include <TFTrading/Position.h>
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
+// round trips waiting on their exits are indexed by what would make a quote act on them:
+//   waiting (no exit order): basis ladder (moves into the profitable range), stop ladder, forced close queue
+//   working (profit limit outstanding): basis ladder (moves out of the profitable range)
+//   a quote visits only the ends of the ladders it has crossed, others are not touched
+//   prices in the ladders are signed, negated for shorts, so one comparison serves both sides
+
   class OrdersOutstanding {
 public:
 
@@ -42,9 +49,9 @@ public:
     double dblSlope1, dblSlope2, dblSlope3;  // stats for post analysis
     double dblSlopeSlope1, dblSlopeSlope2;
     double dblSlopeBollingerOffset;
-    structRoundTrip( void ): eState( EStateOpenWaitingFill ), dblBasis( 0.0 ) {};
+    structRoundTrip( void ): eState( EStateOpenWaitingFill ), dblBasis( 0.0 ), dblTarget( 0.0 ), dblStop( 0.0 ) {};
     structRoundTrip( pOrder_t entry )
-      : eState( EStateOpenWaitingFill ), pOrderEntry( entry ), dblBasis( 0.0 ) {};
+      : eState( EStateOpenWaitingFill ), pOrderEntry( entry ), dblBasis( 0.0 ), dblTarget( 0.0 ), dblStop( 0.0 ) {};
     structRoundTrip( pOrder_t entry, double target, double stop )
       : eState( EStateOpenWaitingFill ), pOrderEntry( entry ), dblBasis( 0.0 ),
         dblTarget( target ), dblStop( stop ) {};
@@ -64,8 +71,8 @@ protected:
 
 public:
 
-  OrdersOutstanding( pPosition_t pPosition );
-  virtual ~OrdersOutstanding( void ) {};
+  OrdersOutstanding( pPosition_t pPosition, ou::tf::OrderSide::enumOrderSide sideEntry );
+  virtual ~OrdersOutstanding( void );
 
   void AddOrderFilling( structRoundTrip* pTrip );  // migrate to using this instead
   void CancelAllButNEntryOrders( unsigned int n );
@@ -101,6 +108,8 @@ protected:
   void CheckBaseOrder( const ou::tf::Quote& quote );
   bool CancelAndCloseInProgress( void );
 
+  void HandleQuote( const ou::tf::Quote& quote, double dblPrice ); // ask for longs, bid for shorts
+
   void PlaceOrder( pOrder_t& pOrder, const std::string& sDescription, ou::tf::OrderType::enumOrderType, ou::tf::OrderSide::enumOrderSide, boost::uint32_t nOrderQuantity );
   void PlaceOrder( pOrder_t& pOrder, const std::string& sDescription, ou::tf::OrderType::enumOrderType, ou::tf::OrderSide::enumOrderSide, boost::uint32_t nOrderQuantity, double dblPrice1 );
   void PlaceOrder( pOrder_t& pOrder, const std::string& sDescription, ou::tf::OrderType::enumOrderType, ou::tf::OrderSide::enumOrderSide, boost::uint32_t nOrderQuantity, double dblPrice1, double dblPrice2 );
@@ -115,6 +124,43 @@ private:
 
   time_duration m_durOrderOpenTimeOut;
 
+  double m_dblSign; // 1 for longs, -1 for shorts
+  ou::tf::OrderSide::enumOrderSide m_sideExit;
+  const char* m_szSide; // description prefix
+
+  unsigned int m_nKillSwitch; // RiskManager::KillSwitchGeneration last seen
+
+  typedef std::multimap<double, pRoundTrip_t> mapLadder_t; // signed price
+  typedef std::multimap<ptime, pRoundTrip_t> mapForceClose_t;
+
+  enum enumTrigger { ETriggerNone, ETriggerWaiting, ETriggerWorking };
+  struct structTriggers {
+    enumTrigger eTrigger;
+    bool bCancelSent; // on the profit limit, so it is cancelled once
+    bool bStop;
+    mapLadder_t::iterator iterBasis;
+    mapLadder_t::iterator iterStop;
+    mapForceClose_t::iterator iterForceClose;
+    structTriggers( void ): eTrigger( ETriggerNone ), bCancelSent( false ), bStop( false ) {};
+  };
+  typedef std::map<const structRoundTrip*, structTriggers> mapTriggers_t;
+  mapTriggers_t m_mapTriggers; // round trips in m_mapOrdersToMatch
+
+  mapLadder_t m_mapWaitingBasis;
+  mapLadder_t m_mapWaitingStop;
+  mapForceClose_t m_mapForceClose;
+  mapLadder_t m_mapWorkingBasis;
+
+  typedef std::vector<pRoundTrip_t> vRoundTrip_t;
+  vRoundTrip_t m_vCandidates; // reused by HandleQuote
+
+  void Index( const pRoundTrip_t& ); // (re)file by the round trip's present state
+  void Unindex( const structRoundTrip& );
+  void Unfile( structTriggers& );
+  void Evaluate( const pRoundTrip_t&, const ou::tf::Quote& quote, double dblSigned );
+  void PlaceExit( structRoundTrip&, const char* szAction, ou::tf::OrderType::enumOrderType );
+  void CancelExit( structRoundTrip& );
+
   void HandleBaseOrderFilled( const ou::tf::Order& order );
   void HandleBaseOrderCancelled( const ou::tf::Order& order );
 
@@ -124,9 +170,9 @@ class OrdersOutstandingLongs: public OrdersOutstanding {
 public:
   typedef ou::tf::Position::pPosition_t pPosition_t;
   typedef ou::tf::Position::pOrder_t pOrder_t;
-  OrdersOutstandingLongs( pPosition_t pPosition ): OrdersOutstanding( pPosition ) {};
+  OrdersOutstandingLongs( pPosition_t pPosition ): OrdersOutstanding( pPosition, ou::tf::OrderSide::Buy ) {};
   ~OrdersOutstandingLongs( void ) {};
-  void HandleQuote( const ou::tf::Quote& quote );  // set from external
+  void HandleQuote( const ou::tf::Quote& quote ) { OrdersOutstanding::HandleQuote( quote, quote.Ask() ); };  // set from external
 protected:
 private:
 };
@@ -135,9 +181,9 @@ class OrdersOutstandingShorts: public OrdersOutstanding {
 public:
   typedef ou::tf::Position::pPosition_t pPosition_t;
   typedef ou::tf::Position::pOrder_t pOrder_t;
-  OrdersOutstandingShorts( pPosition_t pPosition ): OrdersOutstanding( pPosition ) {};
+  OrdersOutstandingShorts( pPosition_t pPosition ): OrdersOutstanding( pPosition, ou::tf::OrderSide::Sell ) {};
   ~OrdersOutstandingShorts( void ) {};
-  void HandleQuote( const ou::tf::Quote& quote );  // set from external
+  void HandleQuote( const ou::tf::Quote& quote ) { OrdersOutstanding::HandleQuote( quote, quote.Bid() ); };  // set from external
 protected:
 private:
 };
@@ -88,6 +88,8 @@ Portfolio::pPosition_t Portfolio::AddPosition( const std::string &sName, pPositi
   m_mapPositionsViaUserName.insert( mapPositions_pair_t( sName, pPosition ) );
   m_mapPositionsViaInstrumentName.insert( mapPositions_pair_t( sInstrumentName, pPosition ) );
 
+  pPosition->SetUnRealizedPLDeferred( AggregateDeferred == m_eAggregation );
+
   pPosition->OnUnRealizedPL.Add( MakeDelegate( this, &Portfolio::HandleUnRealizedPL ) );
   pPosition->OnExecution.Add( MakeDelegate( this, &Portfolio::HandleExecution ) );
   pPosition->OnCommission.Add( MakeDelegate( this, &Portfolio::HandleCommission ) );
@@ -189,6 +191,8 @@ void Portfolio::AddSubPortfolio( pPortfolio_t& pPortfolio ) {
 
     m_mapSubPortfolios[ idSubPortfolio ] = pPortfolio;
 
+    pPortfolio->SetAggregation( m_eAggregation );
+
     pPortfolio->OnCommission.Add( MakeDelegate( this, &Portfolio::HandleCommission ) );
     pPortfolio->OnExecution.Add( MakeDelegate( this, &Portfolio::HandleExecution ) );
     pPortfolio->OnUnRealizedPL.Add( MakeDelegate( this, &Portfolio::HandleUnRealizedPL ) );
@@ -222,15 +226,68 @@ void Portfolio::SetOwnerPortfolio( const idPortfolio_t& idOwner, pPortfolio_t& p
 // as positions and portfolios get attached, they should perform an initial update of 
 //   unrealized, realized, & commission (if non-zero)
 
-void Portfolio::HandleUnRealizedPL( const PositionDelta_delegate_t& position ) {
+void Portfolio::SetAggregation( EAggregation eAggregation ) {
+
+  const bool bDeferred( AggregateDeferred == eAggregation );
+
+  for ( mapPositions_t::value_type& vt: m_mapPositionsViaUserName ) {
+    vt.second->SetUnRealizedPLDeferred( bDeferred );
+  }
+  for ( mapPortfolios_t::value_type& vt: m_mapSubPortfolios ) {
+    vt.second->SetAggregation( eAggregation );
+  }
 
-  m_plCurrent.dblUnRealized += ( -position.get<1>() + position.get<2>() );
+  m_eAggregation = eAggregation;
+
+  // returning to immediate mode continues with deltas, so start from exact totals
+  if ( !bDeferred ) Aggregate();
+}
+
+bool Portfolio::Aggregate( void ) {
+
+  double dblUnRealized {};
+  size_t nReceived {};
+
+  for ( mapPositions_t::value_type& vt: m_mapPositionsViaUserName ) {
+    Position& position( *vt.second );
+    if ( position.TestAndClearUnRealizedPLDirty() ) nReceived++;
+    dblUnRealized += position.GetUnRealizedPLPublished(); // the quote thread writes the row
+  }
+
+  for ( mapPortfolios_t::value_type& vt: m_mapSubPortfolios ) {
+    Portfolio& portfolio( *vt.second );
+    if ( portfolio.Aggregate() ) nReceived++;
+    dblUnRealized += portfolio.m_plCurrent.dblUnRealized;
+  }
+
+  m_cntEventsReceived += nReceived;
+
+  bool bChanged( dblUnRealized != m_plCurrent.dblUnRealized );
+  if ( bChanged ) {
+    UpdateUnRealizedPL( dblUnRealized );
+    EmitUnRealizedPLUpdate();
+  }
+
+  return bChanged;
+}
+
+void Portfolio::UpdateUnRealizedPL( double dblUnRealized ) {
+
+  m_plCurrent.dblUnRealized = dblUnRealized;
 
 //  m_row.db.dblUnRealized = m_plCurrent.dblUnRealized;
 
   m_plCurrent.Sum();
   if ( m_plCurrent > m_plMax ) m_plMax.dblUnRealized = m_plCurrent.dblUnRealized;
   if ( m_plCurrent < m_plMin ) m_plMin.dblUnRealized = m_plCurrent.dblUnRealized;
+}
+
+void Portfolio::HandleUnRealizedPL( const PositionDelta_delegate_t& position ) {
+
+  UpdateUnRealizedPL( m_plCurrent.dblUnRealized + ( -position.get<1>() + position.get<2>() ) );
+
+  m_cntEventsReceived++;
+  m_cntEventsEmitted++;
 
   // need to propogate up portfolios yet
   OnUnRealizedPL( position );
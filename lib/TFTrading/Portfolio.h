@@ -12,8 +12,9 @@
  ************************************************************************/
 #pragma once
 
-#include <string>
 #include <map>
+#include <atomic>
+#include <string>
 
 #include <boost/shared_ptr.hpp>
 
@@ -162,6 +163,22 @@ public:
 
   const TableRowDef& GetRow( void ) const { return m_row; };
 
+  // unrealized PL aggregation
+  //   AggregateImmediate: each position change is pushed upwards through OnUnRealizedPL
+  //   AggregateDeferred: positions mark themselves dirty, totals (and greeks in PortfolioGreek)
+  //     are rebuilt in a single pass by Aggregate, called per interval or per event batch
+  enum EAggregation { AggregateImmediate, AggregateDeferred };
+  void SetAggregation( EAggregation ); // applies to positions and sub-portfolios
+  EAggregation GetAggregation( void ) const { return m_eAggregation; }
+  virtual bool Aggregate( void ); // exact totals in either mode, true with OnUnRealizedPLUpdate when changed
+
+  // per level notification counts: received from positions/sub-portfolios, emitted as OnUnRealizedPLUpdate
+  void QueryEventCounts( size_t& nReceived, size_t& nEmitted ) const {
+    nReceived = m_cntEventsReceived.load();
+    nEmitted = m_cntEventsEmitted.load();
+  }
+  void ResetEventCounts( void ) { m_cntEventsReceived.store( 0 ); m_cntEventsEmitted.store( 0 ); }
+
   ou::Delegate<const Portfolio&> OnUnRealizedPLUpdate;
   ou::Delegate<const Portfolio&> OnExecutionUpdate;
   ou::Delegate<const Portfolio&> OnCommissionUpdate;
@@ -171,7 +188,16 @@ public:
   ou::Delegate<const PositionDelta_delegate_t&> OnUnRealizedPL;/* ( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL ) */  // < - use by portfolio
 
 protected:
-  
+
+  void EmitUnRealizedPLUpdate( void ) { m_cntEventsEmitted++; OnUnRealizedPLUpdate( *this ); }
+
+  template<typename F> void ScanPositions( F f ) const {
+    for ( const mapPositions_t::value_type& vt: m_mapPositionsViaUserName ) f( vt.second );
+  }
+  template<typename F> void ScanSubPortfolios( F f ) const {
+    for ( const mapPortfolios_t::value_type& vt: m_mapSubPortfolios ) f( vt.second );
+  }
+
 private:
 
   typedef std::map<std::string, pPosition_t> mapPositions_t;
@@ -203,6 +229,12 @@ private:
   structPL m_plMax;
   structPL m_plMin;
 
+  EAggregation m_eAggregation {AggregateImmediate};
+  std::atomic<size_t> m_cntEventsReceived {0}; // counted on the quote thread, read from any
+  std::atomic<size_t> m_cntEventsEmitted {0};
+
+  void UpdateUnRealizedPL( double dblUnRealized );
+
   void ReCalc( void );  // not used at the moment, may require tuning
 
   void HandleExecution( const PositionDelta_delegate_t& );
@@ -50,10 +50,51 @@ void PortfolioGreek::RemoveSubPortfolio( const idPortfolio_t& idPortfolio ) {
   Portfolio::RemoveSubPortfolio( idPortfolio );
 }
 
+bool PortfolioGreek::Aggregate( void ) {
+
+  const bool bPLChanged = Portfolio::Aggregate();  // sub-portfolios aggregate their greeks in here
+
+  const ou::tf::Greek::greeks_t greeksPrevious( m_greeks );
+  m_greeks = ou::tf::Greek::greeks_t();
+
+  bool bGreeksChanged( false );
+
+  ScanPositions( [this,&bGreeksChanged]( const pPosition_t& pPosition ){
+    PositionGreek* pPositionGreek = dynamic_cast<PositionGreek*>( pPosition.get() );
+    if ( nullptr != pPositionGreek ) {
+      if ( pPositionGreek->AddGreeks( m_greeks ) ) bGreeksChanged = true;
+    }
+  } );
+
+  ScanSubPortfolios( [this]( const pPortfolio_t& pPortfolio ){
+    const PortfolioGreek* pPortfolioGreek = dynamic_cast<const PortfolioGreek*>( pPortfolio.get() );
+    if ( nullptr != pPortfolioGreek ) {
+      const ou::tf::Greek::greeks_t& greeks( pPortfolioGreek->Greeks() );
+      m_greeks.delta += greeks.delta;
+      m_greeks.gamma += greeks.gamma;
+      m_greeks.theta += greeks.theta;
+      m_greeks.vega  += greeks.vega;
+      m_greeks.rho   += greeks.rho;
+    }
+  } );
+
+  // sub-portfolio greeks show up in the totals only
+  bGreeksChanged = bGreeksChanged
+    || ( greeksPrevious.delta != m_greeks.delta ) || ( greeksPrevious.gamma != m_greeks.gamma )
+    || ( greeksPrevious.theta != m_greeks.theta ) || ( greeksPrevious.vega  != m_greeks.vega )
+    || ( greeksPrevious.rho   != m_greeks.rho );
+
+  if ( bGreeksChanged && !bPLChanged ) {
+    EmitUnRealizedPLUpdate(); // the base emitted already when the PL moved
+  }
+
+  return bPLChanged || bGreeksChanged;
+}
+
 std::ostream& operator<<( std::ostream& os, const PortfolioGreek& portfolio ) {
 
   os 
-    << (Portfolio) portfolio
+    << static_cast<const Portfolio&>( portfolio )
     ;
   return os;
 }
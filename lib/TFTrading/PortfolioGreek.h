@@ -50,10 +50,15 @@ public:
   
   void AddSubPortfolio( pPortfolioGreek_t& );
   void RemoveSubPortfolio( const idPortfolio_t& idPortfolio );
-  
+
+  virtual bool Aggregate( void ); // unrealized PL, plus greeks of positions and sub-portfolios, true when either changed
+  const ou::tf::Greek::greeks_t& Greeks( void ) const { return m_greeks; } // as of last Aggregate
+
 protected:
 private:
 
+  ou::tf::Greek::greeks_t m_greeks;
+
 };
 
 std::ostream& operator<<( std::ostream& os, const PortfolioGreek& );
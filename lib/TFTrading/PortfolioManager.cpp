@@ -292,6 +292,31 @@ void PortfolioManager::UpdateReportingPortfolio( idPortfolio_t idOwner, idPortfo
   iter->second.insert( iter->second.begin(), idReporting );
 }
 
+void PortfolioManager::SetAggregation( Portfolio::EAggregation eAggregation, boost::posix_time::time_duration tdInterval ) {
+  m_tdAggregationInterval = tdInterval;
+  for ( mapPortfolios_t::value_type& vt: m_mapPortfolios ) {
+    if ( "" == vt.second.pPortfolio->GetRow().idOwner ) {
+      vt.second.pPortfolio->SetAggregation( eAggregation );
+    }
+  }
+}
+
+bool PortfolioManager::Aggregate( boost::posix_time::ptime dtNow, bool bForce ) {
+  bool bChanged( false );
+  if ( bForce
+    || m_dtLastAggregation.is_not_a_date_time()
+    || ( m_tdAggregationInterval <= ( dtNow - m_dtLastAggregation ) )
+  ) {
+    m_dtLastAggregation = dtNow;
+    for ( mapPortfolios_t::value_type& vt: m_mapPortfolios ) {
+      if ( "" == vt.second.pPortfolio->GetRow().idOwner ) {
+        bChanged |= vt.second.pPortfolio->Aggregate();
+      }
+    }
+  }
+  return bChanged;
+}
+
 void PortfolioManager::LoadActivePortfolios( void ) {
   // todo:  work with sub-portfolios, and get them attached properly
 
@@ -122,6 +122,11 @@ public:
 
   void LoadActivePortfolios( void );
 
+  // see Portfolio::SetAggregation, applied to the top level portfolios (and thereby all below)
+  void SetAggregation( Portfolio::EAggregation, boost::posix_time::time_duration tdInterval = boost::posix_time::milliseconds( 250 ) );
+  // call from a gui/timer tick or after an event batch, passes through when the interval has not elapsed
+  bool Aggregate( boost::posix_time::ptime dtNow, bool bForce = false );
+
   void AttachToSession( ou::db::Session* pSession );
   void DetachFromSession( ou::db::Session* pSession );
 
@@ -135,6 +140,9 @@ private:
 
   mapPortfolios_t m_mapPortfolios;
 
+  boost::posix_time::time_duration m_tdAggregationInterval {boost::posix_time::milliseconds( 250 )};
+  boost::posix_time::ptime m_dtLastAggregation;
+
   // method for getting at child portfolios
   // portfolio id "" is root where all top level portfolios are linked
   typedef std::map<idPortfolio_t,setPortfolioId_t> mapReportingPortfolios_t;
@@ -13,9 +13,12 @@
 
 #include <algorithm>
 
+#include <OUCommon/Latency.h>
+
 #include <TFOptions/Option.h>
 
 #include "OrderManager.h"
+#include "RiskManager.h"
 #include "Position.h"
 
 namespace ou { // One Unified
@@ -83,6 +86,7 @@ Position::Position(
   m_pExecutionProvider( pExecutionProvider ),
   m_dblMultiplier( 1 )
 {
+  PublishUnRealizedPL();
   ConstructWatch( pInstrument, pDataProvider );
   Construction();
 }
@@ -91,6 +95,7 @@ Position::Position( const TableRowDef& row )
 : m_row( row ),
   m_dblMultiplier( 1 )
 {
+  PublishUnRealizedPL();
 }
 
 Position::Position( void )
@@ -149,6 +154,7 @@ Position::~Position(void) {
 
   for ( std::vector<pOrder_t>::iterator iter = m_vAllOrders.begin(); iter != m_vAllOrders.end(); ++iter ) {
     iter->get()->OnOrderCancelled.Remove( MakeDelegate( this, &Position::HandleCancellation ) );
+    iter->get()->OnOrderRejected.Remove( MakeDelegate( this, &Position::HandleRejection ) );
     iter->get()->OnCommission.Remove( MakeDelegate( this, &Position::HandleCommission ) );
     iter->get()->OnExecution.Remove( MakeDelegate( this, &Position::HandleExecution ) );
   }
@@ -161,6 +167,8 @@ Position::~Position(void) {
 
 void Position::HandleQuote( const quote_t& quote ) {
 
+  OU_LATENCY_MARK( Position );
+
   // TODO: use a flag to determine if to use zero based or not?
   //       maybe allow on optiosn, but not futures/equity?
   if ( ( 0 == quote.Bid() ) && ( 0 == quote.Ask() ) ) {
@@ -187,9 +195,16 @@ void Position::HandleQuote( const quote_t& quote ) {
   }
 
   if ( bProcessed ) {
+    PublishUnRealizedPL();
     OnQuotePostProcess( quote_pair_t( *this, quote ) );
     if ( dblPreviousUnRealizedPL != m_row.dblUnRealizedPL ) {
-      OnUnRealizedPL( PositionDelta_delegate_t( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL ) );
+      m_cntUnRealizedPLEvents++;
+      if ( m_bUnRealizedPLDeferred ) {
+        m_bUnRealizedPLDirty.store( true );
+      }
+      else {
+        OnUnRealizedPL( PositionDelta_delegate_t( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL ) );
+      }
     }
   }
 
@@ -289,10 +304,26 @@ void Position::PlaceOrder( pOrder_t pOrder ) {
 //    }
 //  }
 
+  const auto id = pOrder->GetOrderId();
+
+  RiskManager::ERejection eRejection
+    = RiskManager::LocalCommonInstance().Check( *pOrder, m_row.idPortfolio, m_pWatch->LastQuote() );
+  if ( RiskManager::ERejection::Accepted != eRejection ) {
+    // reported through RiskManager::OnRejection and OrderManager's error report
+    vOrders_iter_t iter = std::find_if(
+      m_vOpenOrders.begin(), m_vOpenOrders.end(),
+      [id]( pOrder_t& pOrder ){ return ( id == pOrder->GetOrderId() ); } );
+    if ( m_vOpenOrders.end() != iter ) {
+      m_vClosedOrders.push_back( *iter );
+      m_vOpenOrders.erase( iter );
+    }
+    OrderManager::LocalCommonInstance().ReportErrors( id, OrderErrors::Rejected );
+    return;
+  }
+
   if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = pOrder->GetOrderSide();  // first to set non-zero gives us our predominant side
 
   m_row.nPositionPending += pOrder->GetQuantity();
-  const auto id = pOrder->GetOrderId();
   if ( 0 == std::count_if(
     m_vAllOrders.begin(), m_vAllOrders.end(),  // this may not be efficient for large order lists, maybe use a map sometime
     [id]( pOrder_t& pOrder ){ return ( id == pOrder->GetOrderId() ); } ) ) {
@@ -309,6 +340,7 @@ void Position::Register( pOrder_t pOrder ) {
   pOrder->OnExecution.Add( MakeDelegate( this, &Position::HandleExecution ) );
   pOrder->OnCommission.Add( MakeDelegate( this, &Position::HandleCommission ) );
   pOrder->OnOrderCancelled.Add( MakeDelegate( this, &Position::HandleCancellation ) );
+  pOrder->OnOrderRejected.Add( MakeDelegate( this, &Position::HandleRejection ) );
 }
 
 void Position::UpdateOrder( pOrder_t pOrder ) {
@@ -349,10 +381,14 @@ void Position::CancelOrder( idOrder_t idOrder ) {
   }
 }
 
+// risk usage is released only for an order still open here, once:
+//   a risk rejected order was closed in PlaceOrder without being counted,
+//   a provider may follow a reject with a cancel
 void Position::HandleCancellation( const Order& order ) {
   Order::idOrder_t idOrder = order.GetOrderId();
   for ( vOrders_t::iterator iter = m_vOpenOrders.begin(); iter != m_vOpenOrders.end(); ++iter ) {
     if ( idOrder == iter->get()->GetOrderId() ) {
+      RiskManager::LocalCommonInstance().Cancelled( order, m_row.idPortfolio );
       if ( m_row.nPositionPending >= iter->get()->GetQuanRemaining() ) {
         m_row.nPositionPending -= iter->get()->GetQuanRemaining();
         if ( 0 == m_row.nPositionPending ) m_row.eOrderSidePending = OrderSide::Unknown;
@@ -369,6 +405,10 @@ void Position::HandleCancellation( const Order& order ) {
   OnPositionChanged( *this );
 }
 
+void Position::HandleRejection( const Order& order ) {
+  HandleCancellation( order );  // nothing was filled, the remaining quantity comes off pending as with a cancel
+}
+
 void Position::CancelOrder( vOrders_iter_t iter ) {
   CancelOrder( *iter );
 }
@@ -497,6 +537,9 @@ void Position::HandleExecution( const std::pair<const Order&, const Execution&>&
 
   // update position, regardless of whether we see order open or closed
   UpdateRowValues( exec.GetPrice(), exec.GetSize(), exec.GetOrderSide() );
+  PublishUnRealizedPL();
+
+  RiskManager::LocalCommonInstance().Filled( order, m_row.idPortfolio, exec );
 
   if ( ( 0 == m_row.nPositionActive ) && ( OrderSide::Unknown != m_row.eOrderSideActive ) ) {
     std::cout << "problems" << std::endl;
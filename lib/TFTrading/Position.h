@@ -13,6 +13,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <vector>
 #include <sstream>
 
@@ -274,6 +275,14 @@ public:
   ou::Delegate<const PositionDelta_delegate_t&> OnCommission;  // < - used by portfolio
   ou::Delegate<const PositionDelta_delegate_t&> OnUnRealizedPL;// < - use by portfolio, ( *this, dblPreviousUnRealizedPL, m_row.dblUnRealizedPL )  when unrealizedPL changes, updated by HandleQuote
 
+  // deferred aggregation: HandleQuote still updates unrealized PL, but marks the position dirty
+  //   rather than emitting OnUnRealizedPL, the owning Portfolio collects it in Portfolio::Aggregate
+  void SetUnRealizedPLDeferred( bool bDeferred ) { m_bUnRealizedPLDeferred = bDeferred; }
+  bool UnRealizedPLDeferred( void ) const { return m_bUnRealizedPLDeferred; }
+  bool TestAndClearUnRealizedPLDirty( void ) { return m_bUnRealizedPLDirty.exchange( false ); }
+  double GetUnRealizedPLPublished( void ) const { return m_dblUnRealizedPLPublished.load( std::memory_order_acquire ); } // for threads other than the quote thread
+  size_t UnRealizedPLEventCount( void ) const { return m_cntUnRealizedPLEvents.load(); } // quote driven changes to unrealized PL
+
   void Set( pInstrument_cref, pProvider_t& pExecutionProvider, pProvider_t& pDataProvider );  // need to set verification that pointers have been set
   void Set( idPosition_t idPosition ) { m_row.idPosition = idPosition; };
   void Set( const std::string& sName ) { m_row.sName = sName; }
@@ -303,6 +312,12 @@ private:
 
   double m_dblMultiplier;
 
+  bool m_bUnRealizedPLDeferred {false};
+  std::atomic<bool> m_bUnRealizedPLDirty {false};  // written on the quote thread, cleared by the aggregation pass
+  std::atomic<size_t> m_cntUnRealizedPLEvents {0};
+  std::atomic<double> m_dblUnRealizedPLPublished {0.0}; // m_row.dblUnRealizedPL, stored before the dirty flag is set
+  void PublishUnRealizedPL( void ) { m_dblUnRealizedPLPublished.store( m_row.dblUnRealizedPL, std::memory_order_release ); }
+
   void ConstructWatch( pInstrument_cref, pProvider_t pDataProvider );
   void Construction( void );
 
@@ -311,6 +326,7 @@ private:
   void HandleExecution( const std::pair<const Order&, const Execution&>& );
   void HandleCommission( const Order& );
   void HandleCancellation( const Order& );
+  void HandleRejection( const Order& );
 
   void CancelOrder( vOrders_iter_t iter );
   void CancelOrder( pOrder_t& pOrder );
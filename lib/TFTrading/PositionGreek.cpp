@@ -83,11 +83,46 @@ void PositionGreek::PositionPendingDelta( int n ) {
   OnPositionChanged( *this );
 }
 
+bool PositionGreek::AddGreeks( ou::tf::Greek::greeks_t& greeks ) {
+  double dblQuantity {};
+  switch ( m_row.eOrderSideActive ) {
+    case OrderSide::Buy:
+      dblQuantity = m_row.nPositionActive;
+      break;
+    case OrderSide::Sell:
+      dblQuantity = -(double)m_row.nPositionActive;
+      break;
+    default:
+      break; // no active quantity, contributes nothing
+  }
+  ou::tf::Greek::greeks_t added;
+  if ( 0.0 != dblQuantity ) {
+    const double dblScale( dblQuantity * m_pOption->GetInstrument()->GetMultiplier() );
+    const ou::tf::Greek& greek( m_pOption->LastGreek() );
+    added.delta = dblScale * greek.Delta();
+    added.gamma = dblScale * greek.Gamma();
+    added.theta = dblScale * greek.Theta();
+    added.vega  = dblScale * greek.Vega();
+    added.rho   = dblScale * greek.Rho();
+  }
+  greeks.delta += added.delta;
+  greeks.gamma += added.gamma;
+  greeks.theta += added.theta;
+  greeks.vega  += added.vega;
+  greeks.rho   += added.rho;
+  const bool bChanged(
+       ( added.delta != m_greeksAdded.delta ) || ( added.gamma != m_greeksAdded.gamma )
+    || ( added.theta != m_greeksAdded.theta ) || ( added.vega  != m_greeksAdded.vega )
+    || ( added.rho   != m_greeksAdded.rho ) );
+  m_greeksAdded = added;
+  return bChanged;
+}
+
 // TODO: multiply by multiplier and position size
 std::ostream& operator<<( std::ostream& os, const PositionGreek& position ) {
   const ou::tf::Greek& greek( position.m_pOption->LastGreek() );
   os 
-    << (Position) position
+    << static_cast<const Position&>( position )
     << ", ImpVol " << greek.ImpliedVolatility() 
     << ", Delta " << greek.Delta()
     << ", Gamma " << greek.Gamma()
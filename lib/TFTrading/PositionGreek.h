@@ -54,6 +54,10 @@ public:
   ou::Delegate<const ou::tf::Greek&> OnGreek; // need to fire this on option updates
   
   void PositionPendingDelta( int n );  // -1 or +1
+
+  // last greeks scaled by active quantity (signed by side) and multiplier, added into the totals
+  //   true when the contribution differs from that of the previous call, aggregation thread only
+  bool AddGreeks( ou::tf::Greek::greeks_t& );
   
 protected:
   
@@ -65,6 +69,8 @@ private:
   pUnderlying_t m_pUnderlying;
   
   int m_nQuantity;  // number of contracts
+
+  ou::tf::Greek::greeks_t m_greeksAdded; // contribution at the last AddGreeks
   
   void Construction();
 
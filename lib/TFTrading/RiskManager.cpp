@@ -15,16 +15,245 @@
 
 #include "stdafx.h"
 
+#include <cmath>
+
+#include <OUCommon/TimeSource.h>
+
 #include "RiskManager.h"
 
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
-RiskManager::RiskManager(void): ou::db::ManagerBase<RiskManager>() {
+namespace {
+
+  void Add( std::atomic<double>& dbl, double increment ) {
+    double current = dbl.load( std::memory_order_relaxed );
+    while ( !dbl.compare_exchange_weak( current, current + increment, std::memory_order_relaxed ) ) {}
+  }
+
+  int64_t Second( void ) {
+    static const ptime dtEpoch( boost::gregorian::date( 1970, 1, 1 ) );
+    return ( ou::TimeSource::LocalCommonInstance().Internal() - dtEpoch ).total_seconds();
+  }
+
+  int64_t Signed( OrderSide::enumOrderSide side, int64_t quan ) {
+    return ( OrderSide::Sell == side ) ? -quan : quan;
+  }
+
+}
+
+//
+// RiskManager::State
+//
+
+RiskManager::State::State( void )
+: nMaxPosition( 0 ), nMaxOrdersPerSecond( 0 ), nMaxOpenOrders( 0 ), dblMaxNotional( 0.0 ), dblPriceBand( 0.0 ),
+  nPosition( 0 ), nPendingBuy( 0 ), nPendingSell( 0 ), dblNotional( 0.0 ), nOpenOrders( 0 ),
+  nRateSecond( 0 ), nRateCount( 0 )
+{
+}
+
+void RiskManager::State::Set( const Limits& limits ) {
+  nMaxPosition.store( limits.nMaxPosition );
+  nMaxOrdersPerSecond.store( limits.nMaxOrdersPerSecond );
+  nMaxOpenOrders.store( limits.nMaxOpenOrders );
+  dblMaxNotional.store( limits.dblMaxNotional );
+  dblPriceBand.store( limits.dblPriceBand );
+}
+
+RiskManager::ERejection RiskManager::State::Test( const Order& order, double dblReference, double dblMultiplier, int64_t nSecond ) const {
+
+  const std::memory_order relaxed( std::memory_order_relaxed );
+  const int64_t quan = order.GetQuanRemaining();
+  const OrderSide::enumOrderSide side = order.GetOrderSide();
+
+  const uint32_t nMaxOpenOrders_ = nMaxOpenOrders.load( relaxed );
+  if ( ( 0 != nMaxOpenOrders_ ) && ( nMaxOpenOrders_ <= nOpenOrders.load( relaxed ) ) ) {
+    return ERejection::OpenOrders;
+  }
+
+  const uint32_t nMaxOrdersPerSecond_ = nMaxOrdersPerSecond.load( relaxed );
+  if ( ( 0 != nMaxOrdersPerSecond_ )
+    && ( nSecond == nRateSecond.load( relaxed ) )
+    && ( nMaxOrdersPerSecond_ <= nRateCount.load( relaxed ) ) ) {
+    return ERejection::OrderRate;
+  }
+
+  const uint32_t nMaxPosition_ = nMaxPosition.load( relaxed );
+  if ( 0 != nMaxPosition_ ) {
+    // worst case: all open orders on this side fill
+    const int64_t nPosition_ = nPosition.load( relaxed );
+    const int64_t nWorst = ( OrderSide::Buy == side )
+      ? ( nPosition_ + nPendingBuy.load( relaxed ) + quan )
+      : ( nPosition_ - nPendingSell.load( relaxed ) - quan );
+    if ( (int64_t)nMaxPosition_ < std::abs( nWorst ) ) {
+      return ERejection::Position;
+    }
+  }
+
+  const double dblMaxNotional_ = dblMaxNotional.load( relaxed );
+  if ( ( 0.0 != dblMaxNotional_ ) && ( 0.0 < dblReference ) ) {
+    const double dblAfter = dblNotional.load( relaxed ) + (double)Signed( side, quan ) * dblReference * dblMultiplier;
+    if ( dblMaxNotional_ < std::fabs( dblAfter ) ) {
+      return ERejection::Notional;
+    }
+  }
+
+  return ERejection::Accepted;
+}
+
+void RiskManager::State::Accept( const Order& order, int64_t nSecond ) {
+  const int64_t quan = order.GetQuanRemaining();
+  if ( OrderSide::Buy == order.GetOrderSide() ) nPendingBuy.fetch_add( quan, std::memory_order_relaxed );
+  else nPendingSell.fetch_add( quan, std::memory_order_relaxed );
+  nOpenOrders.fetch_add( 1, std::memory_order_relaxed );
+  int64_t nRateSecond_ = nRateSecond.load( std::memory_order_relaxed );
+  if ( ( nSecond != nRateSecond_ ) && nRateSecond.compare_exchange_strong( nRateSecond_, nSecond, std::memory_order_relaxed ) ) {
+    nRateCount.store( 1, std::memory_order_relaxed );  // first in a new second
+  }
+  else {
+    nRateCount.fetch_add( 1, std::memory_order_relaxed );
+  }
+}
+
+void RiskManager::State::Fill( OrderSide::enumOrderSide side, int64_t quan, double dblNotional_, bool bOrderDone ) {
+  nPosition.fetch_add( Signed( side, quan ), std::memory_order_relaxed );
+  if ( OrderSide::Buy == side ) nPendingBuy.fetch_sub( quan, std::memory_order_relaxed );
+  else nPendingSell.fetch_sub( quan, std::memory_order_relaxed );
+  Add( dblNotional, dblNotional_ );
+  if ( bOrderDone ) nOpenOrders.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+void RiskManager::State::Cancel( OrderSide::enumOrderSide side, int64_t quan ) {
+  if ( OrderSide::Buy == side ) nPendingBuy.fetch_sub( quan, std::memory_order_relaxed );
+  else nPendingSell.fetch_sub( quan, std::memory_order_relaxed );
+  nOpenOrders.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+//
+// RiskManager
+//
+
+RiskManager::RiskManager(void): ou::db::ManagerBase<RiskManager>(), m_bKillSwitch( false ), m_nKillSwitch( 0 ) {
 }
 
 RiskManager::~RiskManager(void) {
 }
 
+RiskManager::State& RiskManager::Locate( mapState_t& map, const std::string& sKey ) {
+  {
+    std::shared_lock<std::shared_mutex> lock( m_mutex );
+    mapState_t::iterator iter = map.find( sKey );
+    if ( map.end() != iter ) return iter->second;
+  }
+  std::unique_lock<std::shared_mutex> lock( m_mutex );
+  return map[ sKey ];  // scopes without limits are still tracked, limits may be applied later
+}
+
+void RiskManager::SetGlobalLimits( const Limits& limits ) {
+  m_stateGlobal.Set( limits );
+}
+
+void RiskManager::SetInstrumentLimits( const idInstrument_t& idInstrument, const Limits& limits ) {
+  Locate( m_mapInstrument, idInstrument ).Set( limits );
+}
+
+void RiskManager::SetPortfolioLimits( const idPortfolio_t& idPortfolio, const Limits& limits ) {
+  Locate( m_mapPortfolio, idPortfolio ).Set( limits );
+}
+
+RiskManager::ERejection RiskManager::Check( const Order& order, const idPortfolio_t& idPortfolio, const Quote& quote ) {
+
+  State& stateInstrument( Locate( m_mapInstrument, order.GetInstrument()->GetInstrumentName() ) );
+  State& statePortfolio( Locate( m_mapPortfolio, idPortfolio ) );
+
+  ERejection eRejection( ERejection::Accepted );
+
+  const bool bQuote( quote.IsValid() && ( 0.0 < quote.Bid() ) && ( 0.0 < quote.Ask() ) );
+  const double dblMid( bQuote ? quote.Midpoint() : 0.0 );
+  const bool bPriced( ( OrderType::Market != order.GetOrderType() ) && ( 0.0 < order.GetPrice1() ) );
+
+  if ( m_bKillSwitch.load( std::memory_order_relaxed ) ) {
+    const int64_t quan = order.GetQuanRemaining();
+    const int64_t nPosition = stateInstrument.nPosition.load( std::memory_order_relaxed );
+    const bool bReducing = ( OrderSide::Buy == order.GetOrderSide() )
+      ? ( 0 >= ( nPosition + stateInstrument.nPendingBuy.load( std::memory_order_relaxed ) + quan ) )
+      : ( 0 <= ( nPosition - stateInstrument.nPendingSell.load( std::memory_order_relaxed ) - quan ) );
+    if ( !bReducing ) eRejection = ERejection::KillSwitch;
+  }
+
+  // fat finger, instrument scope and global
+  if ( ( ERejection::Accepted == eRejection ) && bPriced && bQuote ) {
+    const double dblDeviation = std::fabs( order.GetPrice1() - dblMid ) / dblMid;
+    const double dblBandInstrument = stateInstrument.dblPriceBand.load( std::memory_order_relaxed );
+    const double dblBandGlobal = m_stateGlobal.dblPriceBand.load( std::memory_order_relaxed );
+    if ( ( ( 0.0 != dblBandInstrument ) && ( dblBandInstrument < dblDeviation ) )
+      || ( ( 0.0 != dblBandGlobal ) && ( dblBandGlobal < dblDeviation ) ) ) {
+      eRejection = ERejection::PriceBand;
+    }
+  }
+
+  const double dblReference( bPriced ? order.GetPrice1() : dblMid );
+  const double dblMultiplier( order.GetInstrument()->GetMultiplier() );
+  const int64_t nSecond( Second() );
+
+  if ( ERejection::Accepted == eRejection ) eRejection = stateInstrument.Test( order, dblReference, dblMultiplier, nSecond );
+  if ( ERejection::Accepted == eRejection ) eRejection = statePortfolio.Test( order, dblReference, dblMultiplier, nSecond );
+  if ( ERejection::Accepted == eRejection ) eRejection = m_stateGlobal.Test( order, dblReference, dblMultiplier, nSecond );
+
+  if ( ERejection::Accepted == eRejection ) {
+    stateInstrument.Accept( order, nSecond );
+    statePortfolio.Accept( order, nSecond );
+    m_stateGlobal.Accept( order, nSecond );
+  }
+  else {
+    OnRejection( rejection_t( order, eRejection ) );
+  }
+
+  return eRejection;
+}
+
+void RiskManager::Filled( const Order& order, const idPortfolio_t& idPortfolio, const Execution& exec ) {
+  const int64_t quan = exec.GetSize();
+  const OrderSide::enumOrderSide side = exec.GetOrderSide();
+  const double dblNotional = (double)Signed( side, quan ) * exec.GetPrice() * order.GetInstrument()->GetMultiplier();
+  const bool bOrderDone( 0 == order.GetQuanRemaining() );
+  Locate( m_mapInstrument, order.GetInstrument()->GetInstrumentName() ).Fill( side, quan, dblNotional, bOrderDone );
+  Locate( m_mapPortfolio, idPortfolio ).Fill( side, quan, dblNotional, bOrderDone );
+  m_stateGlobal.Fill( side, quan, dblNotional, bOrderDone );
+}
+
+void RiskManager::Cancelled( const Order& order, const idPortfolio_t& idPortfolio ) {
+  const int64_t quan = order.GetQuanRemaining();
+  const OrderSide::enumOrderSide side = order.GetOrderSide();
+  Locate( m_mapInstrument, order.GetInstrument()->GetInstrumentName() ).Cancel( side, quan );
+  Locate( m_mapPortfolio, idPortfolio ).Cancel( side, quan );
+  m_stateGlobal.Cancel( side, quan );
+}
+
+void RiskManager::EngageKillSwitch( void ) {
+  m_bKillSwitch.store( true, std::memory_order_release );
+  m_nKillSwitch.fetch_add( 1, std::memory_order_release );  // OrdersOutstanding act on the next quote
+  OnKillSwitch( true );
+}
+
+void RiskManager::ResetKillSwitch( void ) {
+  m_bKillSwitch.store( false, std::memory_order_release );
+  OnKillSwitch( false );
+}
+
+const char* RiskManager::Name( ERejection eRejection ) {
+  switch ( eRejection ) {
+    case ERejection::Accepted: return "accepted";
+    case ERejection::KillSwitch: return "kill switch";
+    case ERejection::Position: return "position limit";
+    case ERejection::Notional: return "notional limit";
+    case ERejection::OrderRate: return "order rate limit";
+    case ERejection::OpenOrders: return "open order limit";
+    case ERejection::PriceBand: return "outside price band";
+  }
+  return "unknown";
+}
+
 } // namespace tf
 } // namespace ou
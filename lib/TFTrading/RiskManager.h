@@ -13,19 +13,118 @@
 
 // Started 20130407
 
+// pre-trade risk checks, Position::PlaceOrder runs each order through Check before it goes to OrderManager
+//   limits are held per instrument, per portfolio and globally, a limit of 0 is not checked
+//   usage (position, pending quantity, open orders, order rate) is maintained from the order path,
+//     executions and cancellations as atomics, one cache line per scope, so a check takes no locks
+//     other than a shared lock to find the instrument and portfolio scopes, exclusive only to add a scope
+//   an order rejected by the provider, or cancelled, releases its usage through Position, as does a fill
+//   the kill switch is a flag and a generation, each OrdersOutstanding cancels and closes on its next quote,
+//     on its own thread, rather than from the thread engaging the switch
+//   check and accept are not a single atomic step, orders from concurrent threads may overshoot a limit by an order
+
 #pragma once
 
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include <OUCommon/Delegate.h>
 #include <OUCommon/ManagerBase.h>
 
+#include <TFTimeSeries/DatedDatum.h>
+
+#include "KeyTypes.h"
+#include "Order.h"
+#include "Execution.h"
+
 namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 class RiskManager: public ou::db::ManagerBase<RiskManager> {
 public:
+
+  typedef keytypes::idInstrument_t idInstrument_t;
+  typedef keytypes::idPortfolio_t idPortfolio_t;
+
+  struct Limits { // 0 for no limit
+    uint32_t nMaxPosition;  // absolute net quantity, including pending orders on the side of the order
+    double dblMaxNotional;  // absolute net notional ( quantity * price * multiplier ), filled plus the order
+    uint32_t nMaxOrdersPerSecond;
+    uint32_t nMaxOpenOrders;
+    double dblPriceBand;  // limit and stop prices within this fraction of the quote mid (fat finger), instrument and global only
+    Limits( void )
+    : nMaxPosition( 0 ), dblMaxNotional( 0.0 ), nMaxOrdersPerSecond( 0 ), nMaxOpenOrders( 0 ), dblPriceBand( 0.0 ) {};
+  };
+
+  enum class ERejection { Accepted = 0, KillSwitch, Position, Notional, OrderRate, OpenOrders, PriceBand };
+
   RiskManager(void);
   ~RiskManager(void);
+
+  void SetGlobalLimits( const Limits& );
+  void SetInstrumentLimits( const idInstrument_t&, const Limits& );
+  void SetPortfolioLimits( const idPortfolio_t&, const Limits& );
+
+  // quote is the last quote from the position's watch, used for price bands and notional of market orders
+  // an accepted order is counted against the limits until filled, cancelled or rejected by the provider
+  ERejection Check( const Order&, const idPortfolio_t&, const Quote& );
+  void Filled( const Order&, const idPortfolio_t&, const Execution& );
+  void Cancelled( const Order&, const idPortfolio_t& );
+
+  // kill switch: only orders reducing an instrument's position are accepted,
+  //   OrdersOutstanding cancel their orders and close their round trips on their next quote
+  void EngageKillSwitch( void );
+  void ResetKillSwitch( void );
+  bool KillSwitchEngaged( void ) const { return m_bKillSwitch.load( std::memory_order_acquire ); };
+  unsigned int KillSwitchGeneration( void ) const { return m_nKillSwitch.load( std::memory_order_acquire ); }; // changes with each engage
+
+  typedef std::pair<const Order&, ERejection> rejection_t;
+  ou::Delegate<const rejection_t&> OnRejection;
+  ou::Delegate<bool> OnKillSwitch;  // true when engaged
+
+  static const char* Name( ERejection );
+
 protected:
 private:
+
+  struct alignas(64) State {
+    // limits
+    std::atomic<uint32_t> nMaxPosition;
+    std::atomic<uint32_t> nMaxOrdersPerSecond;
+    std::atomic<uint32_t> nMaxOpenOrders;
+    std::atomic<double> dblMaxNotional;
+    std::atomic<double> dblPriceBand;
+    // usage
+    std::atomic<int64_t> nPosition;  // net filled, signed
+    std::atomic<int64_t> nPendingBuy;  // quantity remaining on open buy orders
+    std::atomic<int64_t> nPendingSell;  // quantity remaining on open sell orders
+    std::atomic<double> dblNotional;  // net filled notional, signed
+    std::atomic<uint32_t> nOpenOrders;
+    std::atomic<int64_t> nRateSecond;  // second to which nRateCount applies
+    std::atomic<uint32_t> nRateCount;
+    State( void );
+    void Set( const Limits& );
+    ERejection Test( const Order&, double dblReference, double dblMultiplier, int64_t nSecond ) const;
+    void Accept( const Order&, int64_t nSecond );
+    void Fill( OrderSide::enumOrderSide, int64_t quan, double dblNotional, bool bOrderDone );
+    void Cancel( OrderSide::enumOrderSide, int64_t quan );
+  };
+
+  typedef std::unordered_map<std::string,State> mapState_t;  // nodes don't move, State is referenced outside the lock
+
+  std::atomic<bool> m_bKillSwitch;
+  std::atomic<unsigned int> m_nKillSwitch;
+
+  State m_stateGlobal;
+
+  std::shared_mutex m_mutex;  // scope lookup
+  mapState_t m_mapInstrument;
+  mapState_t m_mapPortfolio;
+
+  State& Locate( mapState_t&, const std::string& );
 };
 
 } // namespace tf
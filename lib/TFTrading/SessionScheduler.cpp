@@ -0,0 +1,386 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    SessionScheduler.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 17, 2020, 10:20
+ */
+
+#include "stdafx.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include <OUCommon/TimeSource.h>
+
+#include "SessionScheduler.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+namespace {
+  const boost::posix_time::ptime dtEpoch( boost::gregorian::date( 1970, 1, 1 ) );
+}
+
+SessionScheduler::Calendar SessionScheduler::Calendar::USEquity() {
+  Calendar calendar;
+  calendar.sZone = "America/New_York";
+  calendar.rOffset = { {
+    { 0, boost::posix_time::time_duration(  7,  0,  0 ) }, // MarketOpen
+    { 0, boost::posix_time::time_duration(  9, 30,  0 ) }, // RHOpen
+    { 0, boost::posix_time::time_duration(  9, 30, 30 ) }, // StartTrading
+    { 0, boost::posix_time::time_duration( 15, 56,  0 ) }, // Cancellation
+    { 0, boost::posix_time::time_duration( 15, 56, 15 ) }, // GoNeutral
+    { 0, boost::posix_time::time_duration( 15, 58,  0 ) }, // WaitForRHClose
+    { 0, boost::posix_time::time_duration( 16,  0,  0 ) }, // RHClose
+    { 0, boost::posix_time::time_duration( 17, 30,  0 ) }  // MarketClose
+  } };
+  calendar.pHolidays = &ou::tf::holidays::exchange::setUSDates;
+  return calendar;
+}
+
+// the trading date is the regular hours date, the day after the one passed to InitForUS24HourFutures
+SessionScheduler::Calendar SessionScheduler::Calendar::US24HourFutures() {
+  Calendar calendar;
+  calendar.sZone = "America/New_York";
+  calendar.rOffset = { {
+    { -1, boost::posix_time::time_duration( 17, 45,  0 ) }, // MarketOpen, prior evening
+    {  0, boost::posix_time::time_duration(  9, 30,  0 ) }, // RHOpen
+    {  0, boost::posix_time::time_duration(  9, 30, 30 ) }, // StartTrading
+    {  0, boost::posix_time::time_duration( 15, 57,  0 ) }, // Cancellation
+    {  0, boost::posix_time::time_duration( 15, 57,  5 ) }, // GoNeutral
+    {  0, boost::posix_time::time_duration( 15, 58,  0 ) }, // WaitForRHClose
+    {  0, boost::posix_time::time_duration( 16,  0,  0 ) }, // RHClose
+    {  0, boost::posix_time::time_duration( 17, 15,  0 ) }  // MarketClose
+  } };
+  calendar.pHolidays = &ou::tf::holidays::exchange::setUSDates;
+  return calendar;
+}
+
+SessionScheduler::SessionScheduler( bool bSimulation, boost::posix_time::time_duration resolution )
+: m_bSimulation( bSimulation ),
+  m_nResolution( std::max<int64_t>( 1, resolution.total_microseconds() ) ),
+  m_tickCurrent( tickNone ),
+  m_idNext( 1 ),
+  m_bAdvancing( false ),
+  m_vSlot( nSlots ),
+  m_bRunning( false )
+{
+  static_assert( 0 == ( nSlots & ( nSlots - 1 ) ), "nSlots must be a power of two" );
+}
+
+SessionScheduler::~SessionScheduler() {
+  Stop();
+}
+
+void SessionScheduler::Start() {
+  assert( !m_bSimulation );
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( !m_bRunning ) {
+    m_bRunning = true;
+    m_thread = std::thread(
+      [this](){
+        for (;;) {
+          {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            if ( m_cvStop.wait_for(
+                   lock, std::chrono::microseconds( m_nResolution ), [this]{ return !m_bRunning; } ) ) break;
+          }
+          Advance( ou::TimeSource::Instance().External() );
+        }
+      } );
+  }
+}
+
+void SessionScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_bRunning = false;
+  }
+  m_cvStop.notify_all();
+  if ( m_thread.joinable() ) {
+    m_thread.join();
+  }
+}
+
+int64_t SessionScheduler::Tick( boost::posix_time::ptime dt ) const {
+  if ( dt.is_special() ) return tickNone;
+  return ( dt - dtEpoch ).total_microseconds() / m_nResolution;
+}
+
+int64_t SessionScheduler::Deadline( boost::posix_time::ptime dt ) const {
+  assert( !dt.is_special() );
+  return ( ( dt - dtEpoch ).total_microseconds() + m_nResolution - 1 ) / m_nResolution;
+}
+
+boost::posix_time::ptime SessionScheduler::Now() const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return m_dtNow;
+}
+
+// moves timers due by tickTo out of the slots covering tickFrom .. tickTo
+void SessionScheduler::Collect( int64_t tickFrom, int64_t tickTo, vTimer_t& vDue ) {
+
+  auto collect = [this,tickTo,&vDue]( vTimer_t& vSlot ){
+    vTimer_t::iterator iterKeep = vSlot.begin();
+    for ( vTimer_t::iterator iter = vSlot.begin(); vSlot.end() != iter; ++iter ) {
+      if ( tickTo >= iter->tick ) {
+        m_mapTimer.erase( iter->id );
+        vDue.emplace_back( std::move( *iter ) );
+      }
+      else {
+        if ( iterKeep != iter ) *iterKeep = std::move( *iter );
+        ++iterKeep;
+      }
+    }
+    vSlot.erase( iterKeep, vSlot.end() );
+  };
+
+  if ( ( tickNone == tickFrom ) || ( ( tickTo - tickFrom ) >= (int64_t)nSlots ) ) {
+    for ( vTimer_t& vSlot: m_vSlot ) { // a revolution or more, every slot
+      collect( vSlot );
+    }
+  }
+  else {
+    for ( int64_t tick = tickFrom; tick <= tickTo; ++tick ) {
+      collect( m_vSlot[ tick & ( nSlots - 1 ) ] );
+    }
+  }
+}
+
+void SessionScheduler::AdvanceTo( boost::posix_time::ptime dt ) {
+
+  std::lock_guard<std::mutex> lockAdvance( m_mutexAdvance );
+
+  const int64_t tick( Tick( dt ) );
+  vTimer_t vDue;
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const int64_t tickCurrent( m_tickCurrent.load( std::memory_order_relaxed ) );
+    if ( tick <= tickCurrent ) return; // another thread has been here first
+    Collect( ( tickNone == tickCurrent ) ? tickNone : tickCurrent + 1, tick, vDue );
+    m_dtNow = dt;
+    m_bAdvancing = true;
+    m_tickCurrent.store( tick, std::memory_order_release );
+  }
+
+  // timers fire outside the lock so they may schedule and cancel,
+  //   anything they schedule at or before this time is picked up from m_vLate
+  for (;;) {
+    std::sort(
+      vDue.begin(), vDue.end(),
+      []( const Timer& lhs, const Timer& rhs ){
+        return ( lhs.tick < rhs.tick ) || ( ( lhs.tick == rhs.tick ) && ( lhs.id < rhs.id ) ); } );
+    for ( Timer& timer: vDue ) {
+      timer.f( timer.dt );
+    }
+    vDue.clear();
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    vDue.swap( m_vLate );
+    if ( vDue.empty() ) {
+      m_bAdvancing = false;
+      break;
+    }
+    for ( const Timer& timer: vDue ) {
+      m_mapTimer.erase( timer.id );
+    }
+  }
+}
+
+SessionScheduler::idTimer_t SessionScheduler::Schedule( boost::posix_time::ptime dt, fTimer_t&& f ) {
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  const idTimer_t id( m_idNext++ );
+  int64_t tick( Deadline( dt ) );
+  const int64_t tickCurrent( m_tickCurrent.load( std::memory_order_relaxed ) );
+
+  if ( ( tickNone != tickCurrent ) && ( tick <= tickCurrent ) ) {
+    if ( m_bAdvancing ) {
+      m_vLate.emplace_back( Timer{ tick, id, dt, std::move( f ) } );
+      m_mapTimer.emplace( id, tick );
+      return id;
+    }
+    tick = tickCurrent + 1;
+  }
+
+  m_vSlot[ tick & ( nSlots - 1 ) ].emplace_back( Timer{ tick, id, dt, std::move( f ) } );
+  m_mapTimer.emplace( id, tick );
+  return id;
+}
+
+bool SessionScheduler::Cancel( idTimer_t id ) {
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+
+  auto iterMap = m_mapTimer.find( id );
+  if ( m_mapTimer.end() == iterMap ) return false;
+
+  auto match = [id]( const Timer& timer ){ return id == timer.id; };
+
+  vTimer_t& vSlot( m_vSlot[ iterMap->second & ( nSlots - 1 ) ] );
+  vTimer_t::iterator iter = std::find_if( vSlot.begin(), vSlot.end(), match );
+  if ( vSlot.end() != iter ) {
+    vSlot.erase( iter );
+  }
+  else {
+    iter = std::find_if( m_vLate.begin(), m_vLate.end(), match );
+    assert( m_vLate.end() != iter );
+    m_vLate.erase( iter );
+  }
+  m_mapTimer.erase( iterMap );
+  return true;
+}
+
+bool SessionScheduler::IsTradingDate( const Calendar& calendar, boost::gregorian::date date ) {
+  const boost::gregorian::greg_weekday day( date.day_of_week() );
+  if ( ( boost::gregorian::Saturday == day ) || ( boost::gregorian::Sunday == day ) ) return false;
+  if ( nullptr == calendar.pHolidays ) return true;
+  return calendar.pHolidays->end() == calendar.pHolidays->find( date );
+}
+
+SessionScheduler::rBoundary_t SessionScheduler::ComputeBoundaries( const Calendar& calendar, boost::gregorian::date date ) {
+  rBoundary_t rBoundary;
+  for ( size_t ix = 0; ix < nBoundaries; ++ix ) {
+    const Calendar::Offset& offset( calendar.rOffset[ ix ] );
+    rBoundary[ ix ] = ou::TimeSource::Instance().ConvertRegionalToUtc(
+      date + boost::gregorian::date_duration( offset.nDays ), offset.td, calendar.sZone, true );
+  }
+  return rBoundary;
+}
+
+SessionScheduler::idSession_t SessionScheduler::AddSession( const Calendar& calendar, boost::gregorian::date date ) {
+
+  std::unique_ptr<Session> pSession( new Session );
+  pSession->calendar = calendar;
+  while ( !IsTradingDate( calendar, date ) ) date += boost::gregorian::date_duration( 1 );
+  pSession->date = date;
+  pSession->rBoundary = ComputeBoundaries( calendar, date );
+  pSession->ixNext = 0;
+
+  Session& session( *pSession );
+  idSession_t id;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    id = m_vSession.size();
+    m_vSession.emplace_back( std::move( pSession ) );
+  }
+
+  ScheduleSession( session );
+  return id;
+}
+
+void SessionScheduler::ScheduleSession( Session& session ) {
+  rBoundary_t rBoundary;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    rBoundary = session.rBoundary;
+  }
+  for ( size_t ix = 0; ix < nBoundaries; ++ix ) {
+    const Boundary boundary( static_cast<Boundary>( ix ) );
+    Schedule( rBoundary[ ix ], [this,&session,boundary]( boost::posix_time::ptime ){ Deliver( session, boundary ); } );
+  }
+}
+
+void SessionScheduler::Deliver( Session& session, Boundary boundary ) {
+
+  std::lock_guard<std::recursive_mutex> lockDelivery( session.mutexDelivery );
+
+  const bool bRoll( Boundary::MarketClose == boundary );
+
+  std::vector<Subscriber*> vSubscriber;
+  rBoundary_t rBoundary;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( bRoll ) { // to the next trading date
+      boost::gregorian::date date( session.date + boost::gregorian::date_duration( 1 ) );
+      while ( !IsTradingDate( session.calendar, date ) ) date += boost::gregorian::date_duration( 1 );
+      session.date = date;
+      session.rBoundary = ComputeBoundaries( session.calendar, date );
+      session.ixNext = 0;
+    }
+    else {
+      session.ixNext = static_cast<size_t>( boundary ) + 1;
+    }
+    vSubscriber = session.vSubscriber;
+    rBoundary = session.rBoundary;
+  }
+
+  for ( Subscriber* pSubscriber: vSubscriber ) {
+    pSubscriber->SessionBoundary( boundary, rBoundary, false );
+  }
+
+  if ( bRoll ) {
+    ScheduleSession( session );
+  }
+}
+
+boost::gregorian::date SessionScheduler::TradingDate( idSession_t id ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  assert( id < m_vSession.size() );
+  return m_vSession[ id ]->date;
+}
+
+SessionScheduler::rBoundary_t SessionScheduler::Boundaries( idSession_t id ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  assert( id < m_vSession.size() );
+  return m_vSession[ id ]->rBoundary;
+}
+
+void SessionScheduler::Subscribe( idSession_t id, Subscriber* pSubscriber ) {
+
+  Session* pSession;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    assert( id < m_vSession.size() );
+    pSession = m_vSession[ id ].get();
+  }
+
+  std::lock_guard<std::recursive_mutex> lockDelivery( pSession->mutexDelivery );
+
+  size_t ixNext;
+  rBoundary_t rBoundary;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    pSession->vSubscriber.push_back( pSubscriber );
+    ixNext = pSession->ixNext;
+    rBoundary = pSession->rBoundary;
+  }
+
+  for ( size_t ix = 0; ix < ixNext; ++ix ) { // catch up on the current trading date
+    pSubscriber->SessionBoundary( static_cast<Boundary>( ix ), rBoundary, true );
+  }
+}
+
+void SessionScheduler::Unsubscribe( idSession_t id, Subscriber* pSubscriber ) {
+
+  Session* pSession;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    assert( id < m_vSession.size() );
+    pSession = m_vSession[ id ].get();
+  }
+
+  std::lock_guard<std::recursive_mutex> lockDelivery( pSession->mutexDelivery );
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+  std::vector<Subscriber*>& v( pSession->vSubscriber );
+  v.erase( std::remove( v.begin(), v.end(), pSubscriber ), v.end() );
+}
+
+} // namespace tf
+} // namespace ou
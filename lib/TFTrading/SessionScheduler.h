@@ -0,0 +1,179 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    SessionScheduler.h
+ * Author:  raymond@burkholder.net
+ * Project: TFTrading
+ * Created: May 17, 2020, 10:20
+ */
+
+// session boundaries shared by many DailyTradeTimeFrame instances
+//   a session is an exchange calendar (boundary times, time zone, holidays), its boundaries are computed once
+//     per trading date and held as one timer each in a hashed timer wheel, rather than being compared against
+//     the datum time on every tick of every strategy
+//   subscribers receive each boundary as it passes, including on symbols which are not quoting
+//   time advances through Advance:
+//     live: Start() runs a thread advancing from TimeSource External at the wheel resolution
+//     simulation: the simulated datum time, DailyTradeTimeFrame::TimeTick advances a simulated scheduler,
+//       a simulation driver can also call Advance directly to cover quiet periods
+//   timers and boundaries are fired on the thread calling Advance, a subscriber with work to do on its own
+//     thread records the boundary and hands off from there (DailyTradeTimeFrame runs its one shots in TimeTick)
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <TFTimeSeries/ExchangeHolidays.h>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class SessionScheduler {
+public:
+
+  // in chronological order within a trading date
+  enum class Boundary { MarketOpen = 0, RHOpen, StartTrading, Cancellation, GoNeutral, WaitForRHClose, RHClose, MarketClose };
+  static const size_t nBoundaries = 8;
+
+  using rBoundary_t = std::array<boost::posix_time::ptime,nBoundaries>; // utc, indexed by Boundary
+
+  struct Calendar {
+    struct Offset {
+      int nDays; // relative to the trading date (the regular hours date)
+      boost::posix_time::time_duration td; // time of day in sZone
+    };
+    std::string sZone;
+    std::array<Offset,nBoundaries> rOffset;
+    const ou::tf::holidays::exchange::setDates_t* pHolidays; // nullptr for no holidays
+    // same times as DailyTradeTimeFrame InitForUSEquityExchanges, InitForUS24HourFutures
+    static Calendar USEquity();
+    static Calendar US24HourFutures();
+  };
+
+  class Subscriber {
+  public:
+    virtual ~Subscriber() {}
+    // boundaries of the current trading date, MarketClose carries those of the next trading date
+    //   bCatchUp: the boundary had passed before the subscription, delivered from Subscribe
+    virtual void SessionBoundary( Boundary, const rBoundary_t&, bool bCatchUp ) = 0;
+  };
+
+  using idSession_t = size_t;
+  using idTimer_t = uint64_t;
+  using fTimer_t = std::function<void(boost::posix_time::ptime)>; // called with the scheduled time
+
+  explicit SessionScheduler(
+    bool bSimulation, boost::posix_time::time_duration resolution = boost::posix_time::seconds( 1 ) );
+  SessionScheduler( const SessionScheduler& ) = delete;
+  ~SessionScheduler();
+
+  bool Simulated() const { return m_bSimulation; }
+
+  void Start(); // live only: thread advancing from TimeSource External
+  void Stop();
+
+  // hot path: a single load when the time has not moved past the current resolution tick
+  void Advance( boost::posix_time::ptime dt ) {
+    if ( Tick( dt ) > m_tickCurrent.load( std::memory_order_acquire ) ) {
+      AdvanceTo( dt );
+    }
+  }
+
+  boost::posix_time::ptime Now() const; // time of the last Advance
+
+  // one shot timers, a time already passed fires on the next Advance
+  idTimer_t Schedule( boost::posix_time::ptime, fTimer_t&& );
+  bool Cancel( idTimer_t ); // false if already fired or in the process of firing
+
+  // boundaries start with the first trading date on or after date, roll to the next trading date after MarketClose
+  idSession_t AddSession( const Calendar&, boost::gregorian::date );
+  boost::gregorian::date TradingDate( idSession_t ) const;
+  rBoundary_t Boundaries( idSession_t ) const;
+
+  // boundaries of the current trading date already passed are delivered during Subscribe, flagged as catch up
+  void Subscribe( idSession_t, Subscriber* );
+  void Unsubscribe( idSession_t, Subscriber* ); // waits for a delivery in progress to complete
+
+  static bool IsTradingDate( const Calendar&, boost::gregorian::date );
+  static rBoundary_t ComputeBoundaries( const Calendar&, boost::gregorian::date );
+
+protected:
+private:
+
+  static const size_t nSlots = 4096; // power of two, one revolution is about an hour at one second resolution
+  static const int64_t tickNone = INT64_MIN;
+
+  struct Timer {
+    int64_t tick;
+    idTimer_t id;
+    boost::posix_time::ptime dt;
+    fTimer_t f;
+  };
+  using vTimer_t = std::vector<Timer>;
+
+  struct Session {
+    Calendar calendar;
+    boost::gregorian::date date;
+    rBoundary_t rBoundary;
+    size_t ixNext; // next boundary to be delivered
+    std::vector<Subscriber*> vSubscriber;
+    std::recursive_mutex mutexDelivery; // a subscriber may unsubscribe from within its handler
+  };
+  using vSession_t = std::vector<std::unique_ptr<Session> >;
+
+  const bool m_bSimulation;
+  const int64_t m_nResolution; // microseconds
+
+  std::atomic<int64_t> m_tickCurrent;
+
+  mutable std::mutex m_mutex; // wheel, timers, sessions
+  std::mutex m_mutexAdvance; // one thread advances at a time
+
+  boost::posix_time::ptime m_dtNow;
+  idTimer_t m_idNext;
+  bool m_bAdvancing;
+
+  std::vector<vTimer_t> m_vSlot;
+  vTimer_t m_vLate; // scheduled during an Advance at or before the time being advanced to
+  std::unordered_map<idTimer_t,int64_t> m_mapTimer; // id -> tick, locates the slot for Cancel
+
+  vSession_t m_vSession;
+
+  bool m_bRunning;
+  std::thread m_thread;
+  std::condition_variable m_cvStop;
+
+  int64_t Tick( boost::posix_time::ptime dt ) const; // floor
+  int64_t Deadline( boost::posix_time::ptime dt ) const; // ceiling
+
+  void AdvanceTo( boost::posix_time::ptime );
+  void Collect( int64_t tickFrom, int64_t tickTo, vTimer_t& );
+  void ScheduleSession( Session& );
+  void Deliver( Session&, Boundary );
+};
+
+} // namespace tf
+} // namespace ou
@@ -18,7 +18,9 @@
 #include <TFHDF5TimeSeries/HDF5WriteTimeSeries.h>
 #include <TFHDF5TimeSeries/HDF5IterateGroups.h>
 #include <TFHDF5TimeSeries/HDF5Attribute.h>
+#include <TFHDF5TimeSeries/HDF5TickFilter.h>
 
+#include <OUCommon/Latency.h>
 #include <OUCommon/TimeSource.h>
 
 #include <TFIQFeed/IQFeedProvider.h>
@@ -33,7 +35,7 @@ Watch::Watch( pInstrument_t pInstrument, pProvider_t pDataProvider ) :
   m_pDataProvider( pDataProvider ),
   m_PriceMax( 0 ), m_PriceMin( 0 ), m_VolumeTotal( 0 ),
   m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false ), m_bRecordSeries( true ),
-  m_bEventsAttached( false )
+  m_bEventsAttached( false ), m_bWatchDepth( false ), m_bTickCodec( false )
 {
   assert( 0 != pInstrument.get() );
   assert( 0 != pDataProvider.get() );
@@ -46,7 +48,7 @@ Watch::Watch( const Watch& rhs ) :
   m_PriceMax( rhs.m_PriceMax ), m_PriceMin( rhs.m_PriceMin ), m_VolumeTotal( rhs.m_VolumeTotal ),
   m_quote( rhs.m_quote ), m_trade( rhs.m_trade ),
   m_cntWatching( 0 ), m_bWatching( false ), m_bWatchingEnabled( false ), m_bRecordSeries( rhs.m_bRecordSeries ),
-  m_bEventsAttached( false )
+  m_bEventsAttached( false ), m_bWatchDepth( rhs.m_bWatchDepth ), m_bTickCodec( rhs.m_bTickCodec )
 {
   assert( 0 == rhs.m_cntWatching );
   assert( !rhs.m_bWatching );
@@ -136,6 +138,9 @@ void Watch::EnableWatch( void ) {
     m_bWatching = true;
     m_pDataProvider->AddQuoteHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleQuote ) );
     m_pDataProvider->AddTradeHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleTrade ) );
+    if ( m_bWatchDepth && m_pDataProvider->ProvidesDepth() ) {
+      m_pDataProvider->AddDepthHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleDepth ) );
+    }
     // these two message types come second so that the symbol gets registered in previous statements
     if ( ou::tf::keytypes::EProviderIQF == m_pDataProvider->ID() ) {
       ou::tf::IQFeedProvider::pProvider_t pIQFeedProvider;
@@ -167,6 +172,9 @@ void Watch::DisableWatch( void ) {
     //std::cout << "Stop Watching " << m_pInstrument->GetInstrumentName() << std::endl;
     m_pDataProvider->RemoveQuoteHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleQuote ) );
     m_pDataProvider->RemoveTradeHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleTrade ) );
+    if ( m_bWatchDepth && m_pDataProvider->ProvidesDepth() ) {
+      m_pDataProvider->RemoveDepthHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleDepth ) );
+    }
     m_bWatching = false;
     if ( ou::tf::keytypes::EProviderIQF == m_pDataProvider->ID() ) {
       ou::tf::IQFeedProvider::pProvider_t pIQFeedProvider;
@@ -180,6 +188,20 @@ void Watch::DisableWatch( void ) {
   }
 }
 
+void Watch::WatchDepth( bool bDepth ) {
+  if ( bDepth != m_bWatchDepth ) {
+    if ( m_bWatching && m_pDataProvider->ProvidesDepth() ) {
+      if ( bDepth ) {
+        m_pDataProvider->AddDepthHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleDepth ) );
+      }
+      else {
+        m_pDataProvider->RemoveDepthHandler( m_pInstrument, MakeDelegate( this, &Watch::HandleDepth ) );
+      }
+    }
+    m_bWatchDepth = bDepth;
+  }
+}
+
 bool Watch::StopWatch( void ) {  // return true if actively stopped feed
 //  std::cout << "Watch::StopWatch: " << this->m_pInstrument->GetInstrumentName() << " " << m_cntWatching << std::endl;
   assert( 0 != m_cntWatching );
@@ -201,6 +223,7 @@ void Watch::EmitValues( void ) const {
 }
 
 void Watch::HandleQuote( const Quote& quote ) {
+  OU_LATENCY_MARK( Watch );
   m_quote = quote;
   //OnPossibleResizeBegin( stateTimeSeries_t( m_quotes.Capacity(), m_quotes.Size() ) );
   {
@@ -211,9 +234,11 @@ void Watch::HandleQuote( const Quote& quote ) {
   //OnPossibleResizeEnd( stateTimeSeries_t( m_quotes.Capacity(), m_quotes.Size() ) );
   //if ( 0 != m_OnQuote ) m_OnQuote( quote );
   OnQuote( quote );
+  OU_LATENCY_MARK( WatchDone );
 }
 
 void Watch::HandleTrade( const Trade& trade ) {
+  OU_LATENCY_MARK( Watch );
   m_trade = trade;
   if ( trade.Price() > m_PriceMax ) m_PriceMax = trade.Price();
   if ( trade.Price() < m_PriceMin ) m_PriceMin = trade.Price();
@@ -226,6 +251,12 @@ void Watch::HandleTrade( const Trade& trade ) {
   //OnPossibleResizeEnd( stateTimeSeries_t( m_trades.Capacity(), m_trades.Size() ) );
   //if ( 0 != m_OnTrade ) m_OnTrade( trade );
   OnTrade( trade );
+  OU_LATENCY_MARK( WatchDone );
+}
+
+void Watch::HandleDepth( const MarketDepth& depth ) {
+  if ( m_bRecordSeries ) m_depths.Append( depth );
+  OnDepth( depth );
 }
 
 void Watch::HandleIQFeedFundamentalMessage( ou::tf::IQFeedSymbol& symbol ) {
@@ -259,9 +290,13 @@ void Watch::SaveSeries( const std::string& sPrefix ) {
 
     std::string sPathName;
 
+    // 0 leaves the writers with shuffle + deflate
+    const uint32_t nPriceScale( m_bTickCodec ? HDF5TickFilter::PriceScale( m_pInstrument->GetSignificantDigits() ) : 0 );
+
     if ( 0 != m_quotes.Size() ) {
       sPathName = sPrefix + "/quotes/" + m_pInstrument->GetInstrumentName();
       HDF5WriteTimeSeries<ou::tf::Quotes> wtsQuotes( dm, true, true, 5, 256 );
+      wtsQuotes.UseTickCodec( nPriceScale );
       wtsQuotes.Write( sPathName, &m_quotes );
       HDF5Attributes attrQuotes( dm, sPathName );
       attrQuotes.SetSignature( ou::tf::Quote::Signature() );
@@ -273,6 +308,7 @@ void Watch::SaveSeries( const std::string& sPrefix ) {
     if ( 0 != m_trades.Size() ) {
       sPathName = sPrefix + "/trades/" + m_pInstrument->GetInstrumentName();
       HDF5WriteTimeSeries<ou::tf::Trades> wtsTrades( dm, true, true, 5, 256 );
+      wtsTrades.UseTickCodec( nPriceScale );
       wtsTrades.Write( sPathName, &m_trades );
       HDF5Attributes attrTrades( dm, sPathName );
       attrTrades.SetSignature( ou::tf::Trade::Signature() );
@@ -281,6 +317,17 @@ void Watch::SaveSeries( const std::string& sPrefix ) {
       attrTrades.SetProviderType( m_pDataProvider->ID() );
     }
 
+    if ( 0 != m_depths.Size() ) {
+      sPathName = sPrefix + "/depths/" + m_pInstrument->GetInstrumentName();
+      HDF5WriteTimeSeries<ou::tf::MarketDepths> wtsDepths( dm, true, true, 5, 256 );
+      wtsDepths.Write( sPathName, &m_depths );
+      HDF5Attributes attrDepths( dm, sPathName );
+      attrDepths.SetSignature( ou::tf::MarketDepth::Signature() );
+      attrDepths.SetMultiplier( m_pInstrument->GetMultiplier() );
+      attrDepths.SetSignificantDigits( m_pInstrument->GetSignificantDigits() );
+      attrDepths.SetProviderType( m_pDataProvider->ID() );
+    }
+
   }
   catch (...) {
     std::cout << "Watch::SaveSeries1 error: " << sPrefix << std::endl;
@@ -322,6 +369,7 @@ void Watch::SaveSeries( const std::string& sPrefix, const std::string& sDaily )
 void Watch::ClearSeries() {
   m_quotes.Clear();
   m_trades.Clear();
+  m_depths.Clear();
 }
 
 } // namespace tf
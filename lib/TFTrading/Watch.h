@@ -86,9 +86,11 @@ public:
 
   const Quotes& GetQuotes( void ) const { return m_quotes; };
   const Trades& GetTrades( void ) const { return m_trades; };
+  const MarketDepths& GetDepths( void ) const { return m_depths; };
 
   ou::Delegate<const Quote&> OnQuote;
   ou::Delegate<const Trade&> OnTrade;
+  ou::Delegate<const MarketDepth&> OnDepth; // feed a DepthBook from here
 
   //typedef std::pair<size_t,size_t> stateTimeSeries_t;
   //ou::Delegate<const stateTimeSeries_t&> OnPossibleResizeBegin;
@@ -102,6 +104,15 @@ public:
   void RecordSeries( bool bRecord ) { m_bRecordSeries = bRecord; }
   bool RecordingSeries() const { return m_bRecordSeries; }
 
+  // level 2, when the provider supplies depth, recorded along with quotes and trades
+  void WatchDepth( bool bDepth );
+  bool WatchingDepth() const { return m_bWatchDepth; }
+
+  // quotes and trades saved through the tick codec, HDF5 filter 311, which only readers linked with
+  //   TFHDF5TimeSeries can decode, so off by default, shuffle + deflate as before
+  void SaveWithTickCodec( bool bTickCodec ) { m_bTickCodec = bTickCodec; }
+  bool SavingWithTickCodec() const { return m_bTickCodec; }
+
   virtual void SaveSeries( const std::string& sPrefix );
   virtual void SaveSeries( const std::string& sPrefix, const std::string& sDaily );
 
@@ -119,6 +130,7 @@ protected:
 
   ou::tf::Quotes m_quotes;
   ou::tf::Trades m_trades;
+  ou::tf::MarketDepths m_depths;
 
   pInstrument_t m_pInstrument;
 
@@ -131,6 +143,8 @@ private:
   bool m_bWatchingEnabled;
   bool m_bWatching; // in/out of connected state
   bool m_bEventsAttached; // code validation
+  bool m_bWatchDepth;
+  bool m_bTickCodec;
 
   Fundamentals_t m_fundamentals;
   Summary_t m_summary;
@@ -154,6 +168,7 @@ private:
 
   void HandleQuote( const Quote& quote );
   void HandleTrade( const Trade& trade );
+  void HandleDepth( const MarketDepth& depth );
 
   void HandleIQFeedFundamentalMessage( ou::tf::IQFeedSymbol& symbol );
   void HandleIQFeedSummaryMessage( ou::tf::IQFeedSymbol& symbol );
@@ -0,0 +1,76 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    FormatFixed.h
+ * Author:  raymond@burkholder.net
+ * Project: TFVuTrading
+ * Created: May 28, 2020, 09:15
+ */
+
+// fixed point text for a double, as a stream with std::fixed and std::setprecision would give,
+//   but without the stream: no locale, no allocation, digits written straight into the buffer
+//   rounds half away from zero, the stream rounds the exact binary value, so the two may differ
+//     in the last digit on a value sitting on the half, eg 0.125 to two places
+//   precision is capped at 9 places, larger values (1e15 and up, once scaled), nan and inf go to snprintf,
+//     cut to the buffer
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+const size_t c_nFormatFixedBuffer( 32 ); // characters, with the terminator
+
+// returns the length, sz is terminated, and must hold c_nFormatFixedBuffer characters
+inline size_t FormatFixed( double dbl, unsigned int nPrecision, char* sz ) {
+
+  static const double rScale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+  if ( 9 < nPrecision ) nPrecision = 9;
+
+  const double dblScaled( std::fabs( dbl ) * rScale[ nPrecision ] );
+  if ( !( dblScaled < 1e15 ) ) { // also nan
+    const int n( std::snprintf( sz, c_nFormatFixedBuffer, "%.*f", nPrecision, dbl ) );
+    return ( n < 0 ) ? 0 : std::min<size_t>( n, c_nFormatFixedBuffer - 1 );
+  }
+
+  uint64_t n( static_cast<uint64_t>( dblScaled + 0.5 ) );
+
+  char rDigit[ c_nFormatFixedBuffer ];
+  char* p( rDigit + c_nFormatFixedBuffer );
+  for ( unsigned int ix = 0; ix < nPrecision; ++ix ) {
+    *--p = '0' + ( n % 10 );
+    n /= 10;
+  }
+  if ( 0 < nPrecision ) *--p = '.';
+  do {
+    *--p = '0' + ( n % 10 );
+    n /= 10;
+  } while ( 0 != n );
+  if ( std::signbit( dbl ) ) *--p = '-'; // as the stream, -0.001 to two places is -0.00
+
+  const size_t nLength( rDigit + c_nFormatFixedBuffer - p );
+  for ( size_t ix = 0; ix < nLength; ++ix ) sz[ ix ] = p[ ix ];
+  sz[ nLength ] = 0;
+  return nLength;
+}
+
+} // namespace tf
+} // namespace ou
@@ -26,7 +26,7 @@ namespace ou { // One Unified
 namespace tf { // TradeFrame
 
 GridOptionChain_impl::GridOptionChain_impl( GridOptionChain& details )
-: m_details( details ), m_bTimerActive( false ) {
+: m_details( details ), m_changes( GRID_ARRAY_COL_COUNT ), m_bTimerActive( false ) {
 }
 
 void GridOptionChain_impl::CreateControls() {
@@ -95,12 +95,12 @@ void GridOptionChain_impl::Add( double strike, ou::tf::OptionSide::enumOptionSid
   if ( m_mapOptionValueRow.end() == iter ) {
     iter = m_mapOptionValueRow.insert( 
       m_mapOptionValueRow.begin(),
-      mapOptionValueRow_t::value_type( strike, OptionValueRow( m_details, strike ) ) );
+      mapOptionValueRow_t::value_type( strike, OptionValueRow( m_details, m_changes.AddRow( 0 ), strike ) ) );
     
     struct Reindex {
       size_t ix;
       Reindex(): ix{} {}
-      void operator()( OptionValueRow& row ) { row.m_nRow = ix; ix++; }
+      void operator()( OptionValueRow& row ) { row.SetRow( ix ); ix++; }
     };
     
     Reindex reindex; 
@@ -137,14 +137,11 @@ void GridOptionChain_impl::SetSelected(double strike, bool bSelected) {
   // TODO: actually enable/disable watch?
 }
 
-// replace my the 'option engine'?
+// only the cells changed since the last tick, visible or not, the grid repaints only those on screen
 void GridOptionChain_impl::HandleGuiRefresh( wxTimerEvent& event ) {
-  // need extra validation here, crash when redrawing with active options
-  std::for_each( m_mapOptionValueRow.begin(), m_mapOptionValueRow.end(),
-    [this](mapOptionValueRow_t::value_type& value) {
-      if ( m_details.IsVisible( value.second.m_nRow, COL_Strike ) ) {
-        value.second.UpdateGui();
-      }
+  m_changes.Drain(
+    [this]( int nRow, size_t ixCol, const char* sz, size_t nLength ) {
+      m_details.SetCellValue( nRow, ixCol, wxString( sz, nLength ) );
     }
   );
 }
@@ -30,8 +30,8 @@
 //#include <wx/sizer.h>
 
 #include <TFVuTrading/ModelCell.h>
-#include <TFVuTrading/ModelCell_ops.h>
 #include <TFVuTrading/ModelCell_macros.h>
+#include <TFVuTrading/ModelChangeSet.h>
 
 #include "GridOptionChain.h"
 
@@ -75,52 +75,49 @@ struct GridOptionChain_impl {
     BOOST_PP_REPEAT(GRID_ARRAY_COL_COUNT,GRID_EXTRACT_ENUM_LIST,0)
   };
 
-  typedef boost::fusion::VECTOR_DEF<
-    BOOST_PP_REPEAT(GRID_ARRAY_COL_COUNT,COMPOSE_MODEL_CELL,4)
-  > vModelCells_t;
-  
+  // the feed threads set cells, the gui timer drains the ones changed, see ModelChangeSet.h
   struct OptionValueRow {
   //public:
-    OptionValueRow( wxGrid& grid, double strike )
-      : m_grid( grid ), m_nRow {}, m_bSelected( false )
+    OptionValueRow( wxGrid& grid, ModelChangeSet::pRow_t pCells, double strike )
+      : m_grid( grid ), m_nRow {}, m_bSelected( false ), m_pCells( pCells )
       { 
-	      Init(); 
-        boost::fusion::at_c<COL_Strike>( m_vModelCells ).SetValue( strike );
+        Init(); 
+        m_pCells->Set( COL_Strike, strike );
       }
     OptionValueRow( const OptionValueRow& rhs )
-      : m_grid( rhs.m_grid ), m_nRow( rhs.m_nRow ), m_bSelected( rhs.m_bSelected )
+      : m_grid( rhs.m_grid ), m_nRow( rhs.m_nRow ), m_bSelected( rhs.m_bSelected ), m_pCells( rhs.m_pCells )
     { 
       Init(); 
-      boost::fusion::at_c<COL_Strike>( m_vModelCells ).SetValue( boost::fusion::at_c<COL_Strike>( rhs.m_vModelCells ).GetValue() );
     }
     ~OptionValueRow( void ) {}
     
-    void UpdateGui( void ) {
-      boost::fusion::for_each( m_vModelCells, ModelCell_ops::UpdateGui( m_grid, m_nRow ) );
+    void SetRow( int nRow ) {
+      m_nRow = nRow;
+      m_pCells->SetRow( nRow );
     }
     void UpdateCallGreeks( const ou::tf::Greek& greek ) {
-      boost::fusion::at_c<COL_CallIV>( m_vModelCells ).SetValue( greek.ImpliedVolatility() );
-      boost::fusion::at_c<COL_CallDelta>( m_vModelCells ).SetValue( greek.Delta() );
-      boost::fusion::at_c<COL_CallGamma>( m_vModelCells ).SetValue( greek.Gamma() );
+      m_pCells->Set( COL_CallIV, greek.ImpliedVolatility() );
+      m_pCells->Set( COL_CallDelta, greek.Delta() );
+      m_pCells->Set( COL_CallGamma, greek.Gamma() );
     }
     void UpdateCallQuote( const ou::tf::Quote& quote ) {
-      boost::fusion::at_c<COL_CallBid>( m_vModelCells ).SetValue( quote.Bid() );
-      boost::fusion::at_c<COL_CallAsk>( m_vModelCells ).SetValue( quote.Ask() );
+      m_pCells->Set( COL_CallBid, quote.Bid() );
+      m_pCells->Set( COL_CallAsk, quote.Ask() );
     }
     void UpdateCallTrade( const ou::tf::Trade& trade ) {
-      boost::fusion::at_c<COL_CallLast>( m_vModelCells ).SetValue( trade.Price() );
+      m_pCells->Set( COL_CallLast, trade.Price() );
     }
     void UpdatePutGreeks( const ou::tf::Greek& greek ) {
-      boost::fusion::at_c<COL_PutIV>( m_vModelCells ).SetValue( greek.ImpliedVolatility() );
-      boost::fusion::at_c<COL_PutDelta>( m_vModelCells ).SetValue( greek.Delta() );
-      boost::fusion::at_c<COL_PutGamma>( m_vModelCells ).SetValue( greek.Gamma() );
-}
+      m_pCells->Set( COL_PutIV, greek.ImpliedVolatility() );
+      m_pCells->Set( COL_PutDelta, greek.Delta() );
+      m_pCells->Set( COL_PutGamma, greek.Gamma() );
+    }
     void UpdatePutQuote( const ou::tf::Quote& quote ) {
-      boost::fusion::at_c<COL_PutBid>( m_vModelCells ).SetValue( quote.Bid() );
-      boost::fusion::at_c<COL_PutAsk>( m_vModelCells ).SetValue( quote.Ask() );
+      m_pCells->Set( COL_PutBid, quote.Bid() );
+      m_pCells->Set( COL_PutAsk, quote.Ask() );
     }
     void UpdatePutTrade( const ou::tf::Trade& trade ) {
-      boost::fusion::at_c<COL_PutLast>( m_vModelCells ).SetValue( trade.Price() );
+      m_pCells->Set( COL_PutLast, trade.Price() );
     }
   //protected:
   //private:
@@ -132,14 +129,15 @@ struct GridOptionChain_impl {
     
     wxGrid& m_grid;
     int m_nRow;
-    vModelCells_t m_vModelCells;
+    ModelChangeSet::pRow_t m_pCells; // owned by GridOptionChain_impl::m_changes
     
     void Init( void ) {
-      boost::fusion::fold( m_vModelCells, 0, ModelCell_ops::SetCol() );
       BOOST_PP_REPEAT(GRID_ARRAY_COL_COUNT,COL_ALIGNMENT,m_nRow)
     }
   };  // struct OptionValueRow
   
+  ModelChangeSet m_changes;
+
   typedef std::map<double,OptionValueRow> mapOptionValueRow_t;
   typedef mapOptionValueRow_t::iterator mapOptionValueRow_iter;
   mapOptionValueRow_t m_mapOptionValueRow;
@@ -28,6 +28,8 @@ using namespace fastdelegate;
 #define WINRGB
 #include <OUCommon/Colour.h>
 
+#include "FormatFixed.h"
+
 // when ready for owner draw
 // depends upon amount of flicker
 // gtscalp/datarow (composition of elements), datarowelements(data change management), visibleelement (draw onto graphics area) for 
@@ -148,19 +150,12 @@ public:
 protected:
 private:
   unsigned int m_nPrecision;
-  std::stringstream ss;
   void Initialize() {
-    // speed vs space optimization?
-    //ss.precision( m_nPrecision );
-    //ss.setf( std::ios::fixed, std:: ios::floatfield );
   }
   void Val2String( void ) {
-    std::stringstream().swap(ss);
-    // ss.setf( std::ios::fixed, std:: ios::floatfield );
-    //ss.precision( m_nPrecision );
-    ss << std::setprecision(m_nPrecision) << std::fixed << m_val;
-    //ss << m_val;
-    m_sCellText = ss.str();
+    char sz[ c_nFormatFixedBuffer ];
+    const size_t nLength( FormatFixed( m_val, m_nPrecision, sz ) );
+    m_sCellText = wxString( sz, nLength );
   }
 };
 
@@ -0,0 +1,66 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ModelChangeSet.cpp
+ * Author:  raymond@burkholder.net
+ * Project: TFVuTrading
+ * Created: May 28, 2020, 09:40
+ */
+
+#include <cassert>
+
+#include "ModelChangeSet.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+ModelChangeSet::ModelChangeSet( size_t nColumns )
+: m_nColumns( nColumns ), m_vPrecision( nColumns, 2 ), m_queue( 0 )
+{
+  assert( 0 < m_nColumns );
+}
+
+ModelChangeSet::~ModelChangeSet() {}
+
+void ModelChangeSet::SetPrecision( size_t ixCol, unsigned int nPrecision ) {
+  assert( ixCol < m_nColumns );
+  m_vPrecision[ ixCol ] = nPrecision;
+}
+
+ModelChangeSet::pRow_t ModelChangeSet::AddRow( int nRow ) {
+  m_queue.reserve( m_nColumns ); // a node for each new cell, so a Set never allocates
+  std::unique_ptr<Row> pRow( new Row( *this, nRow ) );
+  for ( size_t ix = 0; ix < m_nColumns; ++ix ) {
+    Cell& cell( pRow->m_rCell[ ix ] );
+    cell.bQueued.store( true );
+    Queue( &cell );
+  }
+  m_vRow.emplace_back( std::move( pRow ) );
+  return m_vRow.back().get();
+}
+
+void ModelChangeSet::Queue( Cell* pCell ) {
+  m_queue.push( pCell ); // takes a reserved node, allocates only if the reserve is short
+}
+
+ModelChangeSet::Row::Row( ModelChangeSet& set, int nRow )
+: m_set( set ), m_nRow( nRow ), m_rCell( new Cell[ set.m_nColumns ] )
+{
+  for ( size_t ix = 0; ix < set.m_nColumns; ++ix ) {
+    m_rCell[ ix ].pRow = this;
+  }
+}
+
+} // namespace tf
+} // namespace ou
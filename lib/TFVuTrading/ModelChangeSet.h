@@ -0,0 +1,144 @@
+/************************************************************************
+ * Copyright(c) 2020, One Unified. All rights reserved.                 *
+ * email: info@oneunified.net                                           *
+ *                                                                      *
+ * This file is provided as is WITHOUT ANY WARRANTY                     *
+ *  without even the implied warranty of                                *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.                *
+ *                                                                      *
+ * This software may not be used nor distributed without proper license *
+ * agreement.                                                           *
+ *                                                                      *
+ * See the file LICENSE.txt for redistribution information.             *
+ ************************************************************************/
+/*
+ * File:    ModelChangeSet.h
+ * Author:  raymond@burkholder.net
+ * Project: TFVuTrading
+ * Created: May 28, 2020, 09:40
+ */
+
+// the numeric cells of a grid fed from other threads, with no wx dependency
+//   a feed thread sets a cell: the value is stored atomically, and the first change since the
+//     cell was last drained puts the cell on a lock free queue, later changes only replace the value
+//   the gui thread drains on its timer: each queued cell is taken off, its latest value read,
+//     and when its text would differ from what was last shown, formatted and handed over,
+//     so a tick costs in proportion to the cells changed, not to the size of the grid
+//   rows are added on the gui thread, and kept for the life of the set, a row handle is stable
+//   the grid row of a row is whatever its owner assigns, on the gui thread
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include <boost/lockfree/queue.hpp>
+
+#include "FormatFixed.h"
+
+namespace ou { // One Unified
+namespace tf { // TradeFrame
+
+class ModelChangeSet {
+public:
+
+  class Row;
+  using pRow_t = Row*;
+
+  explicit ModelChangeSet( size_t nColumns );
+  ~ModelChangeSet();
+
+  size_t Columns() const { return m_nColumns; }
+  size_t Rows() const { return m_vRow.size(); }
+
+  // gui thread
+  void SetPrecision( size_t ixCol, unsigned int nPrecision ); // default 2, for text not yet drained
+  pRow_t AddRow( int nRow ); // each cell is queued, so the first drain shows the initial values
+
+  // gui thread: f( int nRow, size_t ixCol, const char* sz, size_t nLength ), returns cells handed to f
+  template<typename F>
+  size_t Drain( F&& f );
+
+  class Row {
+  public:
+    void Set( size_t ixCol, double dbl ); // any thread
+    double Get( size_t ixCol ) const;     // any thread, the latest value
+    void SetRow( int nRow ) { m_nRow = nRow; } // gui thread
+    int GetRow() const { return m_nRow; }
+  protected:
+  private:
+    friend class ModelChangeSet;
+    struct Cell {
+      std::atomic<uint64_t> nValue; // bits of the double
+      std::atomic<bool> bQueued;
+      uint64_t nShown; // gui thread, bits of the value last formatted
+      bool bShown;
+      Row* pRow;
+      Cell(): nValue( 0 ), bQueued( false ), nShown( 0 ), bShown( false ), pRow( nullptr ) {}
+    };
+    ModelChangeSet& m_set;
+    int m_nRow;
+    std::unique_ptr<Cell[]> m_rCell;
+    Row( ModelChangeSet&, int nRow );
+  };
+
+protected:
+private:
+
+  using Cell = Row::Cell;
+
+  const size_t m_nColumns;
+  std::vector<unsigned int> m_vPrecision;
+  std::vector<std::unique_ptr<Row> > m_vRow;
+
+  boost::lockfree::queue<Cell*> m_queue; // a cell is in the queue at most once, nodes are reserved by AddRow
+
+  void Queue( Cell* pCell );
+};
+
+inline void ModelChangeSet::Row::Set( size_t ixCol, double dbl ) {
+  Cell& cell( m_rCell[ ixCol ] );
+  uint64_t nValue;
+  std::memcpy( &nValue, &dbl, sizeof( nValue ) );
+  if ( nValue == cell.nValue.load( std::memory_order_relaxed ) ) return;
+  cell.nValue.store( nValue, std::memory_order_release );
+  if ( !cell.bQueued.exchange( true, std::memory_order_acq_rel ) ) {
+    m_set.Queue( &cell );
+  }
+}
+
+inline double ModelChangeSet::Row::Get( size_t ixCol ) const {
+  const uint64_t nValue( m_rCell[ ixCol ].nValue.load( std::memory_order_acquire ) );
+  double dbl;
+  std::memcpy( &dbl, &nValue, sizeof( dbl ) );
+  return dbl;
+}
+
+template<typename F>
+size_t ModelChangeSet::Drain( F&& f ) {
+  size_t cnt {};
+  char sz[ c_nFormatFixedBuffer ];
+  Cell* pCell;
+  while ( m_queue.pop( pCell ) ) {
+    // un-mark before the read, a Set from here on queues the cell again,
+    //   and the exchange acquires what the Set which queued it stored
+    pCell->bQueued.exchange( false, std::memory_order_acq_rel );
+    const uint64_t nValue( pCell->nValue.load( std::memory_order_acquire ) );
+    if ( pCell->bShown && ( nValue == pCell->nShown ) ) continue; // changed and changed back
+    pCell->nShown = nValue;
+    pCell->bShown = true;
+    const size_t ixCol( pCell - pCell->pRow->m_rCell.get() );
+    double dbl;
+    std::memcpy( &dbl, &nValue, sizeof( dbl ) );
+    const size_t nLength( FormatFixed( dbl, m_vPrecision[ ixCol ], sz ) );
+    f( pCell->pRow->m_nRow, ixCol, sz, nLength );
+    ++cnt;
+  }
+  return cnt;
+}
+
+} // namespace tf
+} // namespace ou